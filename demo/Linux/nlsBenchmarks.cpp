@@ -0,0 +1,920 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * 传输热路径的离线微基准测试, 不连接任何服务端.
+ * 覆盖WebSocket帧封装/解析, OPU/OggOpus编码, 服务端事件json解析,
+ * start指令生成, 多线程竞争下的NlsNodeManager::checkNodeExist,
+ * 未开启的日志点, 以及permessage-deflate对录制消息的压缩率和压缩/解压耗时.
+ * 以-DLOG_COMPILE_LEVEL=3编译时, 日志点用例测得的是编译期移除的LOG_DEBUG.
+ *
+ * 结果以Google Benchmark兼容的json格式输出, 可直接使用其
+ * tools/compare.py对比两个版本:
+ *   ./nls_benchmarks --benchmark_out=v1.json
+ *   compare.py benchmarks v1.json v2.json
+ *
+ * 参数:
+ *   --benchmark_filter=<子串>      只运行名称包含此子串的用例
+ *   --benchmark_min_time=<秒>      每个用例的最短运行时间, 默认0.5
+ *   --benchmark_repetitions=<次数> 每个用例重复次数, 默认1
+ *   --benchmark_out=<文件>         json结果写入文件, 默认写到标准输出
+ *   --audio=<wav/pcm文件>          编码用例使用的16k16bit单声道音频,
+ *                                  默认使用合成音频
+ *   --messages=<文件>              json解析用例使用的录制消息, 每行一条,
+ *                                  默认使用内置的实时识别消息
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dashParaformerTranscriberParam.h"
+#include "nlsClient.h"
+#include "nlsEncoder.h"
+#include "nlsEventInner.h"
+#include "nlsGlobal.h"
+#include "nlog.h"
+#include "nodeManager.h"
+#include "speechTranscriberParam.h"
+#include "speechTranscriberRequest.h"
+#include "webSocketTcp.h"
+#ifdef ENABLE_WS_DEFLATE
+#include "wsDeflate.h"
+#endif
+
+using namespace AlibabaNls;
+
+namespace {
+
+struct BenchmarkOptions {
+  std::string filter;
+  double minTimeSec;
+  int repetitions;
+  std::string outFile;
+  std::string audioFile;
+  std::string messagesFile;
+};
+
+/* 单次运行的输入和产出, 由用例函数填写处理的字节数/条目数 */
+struct BenchmarkState {
+  uint64_t iterations;
+  int threads;
+  size_t arg;
+  uint64_t bytesProcessed;
+  uint64_t itemsProcessed;
+  double compressionRatio; /* 原始字节数/压缩后字节数, 0表示不输出 */
+  std::string error;
+};
+
+typedef void (*BenchmarkFunc)(BenchmarkState& state);
+
+struct BenchmarkCase {
+  std::string name;
+  BenchmarkFunc func;
+  size_t arg;
+  int threads;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  std::string runName;
+  int repetitionIndex;
+  int threads;
+  uint64_t iterations;
+  double realTimeNs;
+  double cpuTimeNs;
+  double bytesPerSecond;
+  double itemsPerSecond;
+  double compressionRatio;
+  std::string error;
+};
+
+BenchmarkOptions g_options;
+std::vector<uint8_t> g_pcm;
+std::vector<std::string> g_nlsMessages;
+std::vector<std::string> g_dashMessages;
+
+uint64_t nowNs(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* 防止编译器把基准测试的结果优化掉 */
+template <class T>
+void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+std::string jsonEscape(const std::string& str) {
+  std::string out;
+  for (size_t i = 0; i < str.size(); i++) {
+    char c = str[i];
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if ((unsigned char)c < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+/* ---------------- 测试数据 ---------------- */
+
+void loadAudio() {
+  if (!g_options.audioFile.empty()) {
+    std::ifstream fs(g_options.audioFile.c_str(),
+                     std::ios::in | std::ios::binary);
+    if (fs.is_open()) {
+      g_pcm.assign(std::istreambuf_iterator<char>(fs),
+                   std::istreambuf_iterator<char>());
+      /* 去掉标准wav头 */
+      if (g_pcm.size() > 44 && memcmp(&g_pcm[0], "RIFF", 4) == 0) {
+        g_pcm.erase(g_pcm.begin(), g_pcm.begin() + 44);
+      }
+    } else {
+      std::cerr << "open audio file " << g_options.audioFile << " failed, "
+                << "use synthetic audio." << std::endl;
+    }
+  }
+  if (g_pcm.size() >= 3200) {
+    return;
+  }
+
+  /* 10s的合成语音: 基频与谐波加少量噪声, 让编码器有真实的工作量 */
+  const int sampleRate = 16000;
+  const int samples = sampleRate * 10;
+  g_pcm.resize(samples * 2);
+  uint32_t seed = 12345;
+  for (int i = 0; i < samples; i++) {
+    double t = (double)i / sampleRate;
+    double f0 = 160.0 + 40.0 * sin(2 * M_PI * 0.5 * t);
+    double v = 0.5 * sin(2 * M_PI * f0 * t) +
+               0.25 * sin(2 * M_PI * 2 * f0 * t) +
+               0.1 * sin(2 * M_PI * 3 * f0 * t);
+    seed = seed * 1103515245 + 12345;
+    v += ((double)((seed >> 16) & 0x7fff) / 32768.0 - 0.5) * 0.05;
+    int16_t s = (int16_t)(v * 12000);
+    g_pcm[i * 2] = (uint8_t)(s & 0xff);
+    g_pcm[i * 2 + 1] = (uint8_t)((s >> 8) & 0xff);
+  }
+}
+
+void loadMessages() {
+  if (!g_options.messagesFile.empty()) {
+    std::ifstream fs(g_options.messagesFile.c_str());
+    std::string line;
+    while (std::getline(fs, line)) {
+      if (line.empty()) {
+        continue;
+      }
+      if (line.find("\"event\"") != std::string::npos) {
+        g_dashMessages.push_back(line);
+      } else {
+        g_nlsMessages.push_back(line);
+      }
+    }
+  }
+  if (!g_nlsMessages.empty() || !g_dashMessages.empty()) {
+    return;
+  }
+
+  /* 实时识别过程中录制的典型消息 */
+  g_nlsMessages.push_back(
+      "{\"header\":{\"namespace\":\"SpeechTranscriber\",\"name\":"
+      "\"TranscriptionStarted\",\"status\":20000000,\"message_id\":"
+      "\"a4d2f0c2b3e14a6b8f3b2f4b5d1c0e9a\",\"task_id\":"
+      "\"5ec521b5aa104e3abccf3d361822xxxx\",\"status_text\":\"Gateway:"
+      "SUCCESS:Success.\"},\"payload\":{\"session_id\":"
+      "\"1231231dfdf232323\"}}");
+  g_nlsMessages.push_back(
+      "{\"header\":{\"namespace\":\"SpeechTranscriber\",\"name\":"
+      "\"TranscriptionResultChanged\",\"status\":20000000,\"message_id\":"
+      "\"dc21193fada84380a3b6137875abxxxx\",\"task_id\":"
+      "\"5ec521b5aa104e3abccf3d361822xxxx\",\"status_text\":\"Gateway:"
+      "SUCCESS:Success.\"},\"payload\":{\"index\":1,\"time\":1835,"
+      "\"result\":\"北京的天气\",\"confidence\":0.0,\"words\":[],"
+      "\"status\":0}}");
+  g_nlsMessages.push_back(
+      "{\"header\":{\"namespace\":\"SpeechTranscriber\",\"name\":"
+      "\"SentenceEnd\",\"status\":20000000,\"message_id\":"
+      "\"c3a9ae4b231649d5ae05d4af36fdxxxx\",\"task_id\":"
+      "\"5ec521b5aa104e3abccf3d361822xxxx\",\"status_text\":\"Gateway:"
+      "SUCCESS:Success.\"},\"payload\":{\"index\":1,\"time\":1820,"
+      "\"begin_time\":0,\"result\":\"北京的天气。\",\"confidence\":0.87,"
+      "\"words\":[{\"text\":\"北京\",\"startTime\":630,\"endTime\":930},"
+      "{\"text\":\"的\",\"startTime\":930,\"endTime\":1110},"
+      "{\"text\":\"天气\",\"startTime\":1110,\"endTime\":1820}],"
+      "\"status\":0,\"stash_result\":{\"sentenceId\":2,\"beginTime\":1820,"
+      "\"text\":\"\",\"currentTime\":1820}}}");
+  g_nlsMessages.push_back(
+      "{\"header\":{\"namespace\":\"SpeechTranscriber\",\"name\":"
+      "\"TranscriptionCompleted\",\"status\":20000000,\"message_id\":"
+      "\"371ba5a4d1b9495289a1b4ae9b8axxxx\",\"task_id\":"
+      "\"5ec521b5aa104e3abccf3d361822xxxx\",\"status_text\":\"Gateway:"
+      "SUCCESS:Success.\"},\"payload\":{}}");
+
+  g_dashMessages.push_back(
+      "{\"header\":{\"task_id\":\"2bf83b9a-baeb-4fda-8d9a-xxxxxxxxxxxx\","
+      "\"event\":\"result-generated\",\"attributes\":{}},\"payload\":"
+      "{\"output\":{\"sentence\":{\"begin_time\":170,\"end_time\":920,"
+      "\"text\":\"好，我知道了\",\"heartbeat\":false,\"sentence_end\":true,"
+      "\"words\":[{\"begin_time\":170,\"end_time\":295,\"text\":\"好\","
+      "\"punctuation\":\"，\"},{\"begin_time\":295,\"end_time\":503,"
+      "\"text\":\"我\",\"punctuation\":\"\"},{\"begin_time\":503,"
+      "\"end_time\":711,\"text\":\"知道\",\"punctuation\":\"\"},"
+      "{\"begin_time\":711,\"end_time\":920,\"text\":\"了\","
+      "\"punctuation\":\"\"}]}},\"usage\":{\"duration\":3}}}");
+}
+
+/* 构造服务端下发的不带掩码的WebSocket帧 */
+std::vector<uint8_t> buildServerFrame(WebSocketHeaderType::OpCodeType type,
+                                      size_t length) {
+  std::vector<uint8_t> frame;
+  frame.push_back(0x80 | type);
+  if (length < 126) {
+    frame.push_back((uint8_t)length);
+  } else if (length < 65536) {
+    frame.push_back(126);
+    frame.push_back((length >> 8) & 0xff);
+    frame.push_back(length & 0xff);
+  } else {
+    frame.push_back(127);
+    for (int i = 7; i >= 0; i--) {
+      frame.push_back(((uint64_t)length >> (i * 8)) & 0xff);
+    }
+  }
+  for (size_t i = 0; i < length; i++) {
+    frame.push_back(type == WebSocketHeaderType::TEXT_FRAME
+                        ? (uint8_t)('a' + i % 26)
+                        : (uint8_t)(i * 31));
+  }
+  return frame;
+}
+
+/* ---------------- 用例 ---------------- */
+
+/* 客户端发送帧的封装(复制并加掩码), arg为载荷字节数 */
+void BM_FramePackage(BenchmarkState& state) {
+  WebSocketTcp ws;
+  ws.setMaskKey(0x9e3779b9);
+  std::vector<uint8_t> payload(state.arg);
+  for (size_t i = 0; i < payload.size(); i++) {
+    payload[i] = (uint8_t)i;
+  }
+  std::vector<uint8_t> frame(WebSocketTcp::frameHeaderSize(state.arg) +
+                             state.arg);
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    size_t frameSize = ws.framePackage(WebSocketHeaderType::BINARY_FRAME,
+                                       &payload[0], payload.size(), &frame[0]);
+    if (frameSize != frame.size()) {
+      state.error = "framePackage failed";
+      return;
+    }
+    doNotOptimize(frame);
+  }
+  state.bytesProcessed = state.iterations * state.arg;
+}
+
+/* 载荷已位于预留的帧头空间之后, 原地加掩码, arg为载荷字节数 */
+void BM_FramePackageInPlace(BenchmarkState& state) {
+  WebSocketTcp ws;
+  ws.setMaskKey(0x9e3779b9);
+  const size_t headroom = WebSocketTcp::frameHeaderSize(state.arg);
+  std::vector<uint8_t> frame(headroom + state.arg);
+  for (size_t i = 0; i < state.arg; i++) {
+    frame[headroom + i] = (uint8_t)i;
+  }
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    size_t frameSize =
+        ws.framePackage(WebSocketHeaderType::BINARY_FRAME, &frame[headroom],
+                        state.arg, &frame[0]);
+    if (frameSize != frame.size()) {
+      state.error = "framePackage failed";
+      return;
+    }
+    doNotOptimize(frame);
+  }
+  state.bytesProcessed = state.iterations * state.arg;
+}
+
+void receiveFrame(BenchmarkState& state, WebSocketHeaderType::OpCodeType type) {
+  WebSocketTcp ws;
+  std::vector<uint8_t> frame = buildServerFrame(type, state.arg);
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    WebSocketHeaderType wsType;
+    WebSocketFrame rData;
+    memset(&wsType, 0, sizeof(wsType));
+    memset(&rData, 0, sizeof(rData));
+    int ret =
+        ws.receiveFullWebSocketFrame(&frame[0], frame.size(), &wsType, &rData);
+    if (ret != Success || rData.length != state.arg) {
+      state.error = "receiveFullWebSocketFrame failed";
+      return;
+    }
+    doNotOptimize(rData);
+  }
+  state.bytesProcessed = state.iterations * frame.size();
+}
+
+/* 服务端文本帧(识别结果)解析, arg为载荷字节数 */
+void BM_ReceiveTextFrame(BenchmarkState& state) {
+  receiveFrame(state, WebSocketHeaderType::TEXT_FRAME);
+}
+
+/* 服务端二进制帧(合成音频)解析, arg为载荷字节数 */
+void BM_ReceiveBinaryFrame(BenchmarkState& state) {
+  receiveFrame(state, WebSocketHeaderType::BINARY_FRAME);
+}
+
+void encodeAudio(BenchmarkState& state, ENCODER_TYPE type) {
+  NlsEncoder encoder;
+  int errorCode = 0;
+  if (encoder.createNlsEncoder(type, 1, 16000, &errorCode) != Success) {
+    state.error = "createNlsEncoder failed";
+    return;
+  }
+  /* OPU固定640字节, OggOpus由编码器决定每帧字节数 */
+  const int frameBytes = encoder.getFrameSampleBytes();
+  const size_t frames = g_pcm.size() / frameBytes;
+  if (frameBytes <= 0 || frames == 0) {
+    state.error = "invalid frame size";
+    encoder.destroyNlsEncoder();
+    return;
+  }
+  std::vector<unsigned char> output(frameBytes);
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    const uint8_t* pcm = &g_pcm[(i % frames) * frameBytes];
+    int ret = encoder.nlsEncoding(pcm, frameBytes, &output[0], frameBytes);
+    if (ret < 0) {
+      state.error = "nlsEncoding failed";
+      break;
+    }
+    doNotOptimize(output);
+  }
+  encoder.destroyNlsEncoder();
+  state.bytesProcessed = state.iterations * frameBytes;
+}
+
+/* 每次编码一帧(20ms)16k单声道PCM */
+void BM_NlsEncodingOpu(BenchmarkState& state) {
+  encodeAudio(state, ENCODER_OPU);
+}
+
+void BM_NlsEncodingOggOpus(BenchmarkState& state) {
+  encodeAudio(state, ENCODER_OPUS);
+}
+
+void parseMessages(BenchmarkState& state, const std::vector<std::string>& msgs,
+                   NlsType nlsType, NlsServiceProtocol protocol) {
+  if (msgs.empty()) {
+    state.error = "no messages";
+    return;
+  }
+  uint64_t bytes = 0;
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    const std::string& msg = msgs[i % msgs.size()];
+    NlsEventInner event(msg, nlsType, protocol);
+    if (event.parseJsonMsg() != Success) {
+      state.error = "parseJsonMsg failed";
+      return;
+    }
+    doNotOptimize(event);
+    bytes += msg.size();
+  }
+  state.bytesProcessed = bytes;
+  state.itemsProcessed = state.iterations;
+}
+
+/* 轮流解析录制的NLS实时识别消息 */
+void BM_ParseJsonMsgNls(BenchmarkState& state) {
+  parseMessages(state, g_nlsMessages, TypeRealTime, WsServiceProtocolNls);
+}
+
+/* 轮流解析录制的DashScope Paraformer消息 */
+void BM_ParseJsonMsgDashScope(BenchmarkState& state) {
+  parseMessages(state, g_dashMessages, TypeDashScopeParaformerRealTime,
+                WsServiceProtocolDashScope);
+}
+
+void BM_GetStartCommandNls(BenchmarkState& state) {
+  SpeechTranscriberParam param;
+  param.setAppKey("benchmark-appkey");
+  param.setFormat("opu");
+  param.setSampleRate(16000);
+  param.setIntermediateResult(true);
+  param.setPunctuationPrediction(true);
+  param.setTextNormalization(true);
+  param.setPayloadParam("{\"vocabulary_id\":\"benchmark\",\"disfluency\":true}");
+  param.setContextParam("{\"custom\":{\"user\":\"benchmark\"}}");
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    const char* cmd = param.getStartCommand();
+    doNotOptimize(cmd);
+  }
+  state.itemsProcessed = state.iterations;
+}
+
+void BM_GetStartCommandDashScope(BenchmarkState& state) {
+  DashParaformerTranscriberParam param;
+  param.setAPIKey("benchmark-apikey");
+  param.setModel("paraformer-realtime-v2");
+  param.setFormat("pcm");
+  param.setSampleRate(16000);
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    const char* cmd = param.getStartCommand();
+    doNotOptimize(cmd);
+  }
+  state.itemsProcessed = state.iterations;
+}
+
+/* 日志参数被求值的次数, 未开启的日志点应保持为0 */
+uint64_t g_logArgEvaluated = 0;
+
+const char* logArgument() {
+  g_logArgEvaluated++;
+  return "benchmark";
+}
+
+/*
+ * 未开启的LOG_DEBUG日志点: 日志实例未配置, 运行时级别未开启,
+ * 或NLS_LOG_COMPILE_LEVEL低于4时在编译期移除. 均不应对参数求值.
+ */
+void BM_LogDisabledSite(BenchmarkState& state) {
+  utility::NlsLog::getInstance();
+  g_logArgEvaluated = 0;
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    LOG_DEBUG("Node(%p) iteration(%llu) %s.", &state, (unsigned long long)i,
+              logArgument());
+  }
+  if (g_logArgEvaluated > 0) {
+    state.error = "disabled log site evaluated its arguments";
+  }
+  state.itemsProcessed = state.iterations;
+}
+
+struct CheckNodeContext {
+  NlsNodeManager* manager;
+  std::vector<void*>* nodes;
+  uint64_t iterations;
+  int failed;
+};
+
+void* checkNodeRoutine(void* arg) {
+  CheckNodeContext* ctx = static_cast<CheckNodeContext*>(arg);
+  const std::vector<void*>& nodes = *ctx->nodes;
+  int status = 0;
+  for (uint64_t i = 0; i < ctx->iterations; i++) {
+    if (ctx->manager->checkNodeExist(nodes[i % nodes.size()], &status) !=
+        Success) {
+      ctx->failed++;
+    }
+  }
+  return NULL;
+}
+
+/*
+ * 多个WorkThread回调同时校验node时的竞争情况,
+ * threads为竞争线程数, 每个线程执行iterations次校验
+ */
+void BM_CheckNodeExist(BenchmarkState& state) {
+  const int nodeCount = 64;
+  int instance = 0;
+  NlsNodeManager manager;
+  std::vector<SpeechTranscriberRequest*> requests;
+  std::vector<void*> nodes;
+  for (int i = 0; i < nodeCount; i++) {
+    SpeechTranscriberRequest* request = new SpeechTranscriberRequest();
+    manager.addRequestIntoInfoWithInstance(request, &instance);
+    requests.push_back(request);
+    nodes.push_back(request->getConnectNode());
+  }
+
+  std::vector<pthread_t> tids(state.threads);
+  std::vector<CheckNodeContext> ctxs(state.threads);
+  for (int i = 0; i < state.threads; i++) {
+    ctxs[i].manager = &manager;
+    ctxs[i].nodes = &nodes;
+    ctxs[i].iterations = state.iterations;
+    ctxs[i].failed = 0;
+    pthread_create(&tids[i], NULL, checkNodeRoutine, &ctxs[i]);
+  }
+  for (int i = 0; i < state.threads; i++) {
+    pthread_join(tids[i], NULL);
+    if (ctxs[i].failed > 0) {
+      state.error = "checkNodeExist failed";
+    }
+  }
+
+  for (int i = 0; i < nodeCount; i++) {
+    manager.removeRequestFromInfo(requests[i], false);
+    delete requests[i];
+  }
+  state.itemsProcessed = state.iterations * state.threads;
+}
+
+#ifdef ENABLE_WS_DEFLATE
+/* 录制的NLS和DashScope消息, 依次作为同一连接上的连续消息 */
+std::vector<std::string> deflateMessages() {
+  std::vector<std::string> messages(g_nlsMessages);
+  messages.insert(messages.end(), g_dashMessages.begin(), g_dashMessages.end());
+  return messages;
+}
+
+/*
+ * 与WebSocketTcp相同的压缩方式: raw deflate, 保留上下文,
+ * 每条消息Z_SYNC_FLUSH后去掉末尾的00 00 ff ff
+ */
+bool deflateMessage(z_stream* zs, const std::string& msg,
+                    std::vector<uint8_t>* out) {
+  out->resize(deflateBound(zs, msg.size()) + 16);
+  zs->next_in = (Bytef*)msg.data();
+  zs->avail_in = msg.size();
+  zs->next_out = &(*out)[0];
+  zs->avail_out = out->size();
+  if (deflate(zs, Z_SYNC_FLUSH) != Z_OK || zs->avail_in != 0 ||
+      zs->avail_out == 0) {
+    return false;
+  }
+  size_t n = out->size() - zs->avail_out;
+  if (n < 4) {
+    return false;
+  }
+  out->resize(n - 4);
+  return true;
+}
+
+/* 客户端压缩, 窗口和内存级别与WsDeflatePool一致 */
+void BM_DeflateTextMessage(BenchmarkState& state) {
+  std::vector<std::string> messages = deflateMessages();
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                   -WsDeflatePool::DeflateWindowBits,
+                   WsDeflatePool::DeflateMemLevel,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    state.error = "deflateInit2 failed";
+    return;
+  }
+  std::vector<uint8_t> out;
+  uint64_t rawBytes = 0, wireBytes = 0;
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    size_t index = i % messages.size();
+    /* 与解压用例一致, 录制消息视为一次会话, 回到第一条时重新开始 */
+    if (index == 0 && i > 0) {
+      deflateReset(&zs);
+    }
+    const std::string& msg = messages[index];
+    if (!deflateMessage(&zs, msg, &out)) {
+      state.error = "deflate failed";
+      break;
+    }
+    doNotOptimize(out);
+    rawBytes += msg.size();
+    wireBytes += out.size();
+  }
+  deflateEnd(&zs);
+  state.bytesProcessed = rawBytes;
+  state.itemsProcessed = state.iterations;
+  state.compressionRatio = wireBytes > 0 ? (double)rawBytes / wireBytes : 0;
+}
+
+/* 服务端以最大窗口压缩下发的消息, 客户端按InflateWindowBits解压 */
+void BM_InflateTextMessage(BenchmarkState& state) {
+  std::vector<std::string> messages = deflateMessages();
+  std::vector<std::vector<uint8_t> > compressed(messages.size());
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                   -WsDeflatePool::InflateWindowBits, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    state.error = "deflateInit2 failed";
+    return;
+  }
+  uint64_t rawTotal = 0, wireTotal = 0;
+  for (size_t i = 0; i < messages.size(); i++) {
+    if (!deflateMessage(&zs, messages[i], &compressed[i])) {
+      state.error = "deflate failed";
+      deflateEnd(&zs);
+      return;
+    }
+    /* 补回末尾的00 00 ff ff, 与WebSocketTcp::inflateFrame一致 */
+    const uint8_t tail[4] = {0x00, 0x00, 0xff, 0xff};
+    compressed[i].insert(compressed[i].end(), tail, tail + 4);
+    rawTotal += messages[i].size();
+    wireTotal += compressed[i].size() - 4;
+  }
+  deflateEnd(&zs);
+
+  memset(&zs, 0, sizeof(zs));
+  if (inflateInit2(&zs, -WsDeflatePool::InflateWindowBits) != Z_OK) {
+    state.error = "inflateInit2 failed";
+    return;
+  }
+  std::vector<uint8_t> out(65536);
+  uint64_t rawBytes = 0;
+  for (uint64_t i = 0; i < state.iterations; i++) {
+    size_t index = i % compressed.size();
+    /* 压缩流依赖之前的消息, 回到第一条时重新开始 */
+    if (index == 0 && i > 0) {
+      inflateReset(&zs);
+    }
+    zs.next_in = &compressed[index][0];
+    zs.avail_in = compressed[index].size();
+    zs.next_out = &out[0];
+    zs.avail_out = out.size();
+    int ret = inflate(&zs, Z_SYNC_FLUSH);
+    size_t n = out.size() - zs.avail_out;
+    if (ret != Z_OK || n != messages[index].size()) {
+      state.error = "inflate failed";
+      break;
+    }
+    doNotOptimize(out);
+    rawBytes += n;
+  }
+  inflateEnd(&zs);
+  state.bytesProcessed = rawBytes;
+  state.itemsProcessed = state.iterations;
+  state.compressionRatio = wireTotal > 0 ? (double)rawTotal / wireTotal : 0;
+}
+#endif  // ENABLE_WS_DEFLATE
+
+/* ---------------- 运行框架 ---------------- */
+
+std::vector<BenchmarkCase> registerCases() {
+  std::vector<BenchmarkCase> cases;
+  const size_t sendSizes[] = {128, 640, 3200, 70000};
+  for (size_t i = 0; i < sizeof(sendSizes) / sizeof(sendSizes[0]); i++) {
+    BenchmarkCase c = {"BM_FramePackage", BM_FramePackage, sendSizes[i], 1};
+    cases.push_back(c);
+  }
+  for (size_t i = 0; i < sizeof(sendSizes) / sizeof(sendSizes[0]); i++) {
+    BenchmarkCase c = {"BM_FramePackageInPlace", BM_FramePackageInPlace,
+                       sendSizes[i], 1};
+    cases.push_back(c);
+  }
+  const size_t textSizes[] = {100, 512, 4096};
+  for (size_t i = 0; i < sizeof(textSizes) / sizeof(textSizes[0]); i++) {
+    BenchmarkCase c = {"BM_ReceiveTextFrame", BM_ReceiveTextFrame,
+                       textSizes[i], 1};
+    cases.push_back(c);
+  }
+  const size_t binarySizes[] = {3200, 70000};
+  for (size_t i = 0; i < sizeof(binarySizes) / sizeof(binarySizes[0]); i++) {
+    BenchmarkCase c = {"BM_ReceiveBinaryFrame", BM_ReceiveBinaryFrame,
+                       binarySizes[i], 1};
+    cases.push_back(c);
+  }
+  BenchmarkCase single[] = {
+      {"BM_NlsEncodingOpu", BM_NlsEncodingOpu, 0, 1},
+      {"BM_NlsEncodingOggOpus", BM_NlsEncodingOggOpus, 0, 1},
+      {"BM_ParseJsonMsgNls", BM_ParseJsonMsgNls, 0, 1},
+      {"BM_ParseJsonMsgDashScope", BM_ParseJsonMsgDashScope, 0, 1},
+      {"BM_GetStartCommandNls", BM_GetStartCommandNls, 0, 1},
+      {"BM_GetStartCommandDashScope", BM_GetStartCommandDashScope, 0, 1},
+      {"BM_LogDisabledSite", BM_LogDisabledSite, 0, 1},
+#ifdef ENABLE_WS_DEFLATE
+      {"BM_DeflateTextMessage", BM_DeflateTextMessage, 0, 1},
+      {"BM_InflateTextMessage", BM_InflateTextMessage, 0, 1},
+#endif
+  };
+  for (size_t i = 0; i < sizeof(single) / sizeof(single[0]); i++) {
+    cases.push_back(single[i]);
+  }
+  const int threads[] = {1, 2, 4, 8};
+  for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+    BenchmarkCase c = {"BM_CheckNodeExist", BM_CheckNodeExist, 0, threads[i]};
+    cases.push_back(c);
+  }
+  return cases;
+}
+
+std::string caseName(const BenchmarkCase& c) {
+  std::ostringstream name;
+  name << c.name;
+  if (c.arg > 0) {
+    name << "/" << c.arg;
+  }
+  if (c.threads > 1 || c.func == BM_CheckNodeExist) {
+    name << "/threads:" << c.threads;
+  }
+  return name.str();
+}
+
+/* 与Google Benchmark相同的迭代次数估算: 逐步放大直到运行时间达到min_time */
+BenchmarkResult runCase(const BenchmarkCase& c, int repetitionIndex) {
+  BenchmarkResult result;
+  result.runName = caseName(c);
+  result.name = result.runName;
+  result.repetitionIndex = repetitionIndex;
+  result.threads = c.threads;
+
+  uint64_t iterations = 1;
+  const uint64_t maxIterations = 1000000000ULL;
+  while (true) {
+    BenchmarkState state;
+    state.iterations = iterations;
+    state.threads = c.threads;
+    state.arg = c.arg;
+    state.bytesProcessed = 0;
+    state.itemsProcessed = 0;
+    state.compressionRatio = 0;
+
+    uint64_t realBegin = nowNs(CLOCK_MONOTONIC);
+    uint64_t cpuBegin = nowNs(CLOCK_PROCESS_CPUTIME_ID);
+    c.func(state);
+    double realNs = (double)(nowNs(CLOCK_MONOTONIC) - realBegin);
+    double cpuNs = (double)(nowNs(CLOCK_PROCESS_CPUTIME_ID) - cpuBegin);
+
+    double seconds = realNs / 1e9;
+    bool enough = seconds >= g_options.minTimeSec ||
+                  iterations >= maxIterations || !state.error.empty();
+    if (enough) {
+      result.iterations = iterations;
+      result.realTimeNs = realNs / iterations;
+      result.cpuTimeNs = cpuNs / iterations / c.threads;
+      result.bytesPerSecond =
+          seconds > 0 ? state.bytesProcessed / seconds : 0;
+      result.itemsPerSecond =
+          seconds > 0 ? state.itemsProcessed / seconds : 0;
+      result.compressionRatio = state.compressionRatio;
+      result.error = state.error;
+      return result;
+    }
+
+    double multiplier = seconds > 0 ? g_options.minTimeSec * 1.4 / seconds
+                                    : 10.0;
+    if (multiplier > 10.0 || seconds <= g_options.minTimeSec / 10) {
+      multiplier = 10.0;
+    }
+    uint64_t next = (uint64_t)(iterations * multiplier);
+    iterations = next > iterations ? next : iterations + 1;
+    if (iterations > maxIterations) {
+      iterations = maxIterations;
+    }
+  }
+}
+
+std::string buildJson(const std::vector<BenchmarkResult>& results,
+                      const std::string& executable) {
+  char date[64] = {0};
+  time_t now = time(NULL);
+  struct tm tmNow;
+  localtime_r(&now, &tmNow);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", &tmNow);
+  char host[256] = {0};
+  gethostname(host, sizeof(host) - 1);
+
+  NlsClient* client = NlsClient::getInstance();
+  std::string version = client->getVersion();
+  NlsClient::releaseInstance();
+
+  std::ostringstream os;
+  os << "{\n  \"context\": {\n";
+  os << "    \"date\": \"" << date << "\",\n";
+  os << "    \"host_name\": \"" << jsonEscape(host) << "\",\n";
+  os << "    \"executable\": \"" << jsonEscape(executable) << "\",\n";
+  os << "    \"num_cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ",\n";
+  os << "    \"nls_sdk_version\": \"" << jsonEscape(version) << "\",\n";
+  os << "    \"nls_log_compile_level\": " << NLS_LOG_COMPILE_LEVEL << ",\n";
+#ifdef NDEBUG
+  os << "    \"library_build_type\": \"release\"\n";
+#else
+  os << "    \"library_build_type\": \"debug\"\n";
+#endif
+  os << "  },\n  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchmarkResult& r = results[i];
+    os << "    {\n";
+    os << "      \"name\": \"" << r.name << "\",\n";
+    os << "      \"run_name\": \"" << r.runName << "\",\n";
+    os << "      \"run_type\": \"iteration\",\n";
+    os << "      \"repetitions\": " << g_options.repetitions << ",\n";
+    os << "      \"repetition_index\": " << r.repetitionIndex << ",\n";
+    os << "      \"threads\": " << r.threads << ",\n";
+    os << "      \"iterations\": " << r.iterations << ",\n";
+    os << "      \"real_time\": " << r.realTimeNs << ",\n";
+    os << "      \"cpu_time\": " << r.cpuTimeNs << ",\n";
+    os << "      \"time_unit\": \"ns\"";
+    if (r.bytesPerSecond > 0) {
+      os << ",\n      \"bytes_per_second\": " << r.bytesPerSecond;
+    }
+    if (r.itemsPerSecond > 0) {
+      os << ",\n      \"items_per_second\": " << r.itemsPerSecond;
+    }
+    if (r.compressionRatio > 0) {
+      os << ",\n      \"compression_ratio\": " << r.compressionRatio;
+    }
+    if (!r.error.empty()) {
+      os << ",\n      \"error_occurred\": true";
+      os << ",\n      \"error_message\": \"" << jsonEscape(r.error) << "\"";
+    }
+    os << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n}\n";
+  return os.str();
+}
+
+bool parseOption(const char* arg, const char* key, std::string* value) {
+  size_t len = strlen(key);
+  if (strncmp(arg, key, len) == 0 && arg[len] == '=') {
+    *value = arg + len + 1;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  g_options.minTimeSec = 0.5;
+  g_options.repetitions = 1;
+  for (int i = 1; i < argc; i++) {
+    std::string value;
+    if (parseOption(argv[i], "--benchmark_filter", &value)) {
+      g_options.filter = value;
+    } else if (parseOption(argv[i], "--benchmark_min_time", &value)) {
+      g_options.minTimeSec = atof(value.c_str());
+    } else if (parseOption(argv[i], "--benchmark_repetitions", &value)) {
+      g_options.repetitions = atoi(value.c_str());
+    } else if (parseOption(argv[i], "--benchmark_out", &value)) {
+      g_options.outFile = value;
+    } else if (parseOption(argv[i], "--audio", &value)) {
+      g_options.audioFile = value;
+    } else if (parseOption(argv[i], "--messages", &value)) {
+      g_options.messagesFile = value;
+    } else {
+      std::cerr << "unknown option: " << argv[i] << std::endl;
+      return -1;
+    }
+  }
+  if (g_options.minTimeSec <= 0) {
+    g_options.minTimeSec = 0.5;
+  }
+  if (g_options.repetitions <= 0) {
+    g_options.repetitions = 1;
+  }
+
+  loadAudio();
+  loadMessages();
+
+  std::vector<BenchmarkCase> cases = registerCases();
+  std::vector<BenchmarkResult> results;
+  for (size_t i = 0; i < cases.size(); i++) {
+    std::string name = caseName(cases[i]);
+    if (!g_options.filter.empty() &&
+        name.find(g_options.filter) == std::string::npos) {
+      continue;
+    }
+    for (int rep = 0; rep < g_options.repetitions; rep++) {
+      BenchmarkResult r = runCase(cases[i], rep);
+      /* 进度输出到stderr, 不影响标准输出的json */
+      fprintf(stderr, "%-44s %14.1f ns %14.1f ns %12llu%s%s\n",
+              r.name.c_str(), r.realTimeNs, r.cpuTimeNs,
+              (unsigned long long)r.iterations, r.error.empty() ? "" : " ",
+              r.error.c_str());
+      results.push_back(r);
+    }
+  }
+
+  std::string json = buildJson(results, argv[0]);
+  if (g_options.outFile.empty()) {
+    std::cout << json;
+  } else {
+    std::ofstream ofs(g_options.outFile.c_str());
+    if (!ofs.is_open()) {
+      std::cerr << "open " << g_options.outFile << " failed." << std::endl;
+      return -1;
+    }
+    ofs << json;
+  }
+  return 0;
+}
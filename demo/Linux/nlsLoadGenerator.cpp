@@ -0,0 +1,843 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * SDK压测驱动, 一般配合nls_mock_server在本地使用:
+ *   ./nls_mock_server --port=8080 --latency-ms=20 --jitter-ms=10 &
+ *   ./nls_load_generator --type=st --concurrency=100 --sessions=2000
+ *
+ * 以固定并发反复执行完整的请求流程(start->音频/文本->stop->Closed),
+ * 统计sessions/s, 各阶段时延的p50/p99, 以及每个会话消耗的CPU时间.
+ *
+ * 参数:
+ *   --url=<地址>            服务地址, 默认ws://127.0.0.1:8080/ws/v1,
+ *                           dash-*类型默认
+ *                           ws://127.0.0.1:8080/dashscope/api-ws/v1/inference
+ *   --type=<类型>           st|sr|sy|fss|dash-asr|dash-tts, 默认st
+ *   --concurrency=<并发数>  同时进行的会话数, 默认10
+ *   --sessions=<总数>       总会话数, 默认100
+ *   --duration=<秒>         按时长压测, 设置后忽略--sessions
+ *   --rate=<会话/秒>        新建会话的速率上限, 默认0不限制
+ *   --audio=<文件>          16k pcm音频文件, 默认使用合成的正弦波
+ *   --audio-ms=<毫秒>       每个会话发送的音频时长, 默认3000
+ *   --speed=<倍数>          音频发送速度相对实时的倍数, 0为不限速, 默认1
+ *   --texts=<条数>          fss/dash-tts每个会话发送的文本条数, 默认3
+ *   --timeout-ms=<毫秒>     单个会话的超时时间, 超时后cancel, 默认30000
+ *   --threads=<线程数>      SDK的startWorkThread参数, 默认-1(与CPU核数相同)
+ *   --drivers=<线程数>      驱动会话的线程数, 默认1
+ *   --sys-getaddrinfo       使用系统getaddrinfo进行dns解析, 默认使用evdns
+ *   --tcp-nodelay           建连时开启TCP_NODELAY
+ *   --sndbuf=<字节>         建连时设置SO_SNDBUF
+ *   --rcvbuf=<字节>         建连时设置SO_RCVBUF
+ *   --user-timeout-ms=<毫秒> 建连时设置TCP_USER_TIMEOUT
+ *   --notsent-lowat=<字节>  建连时设置TCP_NOTSENT_LOWAT
+ *   --busy-poll-us=<微秒>   建连时设置SO_BUSY_POLL
+ *   --ws-deflate            握手时协商permessage-deflate
+ *   --log=<文件>            开启SDK日志, 默认不开启
+ *   --out=<文件>            将结果以json格式写入文件
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "dashCosyVoiceSynthesizerRequest.h"
+#include "dashParaformerTranscriberRequest.h"
+#include "flowingSynthesizerRequest.h"
+#include "nlsClient.h"
+#include "nlsEvent.h"
+#include "speechRecognizerRequest.h"
+#include "speechSynthesizerRequest.h"
+#include "speechTranscriberRequest.h"
+
+using namespace AlibabaNls;
+
+namespace {
+
+enum SessionType {
+  TypeTranscriber = 0,
+  TypeRecognizer,
+  TypeSynthesizer,
+  TypeFlowingSynthesizer,
+  TypeDashParaformer,
+  TypeDashCosyVoice,
+};
+
+enum SessionState {
+  StateIdle = 0,
+  StateStarting,  /* 已调用start, 等待Started */
+  StateStreaming, /* 发送音频或文本 */
+  StateStopping,  /* 已调用stop, 等待Closed */
+};
+
+struct LoadOptions {
+  std::string url;
+  SessionType type;
+  std::string typeName;
+  int concurrency;
+  int sessions;
+  int duration;
+  double rate;
+  std::string audioFile;
+  int audioMs;
+  double speed;
+  int texts;
+  int timeoutMs;
+  int threads;
+  int drivers;
+  bool sysGetAddrInfo;
+  NlsSocketOptions socketOptions;
+  bool wsDeflate;
+  std::string logFile;
+  std::string outFile;
+};
+
+struct Session {
+  SessionType type;
+  void* request;
+  SessionState state;
+  uint64_t startUs;
+  uint64_t streamBeginUs;
+  uint64_t stopUs;
+  size_t audioOffset;
+  bool cancelled;
+
+  /* 以下字段在SDK回调线程中写入 */
+  std::atomic<uint64_t> startedUs;
+  std::atomic<uint64_t> firstResultUs;
+  std::atomic<uint64_t> completedUs;
+  std::atomic<uint64_t> closedUs;
+  std::atomic<bool> failed;
+  std::atomic<int> statusCode;
+};
+
+struct DriverResult {
+  std::vector<double> startLatency;  /* start到Started */
+  std::vector<double> firstLatency;  /* 首包音频/文本到首个结果 */
+  std::vector<double> stopLatency;   /* stop到Completed */
+  std::vector<double> totalLatency;  /* start到Closed */
+  uint64_t succeeded;
+  uint64_t failed;
+  uint64_t timedOut;
+};
+
+struct Driver {
+  pthread_t tid;
+  int index;
+  std::vector<Session*> slots;
+  DriverResult result;
+};
+
+LoadOptions g_options;
+std::vector<char> g_audio;
+std::atomic<int64_t> g_remaining(0);
+std::atomic<uint64_t> g_nextStartUs(0);
+std::atomic<bool> g_running(true);
+uint64_t g_deadlineUs = 0;
+
+const char* kMockText = "今天天气很好, 适合出去走走.";
+
+uint64_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+void storeOnce(std::atomic<uint64_t>* value) {
+  uint64_t expected = 0;
+  value->compare_exchange_strong(expected, nowUs());
+}
+
+/* ---------------- SDK回调 ---------------- */
+
+void onStarted(NlsEvent*, void* param) {
+  storeOnce(&static_cast<Session*>(param)->startedUs);
+}
+
+void onResult(NlsEvent*, void* param) {
+  storeOnce(&static_cast<Session*>(param)->firstResultUs);
+}
+
+void onCompleted(NlsEvent*, void* param) {
+  storeOnce(&static_cast<Session*>(param)->completedUs);
+}
+
+void onFailed(NlsEvent* ev, void* param) {
+  Session* session = static_cast<Session*>(param);
+  session->statusCode = ev->getStatusCode();
+  session->failed = true;
+}
+
+void onClosed(NlsEvent*, void* param) {
+  storeOnce(&static_cast<Session*>(param)->closedUs);
+}
+
+/* ---------------- 各类请求的统一封装 ---------------- */
+
+template <typename T>
+void setCommon(T* request, Session* session) {
+  request->setUrl(g_options.url.c_str());
+  request->setOnTaskFailed(onFailed, session);
+  request->setOnChannelClosed(onClosed, session);
+  if (g_options.wsDeflate) {
+    request->setEnableWsDeflate(true);
+  }
+}
+
+template <typename T>
+void setNlsAuth(T* request) {
+  request->setAppKey("mock-appkey");
+  request->setToken("mock-token");
+}
+
+bool createRequest(Session* session) {
+  NlsClient* client = NlsClient::getInstance();
+  switch (session->type) {
+    case TypeTranscriber: {
+      SpeechTranscriberRequest* request = client->createTranscriberRequest();
+      if (request == NULL) return false;
+      setCommon(request, session);
+      setNlsAuth(request);
+      request->setFormat("pcm");
+      request->setSampleRate(16000);
+      request->setIntermediateResult(true);
+      request->setOnTranscriptionStarted(onStarted, session);
+      request->setOnTranscriptionResultChanged(onResult, session);
+      request->setOnSentenceEnd(onResult, session);
+      request->setOnTranscriptionCompleted(onCompleted, session);
+      session->request = request;
+      break;
+    }
+    case TypeRecognizer: {
+      SpeechRecognizerRequest* request = client->createRecognizerRequest();
+      if (request == NULL) return false;
+      setCommon(request, session);
+      setNlsAuth(request);
+      request->setFormat("pcm");
+      request->setSampleRate(16000);
+      request->setIntermediateResult(true);
+      request->setOnRecognitionStarted(onStarted, session);
+      request->setOnRecognitionResultChanged(onResult, session);
+      request->setOnRecognitionCompleted(onCompleted, session);
+      session->request = request;
+      break;
+    }
+    case TypeSynthesizer: {
+      SpeechSynthesizerRequest* request = client->createSynthesizerRequest();
+      if (request == NULL) return false;
+      setCommon(request, session);
+      setNlsAuth(request);
+      request->setText(kMockText);
+      request->setFormat("pcm");
+      request->setSampleRate(16000);
+      request->setOnSynthesisStarted(onStarted, session);
+      request->setOnBinaryDataReceived(onResult, session);
+      request->setOnSynthesisCompleted(onCompleted, session);
+      session->request = request;
+      break;
+    }
+    case TypeFlowingSynthesizer: {
+      FlowingSynthesizerRequest* request =
+          client->createFlowingSynthesizerRequest();
+      if (request == NULL) return false;
+      setCommon(request, session);
+      setNlsAuth(request);
+      request->setFormat("pcm");
+      request->setSampleRate(16000);
+      request->setOnSynthesisStarted(onStarted, session);
+      request->setOnBinaryDataReceived(onResult, session);
+      request->setOnSynthesisCompleted(onCompleted, session);
+      session->request = request;
+      break;
+    }
+    case TypeDashParaformer: {
+      DashParaformerTranscriberRequest* request =
+          client->createDashParaformerTranscriberRequest();
+      if (request == NULL) return false;
+      setCommon(request, session);
+      request->setAPIKey("mock-apikey");
+      request->setModel("paraformer-realtime-v2");
+      request->setFormat("pcm");
+      request->setSampleRate(16000);
+      request->setOnTranscriptionStarted(onStarted, session);
+      request->setOnTranscriptionResultChanged(onResult, session);
+      request->setOnSentenceEnd(onResult, session);
+      request->setOnTranscriptionCompleted(onCompleted, session);
+      session->request = request;
+      break;
+    }
+    case TypeDashCosyVoice: {
+      DashCosyVoiceSynthesizerRequest* request =
+          client->createDashCosyVoiceSynthesizerRequest();
+      if (request == NULL) return false;
+      setCommon(request, session);
+      request->setAPIKey("mock-apikey");
+      request->setModel("cosyvoice-v1");
+      request->setFormat("pcm");
+      request->setSampleRate(16000);
+      request->setOnSynthesisStarted(onStarted, session);
+      request->setOnBinaryDataReceived(onResult, session);
+      request->setOnSynthesisCompleted(onCompleted, session);
+      session->request = request;
+      break;
+    }
+  }
+  return true;
+}
+
+void releaseRequest(Session* session) {
+  NlsClient* client = NlsClient::getInstance();
+  switch (session->type) {
+    case TypeTranscriber:
+      client->releaseTranscriberRequest(
+          static_cast<SpeechTranscriberRequest*>(session->request));
+      break;
+    case TypeRecognizer:
+      client->releaseRecognizerRequest(
+          static_cast<SpeechRecognizerRequest*>(session->request));
+      break;
+    case TypeSynthesizer:
+      client->releaseSynthesizerRequest(
+          static_cast<SpeechSynthesizerRequest*>(session->request));
+      break;
+    case TypeFlowingSynthesizer:
+      client->releaseFlowingSynthesizerRequest(
+          static_cast<FlowingSynthesizerRequest*>(session->request));
+      break;
+    case TypeDashParaformer:
+      client->releaseDashParaformerTranscriberRequest(
+          static_cast<DashParaformerTranscriberRequest*>(session->request));
+      break;
+    case TypeDashCosyVoice:
+      client->releaseDashCosyVoiceSynthesizerRequest(
+          static_cast<DashCosyVoiceSynthesizerRequest*>(session->request));
+      break;
+  }
+  session->request = NULL;
+}
+
+#define DISPATCH(session, call)                                          \
+  switch ((session)->type) {                                             \
+    case TypeTranscriber:                                                \
+      return static_cast<SpeechTranscriberRequest*>((session)->request)  \
+          ->call;                                                        \
+    case TypeRecognizer:                                                 \
+      return static_cast<SpeechRecognizerRequest*>((session)->request)   \
+          ->call;                                                        \
+    case TypeSynthesizer:                                                \
+      return static_cast<SpeechSynthesizerRequest*>((session)->request)  \
+          ->call;                                                        \
+    case TypeFlowingSynthesizer:                                         \
+      return static_cast<FlowingSynthesizerRequest*>((session)->request) \
+          ->call;                                                        \
+    case TypeDashParaformer:                                             \
+      return static_cast<DashParaformerTranscriberRequest*>(             \
+                 (session)->request)                                     \
+          ->call;                                                        \
+    case TypeDashCosyVoice:                                              \
+      return static_cast<DashCosyVoiceSynthesizerRequest*>(              \
+                 (session)->request)                                     \
+          ->call;                                                        \
+  }                                                                      \
+  return -1;
+
+int startRequest(Session* session) { DISPATCH(session, start()) }
+int stopRequest(Session* session) { DISPATCH(session, stop()) }
+int cancelRequest(Session* session) { DISPATCH(session, cancel()) }
+
+int sendAudio(Session* session, const char* data, size_t length) {
+  const uint8_t* audio = reinterpret_cast<const uint8_t*>(data);
+  switch (session->type) {
+    case TypeTranscriber:
+      return static_cast<SpeechTranscriberRequest*>(session->request)
+          ->sendAudio(audio, length);
+    case TypeRecognizer:
+      return static_cast<SpeechRecognizerRequest*>(session->request)
+          ->sendAudio(audio, length);
+    case TypeDashParaformer:
+      return static_cast<DashParaformerTranscriberRequest*>(session->request)
+          ->sendAudio(audio, length);
+    default:
+      return -1;
+  }
+}
+
+int sendText(Session* session, const char* text) {
+  switch (session->type) {
+    case TypeFlowingSynthesizer:
+      return static_cast<FlowingSynthesizerRequest*>(session->request)
+          ->sendText(text);
+    case TypeDashCosyVoice:
+      return static_cast<DashCosyVoiceSynthesizerRequest*>(session->request)
+          ->sendText(text);
+    default:
+      return -1;
+  }
+}
+
+bool isAudioType(SessionType type) {
+  return type == TypeTranscriber || type == TypeRecognizer ||
+         type == TypeDashParaformer;
+}
+
+/* ---------------- 会话驱动 ---------------- */
+
+/* 按--rate和剩余会话数判断能否新建会话 */
+bool acquireStart() {
+  if (!g_running) return false;
+  if (g_deadlineUs > 0) {
+    if (nowUs() >= g_deadlineUs) return false;
+  } else if (g_remaining.fetch_sub(1) <= 0) {
+    g_remaining++;
+    return false;
+  }
+  if (g_options.rate > 0) {
+    uint64_t interval = (uint64_t)(1000000 / g_options.rate);
+    uint64_t now = nowUs();
+    uint64_t next = g_nextStartUs.load();
+    while (true) {
+      if (next > now) {
+        if (g_deadlineUs == 0) g_remaining++;
+        return false;
+      }
+      uint64_t target = std::max(next, now - interval) + interval;
+      if (g_nextStartUs.compare_exchange_weak(next, target)) break;
+    }
+  }
+  return true;
+}
+
+bool acquireStartPossible() {
+  if (!g_running) return false;
+  if (g_deadlineUs > 0) return nowUs() < g_deadlineUs;
+  return g_remaining > 0;
+}
+
+void resetSession(Session* session) {
+  session->request = NULL;
+  session->state = StateIdle;
+  session->startUs = 0;
+  session->streamBeginUs = 0;
+  session->stopUs = 0;
+  session->audioOffset = 0;
+  session->cancelled = false;
+  session->startedUs = 0;
+  session->firstResultUs = 0;
+  session->completedUs = 0;
+  session->closedUs = 0;
+  session->failed = false;
+  session->statusCode = 0;
+}
+
+void finishSession(Driver* driver, Session* session) {
+  DriverResult& result = driver->result;
+  uint64_t started = session->startedUs;
+  uint64_t first = session->firstResultUs;
+  uint64_t completed = session->completedUs;
+  uint64_t closed = session->closedUs;
+
+  if (session->failed || session->cancelled || completed == 0) {
+    result.failed++;
+  } else {
+    result.succeeded++;
+    if (started > 0) {
+      result.startLatency.push_back((started - session->startUs) / 1000.0);
+    }
+    uint64_t firstBase =
+        session->streamBeginUs > 0 ? session->streamBeginUs : session->startUs;
+    if (first > firstBase) {
+      result.firstLatency.push_back((first - firstBase) / 1000.0);
+    }
+    if (session->stopUs > 0 && completed >= session->stopUs) {
+      result.stopLatency.push_back((completed - session->stopUs) / 1000.0);
+    }
+    result.totalLatency.push_back((closed - session->startUs) / 1000.0);
+  }
+  releaseRequest(session);
+  resetSession(session);
+}
+
+void streamSession(Session* session, uint64_t now) {
+  if (isAudioType(session->type)) {
+    /* 16k pcm, 每毫秒32字节, 每次发送20ms */
+    const size_t chunk = 640;
+    size_t total = (size_t)g_options.audioMs * 32;
+    size_t due = total;
+    if (g_options.speed > 0) {
+      due = (size_t)((now - session->streamBeginUs) / 1000.0 *
+                     g_options.speed * 32);
+      due = std::min(due, total);
+    }
+    while (session->audioOffset + chunk <= due ||
+           (due == total && session->audioOffset < total)) {
+      size_t length = std::min(chunk, total - session->audioOffset);
+      size_t offset = session->audioOffset % g_audio.size();
+      if (offset + length > g_audio.size()) offset = 0;
+      if (sendAudio(session, &g_audio[offset], length) < 0) {
+        session->failed = true;
+        break;
+      }
+      session->audioOffset += length;
+    }
+    if (session->audioOffset < total && !session->failed) return;
+  } else if (session->type != TypeSynthesizer) {
+    for (int i = 0; i < g_options.texts; i++) {
+      if (sendText(session, kMockText) < 0) {
+        session->failed = true;
+        break;
+      }
+    }
+  }
+
+  if (session->type != TypeSynthesizer) {
+    session->stopUs = nowUs();
+    if (stopRequest(session) < 0) session->failed = true;
+  }
+  session->state = StateStopping;
+}
+
+void driveSession(Driver* driver, Session* session, uint64_t now) {
+  if (session->state == StateIdle) {
+    if (!acquireStart()) return;
+    session->type = g_options.type;
+    if (!createRequest(session)) {
+      driver->result.failed++;
+      resetSession(session);
+      return;
+    }
+    session->startUs = nowUs();
+    session->state = StateStarting;
+    if (startRequest(session) < 0) {
+      driver->result.failed++;
+      releaseRequest(session);
+      resetSession(session);
+    }
+    return;
+  }
+
+  if (session->closedUs > 0) {
+    finishSession(driver, session);
+    return;
+  }
+
+  if (now - session->startUs > (uint64_t)g_options.timeoutMs * 1000) {
+    /* cancel之后不会再有回调, 可以直接释放 */
+    session->cancelled = true;
+    driver->result.timedOut++;
+    cancelRequest(session);
+    finishSession(driver, session);
+    return;
+  }
+
+  if (session->state == StateStarting) {
+    if (session->type == TypeSynthesizer || session->startedUs > 0) {
+      session->state = StateStreaming;
+      session->streamBeginUs = nowUs();
+    }
+  }
+  if (session->state == StateStreaming && !session->failed) {
+    streamSession(session, now);
+  }
+}
+
+void* driverRoutine(void* arg) {
+  Driver* driver = static_cast<Driver*>(arg);
+  while (true) {
+    uint64_t now = nowUs();
+    bool active = false;
+    for (size_t i = 0; i < driver->slots.size(); i++) {
+      driveSession(driver, driver->slots[i], now);
+      if (driver->slots[i]->state != StateIdle) active = true;
+    }
+    if (!active && !acquireStartPossible()) break;
+    usleep(g_options.speed > 0 ? 5000 : 1000);
+  }
+  return NULL;
+}
+
+double percentile(std::vector<double>& values, double p) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  size_t index = (size_t)std::ceil(p / 100.0 * values.size());
+  if (index > 0) index--;
+  return values[std::min(index, values.size() - 1)];
+}
+
+void loadAudio() {
+  if (!g_options.audioFile.empty()) {
+    std::ifstream fs(g_options.audioFile.c_str(), std::ios::binary);
+    if (fs) {
+      g_audio.assign(std::istreambuf_iterator<char>(fs),
+                     std::istreambuf_iterator<char>());
+    }
+    if (g_audio.size() >= 640) return;
+    fprintf(stderr, "audio file %s is unavailable, use sine wave\n",
+            g_options.audioFile.c_str());
+  }
+  /* 10s的440Hz正弦波 */
+  g_audio.resize(16000 * 2 * 10);
+  for (size_t i = 0; i < g_audio.size() / 2; i++) {
+    int16_t sample = (int16_t)(8000 * sin(2 * M_PI * 440 * i / 16000.0));
+    memcpy(&g_audio[i * 2], &sample, 2);
+  }
+}
+
+double cpuSeconds(const struct rusage& usage) {
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+void signalHandler(int) { g_running = false; }
+
+bool parseOption(const char* arg, const char* key, std::string* value) {
+  size_t len = strlen(key);
+  if (strncmp(arg, key, len) == 0 && arg[len] == '=') {
+    *value = arg + len + 1;
+    return true;
+  }
+  return false;
+}
+
+bool parseType(const std::string& name, SessionType* type) {
+  static const struct {
+    const char* name;
+    SessionType type;
+  } types[] = {
+      {"st", TypeTranscriber},         {"sr", TypeRecognizer},
+      {"sy", TypeSynthesizer},         {"fss", TypeFlowingSynthesizer},
+      {"dash-asr", TypeDashParaformer}, {"dash-tts", TypeDashCosyVoice},
+  };
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    if (name == types[i].name) {
+      *type = types[i].type;
+      return true;
+    }
+  }
+  return false;
+}
+
+void writeLatency(FILE* fp, const char* name, std::vector<double>& values,
+                  bool last) {
+  fprintf(fp,
+          "    \"%s\": {\"count\": %zu, \"p50_ms\": %.3f, \"p99_ms\": %.3f, "
+          "\"max_ms\": %.3f}%s\n",
+          name, values.size(), percentile(values, 50),
+          percentile(values, 99), percentile(values, 100), last ? "" : ",");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  g_options.type = TypeTranscriber;
+  g_options.typeName = "st";
+  g_options.concurrency = 10;
+  g_options.sessions = 100;
+  g_options.duration = 0;
+  g_options.rate = 0;
+  g_options.audioMs = 3000;
+  g_options.speed = 1;
+  g_options.texts = 3;
+  g_options.timeoutMs = 30000;
+  g_options.threads = -1;
+  g_options.drivers = 1;
+  g_options.sysGetAddrInfo = false;
+  g_options.wsDeflate = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string v;
+    if (parseOption(argv[i], "--url", &v)) {
+      g_options.url = v;
+    } else if (parseOption(argv[i], "--type", &v)) {
+      if (!parseType(v, &g_options.type)) {
+        fprintf(stderr, "invalid type: %s\n", v.c_str());
+        return -1;
+      }
+      g_options.typeName = v;
+    } else if (parseOption(argv[i], "--concurrency", &v)) {
+      g_options.concurrency = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--sessions", &v)) {
+      g_options.sessions = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--duration", &v)) {
+      g_options.duration = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--rate", &v)) {
+      g_options.rate = atof(v.c_str());
+    } else if (parseOption(argv[i], "--audio", &v)) {
+      g_options.audioFile = v;
+    } else if (parseOption(argv[i], "--audio-ms", &v)) {
+      g_options.audioMs = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--speed", &v)) {
+      g_options.speed = atof(v.c_str());
+    } else if (parseOption(argv[i], "--texts", &v)) {
+      g_options.texts = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--timeout-ms", &v)) {
+      g_options.timeoutMs = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--threads", &v)) {
+      g_options.threads = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--drivers", &v)) {
+      g_options.drivers = atoi(v.c_str());
+    } else if (strcmp(argv[i], "--sys-getaddrinfo") == 0) {
+      g_options.sysGetAddrInfo = true;
+    } else if (strcmp(argv[i], "--ws-deflate") == 0) {
+      g_options.wsDeflate = true;
+    } else if (strcmp(argv[i], "--tcp-nodelay") == 0) {
+      g_options.socketOptions.tcp_nodelay = true;
+    } else if (parseOption(argv[i], "--sndbuf", &v)) {
+      g_options.socketOptions.send_buffer_bytes = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--rcvbuf", &v)) {
+      g_options.socketOptions.recv_buffer_bytes = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--user-timeout-ms", &v)) {
+      g_options.socketOptions.user_timeout_ms = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--notsent-lowat", &v)) {
+      g_options.socketOptions.notsent_lowat_bytes = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--busy-poll-us", &v)) {
+      g_options.socketOptions.busy_poll_us = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--log", &v)) {
+      g_options.logFile = v;
+    } else if (parseOption(argv[i], "--out", &v)) {
+      g_options.outFile = v;
+    } else {
+      fprintf(stderr, "unknown option: %s\n", argv[i]);
+      return -1;
+    }
+  }
+  if (g_options.url.empty()) {
+    g_options.url = (g_options.type == TypeDashParaformer ||
+                     g_options.type == TypeDashCosyVoice)
+                        ? "ws://127.0.0.1:8080/dashscope/api-ws/v1/inference"
+                        : "ws://127.0.0.1:8080/ws/v1";
+  }
+  if (g_options.concurrency <= 0) g_options.concurrency = 1;
+  if (g_options.drivers <= 0) g_options.drivers = 1;
+  if (g_options.drivers > g_options.concurrency) {
+    g_options.drivers = g_options.concurrency;
+  }
+
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+  loadAudio();
+
+  NlsClient* client = NlsClient::getInstance();
+  if (!g_options.logFile.empty()) {
+    client->setLogConfig(g_options.logFile.c_str(), LogInfo, 400, 50);
+  }
+  client->setSocketOptions(g_options.socketOptions);
+  if (g_options.sysGetAddrInfo) {
+    client->setUseSysGetAddrInfo(true);
+  }
+  client->startWorkThread(g_options.threads);
+
+  struct rusage usageBegin, usageEnd;
+  getrusage(RUSAGE_SELF, &usageBegin);
+  uint64_t beginUs = nowUs();
+  if (g_options.duration > 0) {
+    g_deadlineUs = beginUs + (uint64_t)g_options.duration * 1000000;
+  } else {
+    g_remaining = g_options.sessions;
+  }
+
+  std::vector<Driver> drivers(g_options.drivers);
+  for (int i = 0; i < g_options.concurrency; i++) {
+    Session* session = new Session();
+    resetSession(session);
+    drivers[i % g_options.drivers].slots.push_back(session);
+  }
+  for (int i = 0; i < g_options.drivers; i++) {
+    drivers[i].index = i;
+    drivers[i].result.succeeded = 0;
+    drivers[i].result.failed = 0;
+    drivers[i].result.timedOut = 0;
+    pthread_create(&drivers[i].tid, NULL, driverRoutine, &drivers[i]);
+  }
+
+  DriverResult total;
+  total.succeeded = 0;
+  total.failed = 0;
+  total.timedOut = 0;
+  for (int i = 0; i < g_options.drivers; i++) {
+    pthread_join(drivers[i].tid, NULL);
+    DriverResult& r = drivers[i].result;
+    total.startLatency.insert(total.startLatency.end(),
+                              r.startLatency.begin(), r.startLatency.end());
+    total.firstLatency.insert(total.firstLatency.end(),
+                              r.firstLatency.begin(), r.firstLatency.end());
+    total.stopLatency.insert(total.stopLatency.end(), r.stopLatency.begin(),
+                             r.stopLatency.end());
+    total.totalLatency.insert(total.totalLatency.end(),
+                              r.totalLatency.begin(), r.totalLatency.end());
+    total.succeeded += r.succeeded;
+    total.failed += r.failed;
+    total.timedOut += r.timedOut;
+  }
+  double elapsed = (nowUs() - beginUs) / 1e6;
+  getrusage(RUSAGE_SELF, &usageEnd);
+
+  uint64_t finished = total.succeeded + total.failed;
+  double cpu = cpuSeconds(usageEnd) - cpuSeconds(usageBegin);
+  double cpuPerSession = finished > 0 ? cpu * 1000 / finished : 0;
+  double sessionsPerSec = elapsed > 0 ? finished / elapsed : 0;
+
+  FILE* fp = stdout;
+  if (!g_options.outFile.empty()) {
+    fp = fopen(g_options.outFile.c_str(), "w");
+    if (fp == NULL) {
+      fprintf(stderr, "open %s failed\n", g_options.outFile.c_str());
+      fp = stdout;
+    }
+  }
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"type\": \"%s\",\n", g_options.typeName.c_str());
+  fprintf(fp, "  \"url\": \"%s\",\n", g_options.url.c_str());
+  fprintf(fp, "  \"sdk_version\": \"%s\",\n", client->getVersion());
+  fprintf(fp, "  \"concurrency\": %d,\n", g_options.concurrency);
+  fprintf(fp, "  \"elapsed_s\": %.3f,\n", elapsed);
+  fprintf(fp, "  \"sessions\": %llu,\n", (unsigned long long)finished);
+  fprintf(fp, "  \"succeeded\": %llu,\n",
+          (unsigned long long)total.succeeded);
+  fprintf(fp, "  \"failed\": %llu,\n", (unsigned long long)total.failed);
+  fprintf(fp, "  \"timed_out\": %llu,\n", (unsigned long long)total.timedOut);
+  fprintf(fp, "  \"sessions_per_sec\": %.3f,\n", sessionsPerSec);
+  fprintf(fp, "  \"cpu_s\": %.3f,\n", cpu);
+  fprintf(fp, "  \"cpu_ms_per_session\": %.3f,\n", cpuPerSession);
+  fprintf(fp, "  \"max_rss_kb\": %ld,\n", usageEnd.ru_maxrss);
+  fprintf(fp, "  \"latency\": {\n");
+  writeLatency(fp, "started", total.startLatency, false);
+  writeLatency(fp, "first_result", total.firstLatency, false);
+  writeLatency(fp, "stop_to_completed", total.stopLatency, false);
+  writeLatency(fp, "total", total.totalLatency, true);
+  fprintf(fp, "  }\n}\n");
+  if (fp != stdout) fclose(fp);
+
+  NlsClient::releaseInstance();
+  for (int i = 0; i < g_options.drivers; i++) {
+    for (size_t j = 0; j < drivers[i].slots.size(); j++) {
+      delete drivers[i].slots[j];
+    }
+  }
+  return total.failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,1039 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * 本地模拟的NLS网关/DashScope WebSocket服务, 用于离线压测SDK.
+ * 基于SDK自身依赖的libevent和OpenSSL, 仅支持ws(非wss).
+ *
+ * 支持的协议:
+ *   NLS: SpeechTranscriber(StartTranscription/StopTranscription),
+ *        SpeechRecognizer(StartRecognition/StopRecognition),
+ *        SpeechSynthesizer/SpeechLongSynthesizer(StartSynthesis),
+ *        FlowingSpeechSynthesizer(StartSynthesis/RunSynthesis/StopSynthesis)
+ *   DashScope: run-task/continue-task/finish-task, 包括asr和tts任务.
+ *              url路径中带有dashscope时SDK使用DashScope协议, 例如
+ *              ws://127.0.0.1:8080/dashscope/api-ws/v1/inference
+ *   SpeechTranscriber重连续传时按start指令中的tw_time_offset和
+ *   tw_index_offset继续时间戳和句子编号.
+ *
+ * 参数:
+ *   --port=<端口>               监听端口, 默认8080
+ *   --threads=<线程数>          工作线程数, 各线程独立监听同一端口, 默认1
+ *   --latency-ms=<毫秒>         每条响应的基础延迟, 默认0
+ *   --jitter-ms=<毫秒>          在基础延迟上叠加的随机抖动, 默认0
+ *   --reject-rate=<0~1>         握手阶段返回HTTP 403的比例
+ *   --fail-rate=<0~1>           start指令返回TaskFailed的比例
+ *   --drop-rate=<0~1>           任务开始后直接断开TCP的比例
+ *   --result-interval-ms=<毫秒> 识别中每收到多少毫秒音频返回一次中间结果,
+ *                               默认200
+ *   --sentence-ms=<毫秒>        识别中每句话的音频时长, 默认3000
+ *   --tts-rate=<字节/秒>        合成音频的下发速率, 0为不限速, 默认64000
+ *   --tts-chunk=<字节>          合成音频每帧字节数, 默认3200
+ *   --tts-ms-per-char=<毫秒>    每个文本字符对应的合成音频时长, 默认200
+ *   --stats-interval=<秒>       统计信息打印间隔, 默认5, 0为不打印
+ *   --deflate=<0|1>             客户端请求时协商permessage-deflate,
+ *                               压缩下发的文本帧, 默认0
+ */
+
+#include <arpa/inet.h>
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+#include <event2/thread.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum WsOpCode {
+  WsContinuation = 0x0,
+  WsText = 0x1,
+  WsBinary = 0x2,
+  WsClose = 0x8,
+  WsPing = 0x9,
+  WsPong = 0xa,
+};
+
+/* 出队时对连接执行的动作 */
+enum OutAction {
+  ActionSendFrame = 0,
+};
+
+enum TaskKind {
+  TaskNone = 0,
+  TaskAsr,         /* 实时识别/一句话识别/DashScope asr */
+  TaskTts,         /* 语音合成, start中携带全部文本 */
+  TaskFlowingTts,  /* 流式文本语音合成/DashScope tts */
+};
+
+struct MockOptions {
+  int port;
+  int threads;
+  int latencyMs;
+  int jitterMs;
+  double rejectRate;
+  double failRate;
+  double dropRate;
+  int resultIntervalMs;
+  int sentenceMs;
+  int ttsRate;
+  int ttsChunk;
+  int ttsMsPerChar;
+  int statsInterval;
+  bool deflate;
+};
+
+struct MockStats {
+  std::atomic<uint64_t> connections;
+  std::atomic<uint64_t> activeConnections;
+  std::atomic<uint64_t> rejected;
+  std::atomic<uint64_t> tasksStarted;
+  std::atomic<uint64_t> tasksCompleted;
+  std::atomic<uint64_t> tasksFailed;
+  std::atomic<uint64_t> tasksDropped;
+  std::atomic<uint64_t> bytesIn;
+  std::atomic<uint64_t> bytesOut;
+};
+
+struct OutMessage {
+  uint64_t dueUs;
+  OutAction action;
+  WsOpCode opCode;
+  std::string payload;
+};
+
+struct MockWorker;
+
+struct MockSession {
+  MockWorker* worker;
+  struct bufferevent* bev;
+  struct event* timer;
+  struct event* dropTimer; /* 模拟网络中断, 到期直接关闭TCP */
+  bool upgraded;
+  bool dashscope;
+  bool closing;
+
+  /* permessage-deflate, 双向均保留上下文 */
+  z_stream* inflater;
+  z_stream* deflater;
+
+  TaskKind kind;
+  std::string ns;
+  std::string taskId;
+  std::string format;
+  int sampleRate;
+  bool started;
+  bool finished;
+
+  /* 识别状态, 以收到的音频时长(毫秒)驱动 */
+  uint64_t audioBytes;
+  uint64_t audioFrames;
+  uint64_t audioMs;
+  uint64_t timeOffsetMs; /* 重连续传的tw_time_offset */
+  uint64_t lastResultMs;
+  uint64_t sentenceBeginMs;
+  int sentenceIndex;
+  bool inSentence;
+
+  /* 下发队列, dueUs单调不减以保证响应的顺序 */
+  std::deque<OutMessage> outQueue;
+  uint64_t lastDueUs;
+};
+
+struct MockWorker {
+  int index;
+  pthread_t tid;
+  struct event_base* base;
+  struct evconnlistener* listener;
+  uint64_t randomState;
+};
+
+MockOptions g_options;
+MockStats g_stats;
+std::atomic<bool> g_running(true);
+
+uint64_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/* xorshift64*, 每个工作线程一个状态 */
+uint64_t nextRandom(MockWorker* worker) {
+  uint64_t x = worker->randomState;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  worker->randomState = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+bool hitRate(MockWorker* worker, double rate) {
+  if (rate <= 0) return false;
+  return (double)(nextRandom(worker) >> 11) / (double)(1ULL << 53) < rate;
+}
+
+std::string randomHex(MockWorker* worker) {
+  char buf[33];
+  snprintf(buf, sizeof(buf), "%016llx%016llx",
+           (unsigned long long)nextRandom(worker),
+           (unsigned long long)nextRandom(worker));
+  return buf;
+}
+
+/*
+ * 从json文本中取出section之后第一个"key"对应的字符串或数字.
+ * SDK发出的指令格式固定, 不需要完整的json解析.
+ */
+std::string jsonValue(const std::string& msg, const char* key,
+                      const char* section = "header") {
+  size_t begin = msg.find(std::string("\"") + section + "\"");
+  if (begin == std::string::npos) return "";
+  std::string pattern = std::string("\"") + key + "\"";
+  size_t pos = msg.find(pattern, begin);
+  if (pos == std::string::npos) return "";
+  pos += pattern.size();
+  while (pos < msg.size() && (msg[pos] == ' ' || msg[pos] == ':')) pos++;
+  if (pos >= msg.size()) return "";
+
+  std::string value;
+  if (msg[pos] == '"') {
+    for (pos++; pos < msg.size() && msg[pos] != '"'; pos++) {
+      if (msg[pos] == '\\' && pos + 1 < msg.size()) {
+        value += msg[pos];
+        pos++;
+      }
+      value += msg[pos];
+    }
+  } else {
+    while (pos < msg.size() && msg[pos] != ',' && msg[pos] != '}' &&
+           msg[pos] != ']' && msg[pos] != ' ') {
+      value += msg[pos++];
+    }
+  }
+  return value;
+}
+
+/* json字符串中的字符数, \uXXXX等转义按一个字符计, 用于估算合成音频时长 */
+size_t textLength(const std::string& str) {
+  size_t count = 0;
+  for (size_t i = 0; i < str.size(); i++) {
+    if (str[i] == '\\' && i + 1 < str.size()) {
+      i += str[i + 1] == 'u' ? 5 : 1;
+    } else if (((unsigned char)str[i] & 0xc0) == 0x80) {
+      continue;
+    }
+    count++;
+  }
+  return count;
+}
+
+std::string webSocketAccept(const std::string& key) {
+  std::string src = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1((const unsigned char*)src.c_str(), src.size(), digest);
+  unsigned char encoded[64] = {0};
+  EVP_EncodeBlock(encoded, digest, SHA_DIGEST_LENGTH);
+  return (const char*)encoded;
+}
+
+/* raw deflate后去掉Z_SYNC_FLUSH末尾的00 00 ff ff */
+bool deflatePayload(z_stream* zs, const char* data, size_t length,
+                    std::string* out) {
+  out->resize(deflateBound(zs, length) + 16);
+  zs->next_in = (Bytef*)data;
+  zs->avail_in = length;
+  zs->next_out = (Bytef*)&(*out)[0];
+  zs->avail_out = out->size();
+  if (deflate(zs, Z_SYNC_FLUSH) != Z_OK || zs->avail_in != 0) return false;
+  size_t n = out->size() - zs->avail_out;
+  if (n < 4) return false;
+  out->resize(n - 4);
+  return true;
+}
+
+/* 补回末尾的00 00 ff ff后解压 */
+bool inflatePayload(z_stream* zs, const std::string& data, std::string* out) {
+  std::string input = data;
+  input.append("\x00\x00\xff\xff", 4);
+  zs->next_in = (Bytef*)&input[0];
+  zs->avail_in = input.size();
+  out->clear();
+  char chunk[4096];
+  do {
+    zs->next_out = (Bytef*)chunk;
+    zs->avail_out = sizeof(chunk);
+    int ret = inflate(zs, Z_SYNC_FLUSH);
+    if (ret != Z_OK && ret != Z_BUF_ERROR) return false;
+    out->append(chunk, sizeof(chunk) - zs->avail_out);
+  } while (zs->avail_out == 0);
+  return zs->avail_in == 0;
+}
+
+/* 服务端帧不加掩码 */
+void writeFrame(MockSession* session, WsOpCode opCode, const char* data,
+                size_t length) {
+  unsigned char header[10];
+  size_t headerSize = 2;
+  header[0] = 0x80 | opCode;
+  std::string compressed;
+  if (session->deflater && opCode == WsText &&
+      deflatePayload(session->deflater, data, length, &compressed)) {
+    header[0] |= 0x40;
+    data = compressed.data();
+    length = compressed.size();
+  }
+  if (length < 126) {
+    header[1] = (unsigned char)length;
+  } else if (length < 65536) {
+    header[1] = 126;
+    header[2] = (length >> 8) & 0xff;
+    header[3] = length & 0xff;
+    headerSize = 4;
+  } else {
+    header[1] = 127;
+    for (int i = 0; i < 8; i++) {
+      header[2 + i] = ((uint64_t)length >> ((7 - i) * 8)) & 0xff;
+    }
+    headerSize = 10;
+  }
+  struct evbuffer* output = bufferevent_get_output(session->bev);
+  evbuffer_add(output, header, headerSize);
+  if (length > 0) evbuffer_add(output, data, length);
+  g_stats.bytesOut += headerSize + length;
+}
+
+void freeSession(MockSession* session) {
+  if (session->inflater) {
+    inflateEnd(session->inflater);
+    delete session->inflater;
+  }
+  if (session->deflater) {
+    deflateEnd(session->deflater);
+    delete session->deflater;
+  }
+  if (session->timer) event_free(session->timer);
+  if (session->dropTimer) event_free(session->dropTimer);
+  if (session->bev) bufferevent_free(session->bev);
+  g_stats.activeConnections--;
+  delete session;
+}
+
+void dropCallback(evutil_socket_t, short, void* arg) {
+  freeSession(static_cast<MockSession*>(arg));
+}
+
+void scheduleTimer(MockSession* session) {
+  if (session->outQueue.empty()) return;
+  uint64_t now = nowUs();
+  uint64_t due = session->outQueue.front().dueUs;
+  struct timeval tv;
+  uint64_t delay = due > now ? due - now : 0;
+  tv.tv_sec = delay / 1000000;
+  tv.tv_usec = delay % 1000000;
+  evtimer_add(session->timer, &tv);
+}
+
+/* 按配置的延迟和抖动计算下发时间 */
+uint64_t responseDueUs(MockSession* session, uint64_t extraUs) {
+  uint64_t delayUs = (uint64_t)g_options.latencyMs * 1000;
+  if (g_options.jitterMs > 0) {
+    delayUs +=
+        nextRandom(session->worker) % ((uint64_t)g_options.jitterMs * 1000);
+  }
+  uint64_t due = nowUs() + delayUs + extraUs;
+  if (due < session->lastDueUs) due = session->lastDueUs;
+  session->lastDueUs = due;
+  return due;
+}
+
+void enqueue(MockSession* session, OutAction action, WsOpCode opCode,
+             const std::string& payload, uint64_t dueUs) {
+  OutMessage message;
+  message.dueUs = dueUs;
+  message.action = action;
+  message.opCode = opCode;
+  message.payload = payload;
+  session->outQueue.push_back(message);
+  if (session->outQueue.size() == 1) scheduleTimer(session);
+}
+
+void enqueueText(MockSession* session, const std::string& text) {
+  enqueue(session, ActionSendFrame, WsText, text, responseDueUs(session, 0));
+}
+
+/* ---------------- 消息构造 ---------------- */
+
+std::string nlsHeader(MockSession* session, const char* name, int status,
+                      const char* statusText) {
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           "{\"namespace\":\"%s\",\"name\":\"%s\",\"status\":%d,"
+           "\"message_id\":\"%s\",\"task_id\":\"%s\",\"status_text\":\"%s\"}",
+           session->ns.c_str(), name, status,
+           randomHex(session->worker).c_str(), session->taskId.c_str(),
+           statusText);
+  return buf;
+}
+
+std::string nlsMessage(MockSession* session, const char* name,
+                       const std::string& payload) {
+  return "{\"header\":" +
+         nlsHeader(session, name, 20000000, "Gateway:SUCCESS:Success.") +
+         ",\"payload\":" + payload + "}";
+}
+
+std::string dashMessage(MockSession* session, const char* event,
+                        const std::string& payload) {
+  return "{\"header\":{\"task_id\":\"" + session->taskId + "\",\"event\":\"" +
+         event + "\",\"attributes\":{}},\"payload\":" + payload + "}";
+}
+
+std::string failedMessage(MockSession* session, const char* reason) {
+  if (session->dashscope) {
+    return "{\"header\":{\"task_id\":\"" + session->taskId +
+           "\",\"event\":\"task-failed\",\"error_code\":\"MockError\","
+           "\"error_message\":\"" +
+           reason + "\",\"attributes\":{}},\"payload\":{}}";
+  }
+  return "{\"header\":" + nlsHeader(session, "TaskFailed", 40000000, reason) +
+         ",\"payload\":{}}";
+}
+
+std::string mockText(uint64_t ms) {
+  /* 每100ms音频识别出一个字 */
+  static const char* words[] = {"北", "京", "的", "天", "气", "晴", "朗"};
+  std::string text;
+  for (uint64_t i = 0; i < ms / 100 && i < 200; i++) {
+    text += words[i % (sizeof(words) / sizeof(words[0]))];
+  }
+  return text;
+}
+
+/* ---------------- 识别 ---------------- */
+
+void sendAsrResult(MockSession* session, bool sentenceEnd) {
+  uint64_t beginMs = session->sentenceBeginMs;
+  uint64_t endMs = session->audioMs;
+  std::string text = mockText(endMs - beginMs);
+  char buf[1024];
+  if (session->dashscope) {
+    snprintf(buf, sizeof(buf),
+             "{\"output\":{\"sentence\":{\"begin_time\":%llu,\"end_time\":"
+             "%llu,\"text\":\"%s\",\"sentence_end\":%s,\"words\":[]}},"
+             "\"usage\":{\"duration\":%llu}}",
+             (unsigned long long)beginMs, (unsigned long long)endMs,
+             text.c_str(), sentenceEnd ? "true" : "false",
+             (unsigned long long)(endMs / 1000));
+    enqueueText(session, dashMessage(session, "result-generated", buf));
+    return;
+  }
+
+  const char* name = "TranscriptionResultChanged";
+  if (session->ns == "SpeechRecognizer") {
+    if (sentenceEnd) return; /* 一句话识别在Stop时返回最终结果 */
+    name = "RecognitionResultChanged";
+    snprintf(buf, sizeof(buf), "{\"result\":\"%s\"}",
+             mockText(endMs).c_str());
+  } else {
+    if (sentenceEnd) name = "SentenceEnd";
+    snprintf(buf, sizeof(buf),
+             "{\"index\":%d,\"time\":%llu,\"begin_time\":%llu,"
+             "\"result\":\"%s\",\"confidence\":0.9,\"words\":[],"
+             "\"status\":0}",
+             session->sentenceIndex, (unsigned long long)endMs,
+             (unsigned long long)beginMs, text.c_str());
+  }
+  enqueueText(session, nlsMessage(session, name, buf));
+}
+
+void onAudio(MockSession* session, size_t length) {
+  if (!session->started || session->finished || session->kind != TaskAsr) {
+    return;
+  }
+  session->audioBytes += length;
+  session->audioFrames++;
+  if (session->format == "pcm" || session->format == "wav" ||
+      session->format.empty()) {
+    uint64_t bytesPerMs = session->sampleRate * 2 / 1000;
+    session->audioMs = session->timeOffsetMs +
+                       session->audioBytes / (bytesPerMs ? bytesPerMs : 32);
+  } else {
+    /* 压缩格式按每次发送20ms估算 */
+    session->audioMs = session->timeOffsetMs + session->audioFrames * 20;
+  }
+
+  if (!session->inSentence) {
+    session->inSentence = true;
+    session->sentenceBeginMs = session->audioMs;
+    session->lastResultMs = session->audioMs;
+    if (!session->dashscope && session->ns == "SpeechTranscriber") {
+      char buf[128];
+      snprintf(buf, sizeof(buf), "{\"index\":%d,\"time\":%llu}",
+               session->sentenceIndex,
+               (unsigned long long)session->audioMs);
+      enqueueText(session, nlsMessage(session, "SentenceBegin", buf));
+    }
+  }
+  if (session->audioMs - session->sentenceBeginMs >=
+      (uint64_t)g_options.sentenceMs) {
+    sendAsrResult(session, true);
+    session->inSentence = false;
+    session->sentenceIndex++;
+  } else if (session->audioMs - session->lastResultMs >=
+             (uint64_t)g_options.resultIntervalMs) {
+    session->lastResultMs = session->audioMs;
+    sendAsrResult(session, false);
+  }
+}
+
+/* ---------------- 合成 ---------------- */
+
+/* 按tts-rate把合成音频分帧排入下发队列 */
+void enqueueTtsAudio(MockSession* session, size_t textLength) {
+  int bytesPerMs = session->sampleRate * 2 / 1000;
+  if (bytesPerMs <= 0) bytesPerMs = 32;
+  uint64_t total =
+      (uint64_t)textLength * g_options.ttsMsPerChar * bytesPerMs;
+  if (total == 0) total = g_options.ttsChunk;
+  const size_t chunk = g_options.ttsChunk > 0 ? g_options.ttsChunk : 3200;
+  std::string data(chunk, '\0');
+  for (size_t i = 0; i < chunk; i++) {
+    data[i] = (char)(i * 7);
+  }
+
+  uint64_t due = responseDueUs(session, 0);
+  for (uint64_t sent = 0; sent < total; sent += chunk) {
+    size_t length = (size_t)(total - sent < chunk ? total - sent : chunk);
+    enqueue(session, ActionSendFrame, WsBinary, data.substr(0, length), due);
+    if (g_options.ttsRate > 0) {
+      due += (uint64_t)length * 1000000 / g_options.ttsRate;
+    }
+  }
+  session->lastDueUs = due;
+}
+
+void onFlowingText(MockSession* session, const std::string& text) {
+  size_t length = textLength(text);
+  char buf[256];
+  if (session->dashscope) {
+    enqueueTtsAudio(session, length);
+    snprintf(buf, sizeof(buf),
+             "{\"output\":{\"sentence\":{\"index\":%d,\"words\":[]}},"
+             "\"usage\":{\"characters\":%d}}",
+             session->sentenceIndex, (int)length);
+    enqueueText(session, dashMessage(session, "result-generated", buf));
+  } else {
+    snprintf(buf, sizeof(buf), "{\"index\":%d}", session->sentenceIndex);
+    enqueueText(session, nlsMessage(session, "SentenceBegin", buf));
+    enqueueTtsAudio(session, length);
+    enqueueText(session, nlsMessage(session, "SentenceEnd", buf));
+  }
+  session->sentenceIndex++;
+}
+
+/* ---------------- 指令处理 ---------------- */
+
+void startTask(MockSession* session, const std::string& msg) {
+  session->taskId = jsonValue(msg, "task_id");
+  session->format = jsonValue(msg, "format", "payload");
+  std::string sampleRate = jsonValue(msg, "sample_rate", "payload");
+  session->sampleRate = sampleRate.empty() ? 16000 : atoi(sampleRate.c_str());
+  /* 重连续传: 时间戳和句子编号从断点之后继续 */
+  std::string timeOffset = jsonValue(msg, "tw_time_offset", "payload");
+  std::string indexOffset = jsonValue(msg, "tw_index_offset", "payload");
+  if (!timeOffset.empty()) {
+    session->timeOffsetMs = strtoull(timeOffset.c_str(), NULL, 10);
+    session->audioMs = session->timeOffsetMs;
+  }
+  if (!indexOffset.empty()) {
+    session->sentenceIndex = atoi(indexOffset.c_str()) + 1;
+  }
+
+  if (hitRate(session->worker, g_options.failRate)) {
+    g_stats.tasksFailed++;
+    session->finished = true;
+    enqueueText(session, failedMessage(session, "mock injected failure"));
+    return;
+  }
+
+  g_stats.tasksStarted++;
+  session->started = true;
+  if (hitRate(session->worker, g_options.dropRate)) {
+    /*
+     * 在开始后的1s内随机断开, 独立于响应队列计时,
+     * 以免延后TranscriptionStarted等响应的下发.
+     */
+    g_stats.tasksDropped++;
+    uint64_t delay = nextRandom(session->worker) % 1000000;
+    struct timeval tv;
+    tv.tv_sec = delay / 1000000;
+    tv.tv_usec = delay % 1000000;
+    session->dropTimer =
+        evtimer_new(session->worker->base, dropCallback, session);
+    evtimer_add(session->dropTimer, &tv);
+  }
+}
+
+void finishTask(MockSession* session, const char* message,
+                const std::string& payload) {
+  if (session->finished) return;
+  session->finished = true;
+  g_stats.tasksCompleted++;
+  if (session->dashscope) {
+    enqueueText(session, dashMessage(session, "task-finished", payload));
+  } else {
+    enqueueText(session, nlsMessage(session, message, payload));
+  }
+}
+
+void onNlsCommand(MockSession* session, const std::string& msg) {
+  std::string name = jsonValue(msg, "name");
+  if (!session->started && !session->finished) {
+    session->ns = jsonValue(msg, "namespace");
+    if (name == "StartTranscription" || name == "StartRecognition") {
+      session->kind = TaskAsr;
+    } else if (name == "StartSynthesis") {
+      session->kind = session->ns == "FlowingSpeechSynthesizer"
+                          ? TaskFlowingTts
+                          : TaskTts;
+    } else {
+      session->taskId = jsonValue(msg, "task_id");
+      enqueueText(session, failedMessage(session, "unsupported command"));
+      return;
+    }
+    startTask(session, msg);
+    if (!session->started) return;
+
+    if (session->kind == TaskAsr) {
+      enqueueText(session, nlsMessage(session,
+                                      name == "StartTranscription"
+                                          ? "TranscriptionStarted"
+                                          : "RecognitionStarted",
+                                      "{}"));
+    } else if (session->kind == TaskFlowingTts) {
+      enqueueText(session, nlsMessage(session, "SynthesisStarted", "{}"));
+    } else {
+      std::string text = jsonValue(msg, "text", "payload");
+      enqueueTtsAudio(session, textLength(text));
+      finishTask(session, "SynthesisCompleted", "{}");
+    }
+    return;
+  }
+  if (session->finished) return;
+
+  if (name == "StopTranscription") {
+    if (session->inSentence) sendAsrResult(session, true);
+    finishTask(session, "TranscriptionCompleted", "{}");
+  } else if (name == "StopRecognition") {
+    char buf[1024];
+    snprintf(buf, sizeof(buf), "{\"result\":\"%s\"}",
+             mockText(session->audioMs).c_str());
+    finishTask(session, "RecognitionCompleted", buf);
+  } else if (name == "RunSynthesis") {
+    onFlowingText(session, jsonValue(msg, "text", "payload"));
+  } else if (name == "StopSynthesis") {
+    finishTask(session, "SynthesisCompleted", "{}");
+  }
+  /* ControlTranscriber/FlushText等指令不需要响应 */
+}
+
+void onDashCommand(MockSession* session, const std::string& msg) {
+  std::string action = jsonValue(msg, "action");
+  if (action == "run-task" && !session->started && !session->finished) {
+    std::string task = jsonValue(msg, "task", "payload");
+    session->kind = task == "tts" ? TaskFlowingTts : TaskAsr;
+    startTask(session, msg);
+    if (session->started) {
+      enqueueText(session,
+                  dashMessage(session, "task-started", "{\"output\":{}}"));
+    }
+  } else if (session->finished) {
+    return;
+  } else if (action == "continue-task") {
+    onFlowingText(session, jsonValue(msg, "text", "payload"));
+  } else if (action == "finish-task") {
+    if (session->kind == TaskAsr && session->inSentence) {
+      sendAsrResult(session, true);
+    }
+    finishTask(session, "", "{\"output\":{}}");
+  }
+}
+
+/* ---------------- 连接处理 ---------------- */
+
+void timerCallback(evutil_socket_t, short, void* arg) {
+  MockSession* session = static_cast<MockSession*>(arg);
+  uint64_t now = nowUs();
+  while (!session->outQueue.empty() && session->outQueue.front().dueUs <= now) {
+    OutMessage& message = session->outQueue.front();
+    writeFrame(session, message.opCode, message.payload.data(),
+               message.payload.size());
+    session->outQueue.pop_front();
+  }
+  scheduleTimer(session);
+}
+
+bool handleHandshake(MockSession* session, struct evbuffer* input) {
+  struct evbuffer_ptr end =
+      evbuffer_search(input, "\r\n\r\n", 4, NULL);
+  if (end.pos < 0) return false;
+
+  size_t length = end.pos + 4;
+  std::string request(length, '\0');
+  evbuffer_remove(input, &request[0], length);
+  g_stats.bytesIn += length;
+
+  session->dashscope = request.find("dashscope") != std::string::npos;
+  std::string key;
+  size_t pos = request.find("Sec-WebSocket-Key:");
+  if (pos != std::string::npos) {
+    pos += strlen("Sec-WebSocket-Key:");
+    size_t eol = request.find("\r\n", pos);
+    key = request.substr(pos, eol - pos);
+    key.erase(0, key.find_first_not_of(' '));
+    key.erase(key.find_last_not_of(' ') + 1);
+  }
+
+  struct evbuffer* output = bufferevent_get_output(session->bev);
+  if (key.empty() || hitRate(session->worker, g_options.rejectRate)) {
+    const char* body = "{\"message\":\"mock rejected\"}";
+    evbuffer_add_printf(output,
+                        "HTTP/1.1 403 Forbidden\r\nContent-Type: "
+                        "application/json\r\nContent-Length: %d\r\n\r\n%s",
+                        (int)strlen(body), body);
+    g_stats.rejected++;
+    session->closing = true;
+    return true;
+  }
+
+  /* 只接受不带参数的permessage-deflate, 客户端参数均按默认处理 */
+  const char* extensions = "";
+  if (g_options.deflate &&
+      request.find("permessage-deflate") != std::string::npos) {
+    session->inflater = new z_stream();
+    session->deflater = new z_stream();
+    memset(session->inflater, 0, sizeof(z_stream));
+    memset(session->deflater, 0, sizeof(z_stream));
+    inflateInit2(session->inflater, -15);
+    deflateInit2(session->deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+                 Z_DEFAULT_STRATEGY);
+    extensions = "Sec-WebSocket-Extensions: permessage-deflate\r\n";
+  }
+  evbuffer_add_printf(output,
+                      "HTTP/1.1 101 Switching Protocols\r\n"
+                      "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Accept: %s\r\n%s\r\n",
+                      webSocketAccept(key).c_str(), extensions);
+  session->upgraded = true;
+  return true;
+}
+
+/* 解析一个完整的客户端帧, 数据不足时返回false */
+bool handleFrame(MockSession* session, struct evbuffer* input) {
+  size_t available = evbuffer_get_length(input);
+  if (available < 2) return false;
+  unsigned char head[14];
+  evbuffer_copyout(input, head, available < 14 ? available : 14);
+
+  int opCode = head[0] & 0x0f;
+  bool compressed = (head[0] & 0x40) != 0;
+  bool masked = (head[1] & 0x80) != 0;
+  uint64_t length = head[1] & 0x7f;
+  size_t headerSize = 2;
+  if (length == 126) {
+    if (available < 4) return false;
+    length = ((uint64_t)head[2] << 8) | head[3];
+    headerSize = 4;
+  } else if (length == 127) {
+    if (available < 10) return false;
+    length = 0;
+    for (int i = 0; i < 8; i++) length = (length << 8) | head[2 + i];
+    headerSize = 10;
+  }
+  unsigned char mask[4] = {0, 0, 0, 0};
+  if (masked) {
+    if (available < headerSize + 4) return false;
+    memcpy(mask, head + headerSize, 4);
+    headerSize += 4;
+  }
+  if (available < headerSize + length) return false;
+
+  evbuffer_drain(input, headerSize);
+  std::string payload((size_t)length, '\0');
+  if (length > 0) evbuffer_remove(input, &payload[0], (size_t)length);
+  g_stats.bytesIn += headerSize + length;
+  if (masked) {
+    for (size_t i = 0; i < payload.size(); i++) payload[i] ^= mask[i & 3];
+  }
+  if (compressed) {
+    std::string raw;
+    if (session->inflater == NULL ||
+        !inflatePayload(session->inflater, payload, &raw)) {
+      fprintf(stderr, "inflate client frame failed\n");
+      session->closing = true;
+      return true;
+    }
+    payload.swap(raw);
+  }
+
+  switch (opCode) {
+    case WsText:
+      if (session->dashscope) {
+        onDashCommand(session, payload);
+      } else {
+        onNlsCommand(session, payload);
+      }
+      break;
+    case WsBinary:
+    case WsContinuation:
+      onAudio(session, payload.size());
+      break;
+    case WsPing:
+      writeFrame(session, WsPong, payload.data(), payload.size());
+      break;
+    case WsClose:
+      writeFrame(session, WsClose, payload.data(), payload.size());
+      session->closing = true;
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+void readCallback(struct bufferevent* bev, void* arg) {
+  MockSession* session = static_cast<MockSession*>(arg);
+  struct evbuffer* input = bufferevent_get_input(bev);
+  if (!session->upgraded) {
+    if (!handleHandshake(session, input)) return;
+  }
+  while (session->upgraded && !session->closing &&
+         handleFrame(session, input)) {
+  }
+  if (session->closing) {
+    /* 写完响应后关闭 */
+    session->outQueue.clear();
+    bufferevent_disable(bev, EV_READ);
+    if (evbuffer_get_length(bufferevent_get_output(bev)) == 0) {
+      freeSession(session);
+    }
+  }
+}
+
+void writeCallback(struct bufferevent* bev, void* arg) {
+  MockSession* session = static_cast<MockSession*>(arg);
+  if (session->closing &&
+      evbuffer_get_length(bufferevent_get_output(bev)) == 0) {
+    freeSession(session);
+  }
+}
+
+void eventCallback(struct bufferevent*, short events, void* arg) {
+  if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) {
+    freeSession(static_cast<MockSession*>(arg));
+  }
+}
+
+void acceptCallback(struct evconnlistener* listener, evutil_socket_t fd,
+                    struct sockaddr*, int, void* arg) {
+  MockWorker* worker = static_cast<MockWorker*>(arg);
+  MockSession* session = new MockSession();
+  session->worker = worker;
+  session->bev = bufferevent_socket_new(worker->base, fd,
+                                        BEV_OPT_CLOSE_ON_FREE);
+  session->timer = evtimer_new(worker->base, timerCallback, session);
+  session->dropTimer = NULL;
+  session->upgraded = false;
+  session->dashscope = false;
+  session->closing = false;
+  session->inflater = NULL;
+  session->deflater = NULL;
+  session->kind = TaskNone;
+  session->sampleRate = 16000;
+  session->started = false;
+  session->finished = false;
+  session->audioBytes = 0;
+  session->audioFrames = 0;
+  session->audioMs = 0;
+  session->timeOffsetMs = 0;
+  session->lastResultMs = 0;
+  session->sentenceBeginMs = 0;
+  session->sentenceIndex = 1;
+  session->inSentence = false;
+  session->lastDueUs = 0;
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  bufferevent_setcb(session->bev, readCallback, writeCallback, eventCallback,
+                    session);
+  bufferevent_enable(session->bev, EV_READ | EV_WRITE);
+  g_stats.connections++;
+  g_stats.activeConnections++;
+}
+
+void* workerRoutine(void* arg) {
+  MockWorker* worker = static_cast<MockWorker*>(arg);
+  event_base_dispatch(worker->base);
+  return NULL;
+}
+
+void signalHandler(int) { g_running = false; }
+
+bool parseOption(const char* arg, const char* key, std::string* value) {
+  size_t len = strlen(key);
+  if (strncmp(arg, key, len) == 0 && arg[len] == '=') {
+    *value = arg + len + 1;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  g_options.port = 8080;
+  g_options.threads = 1;
+  g_options.latencyMs = 0;
+  g_options.jitterMs = 0;
+  g_options.rejectRate = 0;
+  g_options.failRate = 0;
+  g_options.dropRate = 0;
+  g_options.resultIntervalMs = 200;
+  g_options.sentenceMs = 3000;
+  g_options.ttsRate = 64000;
+  g_options.ttsChunk = 3200;
+  g_options.ttsMsPerChar = 200;
+  g_options.statsInterval = 5;
+  g_options.deflate = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string v;
+    if (parseOption(argv[i], "--port", &v)) {
+      g_options.port = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--threads", &v)) {
+      g_options.threads = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--latency-ms", &v)) {
+      g_options.latencyMs = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--jitter-ms", &v)) {
+      g_options.jitterMs = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--reject-rate", &v)) {
+      g_options.rejectRate = atof(v.c_str());
+    } else if (parseOption(argv[i], "--fail-rate", &v)) {
+      g_options.failRate = atof(v.c_str());
+    } else if (parseOption(argv[i], "--drop-rate", &v)) {
+      g_options.dropRate = atof(v.c_str());
+    } else if (parseOption(argv[i], "--result-interval-ms", &v)) {
+      g_options.resultIntervalMs = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--sentence-ms", &v)) {
+      g_options.sentenceMs = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--tts-rate", &v)) {
+      g_options.ttsRate = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--tts-chunk", &v)) {
+      g_options.ttsChunk = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--tts-ms-per-char", &v)) {
+      g_options.ttsMsPerChar = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--stats-interval", &v)) {
+      g_options.statsInterval = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--deflate", &v)) {
+      g_options.deflate = atoi(v.c_str()) != 0;
+    } else {
+      fprintf(stderr, "unknown option: %s\n", argv[i]);
+      return -1;
+    }
+  }
+  if (g_options.threads <= 0) g_options.threads = 1;
+
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+  evthread_use_pthreads();
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(g_options.port);
+
+  std::vector<MockWorker> workers(g_options.threads);
+  for (int i = 0; i < g_options.threads; i++) {
+    MockWorker& worker = workers[i];
+    worker.index = i;
+    worker.randomState = (nowUs() ^ ((uint64_t)(i + 1) << 32)) | 1;
+    worker.base = event_base_new();
+    worker.listener = evconnlistener_new_bind(
+        worker.base, acceptCallback, &worker,
+        LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE | LEV_OPT_REUSEABLE_PORT,
+        4096, (struct sockaddr*)&addr, sizeof(addr));
+    if (worker.listener == NULL) {
+      fprintf(stderr, "listen on port %d failed: %s\n", g_options.port,
+              strerror(errno));
+      return -1;
+    }
+  }
+  for (int i = 0; i < g_options.threads; i++) {
+    pthread_create(&workers[i].tid, NULL, workerRoutine, &workers[i]);
+  }
+  fprintf(stderr, "mock server listening on port %d with %d thread(s)\n",
+          g_options.port, g_options.threads);
+
+  int elapsed = 0;
+  while (g_running) {
+    sleep(1);
+    elapsed++;
+    if (g_options.statsInterval > 0 && elapsed % g_options.statsInterval == 0) {
+      fprintf(stderr,
+              "connections:%llu active:%llu rejected:%llu started:%llu "
+              "completed:%llu failed:%llu dropped:%llu in:%lluB out:%lluB\n",
+              (unsigned long long)g_stats.connections.load(),
+              (unsigned long long)g_stats.activeConnections.load(),
+              (unsigned long long)g_stats.rejected.load(),
+              (unsigned long long)g_stats.tasksStarted.load(),
+              (unsigned long long)g_stats.tasksCompleted.load(),
+              (unsigned long long)g_stats.tasksFailed.load(),
+              (unsigned long long)g_stats.tasksDropped.load(),
+              (unsigned long long)g_stats.bytesIn.load(),
+              (unsigned long long)g_stats.bytesOut.load());
+    }
+  }
+
+  for (int i = 0; i < g_options.threads; i++) {
+    event_base_loopbreak(workers[i].base);
+    pthread_join(workers[i].tid, NULL);
+    evconnlistener_free(workers[i].listener);
+    event_base_free(workers[i].base);
+  }
+  return 0;
+}
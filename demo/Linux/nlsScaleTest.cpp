@@ -0,0 +1,590 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * 单进程大并发实时识别的规模/浸泡测试, 配合nls_mock_server使用:
+ *   ./nls_mock_server --port=8080 --threads=4 &
+ *   ./nls_scale_test --sessions=10000 --ramp=500 --hold=60
+ *
+ * 按--ramp速率逐步建立--sessions路SpeechTranscriberRequest, 全部Started后
+ * 以实时速率持续发送合成音频--hold秒, 然后stop并释放全部请求.
+ * 过程中每秒采样一次RSS、文件描述符数量和事件循环延迟, 结束时按以下预算判定:
+ *   每个会话的RSS增量、每个会话每秒音频消耗的CPU时间、事件循环最大延迟、
+ *   成功Started的比例、结束后残留的文件描述符.
+ * 任一项超出预算时返回1, 便于在CI中发现回退.
+ *
+ * 参数:
+ *   --url=<地址>                 服务地址, 默认ws://127.0.0.1:8080/ws/v1
+ *   --sessions=<数量>            并发会话数, 默认10000
+ *   --ramp=<会话/秒>             建立会话的速率, 默认500
+ *   --hold=<秒>                  全部会话建立后持续发送音频的时长, 默认30
+ *   --chunk-ms=<毫秒>            每次sendAudio的音频时长, 默认100
+ *   --threads=<线程数>           SDK的startWorkThread参数, 默认-1
+ *   --drivers=<线程数>           发送音频的线程数, 默认4
+ *   --start-timeout=<秒>         等待全部会话Started的超时, 默认60
+ *   --max-rss-kb=<KB>            每个会话RSS增量预算, 默认64
+ *   --max-cpu-ms=<毫秒>          每个会话每秒音频的CPU时间预算, 默认1.0
+ *   --max-lag-ms=<毫秒>          事件循环最大调度延迟预算, 默认500
+ *   --min-started=<0~1>          成功Started的会话比例下限, 默认0.99
+ *   --log=<文件>                 开启SDK日志, 默认不开启
+ *   --out=<文件>                 将结果以json格式写入文件
+ */
+
+#include <dirent.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "nlsClient.h"
+#include "nlsEvent.h"
+#include "speechTranscriberRequest.h"
+
+using namespace AlibabaNls;
+
+namespace {
+
+enum SessionState {
+  StateIdle = 0,
+  StateStarting,
+  StateStreaming,
+  StateStopping,
+  StateReleased,
+};
+
+struct ScaleOptions {
+  std::string url;
+  int sessions;
+  double ramp;
+  int hold;
+  int chunkMs;
+  int threads;
+  int drivers;
+  int startTimeout;
+  double maxRssKb;
+  double maxCpuMs;
+  double maxLagMs;
+  double minStarted;
+  std::string logFile;
+  std::string outFile;
+};
+
+struct Session {
+  SpeechTranscriberRequest* request;
+  std::atomic<int> state;
+  uint64_t nextSendUs;
+  uint64_t audioMs;
+
+  std::atomic<bool> started;
+  std::atomic<bool> failed;
+  std::atomic<bool> closed;
+};
+
+struct Sample {
+  double elapsed;
+  int active;
+  long rssKb;
+  int fds;
+  double maxLagMs;
+};
+
+enum Phase {
+  PhaseRamp = 0,
+  PhaseHold,
+  PhaseStop,
+  PhaseDone,
+};
+
+ScaleOptions g_options;
+std::vector<Session> g_sessions;
+std::vector<char> g_audio;
+std::atomic<int> g_phase(PhaseRamp);
+std::atomic<bool> g_running(true);
+std::atomic<uint64_t> g_sendFailed(0);
+std::atomic<uint64_t> g_audioMs(0);
+
+/* 事件循环卡顿回调中记录, 每次采样后清零 */
+std::atomic<unsigned int> g_intervalLagMs(0);
+std::atomic<unsigned int> g_maxLagMs(0);
+std::atomic<uint64_t> g_stalls(0);
+
+uint64_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+long rssKb() {
+  long pages = 0, resident = 0;
+  FILE* fp = fopen("/proc/self/statm", "r");
+  if (fp == NULL) return 0;
+  if (fscanf(fp, "%ld %ld", &pages, &resident) != 2) resident = 0;
+  fclose(fp);
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+int fdCount() {
+  DIR* dir = opendir("/proc/self/fd");
+  if (dir == NULL) return -1;
+  int count = 0;
+  while (readdir(dir) != NULL) count++;
+  closedir(dir);
+  return count - 3; /* ".", ".."和opendir自身 */
+}
+
+double cpuMs() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+void updateMax(std::atomic<unsigned int>* value, unsigned int candidate) {
+  unsigned int current = value->load();
+  while (candidate > current &&
+         !value->compare_exchange_weak(current, candidate)) {
+  }
+}
+
+void onStall(int, unsigned int lagMs, const char*, unsigned int, void*) {
+  g_stalls++;
+  updateMax(&g_intervalLagMs, lagMs);
+  updateMax(&g_maxLagMs, lagMs);
+}
+
+void onStarted(NlsEvent*, void* param) {
+  static_cast<Session*>(param)->started = true;
+}
+
+void onFailed(NlsEvent*, void* param) {
+  static_cast<Session*>(param)->failed = true;
+}
+
+void onClosed(NlsEvent*, void* param) {
+  static_cast<Session*>(param)->closed = true;
+}
+
+void onResult(NlsEvent*, void*) {}
+
+bool startSession(Session* session) {
+  SpeechTranscriberRequest* request =
+      NlsClient::getInstance()->createTranscriberRequest();
+  if (request == NULL) return false;
+  request->setUrl(g_options.url.c_str());
+  request->setAppKey("mock-appkey");
+  request->setToken("mock-token");
+  request->setFormat("pcm");
+  request->setSampleRate(16000);
+  request->setIntermediateResult(true);
+  request->setOnTranscriptionStarted(onStarted, session);
+  request->setOnTranscriptionResultChanged(onResult, session);
+  request->setOnSentenceEnd(onResult, session);
+  request->setOnTaskFailed(onFailed, session);
+  request->setOnChannelClosed(onClosed, session);
+  session->request = request;
+  session->state = StateStarting;
+  if (request->start() < 0) {
+    NlsClient::getInstance()->releaseTranscriberRequest(request);
+    session->request = NULL;
+    session->failed = true;
+    session->state = StateReleased;
+    return false;
+  }
+  return true;
+}
+
+/* 每个驱动线程负责下标为index + k * drivers的会话 */
+void* driverRoutine(void* arg) {
+  size_t index = (size_t)(uintptr_t)arg;
+  const size_t chunkBytes = (size_t)g_options.chunkMs * 32;
+  while (g_phase != PhaseDone) {
+    uint64_t now = nowUs();
+    bool stopping = g_phase == PhaseStop;
+    for (size_t i = index; i < g_sessions.size(); i += g_options.drivers) {
+      Session* session = &g_sessions[i];
+      int state = session->state;
+      if (state == StateStarting && session->started) {
+        session->state = state = StateStreaming;
+        session->nextSendUs = now;
+      }
+      if (state != StateStreaming || session->closed) continue;
+
+      if (stopping) {
+        session->request->stop();
+        session->state = StateStopping;
+        continue;
+      }
+      if (now < session->nextSendUs) continue;
+      size_t offset = (session->audioMs * 32) % (g_audio.size() - chunkBytes);
+      if (session->request->sendAudio(
+              reinterpret_cast<const uint8_t*>(&g_audio[offset]),
+              chunkBytes) < 0) {
+        g_sendFailed++;
+      }
+      session->audioMs += g_options.chunkMs;
+      session->nextSendUs += (uint64_t)g_options.chunkMs * 1000;
+      g_audioMs += g_options.chunkMs;
+    }
+    usleep(2000);
+  }
+  return NULL;
+}
+
+struct Counts {
+  int active;
+  int started;
+  int failed;
+  int closed;
+};
+
+Counts countSessions() {
+  Counts counts = {0, 0, 0, 0};
+  for (size_t i = 0; i < g_sessions.size(); i++) {
+    Session& session = g_sessions[i];
+    if (session.state == StateStreaming && !session.closed) counts.active++;
+    if (session.started) counts.started++;
+    if (session.failed) counts.failed++;
+    if (session.closed) counts.closed++;
+  }
+  return counts;
+}
+
+Sample takeSample(uint64_t beginUs) {
+  Sample sample;
+  sample.elapsed = (nowUs() - beginUs) / 1e6;
+  sample.active = countSessions().active;
+  sample.rssKb = rssKb();
+  sample.fds = fdCount();
+  sample.maxLagMs = g_intervalLagMs.exchange(0);
+  return sample;
+}
+
+void printSample(const Sample& sample, const char* phase) {
+  fprintf(stderr, "[%8.1fs] %-5s active:%d rss:%ldKB fds:%d lag:%.0fms\n",
+          sample.elapsed, phase, sample.active, sample.rssKb, sample.fds,
+          sample.maxLagMs);
+}
+
+void signalHandler(int) { g_running = false; }
+
+bool parseOption(const char* arg, const char* key, std::string* value) {
+  size_t len = strlen(key);
+  if (strncmp(arg, key, len) == 0 && arg[len] == '=') {
+    *value = arg + len + 1;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  g_options.url = "ws://127.0.0.1:8080/ws/v1";
+  g_options.sessions = 10000;
+  g_options.ramp = 500;
+  g_options.hold = 30;
+  g_options.chunkMs = 100;
+  g_options.threads = -1;
+  g_options.drivers = 4;
+  g_options.startTimeout = 60;
+  g_options.maxRssKb = 64;
+  g_options.maxCpuMs = 1.0;
+  g_options.maxLagMs = 500;
+  g_options.minStarted = 0.99;
+
+  for (int i = 1; i < argc; i++) {
+    std::string v;
+    if (parseOption(argv[i], "--url", &v)) {
+      g_options.url = v;
+    } else if (parseOption(argv[i], "--sessions", &v)) {
+      g_options.sessions = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--ramp", &v)) {
+      g_options.ramp = atof(v.c_str());
+    } else if (parseOption(argv[i], "--hold", &v)) {
+      g_options.hold = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--chunk-ms", &v)) {
+      g_options.chunkMs = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--threads", &v)) {
+      g_options.threads = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--drivers", &v)) {
+      g_options.drivers = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--start-timeout", &v)) {
+      g_options.startTimeout = atoi(v.c_str());
+    } else if (parseOption(argv[i], "--max-rss-kb", &v)) {
+      g_options.maxRssKb = atof(v.c_str());
+    } else if (parseOption(argv[i], "--max-cpu-ms", &v)) {
+      g_options.maxCpuMs = atof(v.c_str());
+    } else if (parseOption(argv[i], "--max-lag-ms", &v)) {
+      g_options.maxLagMs = atof(v.c_str());
+    } else if (parseOption(argv[i], "--min-started", &v)) {
+      g_options.minStarted = atof(v.c_str());
+    } else if (parseOption(argv[i], "--log", &v)) {
+      g_options.logFile = v;
+    } else if (parseOption(argv[i], "--out", &v)) {
+      g_options.outFile = v;
+    } else {
+      fprintf(stderr, "unknown option: %s\n", argv[i]);
+      return -1;
+    }
+  }
+  if (g_options.sessions <= 0 || g_options.chunkMs <= 0) return -1;
+  if (g_options.drivers <= 0) g_options.drivers = 1;
+  if (g_options.ramp <= 0) g_options.ramp = 1e9;
+
+  /* 每个会话占用一个socket, 需要放开文件描述符上限 */
+  struct rlimit limit;
+  getrlimit(RLIMIT_NOFILE, &limit);
+  if (limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+  if (limit.rlim_cur < (rlim_t)g_options.sessions + 64) {
+    fprintf(stderr, "RLIMIT_NOFILE(%llu) is too small for %d sessions\n",
+            (unsigned long long)limit.rlim_cur, g_options.sessions);
+    return -1;
+  }
+
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+
+  /* 10s的440Hz正弦波 */
+  g_audio.resize(16000 * 2 * 10);
+  for (size_t i = 0; i < g_audio.size() / 2; i++) {
+    int16_t sample = (int16_t)(8000 * sin(2 * M_PI * 440 * i / 16000.0));
+    memcpy(&g_audio[i * 2], &sample, 2);
+  }
+
+  NlsClient* client = NlsClient::getInstance();
+  if (!g_options.logFile.empty()) {
+    client->setLogConfig(g_options.logFile.c_str(), LogInfo, 400, 50);
+  }
+  client->startWorkThread(g_options.threads);
+  client->setEventLoopWatchdog(1, onStall);
+
+  g_sessions = std::vector<Session>(g_options.sessions);
+  for (size_t i = 0; i < g_sessions.size(); i++) {
+    Session& session = g_sessions[i];
+    session.request = NULL;
+    session.state = StateIdle;
+    session.nextSendUs = 0;
+    session.audioMs = 0;
+    session.started = false;
+    session.failed = false;
+    session.closed = false;
+  }
+
+  std::vector<Sample> samples;
+  uint64_t beginUs = nowUs();
+  Sample baseline = takeSample(beginUs);
+  g_maxLagMs = 0;
+  printSample(baseline, "base");
+
+  std::vector<pthread_t> drivers(g_options.drivers);
+  for (int i = 0; i < g_options.drivers; i++) {
+    pthread_create(&drivers[i], NULL, driverRoutine, (void*)(uintptr_t)i);
+  }
+
+  /* 按ramp速率建立会话, 每秒采样一次 */
+  uint64_t lastSampleUs = beginUs;
+  int created = 0;
+  while (g_running && created < g_options.sessions) {
+    uint64_t now = nowUs();
+    int due = (int)std::min<double>(g_options.sessions,
+                                    (now - beginUs) / 1e6 * g_options.ramp + 1);
+    while (created < due) {
+      startSession(&g_sessions[created++]);
+    }
+    if (now - lastSampleUs >= 1000000) {
+      samples.push_back(takeSample(beginUs));
+      printSample(samples.back(), "ramp");
+      lastSampleUs = now;
+    }
+    usleep(1000);
+  }
+  double rampSeconds = (nowUs() - beginUs) / 1e6;
+
+  /* 等待全部会话Started或失败 */
+  uint64_t startDeadlineUs =
+      nowUs() + (uint64_t)g_options.startTimeout * 1000000;
+  while (g_running && nowUs() < startDeadlineUs) {
+    Counts counts = countSessions();
+    if (counts.started + counts.failed >= created) break;
+    usleep(100000);
+  }
+
+  /* 保持全部会话, 持续发送音频 */
+  g_phase = PhaseHold;
+  uint64_t holdBeginUs = nowUs();
+  double holdCpuBegin = cpuMs();
+  uint64_t holdAudioBegin = g_audioMs;
+  Sample peak = takeSample(beginUs);
+  lastSampleUs = holdBeginUs;
+  while (g_running &&
+         nowUs() - holdBeginUs < (uint64_t)g_options.hold * 1000000) {
+    usleep(100000);
+    uint64_t now = nowUs();
+    if (now - lastSampleUs >= 1000000) {
+      samples.push_back(takeSample(beginUs));
+      printSample(samples.back(), "hold");
+      if (samples.back().rssKb > peak.rssKb) peak = samples.back();
+      lastSampleUs = now;
+    }
+  }
+  double holdCpu = cpuMs() - holdCpuBegin;
+  double holdAudioSeconds = (g_audioMs - holdAudioBegin) / 1000.0;
+  Counts holdCounts = countSessions();
+
+  /* stop全部会话并等待Closed, 超时未关闭的会话cancel后释放 */
+  g_phase = PhaseStop;
+  uint64_t stopDeadlineUs = nowUs() + 30 * 1000000ULL;
+  while (nowUs() < stopDeadlineUs) {
+    int pending = 0;
+    for (size_t i = 0; i < g_sessions.size(); i++) {
+      int state = g_sessions[i].state;
+      if ((state == StateStarting || state == StateStreaming ||
+           state == StateStopping) &&
+          !g_sessions[i].closed) {
+        pending++;
+      }
+    }
+    if (pending == 0) break;
+    usleep(100000);
+  }
+  g_phase = PhaseDone;
+  for (int i = 0; i < g_options.drivers; i++) {
+    pthread_join(drivers[i], NULL);
+  }
+  int cancelled = 0;
+  for (size_t i = 0; i < g_sessions.size(); i++) {
+    Session& session = g_sessions[i];
+    if (session.request == NULL) continue;
+    if (!session.closed) {
+      session.request->cancel();
+      cancelled++;
+    }
+    client->releaseTranscriberRequest(session.request);
+    session.request = NULL;
+    session.state = StateReleased;
+  }
+  /* 等待WorkThread回收连接 */
+  usleep(500000);
+  Sample finalSample = takeSample(beginUs);
+  printSample(finalSample, "final");
+
+  /* 预算判定 */
+  Counts counts = countSessions();
+  int sessionsHeld = std::max(holdCounts.active, 1);
+  double rssPerSession = (double)(peak.rssKb - baseline.rssKb) / sessionsHeld;
+  double fdsPerSession = (double)(peak.fds - baseline.fds) / sessionsHeld;
+  double cpuPerSession =
+      holdAudioSeconds > 0 ? holdCpu / holdAudioSeconds : 0;
+  double startedRatio = (double)counts.started / g_options.sessions;
+  unsigned int maxLag = g_maxLagMs;
+  int leakedFds = finalSample.fds - baseline.fds;
+
+  std::vector<std::string> failures;
+  char reason[256];
+  if (rssPerSession > g_options.maxRssKb) {
+    snprintf(reason, sizeof(reason), "rss per session %.1fKB > %.1fKB",
+             rssPerSession, g_options.maxRssKb);
+    failures.push_back(reason);
+  }
+  if (cpuPerSession > g_options.maxCpuMs) {
+    snprintf(reason, sizeof(reason),
+             "cpu per session-second %.3fms > %.3fms", cpuPerSession,
+             g_options.maxCpuMs);
+    failures.push_back(reason);
+  }
+  if (maxLag > g_options.maxLagMs) {
+    snprintf(reason, sizeof(reason), "event loop lag %ums > %.0fms", maxLag,
+             g_options.maxLagMs);
+    failures.push_back(reason);
+  }
+  if (startedRatio < g_options.minStarted) {
+    snprintf(reason, sizeof(reason), "started ratio %.4f < %.4f",
+             startedRatio, g_options.minStarted);
+    failures.push_back(reason);
+  }
+  if (leakedFds > 0) {
+    snprintf(reason, sizeof(reason), "%d fds left after release", leakedFds);
+    failures.push_back(reason);
+  }
+
+  FILE* fp = stdout;
+  if (!g_options.outFile.empty()) {
+    fp = fopen(g_options.outFile.c_str(), "w");
+    if (fp == NULL) fp = stdout;
+  }
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"sdk_version\": \"%s\",\n", client->getVersion());
+  fprintf(fp, "  \"sessions\": %d,\n", g_options.sessions);
+  fprintf(fp, "  \"started\": %d,\n", counts.started);
+  fprintf(fp, "  \"failed\": %d,\n", counts.failed);
+  fprintf(fp, "  \"held\": %d,\n", holdCounts.active);
+  fprintf(fp, "  \"cancelled\": %d,\n", cancelled);
+  fprintf(fp, "  \"send_failed\": %llu,\n",
+          (unsigned long long)g_sendFailed.load());
+  fprintf(fp, "  \"ramp_s\": %.3f,\n", rampSeconds);
+  fprintf(fp, "  \"hold_s\": %d,\n", g_options.hold);
+  fprintf(fp, "  \"baseline_rss_kb\": %ld,\n", baseline.rssKb);
+  fprintf(fp, "  \"peak_rss_kb\": %ld,\n", peak.rssKb);
+  fprintf(fp, "  \"final_rss_kb\": %ld,\n", finalSample.rssKb);
+  fprintf(fp, "  \"rss_kb_per_session\": %.3f,\n", rssPerSession);
+  fprintf(fp, "  \"baseline_fds\": %d,\n", baseline.fds);
+  fprintf(fp, "  \"peak_fds\": %d,\n", peak.fds);
+  fprintf(fp, "  \"final_fds\": %d,\n", finalSample.fds);
+  fprintf(fp, "  \"fds_per_session\": %.3f,\n", fdsPerSession);
+  fprintf(fp, "  \"hold_cpu_ms\": %.3f,\n", holdCpu);
+  fprintf(fp, "  \"cpu_ms_per_session_second\": %.4f,\n", cpuPerSession);
+  fprintf(fp, "  \"max_event_loop_lag_ms\": %u,\n", maxLag);
+  fprintf(fp, "  \"event_loop_stalls\": %llu,\n",
+          (unsigned long long)g_stalls.load());
+  fprintf(fp, "  \"timeline\": [\n");
+  for (size_t i = 0; i < samples.size(); i++) {
+    fprintf(fp,
+            "    {\"t\": %.1f, \"active\": %d, \"rss_kb\": %ld, \"fds\": %d, "
+            "\"lag_ms\": %.0f}%s\n",
+            samples[i].elapsed, samples[i].active, samples[i].rssKb,
+            samples[i].fds, samples[i].maxLagMs,
+            i + 1 < samples.size() ? "," : "");
+  }
+  fprintf(fp, "  ],\n");
+  fprintf(fp, "  \"passed\": %s,\n", failures.empty() ? "true" : "false");
+  fprintf(fp, "  \"failures\": [");
+  for (size_t i = 0; i < failures.size(); i++) {
+    fprintf(fp, "%s\"%s\"", i > 0 ? ", " : "", failures[i].c_str());
+  }
+  fprintf(fp, "]\n}\n");
+  if (fp != stdout) fclose(fp);
+
+  for (size_t i = 0; i < failures.size(); i++) {
+    fprintf(stderr, "FAIL: %s\n", failures[i].c_str());
+  }
+  client->setEventLoopWatchdog(0, NULL);
+  NlsClient::releaseInstance();
+  return failures.empty() ? 0 : 1;
+}
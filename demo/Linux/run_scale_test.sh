@@ -0,0 +1,29 @@
+#!/bin/bash
+
+echo "Command:"
+echo "./build/demo/tests/run_scale_test.sh [nls_scale_test options]"
+echo "eg: ./build/demo/tests/run_scale_test.sh --sessions=10000 --ramp=500 --hold=60"
+
+git_root_path="$( cd "$( dirname "${BASH_SOURCE[0]}" )/.." && pwd )"
+echo "当前GIT路径:" $git_root_path
+workspace_result_path=$git_root_path/tests/tests_results
+mkdir -p $workspace_result_path
+
+mock_port=${NLS_MOCK_PORT_ENV:-18080}
+mock_threads=${NLS_MOCK_THREADS_ENV:-4}
+
+# 10000路并发需要足够的文件描述符
+ulimit -n $(ulimit -Hn)
+
+$git_root_path/nls_mock_server --port=$mock_port --threads=$mock_threads \
+  --stats-interval=10 &
+mock_pid=$!
+trap "kill $mock_pid 2>/dev/null" EXIT
+sleep 1
+
+result_file=$workspace_result_path/scale_test_$(date +%Y%m%d%H%M%S).json
+$git_root_path/nls_scale_test --url=ws://127.0.0.1:$mock_port/ws/v1 \
+  --out=$result_file "$@"
+ret=$?
+echo "结果文件:" $result_file
+exit $ret
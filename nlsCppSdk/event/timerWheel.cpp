@@ -0,0 +1,184 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "timerWheel.h"
+
+#include "nlog.h"
+#include "nlsMetrics.h"
+#include "text_utils.h"
+#include "utility.h"
+
+namespace AlibabaNls {
+
+TimerWheel::TimerWheel(struct event_base *base, TimerWheelCallback callback)
+    : _tickEvent(NULL),
+      _callback(callback),
+      _currentTick(nowMs() / TickMs),
+      _count(0),
+      _tickPending(false) {
+#if defined(_MSC_VER)
+  _mtxWheel = CreateMutex(NULL, FALSE, NULL);
+#else
+  pthread_mutex_init(&_mtxWheel, NULL);
+#endif
+
+  for (int i = 0; i < SlotNumber; i++) {
+    _slots[i].prev = &_slots[i];
+    _slots[i].next = &_slots[i];
+  }
+
+  _tickEvent = evtimer_new(base, tickEventCallback, this);
+  if (NULL == _tickEvent) {
+    LOG_ERROR("TimerWheel(%p) create tick event failed.", this);
+  }
+}
+
+TimerWheel::~TimerWheel() {
+  stop();
+
+  MUTEX_LOCK(_mtxWheel);
+  for (int i = 0; i < SlotNumber; i++) {
+    while (_slots[i].next != &_slots[i]) {
+      unlinkLocked(_slots[i].next);
+    }
+  }
+  MUTEX_UNLOCK(_mtxWheel);
+
+#if defined(_MSC_VER)
+  CloseHandle(_mtxWheel);
+#else
+  pthread_mutex_destroy(&_mtxWheel);
+#endif
+}
+
+uint64_t TimerWheel::nowMs() {
+  return utility::TextUtils::GetMonotonicUs() / 1000;
+}
+
+void TimerWheel::schedule(TimerWheelEntry *entry, uint64_t deadlineMs) {
+  MUTEX_LOCK(_mtxWheel);
+  if (entry->wheel == this) {
+    unlinkLocked(entry);
+  }
+
+  uint64_t tick = (deadlineMs + TickMs - 1) / TickMs;
+  if (tick <= _currentTick) {
+    tick = _currentTick + 1;
+  }
+  TimerWheelEntry *head = &_slots[tick & (SlotNumber - 1)];
+  entry->expireTick = tick;
+  entry->prev = head->prev;
+  entry->next = head;
+  head->prev->next = entry;
+  head->prev = entry;
+  entry->wheel = this;
+  _count++;
+
+  if (!_tickPending) {
+    addTickLocked();
+  }
+  MUTEX_UNLOCK(_mtxWheel);
+
+  utility::NlsMetrics::addCounter(utility::MetricTimerArm);
+}
+
+void TimerWheel::cancel(TimerWheelEntry *entry) {
+  MUTEX_LOCK(_mtxWheel);
+  if (entry->wheel == this) {
+    unlinkLocked(entry);
+  }
+  MUTEX_UNLOCK(_mtxWheel);
+}
+
+void TimerWheel::stop() {
+  MUTEX_LOCK(_mtxWheel);
+  struct event *tick_event = _tickEvent;
+  _tickEvent = NULL;
+  _tickPending = false;
+  MUTEX_UNLOCK(_mtxWheel);
+
+  if (tick_event) {
+    event_del(tick_event);
+    event_free(tick_event);
+  }
+}
+
+/**
+ * @brief: 扫描上次tick之后到当前时刻之间的各槽, 取出到期的定时项,
+ *         释放锁后再逐个回调, 回调中可以重新加入时间轮.
+ */
+void TimerWheel::tickEventCallback(evutil_socket_t fd, short which,
+                                   void *arg) {
+  TimerWheel *wheel = static_cast<TimerWheel *>(arg);
+
+  MUTEX_LOCK(wheel->_mtxWheel);
+  wheel->_tickPending = false;
+  uint64_t target = nowMs() / TickMs;
+  uint64_t ticks = target > wheel->_currentTick ? target - wheel->_currentTick
+                                                : 0;
+  if (ticks > SlotNumber) {
+    /* 事件循环阻塞超过一圈, 每个槽扫一遍即可 */
+    ticks = SlotNumber;
+  }
+  for (uint64_t i = 1; i <= ticks; i++) {
+    TimerWheelEntry *head =
+        &wheel->_slots[(wheel->_currentTick + i) & (SlotNumber - 1)];
+    TimerWheelEntry *entry = head->next;
+    while (entry != head) {
+      TimerWheelEntry *next = entry->next;
+      if (entry->expireTick <= target) {
+        wheel->unlinkLocked(entry);
+        wheel->_expired.push_back(entry->owner);
+      }
+      entry = next;
+    }
+  }
+  if (target > wheel->_currentTick) {
+    wheel->_currentTick = target;
+  }
+  if (wheel->_count > 0) {
+    wheel->addTickLocked();
+  }
+  MUTEX_UNLOCK(wheel->_mtxWheel);
+
+  for (size_t i = 0; i < wheel->_expired.size(); i++) {
+    wheel->_callback(wheel->_expired[i]);
+  }
+  wheel->_expired.clear();
+}
+
+void TimerWheel::unlinkLocked(TimerWheelEntry *entry) {
+  entry->prev->next = entry->next;
+  entry->next->prev = entry->prev;
+  entry->prev = NULL;
+  entry->next = NULL;
+  entry->wheel = NULL;
+  _count--;
+}
+
+void TimerWheel::addTickLocked() {
+  if (NULL == _tickEvent) {
+    return;
+  }
+  struct timeval tv;
+  tv.tv_sec = 0;
+  tv.tv_usec = TickMs * 1000;
+  if (evtimer_add(_tickEvent, &tv) == 0) {
+    _tickPending = true;
+  }
+}
+
+}  // namespace AlibabaNls
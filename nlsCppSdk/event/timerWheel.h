@@ -0,0 +1,108 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NLS_SDK_TIMER_WHEEL_H
+#define NLS_SDK_TIMER_WHEEL_H
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include <stdint.h>
+
+#include <vector>
+
+#include "event2/event.h"
+#include "event2/util.h"
+
+namespace AlibabaNls {
+
+class TimerWheel;
+
+/* 时间轮中的定时项, 由属主对象持有, 时间轮只负责串链, 不分配内存 */
+struct TimerWheelEntry {
+ public:
+  explicit TimerWheelEntry(void *owner = NULL)
+      : prev(NULL), next(NULL), wheel(NULL), expireTick(0), owner(owner){};
+  TimerWheelEntry *prev;
+  TimerWheelEntry *next;
+  TimerWheel *wheel; /* 所在的时间轮, NULL为未加入 */
+  uint64_t expireTick;
+  void *owner; /* 到期后交给回调的参数 */
+};
+
+typedef void (*TimerWheelCallback)(void *owner);
+
+/*
+ * 单层哈希时间轮, 每个WorkThread一个.
+ * 定时项按到期tick散列到SlotNumber个槽的双向链表中, 加入和移除均为O(1),
+ * 超出一圈的定时项在所在槽被扫到时比较到期tick, 未到期则留在原槽.
+ * 整个时间轮只占用一个libevent定时器, 有定时项时每TickMs触发一次,
+ * 时间轮为空时停止, 不再为每个节点的每次续期调整libevent的定时器最小堆.
+ * 可在任意线程加入/移除定时项, 到期回调只在所属WorkThread中执行.
+ */
+class TimerWheel {
+ public:
+  enum TimerWheelConstValue {
+    TickMs = 10,
+    SlotNumber = 1024, /* 须为2的幂, 一圈约10s */
+  };
+
+  TimerWheel(struct event_base *base, TimerWheelCallback callback);
+  ~TimerWheel();
+
+  static uint64_t nowMs();
+
+  /**
+   * @brief: 将entry加入时间轮, 已加入则移动到新的到期时刻
+   * @param deadlineMs: nowMs()时基下的到期时刻, 到期后最多延迟一个TickMs
+   */
+  void schedule(TimerWheelEntry *entry, uint64_t deadlineMs);
+
+  /**
+   * @brief: 将entry移出时间轮, 返回后时间轮不再访问entry
+   */
+  void cancel(TimerWheelEntry *entry);
+
+  /**
+   * @brief: 释放libevent定时器, 须在所属event_base释放前调用
+   */
+  void stop();
+
+ private:
+  static void tickEventCallback(evutil_socket_t fd, short which, void *arg);
+  void unlinkLocked(TimerWheelEntry *entry);
+  void addTickLocked();
+
+  struct event *_tickEvent;
+  TimerWheelCallback _callback;
+  TimerWheelEntry _slots[SlotNumber]; /* 各槽双向链表的哨兵 */
+  uint64_t _currentTick;              /* 已处理到的tick */
+  size_t _count;
+  bool _tickPending;
+  std::vector<void *> _expired; /* 只在tick回调中使用 */
+
+#ifdef _MSC_VER
+  HANDLE _mtxWheel;
+#else
+  pthread_mutex_t _mtxWheel;
+#endif
+};
+
+}  // namespace AlibabaNls
+
+#endif  // NLS_SDK_TIMER_WHEEL_H
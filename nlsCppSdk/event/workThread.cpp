@@ -39,6 +39,7 @@
 #include "nlsClientImpl.h"
 #include "nlsEventNetWork.h"
 #include "nlsGlobal.h"
+#include "nlsMetrics.h"
 #include "nlsRequestParamInfo.h"
 #include "nodeManager.h"
 #include "text_utils.h"
@@ -48,6 +49,25 @@
 namespace AlibabaNls {
 
 NlsClientImpl *WorkThread::_instance = NULL;
+std::atomic<unsigned int> WorkThread::_stallThresholdMs(0);
+std::atomic<EventLoopStallCallback> WorkThread::_stallCallback(NULL);
+std::atomic<void *> WorkThread::_stallUserParam(NULL);
+
+EventLoopCallbackScope::EventLoopCallbackScope(WorkThread *thread,
+                                               const char *name, void *node,
+                                               short event)
+    : _thread(thread),
+      _name(name),
+      _node(node),
+      _event(event),
+      _beginUs(utility::TextUtils::GetMonotonicUs()) {}
+
+EventLoopCallbackScope::~EventLoopCallbackScope() {
+  if (_thread) {
+    _thread->recordCallback(_name, _node, _event,
+                            utility::TextUtils::GetMonotonicUs() - _beginUs);
+  }
+}
 
 #if defined(_MSC_VER)
 HANDLE WorkThread::_mtxCpu = NULL;
@@ -59,6 +79,15 @@ WorkThread::WorkThread()
     : _workBase(NULL),
       _dnsBase(NULL),
       _workThreadId(0),
+      _threadIndex(-1),
+      _heartbeatEvent(NULL),
+      _readBuffer(NULL),
+      _edgeTriggered(false),
+      _timerWheel(NULL),
+      _maskKeyState(0),
+#ifdef ENABLE_WS_DEFLATE
+      _deflatePool(NULL),
+#endif
       _addrInFamily(AF_INET),
       _directIp(),
       _enableSysGetAddr(false) {
@@ -68,7 +97,17 @@ WorkThread::WorkThread()
   pthread_mutex_init(&_mtxList, NULL);
 #endif
 
-  _workBase = event_base_new();
+  /* epoll合并同一轮循环中对同一fd的修改, 如建连完成时_connectEvent的移除
+   * 与_readEvent的加入合并为一次EPOLL_CTL_MOD. SDK不会dup()socket,
+   * 不受changelist对dup出的fd的限制. */
+  struct event_config *config = event_config_new();
+  if (config) {
+    event_config_set_flag(config, EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST);
+    _workBase = event_base_new_with_config(config);
+    event_config_free(config);
+  } else {
+    _workBase = event_base_new();
+  }
   if (NULL == _workBase) {
     LOG_ERROR("WorkThread(%p) invoke event_base_new failed.", this);
     exit(1);
@@ -76,6 +115,18 @@ WorkThread::WorkThread()
   int features = event_base_get_features(_workBase);
   LOG_INFO("WorkThread(%p) create evbase(%p), get features %d", this, _workBase,
            features);
+  _edgeTriggered = (features & EV_FEATURE_ET) != 0;
+  _timerWheel = new TimerWheel(_workBase, nodeTimeoutCallback);
+  /* splitmix64打散种子, 保证xorshift64的状态非0 */
+  uint64_t seed = (utility::TextUtils::GetMonotonicUs() ^
+                   ((uint64_t)(uintptr_t)this << 16)) +
+                  0x9E3779B97F4A7C15ULL;
+  seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+  _maskKeyState = (seed ^ (seed >> 31)) | 1;
+#ifdef ENABLE_WS_DEFLATE
+  _deflatePool = new WsDeflatePool();
+#endif
 
   _dnsBase = evdns_base_new(_workBase, 1);
   if (NULL == _dnsBase) {
@@ -102,6 +153,14 @@ WorkThread::WorkThread()
     evdns_base_search_add(_dnsBase, "gds.alibabadns.com");
   }
 
+  /* 心跳定时器须在事件循环启动前加入, 由所属WorkThread自行续订 */
+  _heartbeatEvent = evtimer_new(_workBase, heartbeatEventCallback, this);
+  if (NULL == _heartbeatEvent) {
+    LOG_WARN("WorkThread(%p) create heartbeat event failed.", this);
+  } else {
+    addHeartbeat();
+  }
+
 #if defined(_MSC_VER)
   _workThreadHandle = (HANDLE)_beginthreadex(NULL, 0, loopEventCallback,
                                              (LPVOID)this, 0, &_workThreadId);
@@ -217,6 +276,22 @@ WorkThread::~WorkThread() {
   pthread_mutex_destroy(&_mtxList);
 #endif
 
+  /* 工作线程已退出, 不再有节点使用读缓冲区和时间轮 */
+  if (_readBuffer) {
+    free(_readBuffer);
+    _readBuffer = NULL;
+  }
+  if (_timerWheel) {
+    delete _timerWheel;
+    _timerWheel = NULL;
+  }
+#ifdef ENABLE_WS_DEFLATE
+  if (_deflatePool) {
+    delete _deflatePool;
+    _deflatePool = NULL;
+  }
+#endif
+
   LOG_DEBUG("Destroy WorkThread(%p) done.", this);
 }
 
@@ -352,6 +427,13 @@ void *WorkThread::loopEventCallback(void *arg) {
     LOG_DEBUG("workThread(%p) event_base_dispatch ...", arg);
     event_base_dispatch(eventParam->_workBase);
   }
+  if (eventParam->_heartbeatEvent) {
+    event_free(eventParam->_heartbeatEvent);
+    eventParam->_heartbeatEvent = NULL;
+  }
+  if (eventParam->_timerWheel) {
+    eventParam->_timerWheel->stop();
+  }
   if (eventParam->_dnsBase) {
     evdns_base_free(eventParam->_dnsBase, 0);
     eventParam->_dnsBase = NULL;
@@ -372,6 +454,104 @@ void *WorkThread::loopEventCallback(void *arg) {
 #endif
 }
 
+void WorkThread::addHeartbeat() {
+  struct timeval tv;
+  tv.tv_sec = 0;
+  tv.tv_usec = EventLoopStat::HeartbeatIntervalMs * 1000;
+  _loopStat.expected_us = utility::TextUtils::GetMonotonicUs() +
+                          EventLoopStat::HeartbeatIntervalMs * 1000;
+  evtimer_add(_heartbeatEvent, &tv);
+}
+
+/**
+ * @brief: 心跳定时器, 以实际触发时间与预期时间之差度量事件循环的调度延迟.
+ *         libevent没有逐轮回调, 回调次数及最慢回调按心跳周期统计.
+ * @return:
+ */
+void WorkThread::heartbeatEventCallback(evutil_socket_t fd, short which,
+                                        void *arg) {
+  WorkThread *thread = static_cast<WorkThread *>(arg);
+  EventLoopStat *stat = &thread->_loopStat;
+  uint64_t now = utility::TextUtils::GetMonotonicUs();
+  uint64_t lagUs = now > stat->expected_us ? now - stat->expected_us : 0;
+  int index = thread->_threadIndex;
+
+  utility::NlsMetrics::recordHistogram(utility::MetricEventLoopLag, lagUs);
+  utility::NlsMetrics::updateEventLoop(
+      index, lagUs, stat->callback_count, stat->slowest_us,
+      stat->slowest_callback, stat->slowest_node, stat->slowest_event);
+
+  unsigned int thresholdMs = _stallThresholdMs.load();
+  if (thresholdMs > 0 && lagUs >= (uint64_t)thresholdMs * 1000) {
+    utility::NlsMetrics::addCounter(utility::MetricEventLoopStall);
+    LOG_WARN(
+        "WorkThread(%p) index:%d event loop lag %llums, %llu callbacks, "
+        "slowest callback %s of Node(%p) event:%d cost %llums.",
+        thread, index, (unsigned long long)(lagUs / 1000),
+        (unsigned long long)stat->callback_count,
+        stat->slowest_callback ? stat->slowest_callback : "none",
+        stat->slowest_node, stat->slowest_event,
+        (unsigned long long)(stat->slowest_us / 1000));
+    EventLoopStallCallback callback = _stallCallback.load();
+    if (callback) {
+      callback(index, (unsigned int)(lagUs / 1000),
+               stat->slowest_callback ? stat->slowest_callback : "",
+               (unsigned int)(stat->slowest_us / 1000),
+               _stallUserParam.load());
+    }
+  }
+
+  stat->callback_count = 0;
+  stat->slowest_us = 0;
+  stat->slowest_callback = NULL;
+  stat->slowest_node = NULL;
+  stat->slowest_event = 0;
+  thread->addHeartbeat();
+}
+
+void WorkThread::recordCallback(const char *name, void *node, short event,
+                                uint64_t costUs) {
+  _loopStat.callback_count++;
+  if (costUs > _loopStat.slowest_us) {
+    _loopStat.slowest_us = costUs;
+    _loopStat.slowest_callback = name;
+    _loopStat.slowest_node = node;
+    _loopStat.slowest_event = event;
+  }
+}
+
+/**
+ * @brief: 获取本线程复用的读缓冲区, 大小为ReadBufferSize.
+ *         读事件均在本线程内串行处理, 各节点读到的数据随即转存至各自的
+ *         _readEvBuffer, 因此无需加锁, 读路径也不再有堆内存分配.
+ * @return: 读缓冲区, 分配失败则返回NULL.
+ */
+uint8_t *WorkThread::getReadBuffer() {
+  if (_readBuffer == NULL) {
+    _readBuffer = (uint8_t *)malloc(ReadBufferSize);
+    if (_readBuffer == NULL) {
+      LOG_ERROR("WorkThread(%p) malloc read buffer failed.", this);
+      return NULL;
+    }
+    utility::NlsMetrics::addCounter(utility::MetricReadBufferAlloc);
+    LOG_DEBUG("WorkThread(%p) allocate read buffer %dbytes.", this,
+              ReadBufferSize);
+  }
+  return _readBuffer;
+}
+
+/**
+ * @brief: 为本线程上的连接生成WebSocket掩码, 只在本线程的事件回调中调用
+ */
+uint32_t WorkThread::nextMaskKey() {
+  uint64_t x = _maskKeyState;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  _maskKeyState = x;
+  return (uint32_t)(x >> 32);
+}
+
 #ifdef ENABLE_HIGH_EFFICIENCY
 /**
  * @brief: 定时进行connect()后检查链接状态并开启ssl握手.
@@ -383,6 +563,9 @@ void WorkThread::connectTimerEventCallback(evutil_socket_t socketFd,
   ConnectNode *node = static_cast<ConnectNode *>(arg);
   node->_inEventCallbackNode = true;
 
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               event);
+
   LOG_DEBUG("Node(%p) connectTimerEventCallback node status:%s ...", node,
             node->getConnectNodeStatusString().c_str());
 
@@ -400,6 +583,7 @@ void WorkThread::connectTimerEventCallback(evutil_socket_t socketFd,
             "NodeStatus:NodeConnected.",
             node);
         node->setConnectNodeStatus(NodeConnected);
+        node->markTimelineConnected();
 
 #ifndef _MSC_VER
         // get client ip and port from socketFd
@@ -462,6 +646,9 @@ ConnectTimerProcessFailed:
   LOG_ERROR("Node(%p) connect or handshake failed, socket error mesg:%s.", node,
             evutil_socket_error_to_string(
                 evutil_socket_geterror(node->getSocketFd())));
+  utility::NlsMetrics::addCounter(node->getConnectNodeStatus() >= NodeConnected
+                                      ? utility::MetricHandshakeFailed
+                                      : utility::MetricConnectFailed);
 
   node->disconnectProcess();
   node->setConnectNodeStatus(NodeConnecting);
@@ -485,6 +672,90 @@ ConnectTimerProcessFailed:
 }
 #endif
 
+/**
+ * @brief: Happy Eyeballs中某个建连尝试的socket可写, 检查链接状态.
+ *         获胜者交由connectEventCallback继续ssl握手和gateway请求.
+ * @return:
+ */
+void WorkThread::connectRaceEventCallback(evutil_socket_t socketFd,
+                                          short event, void *arg) {
+  struct ConnectAttempt *attempt = static_cast<struct ConnectAttempt *>(arg);
+  ConnectNode *node = attempt->node;
+  int errorCode = 0;
+  socklen_t len = sizeof(errorCode);
+  getsockopt(socketFd, SOL_SOCKET, SO_ERROR, (char *)&errorCode, &len);
+
+  if (!errorCode && (event & EV_WRITE)) {
+    if (node->winConnectRace(attempt) == Success) {
+      connectEventCallback(node->getSocketFd(), EV_WRITE, node);
+      return;
+    }
+    node->_inEventCallbackNode = true;
+    connectRaceFailed(node);
+  } else {
+    node->_inEventCallbackNode = true;
+    LOG_DEBUG("Node(%p) connect attempt Fd:%d get error:%d.", node, socketFd,
+              errorCode);
+    if (node->failConnectAttempt(attempt) < 0) {
+      connectRaceFailed(node);
+    }
+  }
+
+#ifdef _MSC_VER
+  SET_EVENT(node->_inEventCallbackNode, node->_mtxEventCallbackNode);
+#else
+  SEND_COND_SIGNAL(node->_mtxEventCallbackNode, node->_cvEventCallbackNode,
+                   node->_inEventCallbackNode);
+#endif
+  return;
+}
+
+/**
+ * @brief: Happy Eyeballs的错峰定时器, 超过错峰间隔仍未建连则尝试下一个地址.
+ * @return:
+ */
+void WorkThread::connectRaceTimerEventCallback(evutil_socket_t socketFd,
+                                               short event, void *arg) {
+  ConnectNode *node = static_cast<ConnectNode *>(arg);
+  node->_inEventCallbackNode = true;
+
+  if (node->connectRaceTimeout()) {
+    LOG_ERROR("Node(%p) connect race timeout.", node);
+    connectRaceFailed(node);
+  } else if (node->startNextConnectAttempt() < 0) {
+    connectRaceFailed(node);
+  }
+
+#ifdef _MSC_VER
+  SET_EVENT(node->_inEventCallbackNode, node->_mtxEventCallbackNode);
+#else
+  SEND_COND_SIGNAL(node->_mtxEventCallbackNode, node->_cvEventCallbackNode,
+                   node->_inEventCallbackNode);
+#endif
+  return;
+}
+
+/**
+ * @brief: 所有候选地址均建连失败, 进行断链并重新开始dns解析.
+ * @return:
+ */
+void WorkThread::connectRaceFailed(ConnectNode *node) {
+  LOG_ERROR("Node(%p) connect race failed, node status:%s exit status:%s.",
+            node, node->getConnectNodeStatusString().c_str(),
+            node->getExitStatusString().c_str());
+#ifdef ENABLE_DNS_IP_CACHE
+  node->getEventThread()->setIpCache(NULL, NULL);
+#endif
+  node->disconnectProcess();
+  node->setConnectNodeStatus(NodeConnecting);
+  if (node->dnsProcess(node->getEventThread()->_addrInFamily,
+                       node->getEventThread()->_directIp,
+                       node->getEventThread()->_enableSysGetAddr) < 0) {
+    LOG_ERROR("Node(%p) try delete request.", node);
+    destroyConnectNode(node);
+  }
+}
+
 /**
  * @brief: connect()后检查链接状态并开启ssl握手.
  * @return:
@@ -495,6 +766,11 @@ void WorkThread::connectEventCallback(evutil_socket_t socketFd, short event,
   ConnectNode *node = static_cast<ConnectNode *>(arg);
   node->_inEventCallbackNode = true;
 
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               event);
+  /* _connectEvent已触发, 其在时间轮中的超时随之失效 */
+  node->clearTimeout(NodeTimeoutConnect);
+
   // LOG_DEBUG("Node(%p) connectEventCallback node status:%s ...",
   //     node, node_manager->getNodeStatusString(status).c_str());
 
@@ -516,6 +792,7 @@ void WorkThread::connectEventCallback(evutil_socket_t socketFd, short event,
             "NodeStatus:NodeConnected.",
             node);
         node->setConnectNodeStatus(NodeConnected);
+        node->markTimelineConnected();
         node->setConnected(true);
 
 #ifndef _MSC_VER
@@ -577,6 +854,9 @@ ConnectProcessFailed:
   LOG_ERROR("Node(%p) connect or handshake failed, socket error mesg:%s.", node,
             evutil_socket_error_to_string(
                 evutil_socket_geterror(node->getSocketFd())));
+  utility::NlsMetrics::addCounter(node->getConnectNodeStatus() >= NodeConnected
+                                      ? utility::MetricHandshakeFailed
+                                      : utility::MetricConnectFailed);
 
 #ifdef ENABLE_DNS_IP_CACHE
   node->getEventThread()->setIpCache(NULL, NULL);
@@ -621,6 +901,9 @@ void WorkThread::readEventCallBack(evutil_socket_t socketFd, short what,
 
   node->_inEventCallbackNode = true;
 
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               what);
+
 #ifdef ENABLE_NLS_DEBUG_2
   struct timeval start, end;
   gettimeofday(&start, NULL);
@@ -647,6 +930,7 @@ void WorkThread::readEventCallBack(evutil_socket_t socketFd, short what,
   }
 
   if (what == EV_READ) {
+    node->refreshRecvTimeout();
     ret = nodeResponseProcess(node);
     if (ret == -(InvalidRequest)) {
       LOG_ERROR("Node(%p) has invalid request, skip all operation.", node);
@@ -731,6 +1015,9 @@ void WorkThread::writeEventCallBack(evutil_socket_t socketFd, short what,
 
   node->_inEventCallbackNode = true;
 
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               what);
+
   // LOG_DEBUG(
   //     "Request(%p) Node(%p) writeEventCallBack current event:%d, node "
   //     "status:%s, exit status:%s.",
@@ -751,6 +1038,7 @@ void WorkThread::writeEventCallBack(evutil_socket_t socketFd, short what,
   }
 
   if (what == EV_WRITE) {
+    node->clearTimeout(NodeTimeoutSend);
     nodeRequestProcess(node);
   } else if (what == EV_TIMEOUT) {
     snprintf(tmp_msg, 512 - 1, "Send timeout. socket error:%s",
@@ -786,6 +1074,71 @@ void WorkThread::writeEventCallBack(evutil_socket_t socketFd, short what,
   return;
 }
 
+/**
+ * @brief: 边沿触发时读写共用的socket事件回调, 依次按读事件和写事件处理.
+ */
+void WorkThread::socketEventCallBack(evutil_socket_t socketFd, short what,
+                                     void *arg) {
+  ConnectNode *node = static_cast<ConnectNode *>(arg);
+  if (node == NULL) {
+    LOG_ERROR("Node is nullptr!!!");
+    return;
+  }
+  NlsNodeManager *node_manager = node->getInstance()->getNodeManger();
+
+  if (what & EV_READ) {
+    readEventCallBack(socketFd, EV_READ, arg);
+  }
+
+  if (what & EV_WRITE) {
+    /* 读事件处理过程中节点可能已经释放 */
+    int status = NodeStatusInvalid;
+    if (node_manager->checkNodeExist(node, &status) != Success) {
+      return;
+    }
+    if (node->needWritable()) {
+      writeEventCallBack(socketFd, EV_WRITE, arg);
+    }
+  }
+}
+
+/**
+ * @brief: 节点的超时在时间轮中到期, 按对应事件超时的流程处理.
+ */
+void WorkThread::nodeTimeoutCallback(void *arg) {
+  ConnectNode *node = static_cast<ConnectNode *>(arg);
+  if (node == NULL) {
+    LOG_ERROR("Node is nullptr!!!");
+    return;
+  }
+  NlsNodeManager *node_manager = node->getInstance()->getNodeManger();
+  int status = NodeStatusInvalid;
+  int result = node_manager->checkNodeExist(node, &status);
+  if (result != Success) {
+    LOG_ERROR("Node(%p) checkNodeExist failed, result:%d.", node, result);
+    return;
+  }
+
+  switch (node->checkTimeout()) {
+    case NodeTimeoutRecv:
+      readEventCallBack(node->getSocketFd(), EV_TIMEOUT, arg);
+      break;
+    case NodeTimeoutSend:
+      writeEventCallBack(node->getSocketFd(), EV_TIMEOUT, arg);
+      break;
+    case NodeTimeoutConnect:
+      connectEventCallback(node->getSocketFd(), EV_TIMEOUT, arg);
+      break;
+#ifdef ENABLE_HIGH_EFFICIENCY
+    case NodeTimeoutConnectPoll:
+      connectTimerEventCallback(node->getSocketFd(), EV_TIMEOUT, arg);
+      break;
+#endif
+    default:
+      break;
+  }
+}
+
 /**
  * @brief: IP直连
  * @return:
@@ -793,9 +1146,11 @@ void WorkThread::writeEventCallBack(evutil_socket_t socketFd, short what,
 void WorkThread::directConnect(void *arg, char *ip) {
   ConnectNode *node = static_cast<ConnectNode *>(arg);
   if (ip) {
-    LOG_DEBUG("Node(%p) direct IpV4:%s.", node, ip);
+    int aiFamily = strchr(ip, ':') != NULL ? AF_INET6 : AF_INET;
+    LOG_DEBUG("Node(%p) direct %s:%s.", node,
+              aiFamily == AF_INET6 ? "IpV6" : "IpV4", ip);
 
-    int ret = node->connectProcess(ip, AF_INET);
+    int ret = node->connectProcess(ip, aiFamily);
     if (ret == 0) {
       ret = node->sslProcess();
       if (ret == Success) {
@@ -900,6 +1255,67 @@ bool WorkThread::syncDirectConnect(void *arg, char *ip) {
 }
 #endif
 
+/**
+ * @brief: 节点的_triggerEvent触发, 依次执行其中待执行的动作
+ * @return:
+ */
+void WorkThread::nodeTriggerEventCallback(evutil_socket_t fd, short which,
+                                          void *arg) {
+  ConnectNode *node = static_cast<ConnectNode *>(arg);
+  if (NULL == node) {
+    LOG_ERROR("Node is nullptr!!!");
+    return;
+  }
+  NlsNodeManager *node_manager = node->getInstance()->getNodeManger();
+  int status = NodeStatusInvalid;
+  int result = node_manager->checkNodeExist(node, &status);
+  if (result != Success) {
+    LOG_ERROR("The node(%p) checkNodeExist failed, result:%d.", node, result);
+    return;
+  }
+
+  unsigned int actions = node->takeTriggeredActions();
+  bool executed = false;
+  for (int i = 0; i < NodeTriggerNumber; i++) {
+    if ((actions & (1u << i)) == 0) {
+      continue;
+    }
+    /* 前一个动作可能已释放了节点 */
+    if (executed && node_manager->checkNodeExist(node, &status) != Success) {
+      LOG_WARN("Node(%p) has been released, skip actions(0x%x).", node,
+               actions >> i);
+      return;
+    }
+    executed = true;
+
+    switch ((NodeTriggerAction)i) {
+      case NodeTriggerLaunch:
+      case NodeTriggerReconnect:
+        launchEventCallback(fd, which, arg);
+        break;
+      case NodeTriggerLongConnectionStart:
+        longConnectionStartEventCallback(fd, which, arg);
+        break;
+#ifdef ENABLE_PRECONNECTED_POOL
+      case NodeTriggerStartWithPool:
+        startWithPoolEventCallback(fd, which, arg);
+        break;
+#endif
+      case NodeTriggerSingleRoundText:
+        singleRoundTextEventCallback(fd, which, arg);
+        break;
+      case NodeTriggerConnectRace:
+        connectRaceTimerEventCallback(fd, which, arg);
+        break;
+      case NodeTriggerAudioWritable:
+        audioWritableEventCallback(fd, which, arg);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
 /**
  * @brief: 启动语音交互请求
  * @return:
@@ -928,6 +1344,9 @@ void WorkThread::launchEventCallback(evutil_socket_t fd, short which,
 
   node->_inEventCallbackNode = true;
 
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               which);
+
   LOG_DEBUG(
       "WorkThread(%p) Node(%p) Request(%p) trigger launchEventCallback with "
       "reconnection mechanism(%s) and isUsingPreconnection flag(%s) "
@@ -982,6 +1401,48 @@ void WorkThread::launchEventCallback(evutil_socket_t fd, short which,
   return;
 }
 
+/**
+ * @brief: 长链接模式下, 上一轮交互进入NodeClosed后发起延后的start请求
+ * @return:
+ */
+void WorkThread::longConnectionStartEventCallback(evutil_socket_t fd,
+                                                  short which, void *arg) {
+  ConnectNode *node = static_cast<ConnectNode *>(arg);
+  if (NULL == node) {
+    LOG_ERROR("Node is nullptr!!!");
+    return;
+  }
+  NlsNodeManager *node_manager = node->getInstance()->getNodeManger();
+  int status = NodeStatusInvalid;
+  int result = node_manager->checkNodeExist(node, &status);
+  if (result != Success) {
+    LOG_ERROR("The node(%p) checkNodeExist failed, result:%d.", node, result);
+    return;
+  }
+
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               which);
+
+  if (node->getExitStatus() == ExitCancel) {
+    LOG_WARN("Node(%p) is canceled, skip the pending start.", node);
+    return;
+  }
+
+  INlsRequest *request = node->getRequest();
+  if (NlsEventNetWork::_eventClient == NULL || request == NULL) {
+    LOG_ERROR("Node(%p) event client or request is nullptr.", node);
+    return;
+  }
+
+  LOG_DEBUG("Node(%p) begin the pending start on long connection.", node);
+  result = NlsEventNetWork::_eventClient->start(request);
+  if (result < 0) {
+    LOG_ERROR("Node(%p) the pending start failed, result:%d.", node, result);
+    node->handlerTaskFailedEvent(TASKFAILED_CONNECT_JSON_STRING);
+  }
+  return;
+}
+
 #ifdef ENABLE_PRECONNECTED_POOL
 void WorkThread::startWithPoolEventCallback(evutil_socket_t fd, short which,
                                             void *arg) {
@@ -1007,6 +1468,9 @@ void WorkThread::startWithPoolEventCallback(evutil_socket_t fd, short which,
 
   node->_inEventCallbackNode = true;
 
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               which);
+
   // LOG_INFO("Request(%p) Node(%p) %s start with pre-node ...", request, node,
   //          node->getConnectNodeStatusString().c_str());
 
@@ -1029,6 +1493,29 @@ void WorkThread::startWithPoolEventCallback(evutil_socket_t fd, short which,
 }
 #endif
 
+/**
+ * @brief: 音频发送缓冲区降至低水位, 在工作线程中回调AudioWritable
+ * @return:
+ */
+void WorkThread::audioWritableEventCallback(evutil_socket_t fd, short which,
+                                            void *arg) {
+  ConnectNode *node = static_cast<ConnectNode *>(arg);
+  node->_inEventCallbackNode = true;
+
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               which);
+
+  node->handlerAudioWritableEvent();
+
+#ifdef _MSC_VER
+  SET_EVENT(node->_inEventCallbackNode, node->_mtxEventCallbackNode);
+#else
+  SEND_COND_SIGNAL(node->_mtxEventCallbackNode, node->_cvEventCallbackNode,
+                   node->_inEventCallbackNode);
+#endif
+  return;
+}
+
 void WorkThread::singleRoundTextEventCallback(evutil_socket_t fd, short which,
                                               void *arg) {
   ConnectNode *node = static_cast<ConnectNode *>(arg);
@@ -1046,6 +1533,9 @@ void WorkThread::singleRoundTextEventCallback(evutil_socket_t fd, short which,
 
   node->_inEventCallbackNode = true;
 
+  EventLoopCallbackScope scope(node->getEventThread(), __FUNCTION__, node,
+                               which);
+
   INlsRequest *request = node->getRequest();
   NlsType requestMode = request->getRequestParam()->_mode;
   void *rawParam = request->getRequestParam();
@@ -1097,8 +1587,12 @@ void WorkThread::sysDnsEventCallback(evutil_socket_t socketFd, short what,
       return;
     }
 
-    dnsEventCallback(node->_dnsErrorCode, node->_addrinfo, arg);
+    /* _addrinfo交由dnsEventCallback释放 */
+    struct evutil_addrinfo *address = node->_addrinfo;
+    int error_code = node->_dnsErrorCode;
+    node->_addrinfo = NULL;
     node->_dnsErrorCode = 0;
+    dnsEventCallback(error_code, address, arg);
   }
   return;
 }
@@ -1117,6 +1611,9 @@ void WorkThread::dnsEventCallback(int errorCode,
   int ret = node_manager->checkNodeExist(node, &status);
   if (ret != Success) {
     LOG_ERROR("checkNodeExist failed, ret:%d.", ret);
+    if (address) {
+      evutil_freeaddrinfo(address);
+    }
     return;
   } else {
     if (status >= NodeStatusCancelling) {
@@ -1125,7 +1622,9 @@ void WorkThread::dnsEventCallback(int errorCode,
           "nothing later...",
           node, node->getConnectNodeStatusString().c_str(),
           node_manager->getNodeStatusString(status).c_str());
-      // maybe mem leak here
+      if (address) {
+        evutil_freeaddrinfo(address);
+      }
       destroyConnectNode(node);
       return;
     }
@@ -1170,7 +1669,42 @@ void WorkThread::dnsEventCallback(int errorCode,
   }
 
   struct evutil_addrinfo *ai;
+  /* 解析出多个地址时, 错峰并行建连(Happy Eyeballs) */
+  std::vector<struct ConnectCandidate> candidates;
   for (ai = address; ai; ai = ai->ai_next) {
+    char buffer[HostSize] = {0};
+    const char *ip = NULL;
+    if (ai->ai_family == AF_INET) {
+      struct sockaddr_in *sin = (struct sockaddr_in *)ai->ai_addr;
+      ip = evutil_inet_ntop(AF_INET, &sin->sin_addr, buffer, HostSize);
+    } else if (ai->ai_family == AF_INET6) {
+      struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)ai->ai_addr;
+      ip = evutil_inet_ntop(AF_INET6, &sin6->sin6_addr, buffer, HostSize);
+    }
+    if (ip) {
+      candidates.push_back(ConnectCandidate(ip, ai->ai_family));
+    }
+  }
+
+  bool connectRacing = false;
+  if (candidates.size() > 1) {
+#ifdef ENABLE_DNS_IP_CACHE
+    for (size_t i = 0; i < candidates.size(); i++) {
+      node->getEventThread()->setIpCache(
+          (char *)node->getRequest()->getRequestParam()->_url.c_str(),
+          (char *)candidates[i].ip.c_str());
+    }
+#endif
+    LOG_DEBUG("WorkThread(%p) Node(%p) race to connect %d addresses.", pThread,
+              node, candidates.size());
+    if (node->connectRaceProcess(candidates) < 0) {
+      LOG_DEBUG("WorkThread(%p) Node(%p) goto ConnectRetry.", pThread, node);
+      goto ConnectRetry;
+    }
+    connectRacing = true;
+  }
+
+  for (ai = connectRacing ? NULL : address; ai; ai = ai->ai_next) {
     char buffer[HostSize] = {0};
     const char *ip = NULL;
     if (ai->ai_family == AF_INET) {
@@ -1442,6 +1976,7 @@ int WorkThread::nodeResponseProcess(ConnectNode *node) {
       if (ret == 0) {
         /* ret == 0 mean parsing response successfully */
         node->setConnectNodeStatus(NodeStarting);
+        node->markTimelineHandshaked();
         if (node->isPreNodeStartStepByStep()) {
           LOG_INFO(
               "Request(%p) Node(%p) pre-node starts step by step, now break "
@@ -1582,6 +2117,16 @@ void WorkThread::setUseSysGetAddrInfo(bool enable) {
 
 void WorkThread::setInstance(NlsClientImpl *instance) { _instance = instance; }
 
+void WorkThread::setEventLoopWatchdog(unsigned int thresholdMs,
+                                      EventLoopStallCallback callback,
+                                      void *userParam) {
+  /* 先关闭阈值, 避免WorkThread读到新旧混合的回调与参数 */
+  _stallThresholdMs.store(0);
+  _stallUserParam.store(userParam);
+  _stallCallback.store(callback);
+  _stallThresholdMs.store(thresholdMs);
+}
+
 #ifdef ENABLE_DNS_IP_CACHE
 std::string WorkThread::getIpFromCache(char *host, bool force) {
   MUTEX_LOCK(_mtxList);
@@ -1626,6 +2171,26 @@ std::string WorkThread::getIpFromCache(char *host, bool force) {
   return ip_str;
 }
 
+void WorkThread::getIpListFromCache(
+    char *host, std::vector<struct ConnectCandidate> &candidates) {
+  MUTEX_LOCK(_mtxList);
+  if (host != NULL && !WebSocketTcp::urlWithAccess(host)) {
+    std::map<std::string, struct DnsIpCache>::iterator iter =
+        _dnsIpCache.find(std::string(host));
+    if (iter != _dnsIpCache.end() &&
+        iter->second.same_ip_count >= DnsIpCache::WorkThreshold) {
+      std::vector<std::string>::iterator ip_iter;
+      for (ip_iter = iter->second.ip_list.begin();
+           ip_iter != iter->second.ip_list.end(); ++ip_iter) {
+        int family =
+            ip_iter->find(':') != std::string::npos ? AF_INET6 : AF_INET;
+        candidates.push_back(ConnectCandidate(*ip_iter, family));
+      }
+    }
+  }
+  MUTEX_UNLOCK(_mtxList);
+}
+
 void WorkThread::setIpCache(char *host, char *ip) {
   MUTEX_LOCK(_mtxList);
   if (host == NULL || ip == NULL) {
@@ -1677,6 +2242,95 @@ void WorkThread::setIpCache(char *host, char *ip) {
 }
 #endif
 
+void WorkThread::updateAddrConnectStat(const std::string &ip, bool success,
+                                       uint64_t rttMs) {
+  MUTEX_LOCK(_mtxList);
+  struct AddrConnectStat &stat = _addrConnectStat[ip];
+  if (success) {
+    if (stat.success_count == 0) {
+      stat.rtt_ms = (double)rttMs;
+    } else {
+      stat.rtt_ms = stat.rtt_ms * 0.7 + (double)rttMs * 0.3;
+    }
+    stat.success_count++;
+    stat.failure_count = 0;
+  } else {
+    stat.failure_count++;
+    stat.last_failure_ms = utility::TextUtils::GetTimestampMs();
+  }
+  MUTEX_UNLOCK(_mtxList);
+}
+
+struct ConnectCandidateRank {
+  bool penalized;
+  bool measured;
+  double rtt_ms;
+  size_t index;
+  bool operator<(const ConnectCandidateRank &other) const {
+    if (penalized != other.penalized) return !penalized;
+    if (measured != other.measured) return measured;
+    if (measured && rtt_ms != other.rtt_ms) return rtt_ms < other.rtt_ms;
+    return index < other.index;
+  }
+};
+
+/**
+ * @brief: 按照历史建连结果对候选地址排序: 近期失败过的地址排在最后,
+ *         有建连耗时记录的地址按耗时升序在前, 其余保持dns返回的顺序,
+ *         最后按RFC 8305交替排列IPv6/IPv4.
+ * @return:
+ */
+void WorkThread::sortConnectCandidates(
+    std::vector<struct ConnectCandidate> &candidates) {
+  if (candidates.size() < 2) {
+    return;
+  }
+
+  uint64_t now = utility::TextUtils::GetTimestampMs();
+  std::vector<struct ConnectCandidateRank> ranks(candidates.size());
+  MUTEX_LOCK(_mtxList);
+  for (size_t i = 0; i < candidates.size(); i++) {
+    ranks[i].penalized = false;
+    ranks[i].measured = false;
+    ranks[i].rtt_ms = 0.0;
+    ranks[i].index = i;
+    std::map<std::string, struct AddrConnectStat>::iterator iter =
+        _addrConnectStat.find(candidates[i].ip);
+    if (iter != _addrConnectStat.end()) {
+      ranks[i].penalized =
+          iter->second.failure_count > 0 &&
+          now - iter->second.last_failure_ms < AddrConnectStat::PenaltyMs;
+      ranks[i].measured = iter->second.success_count > 0;
+      ranks[i].rtt_ms = iter->second.rtt_ms;
+    }
+  }
+  MUTEX_UNLOCK(_mtxList);
+  std::sort(ranks.begin(), ranks.end());
+
+  /* 未受惩罚的地址以首个地址的协议族开始交替排列 */
+  std::vector<struct ConnectCandidate> preferred, others, penalized;
+  int firstFamily = candidates[ranks[0].index].aiFamily;
+  for (size_t i = 0; i < ranks.size(); i++) {
+    const struct ConnectCandidate &candidate = candidates[ranks[i].index];
+    if (ranks[i].penalized) {
+      penalized.push_back(candidate);
+    } else if (candidate.aiFamily == firstFamily) {
+      preferred.push_back(candidate);
+    } else {
+      others.push_back(candidate);
+    }
+  }
+
+  std::vector<struct ConnectCandidate> sorted;
+  size_t p = 0, o = 0;
+  while (p < preferred.size() || o < others.size()) {
+    if (p < preferred.size()) sorted.push_back(preferred[p++]);
+    if (o < others.size()) sorted.push_back(others[o++]);
+  }
+  sorted.insert(sorted.end(), penalized.begin(), penalized.end());
+  candidates.swap(sorted);
+}
+
 void WorkThread::updateParameters(ConnectNode *node) {
   if (node) {
     if (_dnsBase) {
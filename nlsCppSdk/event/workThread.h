@@ -17,6 +17,7 @@
 #ifndef NLS_SDK_WORK_THREAD_H
 #define NLS_SDK_WORK_THREAD_H
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <queue>
@@ -26,6 +27,8 @@
 #include "event2/dns.h"
 #include "event2/util.h"
 #include "nlsClientImpl.h"
+#include "timerWheel.h"
+#include "wsDeflate.h"
 
 namespace AlibabaNls {
 
@@ -42,20 +45,80 @@ struct DnsIpCache {
 };
 #endif
 
+/* 每个地址的建连统计, 用于Happy Eyeballs决定候选地址的尝试顺序 */
+struct AddrConnectStat {
+ public:
+  explicit AddrConnectStat()
+      : rtt_ms(0.0), success_count(0), failure_count(0), last_failure_ms(0){};
+  enum AddrConnectStatConstValue {
+    /* 最近一次失败后PenaltyMs内, 此地址排在最后尝试 */
+    PenaltyMs = 30000,
+  };
+  double rtt_ms; /* 建连耗时的EWMA */
+  uint32_t success_count;
+  uint32_t failure_count; /* 连续失败次数 */
+  uint64_t last_failure_ms;
+};
+
+/* 一个心跳周期内事件循环的负载统计, 只在所属WorkThread内读写 */
+struct EventLoopStat {
+ public:
+  explicit EventLoopStat()
+      : expected_us(0),
+        callback_count(0),
+        slowest_us(0),
+        slowest_callback(NULL),
+        slowest_node(NULL),
+        slowest_event(0){};
+  enum EventLoopStatConstValue {
+    HeartbeatIntervalMs = 100,
+  };
+  uint64_t expected_us; /* 心跳定时器预期触发的时间点 */
+  uint64_t callback_count;
+  uint64_t slowest_us; /* 本周期内耗时最长的回调 */
+  const char *slowest_callback;
+  void *slowest_node;
+  short slowest_event;
+};
+
 class ConnectNode;
 class INlsRequest;
+struct ConnectCandidate;
+class WorkThread;
+
+/* 统计事件回调耗时, 析构时记入所属WorkThread的EventLoopStat */
+class EventLoopCallbackScope {
+ public:
+  EventLoopCallbackScope(WorkThread *thread, const char *name, void *node,
+                         short event);
+  ~EventLoopCallbackScope();
+
+ private:
+  WorkThread *_thread;
+  const char *_name;
+  void *_node;
+  short _event;
+  uint64_t _beginUs;
+};
+
 class WorkThread {
  public:
   WorkThread();
   virtual ~WorkThread();
 
+  static void nodeTriggerEventCallback(evutil_socket_t fd, short which,
+                                       void *arg);
   static void launchEventCallback(evutil_socket_t fd, short which, void *arg);
+  static void longConnectionStartEventCallback(evutil_socket_t fd, short which,
+                                               void *arg);
 #ifdef ENABLE_PRECONNECTED_POOL
   static void startWithPoolEventCallback(evutil_socket_t fd, short which,
                                          void *arg);
 #endif
   static void singleRoundTextEventCallback(evutil_socket_t fd, short which,
                                            void *arg);
+  static void audioWritableEventCallback(evutil_socket_t fd, short which,
+                                         void *arg);
   static void connectEventCallback(evutil_socket_t socketFd, short event,
                                    void *arg);
 #ifdef ENABLE_HIGH_EFFICIENCY
@@ -66,6 +129,9 @@ class WorkThread {
                                 void *arg);
   static void writeEventCallBack(evutil_socket_t socketFd, short what,
                                  void *arg);
+  static void socketEventCallBack(evutil_socket_t socketFd, short what,
+                                  void *arg);
+  static void nodeTimeoutCallback(void *arg);
 #ifdef __LINUX__
   static void sysDnsEventCallback(evutil_socket_t socketFd, short what,
                                   void *arg);
@@ -73,9 +139,16 @@ class WorkThread {
   static void dnsEventCallback(int errorCode, struct evutil_addrinfo *address,
                                void *arg);
   static void directConnect(void *arg, char *ip);
+  static void connectRaceEventCallback(evutil_socket_t socketFd, short event,
+                                       void *arg);
+  static void connectRaceTimerEventCallback(evutil_socket_t socketFd,
+                                            short event, void *arg);
+  static void connectRaceFailed(ConnectNode *node);
 #ifdef ENABLE_PRECONNECTED_POOL
   static bool syncDirectConnect(void *arg, char *ip);
 #endif
+  static void heartbeatEventCallback(evutil_socket_t fd, short which,
+                                     void *arg);
 #ifdef _MSC_VER
   static unsigned __stdcall loopEventCallback(LPVOID arg);
 #else
@@ -90,14 +163,33 @@ class WorkThread {
   static bool freeListNode(WorkThread *thread, INlsRequest *request);
 
   static void setInstance(NlsClientImpl *instance);
+  static void setEventLoopWatchdog(unsigned int thresholdMs,
+                                   EventLoopStallCallback callback,
+                                   void *userParam);
+
+  void setThreadIndex(int index) { _threadIndex = index; }
+  void recordCallback(const char *name, void *node, short event,
+                      uint64_t costUs);
+  uint8_t *getReadBuffer();
+  uint32_t nextMaskKey();
+  inline bool isEdgeTriggered() { return _edgeTriggered; }
+  inline TimerWheel *getTimerWheel() { return _timerWheel; }
+#ifdef ENABLE_WS_DEFLATE
+  inline WsDeflatePool *getDeflatePool() { return _deflatePool; }
+#endif
 
   void setUseSysGetAddrInfo(bool enable);
   void setDirectHost(char *ip);
   void setAddrInFamily(int aiFamily);
 #ifdef ENABLE_DNS_IP_CACHE
   std::string getIpFromCache(char *host, bool force = false);
+  void getIpListFromCache(char *host,
+                          std::vector<struct ConnectCandidate> &candidates);
   void setIpCache(char *host, char *ip);
 #endif
+  void updateAddrConnectStat(const std::string &ip, bool success,
+                             uint64_t rttMs);
+  void sortConnectCandidates(std::vector<struct ConnectCandidate> &candidates);
   void updateParameters(ConnectNode *node);
 
 #ifdef ENABLE_PRECONNECTED_POOL
@@ -123,11 +215,28 @@ class WorkThread {
 
  private:
   static NlsClientImpl *_instance;
+  static std::atomic<unsigned int> _stallThresholdMs;
+  static std::atomic<EventLoopStallCallback> _stallCallback;
+  static std::atomic<void *> _stallUserParam;
+
+  void addHeartbeat();
+
+  std::atomic<int> _threadIndex;
+  struct event *_heartbeatEvent;
+  EventLoopStat _loopStat;
+  uint8_t *_readBuffer; /* 本线程各节点复用的读缓冲区, 首次读取时分配 */
+  bool _edgeTriggered;  /* 事件后端支持EV_ET时, 节点读写共用一个事件 */
+  TimerWheel *_timerWheel; /* 本线程各节点的建连及收发超时 */
+  uint64_t _maskKeyState;  /* xorshift64状态, 只在本线程内生成掩码 */
+#ifdef ENABLE_WS_DEFLATE
+  WsDeflatePool *_deflatePool; /* 本线程各节点permessage-deflate的zlib流 */
+#endif
   int _addrInFamily;
   char _directIp[64];
 #ifdef ENABLE_DNS_IP_CACHE
   std::map<std::string, struct DnsIpCache> _dnsIpCache;
 #endif
+  std::map<std::string, struct AddrConnectStat> _addrConnectStat;
   bool _enableSysGetAddr;
 };
 
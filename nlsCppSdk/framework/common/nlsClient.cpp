@@ -109,6 +109,26 @@ void NlsClient::setSyncCallTimeout(unsigned int timeout_ms) {
   MUTEX_UNLOCK(_mtxNlsClient);
 }
 
+void NlsClient::setSocketOptions(const NlsSocketOptions &options) {
+  MUTEX_LOCK(_mtxNlsClient);
+  if (_instance) {
+    _instance->_impl->setSocketOptionsImpl(options);
+  } else {
+    LOG_WARN("Current instance has released.");
+  }
+  MUTEX_UNLOCK(_mtxNlsClient);
+}
+
+void NlsClient::setWsDeflateMemoryLimit(unsigned int limitBytes) {
+  MUTEX_LOCK(_mtxNlsClient);
+  if (_instance) {
+    _instance->_impl->setWsDeflateMemoryLimitImpl(limitBytes);
+  } else {
+    LOG_WARN("Current instance has released.");
+  }
+  MUTEX_UNLOCK(_mtxNlsClient);
+}
+
 void NlsClient::setPreconnectedPool(unsigned int maxNumber,
                                     unsigned int timeoutMs,
                                     unsigned requestTimeoutMs) {
@@ -124,6 +144,37 @@ void NlsClient::setPreconnectedPool(unsigned int maxNumber,
 #endif
 }
 
+int NlsClient::setPreconnectedPoolAutoScale(unsigned int minNumber,
+                                            unsigned int maxNumber,
+                                            float targetHitRatio) {
+  int ret = -(ConnectedPoolEmpty);
+#ifdef ENABLE_PRECONNECTED_POOL
+  MUTEX_LOCK(_mtxNlsClient);
+  if (_instance) {
+    ret = _instance->_impl->setPreconnectedPoolAutoScaleImpl(
+        minNumber, maxNumber, targetHitRatio);
+  } else {
+    LOG_WARN("Current instance has released.");
+  }
+  MUTEX_UNLOCK(_mtxNlsClient);
+#endif
+  return ret;
+}
+
+int NlsClient::dumpPreconnectedPoolInfo(std::string &info) {
+  int ret = -(ConnectedPoolEmpty);
+#ifdef ENABLE_PRECONNECTED_POOL
+  MUTEX_LOCK(_mtxNlsClient);
+  if (_instance) {
+    ret = _instance->_impl->dumpPreconnectedPoolInfoImpl(info);
+  } else {
+    LOG_WARN("Current instance has released.");
+  }
+  MUTEX_UNLOCK(_mtxNlsClient);
+#endif
+  return ret;
+}
+
 void NlsClient::setDirectHost(const char *ip) {
   MUTEX_LOCK(_mtxNlsClient);
   if (_instance) {
@@ -166,6 +217,57 @@ int NlsClient::setLogConfig(const char *logOutputFile, const LogLevel logLevel,
   return result;
 }
 
+int NlsClient::setAsyncLogConfig(bool enable, unsigned int ringSize) {
+  MUTEX_LOCK(_mtxNlsClient);
+  int result = -(EventClientEmpty);
+  if (_instance) {
+    result = _instance->_impl->setAsyncLogConfigImpl(enable, ringSize);
+  } else {
+    LOG_WARN("Current instance has released.");
+  }
+  MUTEX_UNLOCK(_mtxNlsClient);
+  return result;
+}
+
+int NlsClient::getMetricsSnapshot(std::string &snapshot, bool openMetrics) {
+  MUTEX_LOCK(_mtxNlsClient);
+  int result = -(EventClientEmpty);
+  if (_instance) {
+    result = _instance->_impl->getMetricsSnapshotImpl(snapshot, openMetrics);
+  } else {
+    LOG_WARN("Current instance has released.");
+  }
+  MUTEX_UNLOCK(_mtxNlsClient);
+  return result;
+}
+
+int NlsClient::setEventLoopWatchdog(unsigned int thresholdMs,
+                                    EventLoopStallCallback callback,
+                                    void *userParam) {
+  MUTEX_LOCK(_mtxNlsClient);
+  int result = -(EventClientEmpty);
+  if (_instance) {
+    result = _instance->_impl->setEventLoopWatchdogImpl(thresholdMs, callback,
+                                                        userParam);
+  } else {
+    LOG_WARN("Current instance has released.");
+  }
+  MUTEX_UNLOCK(_mtxNlsClient);
+  return result;
+}
+
+int NlsClient::setTracer(NlsTracer *tracer) {
+  MUTEX_LOCK(_mtxNlsClient);
+  int result = -(EventClientEmpty);
+  if (_instance) {
+    result = _instance->_impl->setTracerImpl(tracer);
+  } else {
+    LOG_WARN("Current instance has released.");
+  }
+  MUTEX_UNLOCK(_mtxNlsClient);
+  return result;
+}
+
 SpeechRecognizerRequest *NlsClient::createRecognizerRequest(
     const char *sdkName, bool isLongConnection) {
   MUTEX_LOCK(_mtxNlsClient);
@@ -25,6 +25,7 @@
 #include <string>
 
 #include "nlsGlobal.h"
+#include "nlsTrace.h"
 
 namespace AlibabaNls {
 
@@ -45,6 +46,10 @@ enum TtsVersion { ShortTts = 0, LongTts };
 enum DaVersion { DaV1 = 0, DaV2 };
 
 typedef void (*LogCallbackMethod)(const char*, int, const char*);
+typedef void (*EventLoopStallCallback)(int threadIndex, unsigned int lagMs,
+                                       const char* slowestCallback,
+                                       unsigned int slowestCallbackMs,
+                                       void* userParam);
 
 class NLS_SDK_CLIENT_EXPORT NlsClient {
  public:
@@ -69,10 +74,24 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
                    unsigned int logFileSize = 10, unsigned int logFileNum = 10,
                    LogCallbackMethod logCallback = NULL);
 
+  /**
+   * @brief 设置异步日志模式
+   * @note 开启后日志在调用线程中格式化并写入无锁环形队列,
+   *       由单独的写日志线程批量写入日志文件/终端/日志回调,
+   *       避免磁盘IO阻塞工作线程. 队列满时丢弃日志并计数, 而不阻塞.
+   * @param enable 是否开启异步日志, 默认关闭
+   * @param ringSize 每个环形队列可缓存的日志条数, 共8个队列按线程分配,
+   *                 仅首次开启时生效, 默认128
+   * @return 成功则返回0; 失败返回负值, 详见NlsRetCode
+   */
+  int setAsyncLogConfig(bool enable, unsigned int ringSize = 128);
+
   /**
    * @brief 创建一句话识别对象
    * @param sdkName SDK的命名, 涉及到运行平台和代码语言
    * @param isLongConnection 是否启用长链接, 即stop后可继续start.
+   * 在Completed回调中即可调用start, 下一轮交互将在Close回调后于同一链接上开始.
+   * 启用预连接池时, 长链接请求自行建链而不经过预连接池.
    * 但是此模式容易因为长时间未操作被服务端超时断链, 请谨慎使用或尽量不使用.
    * @return 成功返回speechRecognizerRequest对象，否则返回NULL
    */
@@ -90,6 +109,7 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    * @brief 创建实时音频流识别对象
    * @param sdkName SDK的命名, 涉及到运行平台和代码语言
    * @param isLongConnection 是否启用长链接, 即stop后可继续start.
+   * 启用预连接池时, 长链接请求自行建链而不经过预连接池.
    * 但是此模式容易因为长时间未操作被服务端超时断链, 请谨慎使用或尽量不使用.
    * @return 成功返回SpeechTranscriberRequest对象，否则返回NULL
    */
@@ -107,6 +127,7 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    * @brief 创建百炼Fun-ASR实时音频流识别对象
    * @param sdkName SDK的命名, 涉及到运行平台和代码语言
    * @param isLongConnection 是否启用长链接, 即stop后可继续start.
+   * 启用预连接池时, 长链接请求自行建链而不经过预连接池.
    * 但是此模式容易因为长时间未操作被服务端超时断链, 请谨慎使用或尽量不使用.
    * @return 成功返回SpeechTranscriberRequest对象，否则返回NULL
    */
@@ -125,6 +146,7 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    * @brief 创建百炼Paraformer实时音频流识别对象
    * @param sdkName SDK的命名, 涉及到运行平台和代码语言
    * @param isLongConnection 是否启用长链接, 即stop后可继续start.
+   * 启用预连接池时, 长链接请求自行建链而不经过预连接池.
    * 但是此模式容易因为长时间未操作被服务端超时断链, 请谨慎使用或尽量不使用.
    * @return 成功返回SpeechTranscriberRequest对象，否则返回NULL
    */
@@ -144,6 +166,7 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    * @param version tts类型
    * @param sdkName SDK的命名, 涉及到运行平台和代码语言
    * @param isLongConnection 是否启用长链接, 即stop后可继续start.
+   * 启用预连接池时, 长链接请求自行建链而不经过预连接池.
    * 但是此模式容易因为长时间未操作被服务端超时断链, 请谨慎使用或尽量不使用.
    * @return 成功则SpeechSynthesizerRequest对象，否则返回NULL
    */
@@ -163,6 +186,7 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    * @param version  dialogAssistant类型
    * @param sdkName SDK的命名, 涉及到运行平台和代码语言
    * @param isLongConnection 是否启用长链接, 即stop后可继续start.
+   * 启用预连接池时, 长链接请求自行建链而不经过预连接池.
    * 但是此模式容易因为长时间未操作被服务端超时断链, 请谨慎使用或尽量不使用.
    * @return 成功则DialogAssistantRequest对象，否则返回NULL
    */
@@ -181,6 +205,7 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    * @brief 创建流式文本输入语音合成对象
    * @param sdkName SDK的命名, 涉及到运行平台和代码语言
    * @param isLongConnection 是否启用长链接, 即stop后可继续start.
+   * 启用预连接池时, 长链接请求自行建链而不经过预连接池.
    * 但是此模式容易因为长时间未操作被服务端超时断链, 请谨慎使用或尽量不使用.
    * @return 成功则FlowingSynthesizerRequest对象，否则返回NULL
    */
@@ -198,6 +223,7 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    * @brief 创建流式文本输入语音合成对象
    * @param sdkName SDK的命名, 涉及到运行平台和代码语言
    * @param isLongConnection 是否启用长链接, 即stop后可继续start.
+   * 启用预连接池时, 长链接请求自行建链而不经过预连接池.
    * 但是此模式容易因为长时间未操作被服务端超时断链, 请谨慎使用或尽量不使用.
    * @return 成功则FlowingSynthesizerRequest对象，否则返回NULL
    */
@@ -241,6 +267,8 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    *        若调用则需要在startWorkThread之前.
    *        存在部分设备在设置了dns后仍然无法通过SDK的dns获取可用的IP,
    *        可调用此接口启用系统的getaddrinfo来解决这个问题.
+   *        启用后由固定数量的解析线程执行getaddrinfo,
+   *        同时发起的相同域名解析会合并为一次查询.
    * @param enable 建议使用更加高效的libevent域名解析, 即默认false
    * @return
    */
@@ -256,9 +284,36 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
    */
   void setSyncCallTimeout(unsigned int timeoutMs);
 
+  /**
+   * @brief 设置所有请求建连时默认的socket参数, 如TCP_NODELAY/SO_SNDBUF/
+   *        SO_RCVBUF/TCP_USER_TIMEOUT/TCP_NOTSENT_LOWAT/SO_BUSY_POLL,
+   *        详见nlsGlobal.h中的NlsSocketOptions. 默认均不设置.
+   * @note 对之后新建的连接生效, 包括预连接池中的连接.
+   *       请求可通过各request的setSocketOptions覆盖此设置.
+   *       参数设置失败仅打印告警, 不影响建连.
+   * @param options socket参数
+   * @return
+   */
+  void setSocketOptions(const NlsSocketOptions& options);
+
+  /**
+   * @brief 设置WebSocket permessage-deflate压缩所用zlib流的进程级内存上限,
+   *        默认32MB. 每个协商成功的连接在存活期间占用约40KB.
+   * @note 超出上限时新连接不协商压缩, 按原样收发, 并计入
+   *       nls_ws_deflate_skipped指标. 未开启ENABLE_WS_DEFLATE编译时无效.
+   *       请求需通过各request的setEnableWsDeflate开启压缩.
+   * @param limitBytes 内存上限, 单位字节
+   * @return
+   */
+  void setWsDeflateMemoryLimit(unsigned int limitBytes);
+
   /**
    * @brief 设置每个域名URL的预连接池, 用于降低每次发起请求前的连接时间.
-   * 此设置会关闭已经设置的长链接模式. 如果听悟场景, 请尽量不要使用此模式.
+   * 长链接模式的请求(isLongConnection为true)不从预连接池获取链接,
+   * 交互结束后也不归还至预连接池, 而是自行建链并在多轮交互间保持链接.
+   * 如果听悟场景, 请尽量不要使用此模式.
+   * 支持所有交互类型, 包括语音助手和百炼Paraformer/Fun-ASR/CosyVoice,
+   * 百炼交互的预连接以APIKey和自定义HTTP头区分.
    * @param maxNumber 默认0表示不启用预连接池. 大于0即启用预连接池,
    * 可有效降低首包延迟.
    * @param timeoutMs 预连接池中每个链接超时时间, 单位毫秒,
@@ -273,6 +328,61 @@ class NLS_SDK_CLIENT_EXPORT NlsClient {
                            unsigned int timeoutMs = 18000,
                            unsigned int requestTimeoutMs = 7000);
 
+  /**
+   * @brief 启用预连接池的自动扩缩容, 需要同时调用setPreconnectedPool启用预连接池.
+   * 按每类交互获取预连接的频率和未命中率(EWMA)调整预连接数量,
+   * 未命中率高于目标时扩容, 空闲预连接富余时逐步缩容.
+   * @param minNumber 每类交互最少保留的预连接数量
+   * @param maxNumber 每类交互最多保留的预连接数量.
+   * 预连接池启动后再调用时, 已分配槽位的交互类型不会扩容,
+   * 其上限不超过首次分配时的槽位数
+   * @param targetHitRatio 目标命中率, 范围(0, 1], 默认0.9
+   * @return 成功则返回0; 失败返回负值, 详见NlsRetCode
+   */
+  int setPreconnectedPoolAutoScale(unsigned int minNumber,
+                                   unsigned int maxNumber,
+                                   float targetHitRatio = 0.9f);
+
+  /**
+   * @brief 获取预连接池当前状态, 包括每类交互的生效数量/获取频率/命中率/扩缩容决策
+   * @param info Json格式的预连接池状态
+   * @return 成功则返回0; 失败返回负值, 详见NlsRetCode
+   */
+  int dumpPreconnectedPoolInfo(std::string& info);
+
+  /**
+   * @brief 获取SDK进程级指标快照, 包括建连/握手/Started/首个结果/首包音频耗时分布,
+   *        回调耗时, 发送缓存深度, 预连接池命中与未命中, 收发字节数等
+   * @param snapshot 指标快照
+   * @param openMetrics false: Json格式, 耗时单位为微秒;
+   *                    true: OpenMetrics(Prometheus)文本格式, 耗时单位为秒
+   * @return 成功则返回0; 失败返回负值, 详见NlsRetCode
+   */
+  int getMetricsSnapshot(std::string& snapshot, bool openMetrics = false);
+
+  /**
+   * @brief 设置事件循环卡顿检测. 每个WorkThread以100ms周期的心跳定时器
+   *        度量调度延迟, 延迟超过阈值时在该WorkThread内触发回调,
+   *        并带上一周期内耗时最长的事件回调名称及耗时
+   * @param thresholdMs 调度延迟阈值, 单位毫秒, 0表示关闭回调
+   * @param callback 卡顿回调, 需尽快返回, 不可在其中调用SDK接口
+   * @param userParam 用户自定义参数, 透传给回调
+   * @return 成功则返回0; 失败返回负值, 详见NlsRetCode
+   */
+  int setEventLoopWatchdog(unsigned int thresholdMs,
+                           EventLoopStallCallback callback,
+                           void* userParam = NULL);
+
+  /**
+   * @brief 设置tracing钩子, 每个请求结束时产生start/connect/handshake/started/
+   *        sendAudio/stop/request等span, 详见nlsTrace.h
+   * @note 未设置时不产生span. tracer由调用方管理, 需在releaseInstance或
+   *       setTracer(NULL)之后才可释放
+   * @param tracer 自定义tracer, 或NlsInMemoryTracer; NULL表示关闭
+   * @return 成功则返回0; 失败返回负值, 详见NlsRetCode
+   */
+  int setTracer(NlsTracer* tracer);
+
   /**
    * @brief 待合成音频文本内容字符数
    * @note 必选参数，需要传入UTF-8编码的文本内容
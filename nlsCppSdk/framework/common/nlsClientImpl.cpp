@@ -25,6 +25,8 @@
 #include "nlog.h"
 #include "nlsClientImpl.h"
 #include "nlsEventNetWork.h"
+#include "nlsMetrics.h"
+#include "nlsTracing.h"
 #include "sr/speechRecognizerRequest.h"
 #include "st/dashFunAsrTranscriberRequest.h"
 #include "st/dashParaformerTranscriberRequest.h"
@@ -32,6 +34,7 @@
 #include "sy/speechSynthesizerRequest.h"
 #include "text_utils.h"
 #include "utility.h"
+#include "workThread.h"
 
 #ifdef ENABLE_VIPSERVER
 //引入VipClientApi相关的头文件
@@ -53,16 +56,19 @@ pthread_mutex_t _mtx = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
 NlsClientImpl::NlsClientImpl(bool sslInitial)
-    : _nodeManager(NULL),
-      _aiFamily(),
+    : _aiFamily(),
       _directHostIp(),
       _enableSysGetAddr(false),
+      _syncCallTimeoutMs(0),
 #ifdef ENABLE_PRECONNECTED_POOL
       _maxPreconnectedNumber(0),
       _preconnectedTimeoutMs(15000),
       _prerequestedTimeoutMs(75000),
+      _minScaleNumber(0),
+      _maxScaleNumber(0),
+      _targetHitRatio(0.0),
 #endif
-      _syncCallTimeoutMs(0) {
+      _nodeManager(NULL) {
   strncpy(_aiFamily, "AF_INET", 16);
 
   // init openssl
@@ -108,6 +114,7 @@ void NlsClientImpl::releaseInstanceImpl() {
     }
     _isInitializeThread = false;
   }
+  utility::NlsTracing::setTracer(NULL);
 
   if (_isInitializeSSL) {
     SSLconnect::destroy();
@@ -156,6 +163,25 @@ void NlsClientImpl::setSyncCallTimeoutImpl(unsigned int timeout_ms) {
   _syncCallTimeoutMs = timeout_ms;
 }
 
+void NlsClientImpl::setSocketOptionsImpl(const NlsSocketOptions &options) {
+  _socketOptions = options;
+  LOG_INFO(
+      "Set socket options -> nodelay(%d) sndbuf(%d) rcvbuf(%d) "
+      "user_timeout(%ums) notsent_lowat(%u) busy_poll(%uus).",
+      options.tcp_nodelay, options.send_buffer_bytes,
+      options.recv_buffer_bytes, options.user_timeout_ms,
+      options.notsent_lowat_bytes, options.busy_poll_us);
+}
+
+void NlsClientImpl::setWsDeflateMemoryLimitImpl(unsigned int limitBytes) {
+#ifdef ENABLE_WS_DEFLATE
+  WsDeflatePool::setMemoryLimit(limitBytes);
+#else
+  LOG_WARN("permessage-deflate is not compiled in, ignore memory limit %u.",
+           limitBytes);
+#endif
+}
+
 #ifdef ENABLE_PRECONNECTED_POOL
 void NlsClientImpl::setPreconnectedPool(unsigned int maxNumber,
                                         unsigned int timeoutMs,
@@ -170,6 +196,42 @@ void NlsClientImpl::setPreconnectedPool(unsigned int maxNumber,
       _maxPreconnectedNumber, maxNumber, _preconnectedTimeoutMs, timeoutMs,
       _prerequestedTimeoutMs, requestTimeoutMs);
 }
+
+int NlsClientImpl::setPreconnectedPoolAutoScaleImpl(unsigned int minNumber,
+                                                    unsigned int maxNumber,
+                                                    float targetHitRatio) {
+  if (maxNumber == 0 || minNumber > maxNumber || targetHitRatio <= 0.0 ||
+      targetHitRatio > 1.0) {
+    LOG_ERROR(
+        "Set Preconnected pool auto scale with invalid parameters -> "
+        "min_num(%u), max_num(%u), target_hit_ratio(%f)",
+        minNumber, maxNumber, targetHitRatio);
+    return -(InvalidInputParam);
+  }
+
+  _minScaleNumber = minNumber;
+  _maxScaleNumber = maxNumber;
+  _targetHitRatio = targetHitRatio;
+  LOG_INFO(
+      "Set Preconnected pool auto scale parameters -> min_num(%u), "
+      "max_num(%u), target_hit_ratio(%f)",
+      _minScaleNumber, _maxScaleNumber, _targetHitRatio);
+
+  /* 预连接池已启动, 则立即生效, 已分配槽位的交互类型上限不超过已分配槽位数 */
+  if (_isInitializeThread && NlsEventNetWork::_eventClient &&
+      NlsEventNetWork::_eventClient->getPreconnectedPool()) {
+    return NlsEventNetWork::_eventClient->setPreconnectedPoolAutoScale(
+        _minScaleNumber, _maxScaleNumber, _targetHitRatio);
+  }
+  return Success;
+}
+
+int NlsClientImpl::dumpPreconnectedPoolInfoImpl(std::string &info) {
+  if (NlsEventNetWork::_eventClient == NULL) {
+    return -(EventClientEmpty);
+  }
+  return NlsEventNetWork::_eventClient->dumpPreconnectedPoolInfo(info);
+}
 #endif
 
 void NlsClientImpl::setDirectHostImpl(const char *ip) {
@@ -194,6 +256,10 @@ void NlsClientImpl::startWorkThreadImpl(int threadsNumber) {
       NlsEventNetWork::_eventClient->initPreconnectedPool(
           _maxPreconnectedNumber, _preconnectedTimeoutMs,
           _prerequestedTimeoutMs);
+      if (_maxScaleNumber > 0) {
+        NlsEventNetWork::_eventClient->setPreconnectedPoolAutoScale(
+            _minScaleNumber, _maxScaleNumber, _targetHitRatio);
+      }
     }
 #endif
   }
@@ -217,6 +283,36 @@ int NlsClientImpl::setLogConfigImpl(const char *logOutputFile,
   return Success;
 }
 
+int NlsClientImpl::setAsyncLogConfigImpl(bool enable, unsigned int ringSize) {
+  utility::NlsLog::getInstance()->setAsyncMode(enable, ringSize);
+  return Success;
+}
+
+int NlsClientImpl::getMetricsSnapshotImpl(std::string &snapshot,
+                                          bool openMetrics) {
+  if (openMetrics) {
+    snapshot = utility::NlsMetrics::dumpOpenMetrics();
+  } else {
+    snapshot = utility::NlsMetrics::dumpSnapshot();
+  }
+  return Success;
+}
+
+int NlsClientImpl::setEventLoopWatchdogImpl(unsigned int thresholdMs,
+                                            EventLoopStallCallback callback,
+                                            void *userParam) {
+  if (thresholdMs > 0 && callback == NULL) {
+    return -(InvalidInputParam);
+  }
+  WorkThread::setEventLoopWatchdog(thresholdMs, callback, userParam);
+  return Success;
+}
+
+int NlsClientImpl::setTracerImpl(NlsTracer *tracer) {
+  utility::NlsTracing::setTracer(tracer);
+  return Success;
+}
+
 SpeechRecognizerRequest *NlsClientImpl::createRecognizerRequestImpl(
     const char *sdkName, bool isLongConnection) {
   SpeechRecognizerRequest *request =
@@ -43,13 +43,26 @@ class NlsClientImpl {
                        unsigned int logFileSize = 10,
                        unsigned int logFileNum = 10,
                        LogCallbackMethod logCallback = NULL);
+  int setAsyncLogConfigImpl(bool enable, unsigned int ringSize);
+  int getMetricsSnapshotImpl(std::string& snapshot, bool openMetrics);
+  int setEventLoopWatchdogImpl(unsigned int thresholdMs,
+                               EventLoopStallCallback callback,
+                               void* userParam);
+  int setTracerImpl(NlsTracer* tracer);
   void setAddrInFamilyImpl(const char* aiFamily = "AF_INET");
   void setDirectHostImpl(const char* ip);
   void setUseSysGetAddrInfoImpl(bool enable);
   void setSyncCallTimeoutImpl(unsigned int timeout_ms);
+  void setSocketOptionsImpl(const NlsSocketOptions& options);
+  inline NlsSocketOptions getSocketOptions() { return _socketOptions; }
+  void setWsDeflateMemoryLimitImpl(unsigned int limitBytes);
 #ifdef ENABLE_PRECONNECTED_POOL
   void setPreconnectedPool(unsigned int maxNumber, unsigned int timeoutMs,
                            unsigned requestTimeoutMs);
+  int setPreconnectedPoolAutoScaleImpl(unsigned int minNumber,
+                                       unsigned int maxNumber,
+                                       float targetHitRatio);
+  int dumpPreconnectedPoolInfoImpl(std::string& info);
 #endif
 
   SpeechRecognizerRequest* createRecognizerRequestImpl(
@@ -109,10 +122,14 @@ class NlsClientImpl {
   char _directHostIp[64];
   bool _enableSysGetAddr;
   unsigned int _syncCallTimeoutMs;
+  NlsSocketOptions _socketOptions; /* 所有请求默认的socket参数 */
 #ifdef ENABLE_PRECONNECTED_POOL
   unsigned int _maxPreconnectedNumber;
   unsigned int _preconnectedTimeoutMs;
   unsigned int _prerequestedTimeoutMs;
+  unsigned int _minScaleNumber;
+  unsigned int _maxScaleNumber;
+  float _targetHitRatio;
 #endif
 
 #if defined(__linux__)
@@ -52,7 +52,8 @@ NlsEvent::NlsEvent()
       _stashResultCurrentTime(0),
       _usage(0),
       _nlsType(TypeNone),
-      _serviceProtocol(WsServiceProtocolNls) {}
+      _serviceProtocol(WsServiceProtocolNls),
+      _requestTimeline() {}
 
 NlsEvent::NlsEvent(NlsType nlsType, NlsServiceProtocol serviceProtocol)
     : _statusCode(0),
@@ -79,7 +80,8 @@ NlsEvent::NlsEvent(NlsType nlsType, NlsServiceProtocol serviceProtocol)
       _stashResultCurrentTime(0),
       _usage(0),
       _nlsType(nlsType),
-      _serviceProtocol(serviceProtocol) {}
+      _serviceProtocol(serviceProtocol),
+      _requestTimeline() {}
 
 NlsEvent::NlsEvent(const NlsEvent& ne) {
   this->_statusCode = ne._statusCode;
@@ -114,6 +116,7 @@ NlsEvent::NlsEvent(const NlsEvent& ne) {
 
   this->_nlsType = ne._nlsType;
   this->_serviceProtocol = ne._serviceProtocol;
+  this->_requestTimeline = ne._requestTimeline;
 }
 
 NlsEvent::NlsEvent(const char* msg, int code, EventType type,
@@ -143,7 +146,8 @@ NlsEvent::NlsEvent(const char* msg, int code, EventType type,
       _stashResultCurrentTime(0),
       _usage(0),
       _nlsType(nlsType),
-      _serviceProtocol(serviceProtocol) {}
+      _serviceProtocol(serviceProtocol),
+      _requestTimeline() {}
 
 NlsEvent::NlsEvent(const std::string& msg, NlsType nlsType,
                    NlsServiceProtocol serviceProtocol)
@@ -171,7 +175,8 @@ NlsEvent::NlsEvent(const std::string& msg, NlsType nlsType,
       _stashResultCurrentTime(0),
       _usage(0),
       _nlsType(nlsType),
-      _serviceProtocol(serviceProtocol) {}
+      _serviceProtocol(serviceProtocol),
+      _requestTimeline() {}
 
 NlsEvent::NlsEvent(const std::vector<unsigned char>& data, int code,
                    EventType type, const std::string& taskId, NlsType nlsType,
@@ -201,7 +206,8 @@ NlsEvent::NlsEvent(const std::vector<unsigned char>& data, int code,
       _stashResultCurrentTime(0),
       _usage(0),
       _nlsType(nlsType),
-      _serviceProtocol(serviceProtocol) {
+      _serviceProtocol(serviceProtocol),
+      _requestTimeline() {
   // LOG_DEBUG("Binary data event:%d.", data.size());
 }
 
@@ -233,7 +239,8 @@ NlsEvent::NlsEvent(unsigned char* data, int dataBytes, int code, EventType type,
       _stashResultCurrentTime(0),
       _usage(0),
       _nlsType(nlsType),
-      _serviceProtocol(serviceProtocol) {}
+      _serviceProtocol(serviceProtocol),
+      _requestTimeline() {}
 
 NlsEvent::~NlsEvent() {
   if (_binaryDataInChar) {
@@ -338,6 +345,9 @@ std::string NlsEvent::getMsgTypeString(int type) {
     case SentenceSynthesis:
       ret_str.assign("SentenceSynthesis");
       break;
+    case AudioWritable:
+      ret_str.assign("AudioWritable");
+      break;
   }
 
   return ret_str;
@@ -472,4 +482,8 @@ const char* NlsEvent::getStashResultText() {
 
 int NlsEvent::getUsage() { return _usage; }
 
+const NlsRequestTimeline* NlsEvent::getRequestTimeline() {
+  return &_requestTimeline;
+}
+
 }  // namespace AlibabaNls
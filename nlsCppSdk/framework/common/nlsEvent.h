@@ -32,6 +32,7 @@ typedef struct {
 } WordInfomation;
 
 class NlsEventImpl;
+class ConnectNode;
 class NLS_SDK_CLIENT_EXPORT NlsEvent {
  public:
   enum EventType {
@@ -54,6 +55,7 @@ class NLS_SDK_CLIENT_EXPORT NlsEvent {
     Close = 16, /*语音功能通道连接关闭*/
     Message,
     SentenceSynthesis,
+    AudioWritable, /* 音频发送缓冲区降至低水位, 可继续sendAudio */
 
     /* DashScope -> */
     TaskStarted = 30,
@@ -62,6 +64,7 @@ class NLS_SDK_CLIENT_EXPORT NlsEvent {
   };
 
   friend class NlsEventInner;
+  friend class ConnectNode;
 
   NlsEvent();
 
@@ -283,6 +286,13 @@ class NLS_SDK_CLIENT_EXPORT NlsEvent {
 
   int getUsage();
 
+  /**
+   * @brief 获取本次请求各阶段的时间线(单调时钟, 微秒)
+   * @note 仅在Close(onChannelClosed)和TaskFailed事件中有效, 其他事件均为0
+   * @return const NlsRequestTimeline*
+   */
+  const NlsRequestTimeline* getRequestTimeline();
+
  private:
   int _statusCode;
   std::string _msg;
@@ -315,6 +325,8 @@ class NLS_SDK_CLIENT_EXPORT NlsEvent {
 
   NlsType _nlsType;
   NlsServiceProtocol _serviceProtocol;
+
+  NlsRequestTimeline _requestTimeline;
 };
 
 typedef void (*NlsCallbackMethod)(NlsEvent*, void*);
@@ -127,6 +127,7 @@ enum NlsRetCode {
   InvalidWsFrameBody,        /* 无效的websocket帧本体 */
   WsFrameBodyEmpty,          /* 帧数据为空, 常见为收到了脏数据 */
   InvalidWsFrameCloseCode,   /* 帧数据收到异常CLOSE_CODE */
+  WsInflateFailed,           /* permessage-deflate消息解压失败 */
 
   /* connect node */
   NodeEmpty = 400,   /* node为空指针 */
@@ -544,6 +545,52 @@ enum NlsRequestStatus {
       21, /* 长链接模式下的request已经被断链, 此状态需要主动释放此request */
 };
 
+/*
+ * 单次请求各阶段的时间线, 单调时钟, 单位微秒, 0表示该阶段未发生.
+ * 时间点只用于相减计算各阶段耗时, 与系统时间无关.
+ * 建连失败重试时, dns/connect/ssl/ws各阶段记录最后一次尝试.
+ */
+struct NlsRequestTimeline {
+  unsigned long long start_us;         /* 调用start */
+  unsigned long long dns_begin_us;     /* 开始dns解析 */
+  unsigned long long dns_end_us;       /* dns解析完成 */
+  unsigned long long connect_begin_us; /* 开始TCP建连 */
+  unsigned long long connect_end_us;   /* TCP建连成功 */
+  unsigned long long ssl_begin_us;     /* 开始SSL握手 */
+  unsigned long long ssl_end_us;       /* SSL握手完成 */
+  unsigned long long ws_request_us;    /* 生成WebSocket升级请求 */
+  unsigned long long ws_response_us;   /* 收到WebSocket升级响应 */
+  unsigned long long first_send_us;    /* 握手后首次发送数据 */
+  unsigned long long started_us;       /* 收到Started事件 */
+  unsigned long long first_result_us;  /* 收到首个识别结果 */
+  unsigned long long first_binary_us;  /* 收到首包音频 */
+  unsigned long long stop_us;          /* 调用stop */
+  unsigned long long completed_us;     /* 收到Completed事件 */
+  unsigned long long closed_us;        /* 触发Close回调 */
+};
+
+/*
+ * 建连时为socket设置的内核参数, 数值为0表示不设置, 沿用系统默认值.
+ * 实时识别建议开启tcp_nodelay, 避免20ms左右的小包被Nagle算法合并延迟发送.
+ * 仅Linux支持的参数在其他平台忽略.
+ */
+struct NlsSocketOptions {
+  bool tcp_nodelay;                 /* TCP_NODELAY, 关闭Nagle算法 */
+  int send_buffer_bytes;            /* SO_SNDBUF */
+  int recv_buffer_bytes;            /* SO_RCVBUF */
+  unsigned int user_timeout_ms;     /* TCP_USER_TIMEOUT, 仅Linux */
+  unsigned int notsent_lowat_bytes; /* TCP_NOTSENT_LOWAT, Linux/macOS */
+  unsigned int busy_poll_us;        /* SO_BUSY_POLL, 仅Linux */
+
+  NlsSocketOptions()
+      : tcp_nodelay(false),
+        send_buffer_bytes(0),
+        recv_buffer_bytes(0),
+        user_timeout_ms(0),
+        notsent_lowat_bytes(0),
+        busy_poll_us(0) {}
+};
+
 enum NlsServiceProtocol {
   WsServiceProtocolNls = 0,   /* 默认使用 智能语音交互(NLS) */
   WsServiceProtocolDashScope, /* 百炼大模型语音交互(DashScope) */
@@ -23,6 +23,7 @@ namespace AlibabaNls {
 #define D_DEFAULT_RECV_TIMEOUT_MS 15000
 #define D_DEFAULT_SEND_TIMEOUT_MS 5000
 #define D_DEFAULT_CONNECTION_TIMEOUT_MS 500
+#define D_DEFAULT_CONTINUED_REPLAY_MS 10000
 #define D_DEFAULT_URL "wss://nls-gateway.cn-shanghai.aliyuncs.com/ws/v1"
 #define D_DASHSCOPE_DEFAULT_URL \
   "wss://dashscope.aliyuncs.com/api-ws/v1/inference"
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nlsTrace.h"
+
+#include <string.h>
+
+#include "utility.h"
+
+namespace AlibabaNls {
+
+NlsInMemoryTracer::NlsInMemoryTracer(unsigned int maxSpans)
+    : _maxSpans(maxSpans), _droppedCount(0) {
+#if defined(_MSC_VER)
+  _mtxSpans = CreateMutex(NULL, FALSE, NULL);
+#else
+  pthread_mutex_init(&_mtxSpans, NULL);
+#endif
+}
+
+NlsInMemoryTracer::~NlsInMemoryTracer() {
+#if defined(_MSC_VER)
+  CloseHandle(_mtxSpans);
+#else
+  pthread_mutex_destroy(&_mtxSpans);
+#endif
+}
+
+void NlsInMemoryTracer::onSpanEnd(const NlsTraceSpan &span) {
+  MUTEX_LOCK(_mtxSpans);
+  if (_spans.size() < _maxSpans) {
+    _spans.push_back(span);
+  } else {
+    _droppedCount++;
+  }
+  MUTEX_UNLOCK(_mtxSpans);
+}
+
+std::vector<NlsTraceSpan> NlsInMemoryTracer::getSpans(const char *taskId) {
+  std::vector<NlsTraceSpan> spans;
+  MUTEX_LOCK(_mtxSpans);
+  if (taskId == NULL || strlen(taskId) == 0) {
+    spans = _spans;
+  } else {
+    std::vector<NlsTraceSpan>::iterator it = _spans.begin();
+    for (; it != _spans.end(); ++it) {
+      if (it->task_id == taskId) {
+        spans.push_back(*it);
+      }
+    }
+  }
+  MUTEX_UNLOCK(_mtxSpans);
+  return spans;
+}
+
+unsigned long long NlsInMemoryTracer::getDroppedCount() {
+  MUTEX_LOCK(_mtxSpans);
+  unsigned long long count = _droppedCount;
+  MUTEX_UNLOCK(_mtxSpans);
+  return count;
+}
+
+void NlsInMemoryTracer::clear() {
+  MUTEX_LOCK(_mtxSpans);
+  _spans.clear();
+  _droppedCount = 0;
+  MUTEX_UNLOCK(_mtxSpans);
+}
+
+}  // namespace AlibabaNls
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NLS_SDK_TRACE_H
+#define NLS_SDK_TRACE_H
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+#include <string>
+#include <vector>
+
+#include "nlsGlobal.h"
+
+namespace AlibabaNls {
+
+/**
+ * @brief 一次请求生命周期中的span, 字段与OpenTelemetry Span对应.
+ *        每个请求产生以下span, 均挂在名为request的根span下:
+ *        start(调用start到收到Started), connect(DNS及TCP建连),
+ *        handshake(SSL及WebSocket握手), started(发送start指令到收到Started),
+ *        sendAudio(每批sendAudio调用), stop(调用stop到收到完成事件),
+ *        request(调用start到Close, 即completion).
+ *        父trace上下文通过请求参数AppendHttpHeaderParam("traceparent", ...)
+ *        以W3C Trace Context格式传入, 同时会随WebSocket请求头发往服务端.
+ */
+struct NlsTraceSpan {
+  std::string name;
+  std::string trace_id;       /* 32位十六进制 */
+  std::string span_id;        /* 16位十六进制 */
+  std::string parent_span_id; /* 根span为调用方传入的父span, 可为空 */
+  unsigned long long start_unix_us;
+  unsigned long long end_unix_us;
+  std::string task_id;
+  std::string node_uuid;
+  int status_code;             /* 0为成功, 否则为失败时的错误码 */
+  unsigned int audio_count;    /* sendAudio批次内的调用次数 */
+  unsigned long long audio_bytes; /* sendAudio批次内的音频字节数 */
+};
+
+/**
+ * @brief tracing钩子, 默认实现不做任何处理.
+ *        span结束时在SDK内部线程中同步调用, 需尽快返回且不可调用SDK接口.
+ */
+class NLS_SDK_CLIENT_EXPORT NlsTracer {
+ public:
+  virtual ~NlsTracer() {}
+  virtual void onSpanEnd(const NlsTraceSpan& /*span*/) {}
+};
+
+/**
+ * @brief 将span保存在内存中的tracer, 用于测试及调试
+ */
+class NLS_SDK_CLIENT_EXPORT NlsInMemoryTracer : public NlsTracer {
+ public:
+  /**
+   * @param maxSpans 最多保存的span数量, 超出后丢弃新的span
+   */
+  explicit NlsInMemoryTracer(unsigned int maxSpans = 10000);
+  ~NlsInMemoryTracer();
+
+  void onSpanEnd(const NlsTraceSpan& span);
+
+  /**
+   * @brief 获取已保存span的拷贝
+   * @param taskId 非空时只返回此task_id的span
+   */
+  std::vector<NlsTraceSpan> getSpans(const char* taskId = NULL);
+  unsigned long long getDroppedCount();
+  void clear();
+
+ private:
+#ifdef _MSC_VER
+  HANDLE _mtxSpans;
+#else
+  pthread_mutex_t _mtxSpans;
+#endif
+  std::vector<NlsTraceSpan> _spans;
+  unsigned int _maxSpans;
+  unsigned long long _droppedCount;
+};
+
+}  // namespace AlibabaNls
+
+#endif  // NLS_SDK_TRACE_H
@@ -70,6 +70,9 @@ void DialogAssistantListener::handlerFrame(NlsEvent& str) {
             &str, _callback->_paramap[NlsEvent::WakeWordVerificationCompleted]);
       }
       break;
+    case NlsEvent::AudioWritable:
+      /* 未提供可写回调, 忽略 */
+      break;
     default:
       if (NULL != _callback->_onTaskFailed) {
         _callback->_onTaskFailed(&str,
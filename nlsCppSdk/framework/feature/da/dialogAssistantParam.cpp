@@ -32,7 +32,7 @@ namespace AlibabaNls {
 #define D_NAMESPACE_RECOGNITION_V2 "DialogAssistant.v2"
 
 DialogAssistantParam::DialogAssistantParam(int version, const char* sdkName)
-    : INlsRequestParam(TypeDialog, sdkName) {
+    : INlsRequestParam(TypeDialog, sdkName, version) {
   if (version == 0) {
     _header[D_NAMESPACE] = D_NAMESPACE_RECOGNITION;
   } else {
@@ -207,6 +207,10 @@ NlsRequestStatus DialogAssistantRequest::getRequestStatus() {
   return INlsRequest::getRequestStatus(this);
 }
 
+int DialogAssistantRequest::getRequestTimeline(NlsRequestTimeline* timeline) {
+  return INlsRequest::getRequestTimeline(this, timeline);
+}
+
 int DialogAssistantRequest::setPayloadParam(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_dialogAssistantParam);
@@ -277,6 +281,18 @@ int DialogAssistantRequest::setSendTimeout(int value) {
   return 0;
 }
 
+int DialogAssistantRequest::setSocketOptions(const NlsSocketOptions& options) {
+  INPUT_REQUEST_PARAM_CHECK(_dialogAssistantParam);
+  _dialogAssistantParam->setSocketOptions(options);
+  return 0;
+}
+
+int DialogAssistantRequest::setEnableWsDeflate(bool enable) {
+  INPUT_REQUEST_PARAM_CHECK(_dialogAssistantParam);
+  _dialogAssistantParam->setEnableWsDeflate(enable);
+  return 0;
+}
+
 int DialogAssistantRequest::setOutputFormat(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_dialogAssistantParam);
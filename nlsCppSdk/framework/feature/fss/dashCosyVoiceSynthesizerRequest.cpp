@@ -211,6 +211,11 @@ NlsRequestStatus DashCosyVoiceSynthesizerRequest::getRequestStatus() {
   return INlsRequest::getRequestStatus(this);
 }
 
+int DashCosyVoiceSynthesizerRequest::getRequestTimeline(
+    NlsRequestTimeline* timeline) {
+  return INlsRequest::getRequestTimeline(this, timeline);
+}
+
 int DashCosyVoiceSynthesizerRequest::setPayloadParam(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_flowingSynthesizerParam);
@@ -341,6 +346,18 @@ int DashCosyVoiceSynthesizerRequest::setSendTimeout(int value) {
   return Success;
 }
 
+int DashCosyVoiceSynthesizerRequest::setSocketOptions(const NlsSocketOptions& options) {
+  INPUT_REQUEST_PARAM_CHECK(_flowingSynthesizerParam);
+  _flowingSynthesizerParam->setSocketOptions(options);
+  return Success;
+}
+
+int DashCosyVoiceSynthesizerRequest::setEnableWsDeflate(bool enable) {
+  INPUT_REQUEST_PARAM_CHECK(_flowingSynthesizerParam);
+  _flowingSynthesizerParam->setEnableWsDeflate(enable);
+  return Success;
+}
+
 int DashCosyVoiceSynthesizerRequest::setOutputFormat(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_flowingSynthesizerParam);
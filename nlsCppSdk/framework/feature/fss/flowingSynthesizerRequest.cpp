@@ -215,6 +215,11 @@ NlsRequestStatus FlowingSynthesizerRequest::getRequestStatus() {
   return INlsRequest::getRequestStatus(this);
 }
 
+int FlowingSynthesizerRequest::getRequestTimeline(
+    NlsRequestTimeline* timeline) {
+  return INlsRequest::getRequestTimeline(this, timeline);
+}
+
 int FlowingSynthesizerRequest::setPayloadParam(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_flowingSynthesizerParam);
@@ -318,6 +323,18 @@ int FlowingSynthesizerRequest::setSendTimeout(int value) {
   return Success;
 }
 
+int FlowingSynthesizerRequest::setSocketOptions(const NlsSocketOptions& options) {
+  INPUT_REQUEST_PARAM_CHECK(_flowingSynthesizerParam);
+  _flowingSynthesizerParam->setSocketOptions(options);
+  return Success;
+}
+
+int FlowingSynthesizerRequest::setEnableWsDeflate(bool enable) {
+  INPUT_REQUEST_PARAM_CHECK(_flowingSynthesizerParam);
+  _flowingSynthesizerParam->setEnableWsDeflate(enable);
+  return Success;
+}
+
 int FlowingSynthesizerRequest::setOutputFormat(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_flowingSynthesizerParam);
@@ -189,6 +189,25 @@ class NLS_SDK_CLIENT_EXPORT FlowingSynthesizerRequest : public INlsRequest {
    */
   int setSendTimeout(int value);
 
+  /**
+   * @brief 设置本请求建连时的socket参数, 覆盖NlsClient::setSocketOptions
+   * @note 需在start之前调用, 详见nlsGlobal.h中的NlsSocketOptions
+   * @param options socket参数
+   * @return 成功则返回0，否则返回负值错误码
+   */
+  int setSocketOptions(const NlsSocketOptions& options);
+
+  /**
+   * @brief 设置是否在握手时协商WebSocket permessage-deflate压缩,
+   *        协商成功后服务端下发的识别结果/字幕等json消息以压缩形式传输.
+   * @note 需在start之前调用, 默认不开启. 使用预连接池时不协商压缩.
+   *       每个连接的压缩上下文常驻内存, 总量受
+   *       NlsClient::setWsDeflateMemoryLimit限制, 超出时按不压缩处理.
+   * @param enable 是否开启
+   * @return 成功则返回0，否则返回负值错误码
+   */
+  int setEnableWsDeflate(bool enable);
+
   /**
    * @brief 设置输出文本的编码格式
    * @note
@@ -330,6 +349,16 @@ class NLS_SDK_CLIENT_EXPORT FlowingSynthesizerRequest : public INlsRequest {
    */
   NlsRequestStatus getRequestStatus();
 
+  /**
+   * @brief 获得当前请求各阶段的时间线, 包括dns/建连/SSL握手/WebSocket握手/
+   *        首次发送/Started/首个结果/首包音频等时间点.
+   * @note 单调时钟, 单位微秒, 仅用于计算各阶段耗时.
+   *       请求结束后也可在onChannelClosed回调的NlsEvent中获取.
+   * @param timeline 输出的时间线
+   * @return 成功则返回0，否则返回负值错误码
+   */
+  int getRequestTimeline(NlsRequestTimeline* timeline);
+
   /**
    * @brief 设置错误回调函数
    * @note 在语音合成过程中出现错误时，sdk内部线程该回调上报.
@@ -48,6 +48,12 @@ void SpeechRecognizerListener::handlerFrame(NlsEvent& str) {
             &str, _callback->_paramap[NlsEvent::RecognitionResultChanged]);
       }
       break;
+    case NlsEvent::AudioWritable:
+      if (NULL != _callback->_onAudioWritable) {
+        _callback->_onAudioWritable(
+            &str, _callback->_paramap[NlsEvent::AudioWritable]);
+      }
+      break;
     case NlsEvent::Message:
       if (NULL != _callback->_onMessage) {
         _callback->_onMessage(&str, _callback->_paramap[NlsEvent::Message]);
@@ -32,6 +32,7 @@ SpeechRecognizerCallback::SpeechRecognizerCallback() {
   this->_onRecognitionResultChanged = NULL;
   this->_onChannelClosed = NULL;
   this->_onMessage = NULL;
+  this->_onAudioWritable = NULL;
 }
 
 SpeechRecognizerCallback::~SpeechRecognizerCallback() {
@@ -41,6 +42,7 @@ SpeechRecognizerCallback::~SpeechRecognizerCallback() {
   this->_onRecognitionResultChanged = NULL;
   this->_onChannelClosed = NULL;
   this->_onMessage = NULL;
+  this->_onAudioWritable = NULL;
 
   std::map<NlsEvent::EventType, void*>::iterator iter;
   for (iter = _paramap.begin(); iter != _paramap.end();) {
@@ -79,6 +81,16 @@ void SpeechRecognizerCallback::setOnMessage(NlsCallbackMethod event,
   }
 }
 
+void SpeechRecognizerCallback::setOnAudioWritable(NlsCallbackMethod event,
+                                                  void* param) {
+  this->_onAudioWritable = event;
+  if (this->_paramap.find(NlsEvent::AudioWritable) != _paramap.end()) {
+    _paramap[NlsEvent::AudioWritable] = param;
+  } else {
+    _paramap.insert(std::make_pair(NlsEvent::AudioWritable, param));
+  }
+}
+
 void SpeechRecognizerCallback::setOnRecognitionCompleted(
     NlsCallbackMethod event, void* param) {
   this->_onRecognitionCompleted = event;
@@ -164,6 +176,14 @@ NlsRequestStatus SpeechRecognizerRequest::getRequestStatus() {
   return INlsRequest::getRequestStatus(this);
 }
 
+int SpeechRecognizerRequest::getRequestTimeline(NlsRequestTimeline* timeline) {
+  return INlsRequest::getRequestTimeline(this, timeline);
+}
+
+int SpeechRecognizerRequest::getAudioCredit() {
+  return INlsRequest::getAudioCredit(this);
+}
+
 int SpeechRecognizerRequest::setPayloadParam(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_recognizerParam);
@@ -294,6 +314,18 @@ int SpeechRecognizerRequest::setSendTimeout(int value) {
   return Success;
 }
 
+int SpeechRecognizerRequest::setSocketOptions(const NlsSocketOptions& options) {
+  INPUT_REQUEST_PARAM_CHECK(_recognizerParam);
+  _recognizerParam->setSocketOptions(options);
+  return Success;
+}
+
+int SpeechRecognizerRequest::setEnableWsDeflate(bool enable) {
+  INPUT_REQUEST_PARAM_CHECK(_recognizerParam);
+  _recognizerParam->setEnableWsDeflate(enable);
+  return Success;
+}
+
 int SpeechRecognizerRequest::setOutputFormat(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_recognizerParam);
@@ -377,4 +409,9 @@ void SpeechRecognizerRequest::setOnMessage(NlsCallbackMethod event,
   _callback->setOnMessage(event, param);
 }
 
+void SpeechRecognizerRequest::setOnAudioWritable(NlsCallbackMethod event,
+                                                 void* param) {
+  _callback->setOnAudioWritable(event, param);
+}
+
 }  // namespace AlibabaNls
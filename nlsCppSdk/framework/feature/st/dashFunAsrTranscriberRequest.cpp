@@ -34,6 +34,7 @@ DashFunAsrTranscriberCallback::DashFunAsrTranscriberCallback() {
   this->_onTranscriptionCompleted = NULL;
   this->_onChannelClosed = NULL;
   this->_onMessage = NULL;
+  this->_onAudioWritable = NULL;
 }
 
 DashFunAsrTranscriberCallback::~DashFunAsrTranscriberCallback() {
@@ -45,6 +46,7 @@ DashFunAsrTranscriberCallback::~DashFunAsrTranscriberCallback() {
   this->_onTranscriptionCompleted = NULL;
   this->_onChannelClosed = NULL;
   this->_onMessage = NULL;
+  this->_onAudioWritable = NULL;
 
   std::map<NlsEvent::EventType, void*>::iterator iter;
   for (iter = _paramap.begin(); iter != _paramap.end();) {
@@ -130,6 +132,16 @@ void DashFunAsrTranscriberCallback::setOnMessage(NlsCallbackMethod _event,
   }
 }
 
+void DashFunAsrTranscriberCallback::setOnAudioWritable(NlsCallbackMethod _event,
+                                                       void* para) {
+  this->_onAudioWritable = _event;
+  if (this->_paramap.find(NlsEvent::AudioWritable) != _paramap.end()) {
+    _paramap[NlsEvent::AudioWritable] = para;
+  } else {
+    _paramap.insert(std::make_pair(NlsEvent::AudioWritable, para));
+  }
+}
+
 void DashFunAsrTranscriberCallback::setOnTranscriptionCompleted(
     NlsCallbackMethod _event, void* para) {
   // LOG_DEBUG("setOnTranscriptionCompleted callback");
@@ -207,6 +219,15 @@ NlsRequestStatus DashFunAsrTranscriberRequest::getRequestStatus() {
   return INlsRequest::getRequestStatus(this);
 }
 
+int DashFunAsrTranscriberRequest::getRequestTimeline(
+    NlsRequestTimeline* timeline) {
+  return INlsRequest::getRequestTimeline(this, timeline);
+}
+
+int DashFunAsrTranscriberRequest::getAudioCredit() {
+  return INlsRequest::getAudioCredit(this);
+}
+
 int DashFunAsrTranscriberRequest::setPayloadParam(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
@@ -307,6 +328,18 @@ int DashFunAsrTranscriberRequest::setSendTimeout(int value) {
   return Success;
 }
 
+int DashFunAsrTranscriberRequest::setSocketOptions(const NlsSocketOptions& options) {
+  INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
+  _transcriberParam->setSocketOptions(options);
+  return Success;
+}
+
+int DashFunAsrTranscriberRequest::setEnableWsDeflate(bool enable) {
+  INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
+  _transcriberParam->setEnableWsDeflate(enable);
+  return Success;
+}
+
 int DashFunAsrTranscriberRequest::setOutputFormat(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
@@ -397,4 +430,9 @@ void DashFunAsrTranscriberRequest::setOnMessage(NlsCallbackMethod _event,
   _callback->setOnMessage(_event, para);
 }
 
+void DashFunAsrTranscriberRequest::setOnAudioWritable(NlsCallbackMethod _event,
+                                                      void* para) {
+  _callback->setOnAudioWritable(_event, para);
+}
+
 }  // namespace AlibabaNls
@@ -39,6 +39,7 @@ class DashFunAsrTranscriberCallback {
   void setOnChannelClosed(NlsCallbackMethod _event, void* para = NULL);
   void setOnSentenceSemantics(NlsCallbackMethod _event, void* para);
   void setOnMessage(NlsCallbackMethod _event, void* para = NULL);
+  void setOnAudioWritable(NlsCallbackMethod _event, void* para = NULL);
 
   NlsCallbackMethod _onSentenceSemantics;
   NlsCallbackMethod _onTaskFailed;
@@ -49,6 +50,7 @@ class DashFunAsrTranscriberCallback {
   NlsCallbackMethod _onTranscriptionCompleted;
   NlsCallbackMethod _onChannelClosed;
   NlsCallbackMethod _onMessage;
+  NlsCallbackMethod _onAudioWritable;
   std::map<NlsEvent::EventType, void*> _paramap;
 };
 
@@ -190,6 +192,25 @@ class NLS_SDK_CLIENT_EXPORT DashFunAsrTranscriberRequest : public INlsRequest {
    */
   int setSendTimeout(int value);
 
+  /**
+   * @brief 设置本请求建连时的socket参数, 覆盖NlsClient::setSocketOptions
+   * @note 需在start之前调用, 详见nlsGlobal.h中的NlsSocketOptions
+   * @param options socket参数
+   * @return 成功则返回0，否则返回负值错误码
+   */
+  int setSocketOptions(const NlsSocketOptions& options);
+
+  /**
+   * @brief 设置是否在握手时协商WebSocket permessage-deflate压缩,
+   *        协商成功后服务端下发的识别结果/字幕等json消息以压缩形式传输.
+   * @note 需在start之前调用, 默认不开启. 使用预连接池时不协商压缩.
+   *       每个连接的压缩上下文常驻内存, 总量受
+   *       NlsClient::setWsDeflateMemoryLimit限制, 超出时按不压缩处理.
+   * @param enable 是否开启
+   * @return 成功则返回0，否则返回负值错误码
+   */
+  int setEnableWsDeflate(bool enable);
+
   /**
    * @brief 设置输出文本的编码格式
    * @note 暂不支持, 输出均为UTF-8
@@ -323,6 +344,24 @@ class NLS_SDK_CLIENT_EXPORT DashFunAsrTranscriberRequest : public INlsRequest {
    */
   NlsRequestStatus getRequestStatus();
 
+  /**
+   * @brief 获得当前请求各阶段的时间线, 包括dns/建连/SSL握手/WebSocket握手/
+   *        首次发送/Started/首个结果/首包音频等时间点.
+   * @note 单调时钟, 单位微秒, 仅用于计算各阶段耗时.
+   *       请求结束后也可在onChannelClosed回调的NlsEvent中获取.
+   * @param timeline 输出的时间线
+   * @return 成功则返回0，否则返回负值错误码
+   */
+  int getRequestTimeline(NlsRequestTimeline* timeline);
+
+  /**
+   * @brief 获得音频发送缓冲区剩余可写的字节数(编码封包后)
+   * @note 缓冲区上限约为6s音频, 返回0时sendAudio会返回EvbufferTooMuch,
+   *       此时可暂停采集或丢弃音频, 待onAudioWritable回调后再继续发送.
+   * @return 成功则返回剩余可写字节数，否则返回负值错误码
+   */
+  int getAudioCredit();
+
   /**
    * @brief 设置错误回调函数
    * @note 在请求过程中出现异常错误时，sdk内部线程上报该回调。
@@ -406,6 +445,16 @@ class NLS_SDK_CLIENT_EXPORT DashFunAsrTranscriberRequest : public INlsRequest {
    */
   void setOnMessage(NlsCallbackMethod _event, void* para = NULL);
 
+  /**
+   * @brief 设置音频发送缓冲区可写回调函数
+   * @note sendAudio返回EvbufferTooMuch或getAudioCredit返回0后,
+   *       发送缓冲区降至一半以下时, sdk内部线程上报一次该回调.
+   * @param _event 回调方法
+   * @param para 用户传入参数, 默认为NULL
+   * @return void
+   */
+  void setOnAudioWritable(NlsCallbackMethod _event, void* para = NULL);
+
  private:
   DashFunAsrTranscriberParam* _transcriberParam;
   DashFunAsrTranscriberCallback* _callback;
@@ -34,6 +34,7 @@ DashParaformerTranscriberCallback::DashParaformerTranscriberCallback() {
   this->_onTranscriptionCompleted = NULL;
   this->_onChannelClosed = NULL;
   this->_onMessage = NULL;
+  this->_onAudioWritable = NULL;
 }
 
 DashParaformerTranscriberCallback::~DashParaformerTranscriberCallback() {
@@ -45,6 +46,7 @@ DashParaformerTranscriberCallback::~DashParaformerTranscriberCallback() {
   this->_onTranscriptionCompleted = NULL;
   this->_onChannelClosed = NULL;
   this->_onMessage = NULL;
+  this->_onAudioWritable = NULL;
 
   std::map<NlsEvent::EventType, void*>::iterator iter;
   for (iter = _paramap.begin(); iter != _paramap.end();) {
@@ -130,6 +132,16 @@ void DashParaformerTranscriberCallback::setOnMessage(NlsCallbackMethod _event,
   }
 }
 
+void DashParaformerTranscriberCallback::setOnAudioWritable(
+    NlsCallbackMethod _event, void* para) {
+  this->_onAudioWritable = _event;
+  if (this->_paramap.find(NlsEvent::AudioWritable) != _paramap.end()) {
+    _paramap[NlsEvent::AudioWritable] = para;
+  } else {
+    _paramap.insert(std::make_pair(NlsEvent::AudioWritable, para));
+  }
+}
+
 void DashParaformerTranscriberCallback::setOnTranscriptionCompleted(
     NlsCallbackMethod _event, void* para) {
   // LOG_DEBUG("setOnTranscriptionCompleted callback");
@@ -211,6 +223,15 @@ NlsRequestStatus DashParaformerTranscriberRequest::getRequestStatus() {
   return INlsRequest::getRequestStatus(this);
 }
 
+int DashParaformerTranscriberRequest::getRequestTimeline(
+    NlsRequestTimeline* timeline) {
+  return INlsRequest::getRequestTimeline(this, timeline);
+}
+
+int DashParaformerTranscriberRequest::getAudioCredit() {
+  return INlsRequest::getAudioCredit(this);
+}
+
 int DashParaformerTranscriberRequest::setPayloadParam(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
@@ -342,6 +363,18 @@ int DashParaformerTranscriberRequest::setSendTimeout(int value) {
   return Success;
 }
 
+int DashParaformerTranscriberRequest::setSocketOptions(const NlsSocketOptions& options) {
+  INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
+  _transcriberParam->setSocketOptions(options);
+  return Success;
+}
+
+int DashParaformerTranscriberRequest::setEnableWsDeflate(bool enable) {
+  INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
+  _transcriberParam->setEnableWsDeflate(enable);
+  return Success;
+}
+
 int DashParaformerTranscriberRequest::setOutputFormat(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
@@ -432,4 +465,9 @@ void DashParaformerTranscriberRequest::setOnMessage(NlsCallbackMethod _event,
   _callback->setOnMessage(_event, para);
 }
 
+void DashParaformerTranscriberRequest::setOnAudioWritable(
+    NlsCallbackMethod _event, void* para) {
+  _callback->setOnAudioWritable(_event, para);
+}
+
 }  // namespace AlibabaNls
@@ -67,6 +67,12 @@ void SpeechTranscriberListener::handlerFrame(NlsEvent& str) {
             &str, _callback->_paramap[NlsEvent::TranscriptionCompleted]);
       }
       break;
+    case NlsEvent::AudioWritable:
+      if (NULL != _callback->_onAudioWritable) {
+        _callback->_onAudioWritable(
+            &str, _callback->_paramap[NlsEvent::AudioWritable]);
+      }
+      break;
     case NlsEvent::Message:
       if (NULL != _callback->_onMessage) {
         _callback->_onMessage(&str, _callback->_paramap[NlsEvent::Message]);
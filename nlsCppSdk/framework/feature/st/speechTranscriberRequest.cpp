@@ -34,6 +34,7 @@ SpeechTranscriberCallback::SpeechTranscriberCallback() {
   this->_onTranscriptionCompleted = NULL;
   this->_onChannelClosed = NULL;
   this->_onMessage = NULL;
+  this->_onAudioWritable = NULL;
 }
 
 SpeechTranscriberCallback::~SpeechTranscriberCallback() {
@@ -45,6 +46,7 @@ SpeechTranscriberCallback::~SpeechTranscriberCallback() {
   this->_onTranscriptionCompleted = NULL;
   this->_onChannelClosed = NULL;
   this->_onMessage = NULL;
+  this->_onAudioWritable = NULL;
 
   std::map<NlsEvent::EventType, void*>::iterator iter;
   for (iter = _paramap.begin(); iter != _paramap.end();) {
@@ -130,6 +132,16 @@ void SpeechTranscriberCallback::setOnMessage(NlsCallbackMethod _event,
   }
 }
 
+void SpeechTranscriberCallback::setOnAudioWritable(NlsCallbackMethod _event,
+                                                   void* para) {
+  this->_onAudioWritable = _event;
+  if (this->_paramap.find(NlsEvent::AudioWritable) != _paramap.end()) {
+    _paramap[NlsEvent::AudioWritable] = para;
+  } else {
+    _paramap.insert(std::make_pair(NlsEvent::AudioWritable, para));
+  }
+}
+
 void SpeechTranscriberCallback::setOnTranscriptionCompleted(
     NlsCallbackMethod _event, void* para) {
   // LOG_DEBUG("setOnTranscriptionCompleted callback");
@@ -213,6 +225,14 @@ NlsRequestStatus SpeechTranscriberRequest::getRequestStatus() {
   return INlsRequest::getRequestStatus(this);
 }
 
+int SpeechTranscriberRequest::getRequestTimeline(NlsRequestTimeline* timeline) {
+  return INlsRequest::getRequestTimeline(this, timeline);
+}
+
+int SpeechTranscriberRequest::getAudioCredit() {
+  return INlsRequest::getAudioCredit(this);
+}
+
 int SpeechTranscriberRequest::setPayloadParam(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
@@ -336,6 +356,18 @@ int SpeechTranscriberRequest::setSendTimeout(int value) {
   return Success;
 }
 
+int SpeechTranscriberRequest::setSocketOptions(const NlsSocketOptions& options) {
+  INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
+  _transcriberParam->setSocketOptions(options);
+  return Success;
+}
+
+int SpeechTranscriberRequest::setEnableWsDeflate(bool enable) {
+  INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
+  _transcriberParam->setEnableWsDeflate(enable);
+  return Success;
+}
+
 int SpeechTranscriberRequest::setOutputFormat(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
@@ -359,6 +391,17 @@ int SpeechTranscriberRequest::setEnableContinued(bool enable) {
 #endif
 }
 
+int SpeechTranscriberRequest::setContinuedReplayDuration(
+    unsigned int durationMs) {
+#ifdef ENABLE_CONTINUED
+  INPUT_REQUEST_PARAM_CHECK(_transcriberParam);
+  _transcriberParam->setContinuedReplayMs(durationMs);
+  return Success;
+#else
+  return -(InvalidRequest);
+#endif
+}
+
 const char* SpeechTranscriberRequest::getOutputFormat() {
   if (_transcriberParam == NULL) {
     LOG_ERROR("Input request param is empty.");
@@ -463,4 +506,9 @@ void SpeechTranscriberRequest::setOnMessage(NlsCallbackMethod _event,
   _callback->setOnMessage(_event, para);
 }
 
+void SpeechTranscriberRequest::setOnAudioWritable(NlsCallbackMethod _event,
+                                                  void* para) {
+  _callback->setOnAudioWritable(_event, para);
+}
+
 }  // namespace AlibabaNls
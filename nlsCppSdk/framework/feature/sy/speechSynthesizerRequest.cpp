@@ -176,6 +176,10 @@ NlsRequestStatus SpeechSynthesizerRequest::getRequestStatus() {
   return INlsRequest::getRequestStatus(this);
 }
 
+int SpeechSynthesizerRequest::getRequestTimeline(NlsRequestTimeline* timeline) {
+  return INlsRequest::getRequestTimeline(this, timeline);
+}
+
 int SpeechSynthesizerRequest::setPayloadParam(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_synthesizerParam);
@@ -285,6 +289,18 @@ int SpeechSynthesizerRequest::setSendTimeout(int value) {
   return Success;
 }
 
+int SpeechSynthesizerRequest::setSocketOptions(const NlsSocketOptions& options) {
+  INPUT_REQUEST_PARAM_CHECK(_synthesizerParam);
+  _synthesizerParam->setSocketOptions(options);
+  return Success;
+}
+
+int SpeechSynthesizerRequest::setEnableWsDeflate(bool enable) {
+  INPUT_REQUEST_PARAM_CHECK(_synthesizerParam);
+  _synthesizerParam->setEnableWsDeflate(enable);
+  return Success;
+}
+
 int SpeechSynthesizerRequest::setOutputFormat(const char* value) {
   INPUT_PARAM_STRING_CHECK(value);
   INPUT_REQUEST_PARAM_CHECK(_synthesizerParam);
@@ -151,6 +151,65 @@ const char* INlsRequest::dumpAllInfo(INlsRequest* request) {
   return NlsEventNetWork::_eventClient->dumpAllInfo(request);
 }
 
+int INlsRequest::getRequestTimeline(INlsRequest* request,
+                                    NlsRequestTimeline* timeline) {
+  if (request == NULL || timeline == NULL) {
+    LOG_ERROR("Input request or timeline is empty.");
+    return -(InvalidInputParam);
+  }
+  if (NlsEventNetWork::_eventClient == NULL) {
+    LOG_ERROR(
+        "NlsEventNetWork has destroyed, please invoke startWorkThread() "
+        "first.");
+    return -(EventClientEmpty);
+  }
+
+  NlsClientImpl* instance = NlsEventNetWork::_eventClient->getInstance();
+  if (instance == NULL) {
+    LOG_ERROR("Request(%p) instance is nullptr.", request);
+    return -(EventClientEmpty);
+  }
+  NlsNodeManager* node_manager = instance->getNodeManger();
+  int status = NodeStatusInvalid;
+  int ret = node_manager->checkRequestExist(request, &status);
+  if (ret != Success) {
+    LOG_ERROR("Request(%p) checkRequestExist failed, ret:%d.", request, ret);
+    return ret;
+  }
+
+  ConnectNode* node = request->getConnectNode();
+  if (node == NULL) {
+    return -(NodeEmpty);
+  }
+  *timeline = *(node->getRequestTimeline());
+  return Success;
+}
+
+int INlsRequest::getAudioCredit(INlsRequest* request) {
+  INPUT_REQUEST_CHECK(request);
+  EVENT_CLIENT_CHECK(NlsEventNetWork::_eventClient);
+
+  NlsClientImpl* instance = NlsEventNetWork::_eventClient->getInstance();
+  if (instance == NULL) {
+    LOG_ERROR("Request(%p) instance is nullptr.", request);
+    return -(EventClientEmpty);
+  }
+  NlsNodeManager* node_manager = instance->getNodeManger();
+  int status = NodeStatusInvalid;
+  int ret = node_manager->checkRequestExist(request, &status);
+  if (ret != Success) {
+    LOG_ERROR("Request(%p) checkRequestExist failed, ret:%d.", request, ret);
+    return ret;
+  }
+
+  ConnectNode* node = request->getConnectNode();
+  if (node == NULL) {
+    return -(NodeEmpty);
+  }
+  /* 可写字节数不超过发送缓冲区上限(Buffer16kMaxLimit) */
+  return (int)node->getAudioCredit();
+}
+
 ConnectNode* INlsRequest::getConnectNode() {
   if (_node == NULL) {
     LOG_WARN("request(%p) _node is nullptr.", this);
@@ -53,6 +53,8 @@ class INlsRequest {
   INlsRequestParam* getRequestParam();
 
   NlsRequestStatus getRequestStatus(INlsRequest*);
+  int getRequestTimeline(INlsRequest*, NlsRequestTimeline*);
+  int getAudioCredit(INlsRequest*);
 
   void setThreadNumber(int num);
   int getThreadNumber();
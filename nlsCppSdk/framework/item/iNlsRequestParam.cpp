@@ -49,10 +49,13 @@ INlsRequestParam::INlsRequestParam(NlsType mode, const char* sdkName,
       _enableOnMessage(false),
 #ifdef ENABLE_CONTINUED
       _enableReconnect(false),
+      _continuedReplayMs(D_DEFAULT_CONTINUED_REPLAY_MS),
 #endif
       _timeout(D_DEFAULT_CONNECTION_TIMEOUT_MS),
       _recvTimeout(D_DEFAULT_RECV_TIMEOUT_MS),
       _sendTimeout(D_DEFAULT_SEND_TIMEOUT_MS),
+      _customSocketOptions(false),
+      _enableWsDeflate(false),
       _sampleRate(D_DEFAULT_VALUE_SAMPLE_RATE),
       _requestType(SpeechNormal),
       _model(""),
@@ -110,10 +113,14 @@ INlsRequestParam& INlsRequestParam::operator=(const INlsRequestParam& other) {
     _enableOnMessage = other._enableOnMessage;
 #ifdef ENABLE_CONTINUED
     _enableReconnect = other._enableReconnect;
+    _continuedReplayMs = other._continuedReplayMs;
 #endif
     _timeout = other._timeout;
     _recvTimeout = other._recvTimeout;
     _sendTimeout = other._sendTimeout;
+    _customSocketOptions = other._customSocketOptions;
+    _socketOptions = other._socketOptions;
+    _enableWsDeflate = other._enableWsDeflate;
     _sampleRate = other._sampleRate;
     _requestType = other._requestType;
     _model = other._model;
@@ -164,14 +171,29 @@ bool INlsRequestParam::operator==(const INlsRequestParam& other) const {
          _enableOnMessage == other._enableOnMessage &&
 #ifdef ENABLE_CONTINUED
          _enableReconnect == other._enableReconnect &&
+         _continuedReplayMs == other._continuedReplayMs &&
 #endif
          _timeout == other._timeout && _recvTimeout == other._recvTimeout &&
          _sendTimeout == other._sendTimeout &&
+         _customSocketOptions == other._customSocketOptions &&
+         (!_customSocketOptions ||
+          (_socketOptions.tcp_nodelay == other._socketOptions.tcp_nodelay &&
+           _socketOptions.send_buffer_bytes ==
+               other._socketOptions.send_buffer_bytes &&
+           _socketOptions.recv_buffer_bytes ==
+               other._socketOptions.recv_buffer_bytes &&
+           _socketOptions.user_timeout_ms ==
+               other._socketOptions.user_timeout_ms &&
+           _socketOptions.notsent_lowat_bytes ==
+               other._socketOptions.notsent_lowat_bytes &&
+           _socketOptions.busy_poll_us == other._socketOptions.busy_poll_us)) &&
+         _enableWsDeflate == other._enableWsDeflate &&
          _sampleRate == other._sampleRate &&
          _requestType == other._requestType && _url == other._url &&
          _outputFormat == other._outputFormat && _appKey == other._appKey &&
          _format == other._format && _mode == other._mode &&
-         _sdkName == other._sdkName;
+         _sdkName == other._sdkName && _apikey == other._apikey &&
+         _httpHeader == other._httpHeader;
 }
 
 Json::Value INlsRequestParam::getSdkInfo() {
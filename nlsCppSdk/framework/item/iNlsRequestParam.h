@@ -85,6 +85,12 @@ class INlsRequestParam {
   };
   inline void setRecvTimeout(int timeout) { _recvTimeout = timeout; };
   inline void setSendTimeout(int timeout) { _sendTimeout = timeout; };
+  inline void setSocketOptions(const NlsSocketOptions& options) {
+    _socketOptions = options;
+    _customSocketOptions = true;
+  };
+  inline void setEnableWsDeflate(bool enable) { _enableWsDeflate = enable; };
+  inline bool getEnableWsDeflate() { return _enableWsDeflate; };
 
   inline void setOutputFormat(const char* outputFormat) {
     _outputFormat = outputFormat;
@@ -93,6 +99,9 @@ class INlsRequestParam {
   inline void setEnableOnMessage(bool enable) { _enableOnMessage = enable; };
 #ifdef ENABLE_CONTINUED
   inline void setEnableContinued(bool enable) { _enableReconnect = enable; };
+  inline void setContinuedReplayMs(unsigned int ms) {
+    _continuedReplayMs = ms;
+  };
 #endif
 
   inline void setTaskId(std::string taskId) { _taskId = taskId; };
@@ -151,6 +160,7 @@ class INlsRequestParam {
   bool _enableOnMessage;
 #ifdef ENABLE_CONTINUED
   bool _enableReconnect;
+  unsigned int _continuedReplayMs; /*重连续传时重放音频的最大时长*/
 #endif
 
   // about speech transcriber and recognizer
@@ -172,6 +182,9 @@ class INlsRequestParam {
   time_t _timeout;
   time_t _recvTimeout;
   time_t _sendTimeout;
+  bool _customSocketOptions; /* 是否覆盖NlsClient::setSocketOptions的设置 */
+  NlsSocketOptions _socketOptions;
+  bool _enableWsDeflate; /* 握手时协商permessage-deflate */
 
   NlsRequestType _requestType;
   std::string _model;
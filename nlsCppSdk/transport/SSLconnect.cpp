@@ -280,6 +280,21 @@ int SSLconnect::sslWrite(const uint8_t *buffer, size_t len) {
   return wLen;
 }
 
+/**
+ * @brief: 获取SSL内部已解密但尚未读取的字节数,
+ *         这部分数据已离开内核socket缓冲, 不会再触发EV_READ.
+ * @return: 待读取的字节数, SSL已关闭则返回0.
+ */
+int SSLconnect::sslPending() {
+  int pending = 0;
+  MUTEX_LOCK(_mtxSSL);
+  if (_ssl) {
+    pending = SSL_pending(_ssl);
+  }
+  MUTEX_UNLOCK(_mtxSSL);
+  return pending;
+}
+
 int SSLconnect::sslRead(uint8_t *buffer, size_t len) {
   MUTEX_LOCK(_mtxSSL);
 
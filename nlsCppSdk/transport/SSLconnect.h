@@ -36,6 +36,7 @@ class SSLconnect {
   int sslHandshake(int socketFd, const char* hostname);  // hostname暂不使用
   int sslWrite(const uint8_t* buffer, size_t len);
   int sslRead(uint8_t* buffer, size_t len);
+  int sslPending();  // SSL内部已解密但尚未读取的字节数
   void sslClose();
 
   const char* getFailedMsg();
@@ -17,6 +17,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -35,6 +36,7 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/ioctl.h>
 #include <sys/poll.h>
 #include <sys/time.h>
@@ -42,12 +44,15 @@
 
 #include "Config.h"
 #include "connectNode.h"
+#include "dnsResolverPool.h"
 #include "iNlsRequest.h"
 #include "iNlsRequestParam.h"
 #include "nlog.h"
 #include "nlsClientImpl.h"
 #include "nlsEventNetWork.h"
 #include "nlsGlobal.h"
+#include "nlsMetrics.h"
+#include "nlsTracing.h"
 #include "nodeManager.h"
 #include "text_utils.h"
 #include "utility.h"
@@ -62,7 +67,14 @@ namespace AlibabaNls {
 ConnectNode::ConnectNode(INlsRequest *request,
                          HandleBaseOneParamWithReturnVoid<NlsEvent> *handler,
                          bool isLongConnection)
-    : _request(request),
+    :
+#ifdef __LINUX__
+      _dnsResolving(false),
+      _dnsEvent(NULL),
+      _dnsErrorCode(0),
+      _addrinfo(NULL),
+#endif
+      _request(request),
       _handler(handler),
       _isLongConnection(isLongConnection),
       _usePreconnection(false),
@@ -94,33 +106,29 @@ ConnectNode::ConnectNode(INlsRequest *request,
       _syncCallTimeoutMs(0),
       _nodeErrCode(Success),
       _limitSize(Buffer16kMaxLimit),
-#ifdef __LINUX__
-      _nodename(NULL),
-      _servname(NULL),
-      _dnsThread(0),
-      _dnsThreadExit(false),
-      _dnsErrorCode(0),
-      _addrinfo(NULL),
-      _dnsThreadRunning(false),
-      _dnsEvent(NULL),
-#endif
+      _audioWritablePending(false),
       _sslHandle(NULL),
       _nativeSslHandle(NULL),
       _enableRecvTv(false),
       _enableOnMessage(false),
-      _launchEvent(NULL),
+      _triggerEvent(NULL),
+      _triggerPending(0),
+      _longConnectionStartPending(false),
 #ifdef ENABLE_PRECONNECTED_POOL
-      _startWithPoolEvent(NULL),
       _poolIndex(-1),
 #endif
-      _singleRoundTextEvent(NULL),
       _isSendSingleRoundText(false),
       _connectEvent(NULL),
       _readEvent(NULL),
       _writeEvent(NULL),
-#ifdef ENABLE_CONTINUED
-      _reconnectEvent(NULL),
-#endif
+      _edgeTriggered(false),
+      _pendingReadError(0),
+      _timeoutEntry(this),
+      _timeoutWheel(NULL),
+      _timeoutEnabled(false),
+      _timeoutFireMs(0),
+      _nextConnectCandidate(0),
+      _connectRaceBeginMs(0),
       _inEventCallbackNode(false),
       _releasingFlag(false),
       _waitEventCallbackAbnormally(false) {
@@ -165,44 +173,42 @@ ConnectNode::ConnectNode(INlsRequest *request,
 
   // will update parameters in updateParameters()
   _enableRecvTv = request->getRequestParam()->getEnableRecvTimeout();
-  utility::TextUtils::GetTimevalFromMs(
-      &_recvTv, request->getRequestParam()->getRecvTimeout());
-  utility::TextUtils::GetTimevalFromMs(
-      &_sendTv, request->getRequestParam()->getSendTimeout());
-  utility::TextUtils::GetTimevalFromMs(
-      &_connectTv, request->getRequestParam()->getTimeout());
+  memset(_deadlineMs, 0, sizeof(_deadlineMs));
+  memset(_triggerDeadlineMs, 0, sizeof(_triggerDeadlineMs));
 
   _enableOnMessage = request->getRequestParam()->getEnableOnMessage();
+  memset(&_timeline, 0, sizeof(_timeline));
 
 #ifdef ENABLE_HIGH_EFFICIENCY
-  _connectTimerTv.tv_sec = 0;
-  _connectTimerTv.tv_usec = ConnectTimerIntervalMs * 1000;
   _connectTimerFlag = true;
-  _connectTimerEvent = NULL;
-#endif
-
-#ifdef __LINUX__
-  _gaicbRequest[0] = NULL;
 #endif
 
 #if defined(_MSC_VER)
   _mtxNode = CreateMutex(NULL, FALSE, NULL);
   _mtxCloseNode = CreateMutex(NULL, FALSE, NULL);
+  _mtxTimeout = CreateMutex(NULL, FALSE, NULL);
   _mtxEventCallbackNode = CreateEvent(NULL, FALSE, FALSE, NULL);
   _mtxInvokeSyncCallNode = CreateEvent(NULL, FALSE, FALSE, NULL);
 #else
   pthread_mutex_init(&_mtxNode, NULL);
   pthread_mutex_init(&_mtxCloseNode, NULL);
+  pthread_mutex_init(&_mtxTimeout, NULL);
   pthread_mutex_init(&_mtxEventCallbackNode, NULL);
   pthread_mutex_init(&_mtxInvokeSyncCallNode, NULL);
   pthread_cond_init(&_cvEventCallbackNode, NULL);
   pthread_cond_init(&_cvInvokeSyncCallNode, NULL);
 #endif
+#ifdef ENABLE_CONTINUED
+#if defined(_MSC_VER)
+  _mtxAudioReplay = CreateMutex(NULL, FALSE, NULL);
+#else
+  pthread_mutex_init(&_mtxAudioReplay, NULL);
+#endif
+#endif
 
 #ifdef ENABLE_REQUEST_RECORDING
   _nodeProcess.last_status = NodeCreated;
-  _nodeProcess.create_timestamp_ms = utility::TextUtils::GetTimestampMs();
-  _nodeProcess.last_op_timestamp_ms = _nodeProcess.create_timestamp_ms;
+  _nodeProcess.record(RecordCreate, true);
 #endif
 
   _nodeUUID = utility::TextUtils::getRandomUuid();
@@ -218,25 +224,22 @@ ConnectNode::~ConnectNode() {
 
 #ifdef __LINUX__
   if (_url._enableSysGetAddr) {
-    if (_dnsThread) {
-      LOG_WARN("Node(%p) dnsThread(%lu) still exist, waiting exiting", this,
-               _dnsThread);
-      _dnsThreadExit = true;
-      pthread_join(_dnsThread, NULL);
-      LOG_WARN("Node(%p) dnsThread(%lu) exited.", this, _dnsThread);
-      _dnsThread = 0;
-      if (_gaicbRequest[0]) {
-        free(_gaicbRequest[0]);
-        _gaicbRequest[0] = NULL;
-      }
-    } else {
-      LOG_DEBUG("Node(%p) dnsThread has exited.", this);
-    }
+    cancelSysDnsResolve();
+  }
+  if (_addrinfo) {
+    evutil_freeaddrinfo(_addrinfo);
+    _addrinfo = NULL;
   }
 #endif
 
   waitEventCallback();
   closeConnectNode();
+  /* closeConnectNode()可能因锁超时提前返回,
+   * _timeoutEntry随节点释放, 须确保已移出时间轮 */
+  cancelTimeouts();
+#ifdef ENABLE_WS_DEFLATE
+  _webSocket.releaseDeflate();
+#endif
   if (_eventThread) {
     _eventThread->freeListNode(_eventThread, _request);
   }
@@ -274,28 +277,14 @@ ConnectNode::~ConnectNode() {
     evbuffer_free(_wwvEvBuffer);
     _wwvEvBuffer = NULL;
   }
-  if (_launchEvent) {
-    event_free(_launchEvent);
-    _launchEvent = NULL;
+  if (_triggerEvent) {
+    event_free(_triggerEvent);
+    _triggerEvent = NULL;
   }
 #ifdef ENABLE_PRECONNECTED_POOL
-  if (_startWithPoolEvent) {
-    event_free(_startWithPoolEvent);
-    _startWithPoolEvent = NULL;
-  }
   _poolIndex = -1;
 #endif
-  if (_singleRoundTextEvent) {
-    event_free(_singleRoundTextEvent);
-    _singleRoundTextEvent = NULL;
-  }
   _isSendSingleRoundText = false;
-#ifdef ENABLE_CONTINUED
-  if (_reconnectEvent) {
-    event_free(_reconnectEvent);
-    _reconnectEvent = NULL;
-  }
-#endif
 
   if (_eventThread) {
     if (_dnsRequest && _dnsRequestCallbackStatus == 1) {
@@ -372,15 +361,24 @@ ConnectNode::~ConnectNode() {
 #if defined(_MSC_VER)
   CloseHandle(_mtxNode);
   CloseHandle(_mtxCloseNode);
+  CloseHandle(_mtxTimeout);
   CloseHandle(_mtxEventCallbackNode);
   CloseHandle(_mtxInvokeSyncCallNode);
 #else
   pthread_mutex_destroy(&_mtxNode);
   pthread_mutex_destroy(&_mtxCloseNode);
+  pthread_mutex_destroy(&_mtxTimeout);
   pthread_mutex_destroy(&_mtxEventCallbackNode);
   pthread_mutex_destroy(&_mtxInvokeSyncCallNode);
   pthread_cond_destroy(&_cvEventCallbackNode);
   pthread_cond_destroy(&_cvInvokeSyncCallNode);
+#endif
+#ifdef ENABLE_CONTINUED
+#if defined(_MSC_VER)
+  CloseHandle(_mtxAudioReplay);
+#else
+  pthread_mutex_destroy(&_mtxAudioReplay);
+#endif
 #endif
   _inEventCallbackNode = false;
 
@@ -408,75 +406,118 @@ void ConnectNode::initAllStatus() {
 }
 
 /**
- * @brief: 获得用于启动当前node的libevent, 用于启动当前请求
- * @return: libevent的event指针
+ * @brief: 长链接模式下, 若上一轮交互已Completed但还未回调Close(NodeClosed),
+ *         则记录start请求, 待进入NodeClosed后由工作线程发起start.
+ * @return: 已延后则为true
  */
-struct event *ConnectNode::getLaunchEvent(bool init) {
-  if (_launchEvent == NULL) {
-    _launchEvent = event_new(_eventThread->_workBase, -1, EV_READ,
-                             WorkThread::launchEventCallback, this);
-    if (NULL == _launchEvent) {
-      LOG_ERROR("Node(%p) new event(_launchEvent) failed.", this);
-    } else {
-      LOG_DEBUG("Node(%p) new event(_launchEvent).", this);
-    }
-  } else {
-    if (init) {
-      event_del(_launchEvent);
-      int assign_ret =
-          event_assign(_launchEvent, _eventThread->_workBase, -1, EV_READ,
-                       WorkThread::launchEventCallback, this);
-      LOG_DEBUG("Node(%p) new event_assign(_launchEvent) with ret:%d.", this,
-                assign_ret);
-    }
+bool ConnectNode::deferLongConnectionStart() {
+  bool deferred = false;
+  MUTEX_LOCK(_mtxNode);
+  if (_isLongConnection && _workStatus == NodeCompleted) {
+    _longConnectionStartPending = true;
+    deferred = true;
   }
-  return _launchEvent;
+  MUTEX_UNLOCK(_mtxNode);
+  return deferred;
 }
 
-#ifdef ENABLE_PRECONNECTED_POOL
-struct event *ConnectNode::getStartWithPoolEvent(bool init) {
-  if (_startWithPoolEvent == NULL) {
-    _startWithPoolEvent =
-        event_new(_eventThread->_workBase, -1, EV_READ,
-                  WorkThread::startWithPoolEventCallback, this);
-    if (NULL == _startWithPoolEvent) {
-      LOG_ERROR("Node(%p) new event(_startWithPoolEvent) failed.", this);
-    } else {
-      LOG_DEBUG("Node(%p) new event(_startWithPoolEvent).", this);
-    }
+/**
+ * @brief: 获得节点的动作事件, 该事件不关联fd, 启动, 重连等动作均经由它
+ *         在工作线程中执行. 节点换了WorkThread时重新绑定到新的event_base.
+ * @return: libevent的event指针
+ */
+struct event *ConnectNode::getTriggerEvent() {
+  if (_triggerEvent == NULL) {
+    _triggerEvent = event_new(_eventThread->_workBase, -1, 0,
+                              WorkThread::nodeTriggerEventCallback, this);
+    if (NULL == _triggerEvent) {
+      LOG_ERROR("Node(%p) new event(_triggerEvent) failed.", this);
+    }
+  } else if (event_get_base(_triggerEvent) != _eventThread->_workBase) {
+    event_del(_triggerEvent);
+    event_assign(_triggerEvent, _eventThread->_workBase, -1, 0,
+                 WorkThread::nodeTriggerEventCallback, this);
+    MUTEX_LOCK(_mtxTimeout);
+    armTriggerEventLocked(TimerWheel::nowMs());
+    MUTEX_UNLOCK(_mtxTimeout);
+  }
+  return _triggerEvent;
+}
+
+/**
+ * @brief: 在本节点的工作线程中执行动作
+ * @param action: 动作类型
+ * @param delayMs: 延时执行的时长, 0为立即执行. 同一动作再次设置时覆盖之前的时刻
+ * @return: 成功则为0, 失败则负值.
+ */
+int ConnectNode::triggerAction(NodeTriggerAction action,
+                               unsigned int delayMs) {
+  struct event *ev = getTriggerEvent();
+  if (NULL == ev) {
+    return -(EventEmpty);
+  }
+
+  if (delayMs == 0) {
+    _triggerPending.fetch_or(1u << action);
+    event_active(ev, EV_READ, 0);
   } else {
-    if (init) {
-      event_del(_startWithPoolEvent);
-      int assign_ret =
-          event_assign(_startWithPoolEvent, _eventThread->_workBase, -1,
-                       EV_READ, WorkThread::startWithPoolEventCallback, this);
-      LOG_DEBUG("Node(%p) new event_assign(_startWithPoolEvent) with ret:%d.",
-                this, assign_ret);
-    }
+    uint64_t now = TimerWheel::nowMs();
+    MUTEX_LOCK(_mtxTimeout);
+    _triggerDeadlineMs[action] = now + delayMs;
+    armTriggerEventLocked(now);
+    MUTEX_UNLOCK(_mtxTimeout);
   }
-  return _startWithPoolEvent;
+  return Success;
 }
-#endif
 
-struct event *ConnectNode::getSingleRoundTextEvent() {
-  if (_singleRoundTextEvent == NULL) {
-    _singleRoundTextEvent =
-        event_new(_eventThread->_workBase, -1, EV_READ,
-                  WorkThread::singleRoundTextEventCallback, this);
-    if (NULL == _singleRoundTextEvent) {
-      LOG_ERROR("Node(%p) new event(_singleRoundTextEvent) failed.", this);
-    } else {
-      LOG_DEBUG("Node(%p) new event(_singleRoundTextEvent).", this);
+/**
+ * @brief: 撤销尚未执行的动作. _triggerEvent若已触发, 回调中不再执行该动作.
+ */
+void ConnectNode::cancelAction(NodeTriggerAction action) {
+  _triggerPending.fetch_and(~(1u << action));
+  MUTEX_LOCK(_mtxTimeout);
+  _triggerDeadlineMs[action] = 0;
+  MUTEX_UNLOCK(_mtxTimeout);
+}
+
+/**
+ * @brief: _triggerEvent回调时取出待执行的动作, 含已到期的延时动作,
+ *         仍有未到期的延时动作则按最近的时刻重新加入_triggerEvent.
+ * @return: 待执行动作的掩码, 第i位对应NodeTriggerAction中的第i个动作
+ */
+unsigned int ConnectNode::takeTriggeredActions() {
+  unsigned int actions = _triggerPending.exchange(0);
+  uint64_t now = TimerWheel::nowMs();
+  MUTEX_LOCK(_mtxTimeout);
+  for (int i = 0; i < NodeTriggerNumber; i++) {
+    if (_triggerDeadlineMs[i] > 0 && _triggerDeadlineMs[i] <= now) {
+      _triggerDeadlineMs[i] = 0;
+      actions |= 1u << i;
+    }
+  }
+  armTriggerEventLocked(now);
+  MUTEX_UNLOCK(_mtxTimeout);
+  return actions;
+}
+
+/**
+ * @brief: 按最近的延时动作时刻设置_triggerEvent的超时.
+ *         非持久事件在event_active后的回调前会被移出定时器,
+ *         因此每次回调都需重新设置.
+ */
+void ConnectNode::armTriggerEventLocked(uint64_t now) {
+  uint64_t next = 0;
+  for (int i = 0; i < NodeTriggerNumber; i++) {
+    if (_triggerDeadlineMs[i] > 0 &&
+        (next == 0 || _triggerDeadlineMs[i] < next)) {
+      next = _triggerDeadlineMs[i];
     }
-  } else {
-    event_del(_singleRoundTextEvent);
-    int assign_ret =
-        event_assign(_singleRoundTextEvent, _eventThread->_workBase, -1,
-                     EV_READ, WorkThread::singleRoundTextEventCallback, this);
-    LOG_DEBUG("Node(%p) new event_assign(_singleRoundTextEvent) with ret:%d.",
-              this, assign_ret);
   }
-  return _singleRoundTextEvent;
+  if (next > 0 && _triggerEvent) {
+    struct timeval tv;
+    utility::TextUtils::GetTimevalFromMs(&tv, next > now ? next - now : 0);
+    event_add(_triggerEvent, &tv);
+  }
 }
 
 /**
@@ -675,16 +716,7 @@ bool ConnectNode::updateDestroyStatus() {
   if (!_isDestroy) {
 #ifdef __LINUX__
     if (_url._enableSysGetAddr) {
-      if (_dnsThread) {
-        LOG_WARN("Node(%p) dnsThread(%lu) still exist, waiting exiting", this,
-                 _dnsThread);
-        _dnsThreadExit = true;
-        pthread_join(_dnsThread, NULL);
-        LOG_WARN("Node(%p) dnsThread(%lu) exited.", this, _dnsThread);
-        _dnsThread = 0;
-      } else {
-        LOG_DEBUG("Node(%p) dnsThread has exited.", this);
-      }
+      cancelSysDnsResolve();
     }
 #endif
 
@@ -801,6 +833,8 @@ void ConnectNode::disconnectProcess() {
       this, getConnectNodeStatusString().c_str(),
       getExitStatusString().c_str());
 
+  cancelConnectRace();
+
   if (_socketFd != INVALID_SOCKET) {
     if (_sslHandle == _nativeSslHandle) {
       if (_url._isSsl) {
@@ -941,34 +975,18 @@ void ConnectNode::closeStatusConnectNodeForConnectedPool() {
     event_free(_writeEvent);
     _writeEvent = NULL;
   }
+  cancelTimeouts();
   if (_connectEvent) {
     event_del(_connectEvent);
     event_free(_connectEvent);
     _connectEvent = NULL;
   }
-  if (_launchEvent) {
-    event_del(_launchEvent);
-    event_free(_launchEvent);
-    _launchEvent = NULL;
-  }
-
+  /* 撤销尚未执行的启动动作, _triggerEvent随节点释放 */
+  cancelAction(NodeTriggerLaunch);
+  cancelAction(NodeTriggerLongConnectionStart);
+  _longConnectionStartPending = false;
 #ifdef ENABLE_PRECONNECTED_POOL
-  if (_startWithPoolEvent) {
-    event_del(_startWithPoolEvent);
-    event_free(_startWithPoolEvent);
-    _startWithPoolEvent = NULL;
-  }
-#endif
-
-#ifdef ENABLE_HIGH_EFFICIENCY
-  if (_connectTimerEvent != NULL) {
-    if (_connectTimerFlag) {
-      evtimer_del(_connectTimerEvent);
-      _connectTimerFlag = false;
-    }
-    event_free(_connectTimerEvent);
-    _connectTimerEvent = NULL;
-  }
+  cancelAction(NodeTriggerStartWithPool);
 #endif
 
   if (_audioFrame) {
@@ -1033,6 +1051,8 @@ void ConnectNode::closeConnectNode() {
       this, getConnectNodeStatusString().c_str(),
       getExitStatusString().c_str());
 
+  cancelConnectRace();
+
   if (_socketFd != INVALID_SOCKET) {
     if (_sslHandle == _nativeSslHandle) {
       if (_url._isSsl) {
@@ -1050,6 +1070,10 @@ void ConnectNode::closeConnectNode() {
   }
 
   _isConnected = false;
+#ifdef ENABLE_WS_DEFLATE
+  /* 压缩上下文随连接失效, 归还zlib流 */
+  _webSocket.releaseDeflate();
+#endif
 
   if (_url._enableSysGetAddr && _dnsEvent) {
     event_del(_dnsEvent);
@@ -1066,34 +1090,22 @@ void ConnectNode::closeConnectNode() {
     event_free(_writeEvent);
     _writeEvent = NULL;
   }
+  cancelTimeouts();
   if (_connectEvent) {
     event_del(_connectEvent);
     event_free(_connectEvent);
     _connectEvent = NULL;
   }
-  if (_launchEvent) {
-    event_del(_launchEvent);
-    event_free(_launchEvent);
-    _launchEvent = NULL;
-  }
-
+  /* 撤销尚未执行的启动动作, _triggerEvent随节点释放 */
+  cancelAction(NodeTriggerLaunch);
+  cancelAction(NodeTriggerLongConnectionStart);
+  _longConnectionStartPending = false;
 #ifdef ENABLE_PRECONNECTED_POOL
-  if (_startWithPoolEvent) {
-    event_del(_startWithPoolEvent);
-    event_free(_startWithPoolEvent);
-    _startWithPoolEvent = NULL;
-  }
+  cancelAction(NodeTriggerStartWithPool);
 #endif
 
 #ifdef ENABLE_HIGH_EFFICIENCY
-  if (_connectTimerEvent != NULL) {
-    if (_connectTimerFlag) {
-      evtimer_del(_connectTimerEvent);
-      _connectTimerFlag = false;
-    }
-    event_free(_connectTimerEvent);
-    _connectTimerEvent = NULL;
-  }
+  _connectTimerFlag = false;
 #endif
 
   if (_audioFrame) {
@@ -1138,7 +1150,10 @@ int ConnectNode::socketWrite(const uint8_t *buffer, size_t len) {
 int ConnectNode::socketRead(uint8_t *buffer, size_t len) {
   int rLen = recv(_socketFd, (char *)buffer, len, 0);
 
-  if (rLen <= 0) {  // rLen == 0, close socket, need do
+  if (rLen == 0 && len > 0) {
+    /* 对端已关闭. 不可依据errno判断, 其可能残留自此前其他socket的EAGAIN */
+    return -(SocketReadFailed);
+  } else if (rLen < 0) {
     int errorCode = utility::getLastErrorCode();
     if (NLS_ERR_RW_RETRIABLE(errorCode)) {
       // LOG_DEBUG("Node(%p) socketRead continue.", this);
@@ -1154,19 +1169,26 @@ int ConnectNode::socketRead(uint8_t *buffer, size_t len) {
 
 int ConnectNode::gatewayRequest() {
   REQUEST_CHECK(_request, this);
-  if (NULL == _readEvent) {
-    LOG_ERROR("Node(%p) _readEvent is nullptr.", this);
-    return -(EventEmpty);
+  int ret = addSocketEvent();
+  if (ret < 0) {
+    return ret;
   }
-
-  if (_enableRecvTv) {
-    utility::TextUtils::GetTimevalFromMs(
-        &_recvTv, _request->getRequestParam()->getRecvTimeout());
-    event_add(_readEvent, &_recvTv);
-  } else {
-    event_add(_readEvent, NULL);
+  if (_eventThread) {
+    _webSocket.setMaskKey(_eventThread->nextMaskKey());
   }
 
+#ifdef ENABLE_WS_DEFLATE
+  /* 预连接池中的连接握手后会转交给其他请求, 压缩上下文无法随之转移,
+   * 因此只在请求自行建立的连接上协商 */
+  bool offerDeflate =
+      _request->getRequestParam()->getEnableWsDeflate() && _eventThread;
+#ifdef ENABLE_PRECONNECTED_POOL
+  offerDeflate = offerDeflate && !_usePreconnection;
+#endif
+  _webSocket.offerDeflate(offerDeflate ? _eventThread->getDeflatePool()
+                                       : NULL);
+#endif
+
   char tmp[NodeFrameSize] = {0};
   int tmpLen = 0;
   if (_url._serviceProtocol == WsServiceProtocolDashScope) {
@@ -1182,6 +1204,7 @@ int ConnectNode::gatewayRequest() {
   }
 
   evbuffer_add(_cmdEvBuffer, (void *)tmp, tmpLen);
+  _timeline.ws_request_us = utility::TextUtils::GetMonotonicUs();
 
   return Success;
 }
@@ -1193,52 +1216,44 @@ int ConnectNode::gatewayRequest() {
 int ConnectNode::gatewayResponse() {
   int ret = 0;
   int read_len = 0;
-  uint8_t *frame = (uint8_t *)calloc(ReadBufferSize, sizeof(char));
+  /* 复用WorkThread的读缓冲区, 超出部分由_readEvBuffer承接 */
+  uint8_t *frame = _eventThread ? _eventThread->getReadBuffer() : NULL;
   if (frame == NULL) {
-    LOG_ERROR("Node(%p) %s %d calloc failed.", this, __func__, __LINE__);
+    LOG_ERROR("Node(%p) %s %d get read buffer failed.", this, __func__,
+              __LINE__);
     return -(MallocFailed);
   }
 
-  read_len = nlsReceive(frame, ReadBufferSize);
+  read_len = nlsReceiveDrain(frame, ReadBufferSize);
   if (read_len < 0) {
     LOG_ERROR("Node(%p) nlsReceive failed, read_len:%d", this, read_len);
-    free(frame);
     return -(NlsReceiveFailed);
   } else if (read_len == 0) {
     LOG_WARN("Node(%p) nlsReceive empty, read_len:%d", this, read_len);
-    free(frame);
     return -(NlsReceiveEmpty);
   }
 
+  /* 就地解析_readEvBuffer中累积的http响应 */
   int frameSize = evbuffer_get_length(_readEvBuffer);
-  if (frameSize > ReadBufferSize) {
-    uint8_t *tmp = (uint8_t *)realloc(frame, frameSize + 1);
-    if (NULL == tmp) {
-      LOG_ERROR("Node(%p) %s %d realloc failed.", this, __func__, __LINE__);
-      free(frame);
-      return -(ReallocFailed);
-    } else {
-      frame = tmp;
-    }
+  const char *response = (const char *)evbuffer_pullup(_readEvBuffer, -1);
+  if (response == NULL) {
+    LOG_ERROR("Node(%p) %s %d evbuffer_pullup failed.", this, __func__,
+              __LINE__);
+    return -(ReallocFailed);
   }
 
-  evbuffer_copyout(_readEvBuffer, frame, frameSize);  // evbuffer_peek
-
-  ret = _webSocket.responsePackage((const char *)frame, frameSize);
+  ret = _webSocket.responsePackage(response, frameSize);
   if (ret == 0) {
     evbuffer_drain(_readEvBuffer, frameSize);
   } else if (ret > 0) {
-    LOG_DEBUG("Node(%p) GateWay Middle response: %d\n %s", this, frameSize,
-              frame);
+    LOG_DEBUG("Node(%p) GateWay Middle response: %d\n %.*s", this, frameSize,
+              frameSize, response);
   } else {
     _nodeErrMsg = _webSocket.getFailedMsg();
     LOG_ERROR("Node(%p) webSocket.responsePackage: %s", this,
               _nodeErrMsg.c_str());
   }
 
-  if (frame) free(frame);
-  frame = NULL;
-
   return ret;
 }
 
@@ -1374,16 +1389,28 @@ int ConnectNode::addSlicedAudioDataBuffer(const uint8_t *frame, size_t length) {
 int ConnectNode::addAudioDataBuffer(const uint8_t *frame, size_t frameSize) {
   REQUEST_CHECK(_request, this);
   int ret = 0;
-  uint8_t *tmp =
-      NULL; /* alloc mem in binaryFrame, pls free in this function. */
-  size_t tmpSize = 0;
   size_t length = 0;
   struct evbuffer *buff = NULL;
   if (frame == NULL || frameSize == 0) {
     return -(NlsEncodingFailed);
   }
+
+  buff = getAudioEvBuffer();
+  if (getAudioCredit() == 0) {
+    /* 缓冲区已满, 在编码封包前拒绝, 待AudioWritable回调后再发送 */
+    LOG_WARN("Node(%p) too many audio data in evbuffer(%zu/%zu).", this,
+             evbuffer_get_length(buff), _limitSize);
+
+    /* 再次等待可写以防写事件本身出了异常 */
+    waitWritable(false);
+    return -(EvbufferTooMuch);
+  }
+
+  const uint8_t *payload = frame; /* 编码后的音频 */
+  size_t payloadSize = frameSize;
+  uint8_t *outputBuffer = NULL;
   if (_nlsEncoder && _encoderType != ENCODER_NONE) {
-    uint8_t *outputBuffer = new uint8_t[frameSize];
+    outputBuffer = new uint8_t[frameSize];
     if (outputBuffer == NULL) {
       LOG_ERROR("Node(%p) new outputBuffer failed.", this);
       return -(NewOutputBufferFailed);
@@ -1402,48 +1429,46 @@ int ConnectNode::addAudioDataBuffer(const uint8_t *frame, size_t frameSize) {
         delete[] outputBuffer;
         return -(NlsEncodingFailed);
       }
-      _webSocket.binaryFrame(outputBuffer, nSize, &tmp, &tmpSize);
-      delete[] outputBuffer;
+      payload = outputBuffer;
+      payloadSize = nSize;
     }
-  } else {
-    // pack frame data
-    _webSocket.binaryFrame(frame, frameSize, &tmp, &tmpSize);
   }
 
-  if (_request && _request->getRequestParam()->_enableWakeWord == true &&
-      !getWakeStatus()) {
-    buff = _wwvEvBuffer;
-  } else {
-    buff = _binaryEvBuffer;
+#ifdef ENABLE_CONTINUED
+  /* 保存至重放缓冲, 并保证与写入evbuffer的顺序一致 */
+  uint32_t replay_ms = 0;
+  if (buff == _binaryEvBuffer) {
+    replay_ms = getAudioReplayDurationMs(frameSize);
+  }
+  if (replay_ms > 0) {
+    MUTEX_LOCK(_mtxAudioReplay);
+    _audioReplay.push(payload, payloadSize, replay_ms);
+    if (_audioReplay.holding) {
+      /* 连接中断等待重连, 重连成功后统一重放 */
+      MUTEX_UNLOCK(_mtxAudioReplay);
+      if (outputBuffer) delete[] outputBuffer;
+      _isFirstAudioFrame = false;
+      return frameSize;
+    }
   }
+#endif
 
+  /* 直接在evbuffer中封包, 加掩码与拷贝一次完成 */
   evbuffer_lock(buff);
   length = evbuffer_get_length(buff);
-  if (length >= _limitSize) {
-    LOG_WARN("Node(%p) too many audio data in evbuffer(%zu/%zu).", this, length,
-             _limitSize);
-
-    if (tmp) free(tmp);
-    tmp = NULL;
-
-    evbuffer_unlock(buff);
+  int packed = _webSocket.binaryFrame(payload, payloadSize, buff);
+  evbuffer_unlock(buff);
 
-    /* 再启动_writeEvent以防_writeEvent本身出了异常 */
-    if (_writeEvent) {
-      event_del(_writeEvent);
-      utility::TextUtils::GetTimevalFromMs(
-          &_sendTv, _request->getRequestParam()->getSendTimeout());
-      event_add(_writeEvent, &_sendTv);
-    }
-    return -(EvbufferTooMuch);
+  if (outputBuffer) delete[] outputBuffer;
+  outputBuffer = NULL;
+#ifdef ENABLE_CONTINUED
+  if (replay_ms > 0) {
+    MUTEX_UNLOCK(_mtxAudioReplay);
+  }
+#endif
+  if (packed < 0) {
+    return packed;
   }
-
-  evbuffer_add(buff, (void *)tmp, tmpSize);
-
-  if (tmp) free(tmp);
-  tmp = NULL;
-
-  evbuffer_unlock(buff);
 
   if (length == 0 && _workStatus == NodeStarted) {
     MUTEX_LOCK(_mtxNode);
@@ -1476,6 +1501,59 @@ int ConnectNode::addAudioDataBuffer(const uint8_t *frame, size_t frameSize) {
   return ret;
 }
 
+/**
+ * @brief: 获得当前音频数据写入的evbuffer, 唤醒词校验前为_wwvEvBuffer
+ */
+struct evbuffer *ConnectNode::getAudioEvBuffer() {
+  if (_request && _request->getRequestParam()->_enableWakeWord == true &&
+      !getWakeStatus()) {
+    return _wwvEvBuffer;
+  }
+  return _binaryEvBuffer;
+}
+
+/**
+ * @brief: 音频发送缓冲区剩余可写的字节数(编码封包后)
+ *         返回0时置位_audioWritablePending,
+ *         待缓冲区降至低水位后通过AudioWritable事件通知.
+ * @return: 剩余可写字节数
+ */
+size_t ConnectNode::getAudioCredit() {
+#ifdef ENABLE_CONTINUED
+  /* 等待重连时音频进入重放缓冲, 旧连接残留数据会在重放前清空 */
+  if (isAudioReplayHolding()) {
+    return _limitSize;
+  }
+#endif
+  struct evbuffer *buff = getAudioEvBuffer();
+  size_t credit = 0;
+  evbuffer_lock(buff);
+  size_t length = evbuffer_get_length(buff);
+  if (length < _limitSize) {
+    credit = _limitSize - length;
+  } else {
+    _audioWritablePending = true;
+  }
+  evbuffer_unlock(buff);
+  return credit;
+}
+
+/**
+ * @brief: 音频发送缓冲区降至低水位, 通知用户可继续发送音频
+ */
+void ConnectNode::handlerAudioWritableEvent() {
+  if (_request == NULL || _handler == NULL || _exitStatus != ExitInvalid) {
+    return;
+  }
+  char msg[128] = {0};
+  snprintf(msg, sizeof(msg),
+           "{\"header\":{\"name\":\"AudioWritable\"},"
+           "\"payload\":{\"credit\":%zu}}",
+           getAudioCredit());
+  LOG_DEBUG("Node(%p) audio evbuffer is writable: %s", this, msg);
+  handlerMessage(msg, NlsEvent::AudioWritable);
+}
+
 /**
  * @brief: 发送控制命令
  * @return: 成功发送的字节数, 失败则返回负值.
@@ -1538,6 +1616,13 @@ void ConnectNode::addCmdDataBuffer(CmdType type, const char *message) {
             Json::UInt64(_reconnection.interruption_timestamp_ms -
                          _reconnection.first_audio_timestamp_ms);
         root["tw_index_offset"] = (Json::UInt64)_reconnection.tw_index_offset;
+        MUTEX_LOCK(_mtxAudioReplay);
+        if (_audioReplay.holding) {
+          /* 从最近确认的句子之后重放音频 */
+          root["tw_time_offset"] = Json::UInt64(_audioReplay.replayBeginMs());
+          root["tw_index_offset"] = (Json::UInt64)_audioReplay.confirmed_index;
+        }
+        MUTEX_UNLOCK(_mtxAudioReplay);
         std::string buf = Json::writeString(writer, root);
         _request->getRequestParam()->setPayloadParam(buf.c_str());
       }
@@ -1590,18 +1675,11 @@ void ConnectNode::addCmdDataBuffer(CmdType type, const char *message) {
                    cmd, &buf_str, "appkey\":\"", 4, 'Z'));
     }
 
-    uint8_t *frame = NULL;
-    size_t frameSize = 0;
     if (type == CmdSendPing) {
-      _webSocket.pingFrame(&frame, &frameSize);
+      _webSocket.pingFrame(_cmdEvBuffer);
     } else {
-      _webSocket.textFrame((uint8_t *)cmd, strlen(cmd), &frame, &frameSize);
+      _webSocket.textFrame((uint8_t *)cmd, strlen(cmd), _cmdEvBuffer);
     }
-
-    evbuffer_add(_cmdEvBuffer, (void *)frame, frameSize);
-
-    if (frame) free(frame);
-    frame = NULL;
   }
 }
 
@@ -1619,8 +1697,15 @@ int ConnectNode::cmdNotify(CmdType type, const char *message) {
             getConnectNodeStatusString().c_str());
 
   if (type == CmdStop) {
+    _timeline.stop_us = utility::TextUtils::GetMonotonicUs();
+    if (_traceContext.enabled) {
+      NlsTracer *tracer = utility::NlsTracing::getTracer();
+      if (tracer) {
+        traceFlushAudio(tracer, utility::NlsTracing::monotonicToUnixOffsetUs());
+      }
+    }
 #ifdef ENABLE_REQUEST_RECORDING
-    updateNodeProcess("stop", NodeStop, true, 0);
+    updateNodeProcess(RecordStop, NodeStop, true, 0);
 #endif
     addRemainAudioData();
     _exitStatus = ExitStopping;
@@ -1637,12 +1722,12 @@ int ConnectNode::cmdNotify(CmdType type, const char *message) {
     }
   } else if (type == CmdCancel) {
 #ifdef ENABLE_REQUEST_RECORDING
-    updateNodeProcess("cancel", NodeCancel, true, 0);
+    updateNodeProcess(RecordCancel, NodeCancel, true, 0);
 #endif
     _exitStatus = ExitCancel;
   } else if (type == CmdStControl) {
 #ifdef ENABLE_REQUEST_RECORDING
-    updateNodeProcess("ctrl", NodeSendControl, true, 0);
+    updateNodeProcess(RecordControl, NodeSendControl, true, 0);
 #endif
     addCmdDataBuffer(CmdStControl, message);
     if (_workStatus == NodeStarted) {
@@ -1660,7 +1745,7 @@ int ConnectNode::cmdNotify(CmdType type, const char *message) {
     }
   } else if (type == CmdSendText) {
 #ifdef ENABLE_REQUEST_RECORDING
-    updateNodeProcess("send_text", NodeSendText, true, 0);
+    updateNodeProcess(RecordSendText, NodeSendText, true, 0);
 #endif
     addCmdDataBuffer(CmdSendText, message);
     if (_workStatus == NodeStarted) {
@@ -1684,13 +1769,13 @@ int ConnectNode::cmdNotify(CmdType type, const char *message) {
 
 #ifdef ENABLE_REQUEST_RECORDING
   if (type == CmdStop) {
-    updateNodeProcess("stop", NodeStop, false, 0);
+    updateNodeProcess(RecordStop, NodeStop, false, 0);
   } else if (type == CmdCancel) {
-    updateNodeProcess("cancel", NodeCancel, false, 0);
+    updateNodeProcess(RecordCancel, NodeCancel, false, 0);
   } else if (type == CmdStControl) {
-    updateNodeProcess("ctrl", NodeSendControl, false, 0);
+    updateNodeProcess(RecordControl, NodeSendControl, false, 0);
   } else if (type == CmdSendText) {
-    updateNodeProcess("send_text", NodeSendText, false, 0);
+    updateNodeProcess(RecordSendText, NodeSendText, false, 0);
   }
 #endif
   return ret;
@@ -1703,9 +1788,9 @@ int ConnectNode::syncPingCmd() {
               _request, this, _sslHandle, _socketFd);
     return -(SslCtxEmpty);
   }
-  uint8_t *frame = NULL;
-  size_t frameSize = 0;
-  _webSocket.pingFrame(&frame, &frameSize);
+  uint8_t frame[MaxFrameHeaderSize];
+  size_t frameSize = _webSocket.framePackage(WebSocketHeaderType::PING, NULL,
+                                             0, frame);
   int ret = nlsSend(frame, frameSize);
   if (ret <= 0) {
     LOG_ERROR("Request(%p) Node(%p) send ping frame failed(%d).", _request,
@@ -1730,6 +1815,14 @@ int ConnectNode::nlsSend(const uint8_t *frame, size_t length) {
     sLen = socketWrite(frame, length);
   }
 
+  if (sLen > 0) {
+    utility::NlsMetrics::addCounter(utility::MetricBytesOut, sLen);
+    if (_timeline.first_send_us == 0 && _timeline.start_us > 0 &&
+        _workStatus >= NodeStarting) {
+      _timeline.first_send_us = utility::TextUtils::GetMonotonicUs();
+    }
+  }
+
   if (sLen < 0) {
     if (_url._isSsl) {
       _nodeErrMsg = _sslHandle->getFailedMsg();
@@ -1761,6 +1854,7 @@ int ConnectNode::nlsSendFrame(struct evbuffer *eventBuffer, bool audio_frame) {
     evbuffer_unlock(eventBuffer);
     return 0;
   }
+  utility::NlsMetrics::recordHistogram(utility::MetricEvbufferDepth, length);
 
   if (length > NodeFrameSize) {
     bufferSize = NodeFrameSize;
@@ -1789,18 +1883,23 @@ int ConnectNode::nlsSendFrame(struct evbuffer *eventBuffer, bool audio_frame) {
 
     evbuffer_drain(eventBuffer, sLen);
     length = evbuffer_get_length(eventBuffer);
-    if (length > 0) {
-      if (NULL == _writeEvent) {
-        LOG_ERROR("Node(%p) event is nullptr.", this);
-        evbuffer_unlock(eventBuffer);
-        return -(EventEmpty);
-      }
-
-      utility::TextUtils::GetTimevalFromMs(
-          &_sendTv, _request->getRequestParam()->getSendTimeout());
-      event_add(_writeEvent, &_sendTv);
+    bool writable = false;
+    if (_audioWritablePending && length <= _limitSize / 2 &&
+        (eventBuffer == _binaryEvBuffer || eventBuffer == _wwvEvBuffer)) {
+      _audioWritablePending = false;
+      writable = true;
+    }
+    if (length > 0 && waitWritable(sLen < (int)bufferSize) < 0) {
+      LOG_ERROR("Node(%p) event is nullptr.", this);
+      evbuffer_unlock(eventBuffer);
+      return -(EventEmpty);
     }
     evbuffer_unlock(eventBuffer);
+
+    if (writable) {
+      /* 调用方可能是持有_mtxNode的用户线程, 交由工作线程回调 */
+      triggerAction(NodeTriggerAudioWritable);
+    }
     return length;
   }
 }
@@ -1827,10 +1926,64 @@ int ConnectNode::nlsReceive(uint8_t *buffer, int max_size) {
   }
 
   evbuffer_add(_readEvBuffer, (void *)buffer, rLen);
+  if (rLen > 0) {
+    utility::NlsMetrics::addCounter(utility::MetricBytesIn, rLen);
+  }
 
   return rLen;
 }
 
+/**
+ * @brief: 循环读取直至socket无数据可读(EAGAIN)或达到ReadDrainBudget,
+ *         使一次读事件可处理一整段突发数据(如TTS音频), 减少事件循环唤醒次数.
+ *         边沿触发时内核不会再次通知, 必须读到EAGAIN/WANT_READ或出错为止,
+ *         否则随数据一起到达的FIN/RST将无人处理.
+ * @return: 本次读取的总字节数, 未读到任何数据且失败则返回负值.
+ */
+int ConnectNode::nlsReceiveDrain(uint8_t *buffer, int max_size) {
+  if (_pendingReadError < 0) {
+    int ret = _pendingReadError;
+    _pendingReadError = 0;
+    return ret;
+  }
+
+  int total = 0;
+  while (total < ReadDrainBudget) {
+    int rLen = nlsReceive(buffer, max_size);
+    if (rLen < 0) {
+      if (total == 0) {
+        return rLen;
+      }
+      /* 先解析已读到的数据. 边沿触发时错误不会再次上报,
+       * 记录下来并主动激活读事件, 在本次唤醒中处理 */
+      _pendingReadError = rLen;
+      if (_readEvent) {
+        event_active(_readEvent, EV_READ, 0);
+      }
+      return total;
+    } else if (rLen == 0) {
+      break;
+    }
+    total += rLen;
+
+    /* 水平触发的明文socket读不满即内核缓冲已空, 省去一次返回EAGAIN的recv,
+     * 剩余的EOF或错误会再次触发EV_READ.
+     * SSL_read每次至多返回一个record, 需读到WANT_READ为止. */
+    if (!_edgeTriggered && !_url._isSsl && rLen < max_size) {
+      break;
+    }
+  }
+
+  /* 达到预算时让出事件循环. 水平触发时内核缓冲中的剩余数据会再次触发
+   * EV_READ, 而边沿触发时不会, SSL已解密的剩余数据也不会, 需主动激活读事件. */
+  if (total >= ReadDrainBudget && _readEvent &&
+      (_edgeTriggered ||
+       (_url._isSsl && _sslHandle && _sslHandle->sslPending() > 0))) {
+    event_active(_readEvent, EV_READ, 0);
+  }
+  return total;
+}
+
 /**
  * @brief: 接收一帧数据
  * @return: 成功接收的字节数, 失败则返回负值.
@@ -1844,9 +1997,11 @@ int ConnectNode::webSocketResponse() {
     return -(InvalidStatusWhenReleasing);
   }
 
-  uint8_t *frame = (uint8_t *)calloc(ReadBufferSize, sizeof(char));
+  /* 复用WorkThread的读缓冲区, 超出部分由_readEvBuffer承接 */
+  uint8_t *frame = _eventThread ? _eventThread->getReadBuffer() : NULL;
   if (frame == NULL) {
-    LOG_ERROR("%s %d calloc failed.", __func__, __LINE__);
+    LOG_ERROR("Node(%p) %s %d get read buffer failed.", this, __func__,
+              __LINE__);
     return 0;
   }
 
@@ -1855,19 +2010,19 @@ int ConnectNode::webSocketResponse() {
   gettimeofday(&timewait_start, NULL);
 #endif
 
+  utility::NlsMetrics::addCounter(utility::MetricReadWakeups);
+
   // receive buffer from SSL into _readEvBuffer
-  read_len = nlsReceive(frame, ReadBufferSize);
+  read_len = nlsReceiveDrain(frame, ReadBufferSize);
   if (read_len < 0) {
     LOG_ERROR("Request(%p Node(%p) nlsReceive failed, read_len:%d", _request,
               this, read_len);
-    free(frame);
     return -(NlsReceiveFailed);
   } else if (read_len == 0) {
 #ifdef ENABLE_NLS_DEBUG_2
     LOG_DEBUG("Request(%p) Node(%p) nlsReceive empty, read_len:%d", _request,
               this, read_len);
 #endif
-    free(frame);
     return 0;
 #ifdef ENABLE_NLS_DEBUG_2
   } else {
@@ -1883,36 +2038,26 @@ int ConnectNode::webSocketResponse() {
     ret = 0;
     size_t frameSize = evbuffer_get_length(_readEvBuffer);
     if (frameSize == 0) {
-      free(frame);
-      frame = NULL;
       ret = 0;
       break;
-    } else if (frameSize > ReadBufferSize) {
-      uint8_t *tmp = (uint8_t *)realloc(frame, frameSize + 1);
-      if (NULL == tmp) {
-        LOG_ERROR("Node(%p) realloc failed.", this);
-        free(frame);
-        frame = NULL;
-        ret = -(ReallocFailed);
-        break;
-      } else {
-        frame = tmp;
-        LOG_WARN("Node(%p) websocket frame realloc, new size:%d.", this,
-                 frameSize + 1);
-      }
+    }
 #ifdef ENABLE_NLS_DEBUG_2
-    } else {
-      LOG_DEBUG("Node(%p) nlsReceive %dbytes in readEvBuffer.", this,
-                frameSize);
+    LOG_DEBUG("Node(%p) nlsReceive %dbytes in readEvBuffer.", this, frameSize);
 #endif
-    }
 
+    /* 就地解析_readEvBuffer, 避免每解析一帧都拷贝一次全部剩余数据.
+     * 帧体完整后才会原地去掩码, 解析成功的帧随即被drain. */
     size_t cur_data_size = frameSize;
-    evbuffer_copyout(_readEvBuffer, frame, frameSize);
+    uint8_t *data = evbuffer_pullup(_readEvBuffer, -1);
+    if (data == NULL) {
+      LOG_ERROR("Node(%p) evbuffer_pullup %zubytes failed.", this, frameSize);
+      ret = -(ReallocFailed);
+      break;
+    }
 
     WebSocketFrame wsFrame;
     memset(&wsFrame, 0x0, sizeof(struct WebSocketFrame));
-    int recv_ret = _webSocket.receiveFullWebSocketFrame(frame, frameSize,
+    int recv_ret = _webSocket.receiveFullWebSocketFrame(data, frameSize,
                                                         &_wsType, &wsFrame);
     if (recv_ret == Success) {
       // LOG_DEBUG("Request(%p) Node(%p) parse websocket frame, len:%zu, frame
@@ -1965,10 +2110,12 @@ int ConnectNode::webSocketResponse() {
         }
       }
 
-      evbuffer_drain(_readEvBuffer, wsFrame.length + _wsType.headerSize);
-      cur_data_size = cur_data_size - (wsFrame.length + _wsType.headerSize);
+      /* 压缩帧解压后length为解压后的字节数, 按接收缓冲区中的载荷drain */
+      evbuffer_drain(_readEvBuffer, wsFrame.wireLength + _wsType.headerSize);
+      cur_data_size =
+          cur_data_size - (wsFrame.wireLength + _wsType.headerSize);
 
-      ret = wsFrame.length + _wsType.headerSize;
+      ret = wsFrame.wireLength + _wsType.headerSize;
       tryAgain = maxTryAgain;
     } else if (recv_ret == -(InvalidWsFrameHeaderSize) ||
                recv_ret == -(InvalidWsFrameHeaderBody)) {
@@ -1981,11 +2128,10 @@ int ConnectNode::webSocketResponse() {
 
         usleep(5 * 1000);
 
-        read_len = nlsReceive(frame, ReadBufferSize);
+        read_len = nlsReceiveDrain(frame, ReadBufferSize);
         if (read_len < 0) {
           LOG_ERROR("Request(%p) Node(%p) nlsReceive failed, read_len:%d",
                     _request, this, read_len);
-          if (frame) free(frame);
           return -(NlsReceiveFailed);
         } else {
           // LOG_WARN("Request(%p) Node(%p) nlsReceive again ...", _request,
@@ -2020,9 +2166,6 @@ int ConnectNode::webSocketResponse() {
     }
   } while (eLoop);
 
-  if (frame) free(frame);
-  frame = NULL;
-
 #ifdef ENABLE_NLS_DEBUG_2
   gettimeofday(&timewait_end, NULL);
   uint64_t time_consuming_a =
@@ -2196,6 +2339,19 @@ NlsEvent *ConnectNode::convertResult(WebSocketFrame *wsFrame, int *ret) {
   return NULL;
 }
 
+/**
+ * @brief: DashScope事件是否属于当前任务. 事件或当前请求没有task_id时视为属于.
+ * @return: 属于当前任务则为true
+ */
+bool ConnectNode::isCurrentDashTaskEvent(NlsEvent *frameEvent) {
+  const char *eventTaskId = frameEvent->getTaskId();
+  if (eventTaskId == NULL || eventTaskId[0] == '\0') {
+    return true;
+  }
+  const std::string &currentTaskId = _request->getRequestParam()->_taskId;
+  return currentTaskId.empty() || currentTaskId == eventTaskId;
+}
+
 /**
  * @brief: 解析websocket帧, 产出当前node的事件帧(frameEvent)
  * @return:
@@ -2294,6 +2450,21 @@ int ConnectNode::parseFrame(WebSocketFrame *wsFrame) {
     return -(InvalidExitStatus);
   }
 
+  /*
+   * DashScope协议下同一条连接可先后承载多个任务(预连接池复用),
+   * 按task_id分发事件, 丢弃不属于当前任务的残留事件.
+   */
+  if (_url._serviceProtocol == WsServiceProtocolDashScope &&
+      !isCurrentDashTaskEvent(frameEvent)) {
+    LOG_WARN(
+        "Node(%p) drop event(%s) of task_id(%s), current task_id is %s.",
+        this, frameEvent->getMsgTypeString().c_str(), frameEvent->getTaskId(),
+        _request->getRequestParam()->_taskId.c_str());
+    delete frameEvent;
+    frameEvent = NULL;
+    return Success;
+  }
+
   NlsEvent::EventType msg_type = frameEvent->getMsgType();
   switch (msg_type) {
     case NlsEvent::RecognitionStarted:
@@ -2358,13 +2529,15 @@ int ConnectNode::parseFrame(WebSocketFrame *wsFrame) {
         }
         if (singleRoundTextSize > 0) {
           _isSendSingleRoundText = true;
-          if (event_add(getSingleRoundTextEvent(), NULL) == Success) {
-            event_active(getSingleRoundTextEvent(), EV_READ, 0);
-          }
+          triggerAction(NodeTriggerSingleRoundText);
         }
       }
 #ifdef ENABLE_CONTINUED
       // reconnecting finished
+      if (_reconnection.state == NodeReconnection::NewReconnectionStarting &&
+          replayAudio() < 0) {
+        LOG_ERROR("Node(%p) replay audio failed.", this);
+      }
       _reconnection.state = NodeReconnection::NoReconnection;
 #endif
       break;
@@ -2558,7 +2731,7 @@ int ConnectNode::handlerFrame(NlsEvent *frameEvent) {
                frameEvent->getAllResponse());
     }
 #endif
-    updateNodeProcess("callback", frameEvent->getMsgType(), true,
+    updateNodeProcess(RecordCallback, frameEvent->getMsgType(), true,
                       frameEvent->getMsgType() == NlsEvent::Binary
                           ? frameEvent->getBinaryData().size()
                           : 0);
@@ -2591,6 +2764,9 @@ int ConnectNode::handlerFrame(NlsEvent *frameEvent) {
     timewait_c = utility::TextUtils::GetTimestampMs();
 #endif
 
+    updateTimelineWithEvent(frameEvent->getMsgType());
+    uint64_t callbackBeginUs = utility::TextUtils::GetMonotonicUs();
+
     /* callback to user */
     if (_enableOnMessage) {
       sendFinishCondSignal(NlsEvent::Message);
@@ -2620,12 +2796,17 @@ int ConnectNode::handlerFrame(NlsEvent *frameEvent) {
       }
 #endif
     }
+    if (!ignore_flag) {
+      utility::NlsMetrics::recordHistogram(
+          utility::MetricCallbackDuration,
+          utility::TextUtils::GetMonotonicUs() - callbackBeginUs);
+    }
 
 #ifdef ENABLE_NLS_DEBUG_2
     timewait_d = utility::TextUtils::GetTimestampMs();
 #endif
 #ifdef ENABLE_REQUEST_RECORDING
-    updateNodeProcess("callback", NodeInvalid, false, 0);
+    updateNodeProcess(RecordCallback, NodeInvalid, false, 0);
 #endif
 
     if (frameEvent->getMsgType() == NlsEvent::Close) {
@@ -2693,15 +2874,15 @@ void ConnectNode::handlerEvent(const char *errorMsg, int errorCode,
   if (error_str.empty()) {
     LOG_WARN("Node(%p) errorMsg is empty!", this);
   }
+  if (eventType == NlsEvent::Close) {
+    _timeline.closed_us = utility::TextUtils::GetMonotonicUs();
+  } else if (eventType == NlsEvent::TaskFailed) {
+    _traceContext.status_code = errorCode;
+  }
 #ifdef ENABLE_REQUEST_RECORDING
   if (eventType == NlsEvent::Close || eventType == NlsEvent::TaskFailed) {
-    if (eventType == NlsEvent::TaskFailed) {
-      _nodeProcess.last_op_timestamp_ms = utility::TextUtils::GetTimestampMs();
-      _nodeProcess.failed_timestamp_ms = _nodeProcess.last_op_timestamp_ms;
-    } else if (eventType == NlsEvent::Close) {
-      _nodeProcess.last_op_timestamp_ms = utility::TextUtils::GetTimestampMs();
-      _nodeProcess.closed_timestamp_ms = _nodeProcess.last_op_timestamp_ms;
-    }
+    _nodeProcess.record(
+        eventType == NlsEvent::TaskFailed ? RecordFailed : RecordClosed, true);
     error_str.assign(replenishNodeProcess(errorMsg));
     if (eventType == NlsEvent::TaskFailed) {
       LOG_ERROR("Node(%p) trigger message: %s", this, error_str.c_str());
@@ -2719,6 +2900,9 @@ void ConnectNode::handlerEvent(const char *errorMsg, int errorCode,
     LOG_ERROR("Node(%p) new NlsEvent failed.", this);
     return;
   }
+  if (eventType == NlsEvent::Close || eventType == NlsEvent::TaskFailed) {
+    useEvent->_requestTimeline = _timeline;
+  }
 
   if (eventType == NlsEvent::Close) {
     LOG_INFO("Node(%p) will callback NlsEvent::Close frame.", this);
@@ -2731,10 +2915,35 @@ void ConnectNode::handlerEvent(const char *errorMsg, int errorCode,
       LOG_WARN("Node(%p) NlsEvent::Close has invoked, skip CloseCallback.",
                this);
     } else {
+      if (eventType == NlsEvent::Close) {
+        traceFinish();
+      }
       handlerFrame(useEvent);
       if (eventType == NlsEvent::Close) {
+        MUTEX_LOCK(_mtxNode);
         _workStatus = NodeClosed;
+        bool startPending = _longConnectionStartPending;
+        _longConnectionStartPending = false;
+        MUTEX_UNLOCK(_mtxNode);
         LOG_INFO("Node(%p) callback NlsEvent::Close frame done.", this);
+
+        if (_isLongConnection && _syncCallTimeoutMs > 0) {
+          /* 唤醒waitLongConnectionClosed中等待NodeClosed的start */
+          bool useless_flag = false;
+#ifdef _MSC_VER
+          SET_EVENT(useless_flag, _mtxInvokeSyncCallNode);
+#else
+          SEND_COND_SIGNAL(_mtxInvokeSyncCallNode, _cvInvokeSyncCallNode,
+                           useless_flag);
+#endif
+        }
+
+        if (startPending) {
+          /* Close回调前用户已调用start, 在同一链接上开始下一轮交互 */
+          LOG_INFO("Node(%p) launch the pending start on long connection.",
+                   this);
+          triggerAction(NodeTriggerLongConnectionStart);
+        }
       } else {
         LOG_INFO("Node(%p) callback NlsEvent::%s frame done.", this,
                  useEvent->getMsgTypeString().c_str());
@@ -2856,131 +3065,67 @@ void ConnectNode::handlerTaskFailedEvent(std::string failedInfo, int code) {
 }
 
 #ifdef __LINUX__
-void *ConnectNode::async_dns_resolve_thread_fn(void *arg) {
-  pthread_detach(pthread_self());
-  ConnectNode *node = static_cast<ConnectNode *>(arg);
-  LOG_DEBUG("Node(%p) dnsThread(%lu) is working ...", node, pthread_self());
-
-  if (node->_gaicbRequest[0] == NULL) {
-    node->_gaicbRequest[0] =
-        (struct gaicb *)malloc(sizeof(*node->_gaicbRequest[0]));
+/**
+ * @brief: DnsResolverPool投递解析结果, 在解析线程中调用,
+ *         通过_dnsEvent将结果交给所属WorkThread处理
+ */
+void ConnectNode::sysDnsResolved(int errorCode,
+                                 struct evutil_addrinfo *address) {
+  if (_addrinfo) {
+    evutil_freeaddrinfo(_addrinfo);
   }
+  _dnsErrorCode = errorCode;
+  _addrinfo = address;
 
-  if (node->_gaicbRequest[0] == NULL) {
-    LOG_ERROR("Node(%p) malloc _gaicbRequest failed.", arg);
+  if (_eventThread == NULL) {
+    LOG_ERROR("The WorkThread of Node(%p) is nullptr.", this);
+    return;
+  }
+  if (_dnsEvent) {
+    event_del(_dnsEvent);
+    event_assign(_dnsEvent, _eventThread->_workBase, -1, EV_READ,
+                 WorkThread::sysDnsEventCallback, this);
   } else {
-    memset(node->_gaicbRequest[0], 0, sizeof(*node->_gaicbRequest[0]));
-    node->_gaicbRequest[0]->ar_name = node->_nodename;
-
-    int err = getaddrinfo_a(GAI_NOWAIT, node->_gaicbRequest, 1, NULL);
-    if (err) {
-      LOG_ERROR("Node(%p) getaddrinfo_a failed, err:%d(%s).", arg, err,
-                gai_strerror(err));
-    } else {
-      /* check this node is alive. */
-      if (node->_request == NULL) {
-        LOG_ERROR("The request of this node(%p) is nullptr.", node);
-        goto dnsExit;
-      }
-      NlsClientImpl *instance = node->getInstance();
-      NlsNodeManager *node_manager = instance->getNodeManger();
-      int status = NodeStatusInvalid;
-      int result = node_manager->checkNodeExist(node, &status);
-      if (result != Success) {
-        LOG_ERROR("Node(%p) checkNodeExist failed, result:%d.", node, result);
-        goto dnsExit;
-      }
+    _dnsEvent = event_new(_eventThread->_workBase, -1, EV_READ,
+                          WorkThread::sysDnsEventCallback, this);
+    if (NULL == _dnsEvent) {
+      LOG_ERROR("Node(%p) new event(_dnsEvent) failed.", this);
+      return;
+    }
+  }
+  event_add(_dnsEvent, NULL);
+  event_active(_dnsEvent, EV_READ, 0);
+  LOG_DEBUG("Node(%p) sys dns event_active done, err:%d.", this, errorCode);
+}
 
-      time_t timeout_ms =
-          node->getRequest()->getRequestParam()->getTimeout();  // ms
-      struct timespec outtime;
-      utility::TextUtils::GetTimespecFromMs(&outtime, timeout_ms);
-      // LOG_DEBUG("Node(%p) ready to gai_suspend.", arg);
-      err = gai_suspend(node->_gaicbRequest, 1, &outtime);
-      // LOG_DEBUG("Node(%p) gai_suspend finish, err:%d(%s).", node, err,
-      // gai_strerror(err));
-      if (node->_dnsThreadExit) {
-        LOG_WARN("Node(%p) ConnectNode is exiting, skip gai.", node);
-        goto dnsExit;
-      }
-      if (node->_dnsThread == 0) {
-        LOG_WARN("Node(%p) ConnectNode has exited, skip gai.", node);
-        goto dnsExit;
-      }
-      if (err) {
-        LOG_ERROR("Node(%p) gai_suspend failed, err:%d(%s).", arg, err,
-                  gai_strerror(err));
-        if (err == EAI_SYSTEM || err == EAI_AGAIN) {
-          LOG_ERROR(
-              "Node(%p) gai_suspend err:%d is mean timeout. please try again "
-              "...",
-              arg, err);
-        }
-      } else {
-        /* check this node is alive again after gai_suspend. */
-        result = node_manager->checkNodeExist(node, &status);
-        if (result != Success) {
-          LOG_ERROR("Node(%p) checkNodeExist failed, result:%d.", node, result);
-          goto dnsExit;
-        }
-
-        err = gai_error(node->_gaicbRequest[0]);
-        if (err) {
-          LOG_WARN("Node(%p) cannot get addrinfo, err:%d(%s).", arg, err,
-                   gai_strerror(err));
-        } else {
-          node->_addrinfo = node->_gaicbRequest[0]->ar_result;
-        }
-      }
-    }
-
-    node->_dnsErrorCode = err;
-    if (node->_dnsEvent) {
-      event_del(node->_dnsEvent);
-      event_assign(node->_dnsEvent, node->_eventThread->_workBase, -1, EV_READ,
-                   WorkThread::sysDnsEventCallback, node);
-    } else {
-      node->_dnsEvent = event_new(node->_eventThread->_workBase, -1, EV_READ,
-                                  WorkThread::sysDnsEventCallback, node);
-      if (NULL == node->_dnsEvent) {
-        LOG_ERROR("Node(%p) new event(_dnsEvent) failed.", node);
-        goto dnsExit;
-      }
-    }
-    event_add(node->_dnsEvent, NULL);
-    event_active(node->_dnsEvent, EV_READ, 0);
-    LOG_INFO("Node(%p) dnsThread(%lu) event_active done.", node,
-             pthread_self());
+/**
+ * @brief: 取消尚未投递的DnsResolverPool解析请求
+ */
+void ConnectNode::cancelSysDnsResolve() {
+  if (!_dnsResolving) {
+    return;
   }
-
-dnsExit:
-  if (node->_gaicbRequest[0]) {
-    free(node->_gaicbRequest[0]);
-    node->_gaicbRequest[0] = NULL;
+  DnsResolverPool *pool = NULL;
+  if (NlsEventNetWork::_eventClient) {
+    pool = NlsEventNetWork::_eventClient->getDnsResolverPool();
+  }
+  if (pool) {
+    pool->cancel(this);
   }
-  node->_dnsThread = 0;
-  node->_dnsThreadRunning = false;
-  LOG_INFO("Node(%p) dnsThread(%lu) is exited.", node, pthread_self());
-  pthread_exit(NULL);
 }
 
 /**
- * @brief: 异步方式使用系统的getaddrinfo()方法获得dns
+ * @brief: 使用系统的getaddrinfo()方法获得dns, 由DnsResolverPool异步解析
  * @return: 成功则为0, 否则为失败
  */
-static int native_getaddrinfo(const char *nodename, const char *servname,
-                              evdns_getaddrinfo_cb cb, void *arg) {
-  ConnectNode *node = static_cast<ConnectNode *>(arg);
+static int native_getaddrinfo(const char *nodename, int aiFamily,
+                              ConnectNode *node) {
   NlsNodeManager *node_manager = node->getInstance()->getNodeManger();
   int status = NodeStatusInvalid;
   int result = node_manager->checkNodeExist(node, &status);
   if (result != Success) {
     LOG_ERROR("Node(%p) checkNodeExist failed, result:%d.", node, result);
     return result;
-  } else {
-    LOG_DEBUG(
-        "Node(%p) use native_getaddrinfo, ready to create dnsThread(%lu).",
-        node, node->_dnsThread);
   }
 
   if (node->getExitStatus() == ExitCancel) {
@@ -2988,27 +3133,18 @@ static int native_getaddrinfo(const char *nodename, const char *servname,
     return -(CancelledExitStatus);
   }
 
-  MUTEX_LOCK(node->_mtxNode);
-
-  node->_dnsThreadRunning = true;
-  node->_nodename = (char *)nodename;
-  node->_servname = (char *)servname;
-
-  if (node->_dnsThread) {
-    pthread_join(node->_dnsThread, NULL);
+  DnsResolverPool *pool = NULL;
+  if (NlsEventNetWork::_eventClient) {
+    pool = NlsEventNetWork::_eventClient->getDnsResolverPool();
   }
-  int err = pthread_create(&node->_dnsThread, NULL,
-                           &ConnectNode::async_dns_resolve_thread_fn, arg);
-  if (err) {
-    node->_dnsThreadRunning = false;
-    LOG_ERROR("Node(%p) dnsThread(%lu) create failed.", node, node->_dnsThread);
-  } else {
-    LOG_DEBUG("Node(%p) dnsThread(%lu) create success.", node,
-              node->_dnsThread);
+  if (pool == NULL) {
+    LOG_ERROR("Node(%p) DnsResolverPool is nullptr.", node);
+    return -(GetAddrinfoFailed);
   }
 
-  MUTEX_UNLOCK(node->_mtxNode);
-  return err;
+  unsigned int timeout_ms =
+      node->getRequest()->getRequestParam()->getTimeout();  // ms
+  return pool->resolve(node, nodename, aiFamily, timeout_ms);
 }
 #endif
 
@@ -3054,6 +3190,9 @@ int ConnectNode::dnsProcess(int aiFamily, char *directIp, bool sysGetAddr) {
     return Success;
   }
 
+  _timeline.dns_begin_us = utility::TextUtils::GetMonotonicUs();
+  _timeline.dns_end_us = 0;
+
   /* 尝试链接校验 */
   if (!checkConnectCount()) {
     LOG_ERROR("Node(%p) restart connect failed.", this);
@@ -3093,9 +3232,19 @@ int ConnectNode::dnsProcess(int aiFamily, char *directIp, bool sysGetAddr) {
     }
 
 #ifdef ENABLE_DNS_IP_CACHE
-    std::string tmp_ip = _eventThread->getIpFromCache(
-        (char *)_request->getRequestParam()->_url.c_str());
-    if (tmp_ip.length() > 0) {
+    std::vector<struct ConnectCandidate> candidates;
+    _eventThread->getIpListFromCache(
+        (char *)_request->getRequestParam()->_url.c_str(), candidates);
+    std::string tmp_ip;
+    if (candidates.size() > 1 && connectRaceProcess(candidates) > 0) {
+      LOG_INFO("Node(%p) find %d IPs in cache, race to connect.", this,
+               candidates.size());
+#ifdef ENABLE_REQUEST_RECORDING
+      _nodeProcess.connect_type = ConnectWithIpCache;
+#endif
+    } else if ((tmp_ip = _eventThread->getIpFromCache(
+                    (char *)_request->getRequestParam()->_url.c_str()))
+                   .length() > 0) {
       LOG_INFO("Node(%p) find IP in cache, connect directly.", this);
       // 从dns cache中获得IP进行直连
 #ifdef ENABLE_REQUEST_RECORDING
@@ -3121,8 +3270,7 @@ int ConnectNode::dnsProcess(int aiFamily, char *directIp, bool sysGetAddr) {
          * 在内部ws协议下或者主动使用系统getaddrinfo_a的情况下,
          * 使用系统的getaddrinfo_a()
          */
-        result = native_getaddrinfo(_url._host, NULL,
-                                    WorkThread::dnsEventCallback, this);
+        result = native_getaddrinfo(_url._host, aiFamily, this);
         if (result != Success) {
           result = -(GetAddrinfoFailed);
         }
@@ -3144,12 +3292,11 @@ int ConnectNode::dnsProcess(int aiFamily, char *directIp, bool sysGetAddr) {
             evdns_getaddrinfo(_eventThread->_dnsBase, _url._host, NULL, &hints,
                               WorkThread::dnsEventCallback, this);
         if (_dnsRequest == NULL) {
-          LOG_ERROR("Node:%p dnsRequest evdns_getaddrinfo failed!", this);
           /*
-           * No need to free user_data ordecrement n_pending_requests; that
-           * happened in the callback.
+           * evdns_getaddrinfo返回NULL表示回调已同步执行(如host为IP),
+           * 成功或失败均已在dnsEventCallback中处理, 此处不能再释放node.
            */
-          return -(InvalidDnsSource);
+          LOG_DEBUG("Node(%p) evdns_getaddrinfo has been answered.", this);
         }
       }
     }
@@ -3164,6 +3311,7 @@ int ConnectNode::dnsProcess(int aiFamily, char *directIp, bool sysGetAddr) {
  */
 int ConnectNode::connectProcess(const char *ip, int aiFamily) {
   EXIT_CANCEL_CHECK(_exitStatus, this);
+  markTimelineConnectBegin();
   evutil_socket_t sockFd = socket(aiFamily, SOCK_STREAM, 0);
   if (sockFd < 0) {
     LOG_ERROR("Node(%p) socket failed. aiFamily:%d, sockFd:%d. error mesg:%s.",
@@ -3182,6 +3330,7 @@ int ConnectNode::connectProcess(const char *ip, int aiFamily) {
     LOG_ERROR("Node(%p) set SO_LINGER failed.", this);
     return -(SetSocketoptFailed);
   }
+  applySocketOptions(sockFd);
 
   if (evutil_make_socket_nonblocking(sockFd) < 0) {
     LOG_ERROR("Node(%p) evutil_make_socket_nonblocking failed.", this);
@@ -3191,67 +3340,344 @@ int ConnectNode::connectProcess(const char *ip, int aiFamily) {
   LOG_INFO("Node(%p) new socket ip:%s port:%d Fd:%d.", this, ip, _url._port,
            sockFd);
 
-  short events = EV_READ | EV_WRITE | EV_TIMEOUT | EV_FINALIZE;
-  // LOG_DEBUG("Node(%p) set events(%d) for connectEventCallback.", this,
-  // events);
-  if (NULL == _connectEvent) {
-    _connectEvent = event_new(_eventThread->_workBase, sockFd, events,
-                              WorkThread::connectEventCallback, this);
-    if (NULL == _connectEvent) {
-      LOG_ERROR("Node(%p) new event(_connectEvent) failed.", this);
-      return -(EventEmpty);
-    }
-  } else {
-    event_del(_connectEvent);
-    event_assign(_connectEvent, _eventThread->_workBase, sockFd, events,
-                 WorkThread::connectEventCallback, this);
+  int ret = assignSocketEvents(sockFd, ip, aiFamily);
+  if (ret < 0) {
+    return ret;
   }
 
-#ifdef ENABLE_HIGH_EFFICIENCY
-  if (NULL == _connectTimerEvent) {
-    _connectTimerEvent = evtimer_new(
-        _eventThread->_workBase, WorkThread::connectTimerEventCallback, this);
-    if (NULL == _connectTimerEvent) {
-      LOG_ERROR("Node(%p) new event(_connectTimerEvent) failed.", this);
-      return -(EventEmpty);
+  return socketConnect();
+}
+
+/**
+ * @brief: 按请求或NlsClient设置的NlsSocketOptions调整socket内核参数,
+ *         需在connect之前调用以使SO_SNDBUF/SO_RCVBUF影响TCP窗口.
+ *         设置失败仅告警, 不影响建连.
+ */
+void ConnectNode::applySocketOptions(evutil_socket_t sockFd) {
+  NlsSocketOptions options;
+  if (_request && _request->getRequestParam()->_customSocketOptions) {
+    options = _request->getRequestParam()->_socketOptions;
+  } else if (_instance) {
+    options = _instance->getSocketOptions();
+  }
+
+  if (options.tcp_nodelay) {
+    int on = 1;
+    if (setsockopt(sockFd, IPPROTO_TCP, TCP_NODELAY, (char *)&on,
+                   sizeof(on)) < 0) {
+      LOG_WARN("Node(%p) set TCP_NODELAY of Fd:%d failed.", this, sockFd);
+    }
+  }
+  if (options.send_buffer_bytes > 0) {
+    if (setsockopt(sockFd, SOL_SOCKET, SO_SNDBUF,
+                   (char *)&options.send_buffer_bytes,
+                   sizeof(options.send_buffer_bytes)) < 0) {
+      LOG_WARN("Node(%p) set SO_SNDBUF(%d) of Fd:%d failed.", this,
+               options.send_buffer_bytes, sockFd);
+    }
+  }
+  if (options.recv_buffer_bytes > 0) {
+    if (setsockopt(sockFd, SOL_SOCKET, SO_RCVBUF,
+                   (char *)&options.recv_buffer_bytes,
+                   sizeof(options.recv_buffer_bytes)) < 0) {
+      LOG_WARN("Node(%p) set SO_RCVBUF(%d) of Fd:%d failed.", this,
+               options.recv_buffer_bytes, sockFd);
+    }
+  }
+#if defined(__linux__) && defined(TCP_USER_TIMEOUT)
+  if (options.user_timeout_ms > 0) {
+    if (setsockopt(sockFd, IPPROTO_TCP, TCP_USER_TIMEOUT,
+                   &options.user_timeout_ms,
+                   sizeof(options.user_timeout_ms)) < 0) {
+      LOG_WARN("Node(%p) set TCP_USER_TIMEOUT(%u) of Fd:%d failed.", this,
+               options.user_timeout_ms, sockFd);
+    }
+  }
+#endif
+#if defined(__GNUC__) && defined(TCP_NOTSENT_LOWAT)
+  if (options.notsent_lowat_bytes > 0) {
+    if (setsockopt(sockFd, IPPROTO_TCP, TCP_NOTSENT_LOWAT,
+                   &options.notsent_lowat_bytes,
+                   sizeof(options.notsent_lowat_bytes)) < 0) {
+      LOG_WARN("Node(%p) set TCP_NOTSENT_LOWAT(%u) of Fd:%d failed.", this,
+               options.notsent_lowat_bytes, sockFd);
     }
   }
 #endif
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+  if (options.busy_poll_us > 0) {
+    /* 超过net.core.busy_poll时需要CAP_NET_ADMIN权限 */
+    if (setsockopt(sockFd, SOL_SOCKET, SO_BUSY_POLL, &options.busy_poll_us,
+                   sizeof(options.busy_poll_us)) < 0) {
+      LOG_WARN("Node(%p) set SO_BUSY_POLL(%u) of Fd:%d failed.", this,
+               options.busy_poll_us, sockFd);
+    }
+  }
+#endif
+}
 
-  if (_enableRecvTv) {
-    events = EV_READ | EV_TIMEOUT | EV_PERSIST | EV_FINALIZE;
-  } else {
-    events = EV_READ | EV_PERSIST | EV_FINALIZE;
+/**
+ * @brief: 将socket绑定到本节点的读写事件及超时定时器.
+ *         事件后端支持边沿触发时, 读写共用一个持久的_readEvent, 整个链接
+ *         只注册一次epoll, 不再随每次未写完的发送反复增删_writeEvent;
+ *         否则保持水平触发的_readEvent和_writeEvent.
+ *         收发超时不再挂在读写事件上, 统一由时间轮中的_timeoutEntry处理.
+ * @return: 成功则为0, 失败则负值.
+ */
+int ConnectNode::assignSocketIoEvents(evutil_socket_t sockFd) {
+  _edgeTriggered = _eventThread->isEdgeTriggered();
+  _pendingReadError = 0;
+  short events = EV_READ | EV_PERSIST | EV_FINALIZE;
+  event_callback_fn callback = WorkThread::readEventCallBack;
+  if (_edgeTriggered) {
+    events |= EV_WRITE | EV_ET;
+    callback = WorkThread::socketEventCallBack;
   }
   // LOG_DEBUG("Node(%p) set events(%d) for readEventCallback with sockFd(%d)",
   //           this, events, sockFd);
   if (NULL == _readEvent) {
-    _readEvent = event_new(_eventThread->_workBase, sockFd, events,
-                           WorkThread::readEventCallBack, this);
+    _readEvent =
+        event_new(_eventThread->_workBase, sockFd, events, callback, this);
     if (NULL == _readEvent) {
       LOG_ERROR("Node(%p) new event(_readEvent) failed.", this);
       return -(EventEmpty);
     }
   } else {
     event_del(_readEvent);
-    event_assign(_readEvent, _eventThread->_workBase, sockFd, events,
-                 WorkThread::readEventCallBack, this);
+    event_assign(_readEvent, _eventThread->_workBase, sockFd, events, callback,
+                 this);
   }
 
-  events = EV_WRITE | EV_TIMEOUT | EV_FINALIZE;
-  // LOG_DEBUG("Node(%p) set events(%d) for writeEventCallback with sockFd(%d)",
-  //           this, events, sockFd);
-  if (NULL == _writeEvent) {
-    _writeEvent = event_new(_eventThread->_workBase, sockFd, events,
-                            WorkThread::writeEventCallBack, this);
+  if (_edgeTriggered) {
+    if (_writeEvent) {
+      event_del(_writeEvent);
+      event_free(_writeEvent);
+      _writeEvent = NULL;
+    }
+  } else {
+    events = EV_WRITE | EV_FINALIZE;
     if (NULL == _writeEvent) {
-      LOG_ERROR("Node(%p) new event(_writeEvent) failed.", this);
+      _writeEvent = event_new(_eventThread->_workBase, sockFd, events,
+                              WorkThread::writeEventCallBack, this);
+      if (NULL == _writeEvent) {
+        LOG_ERROR("Node(%p) new event(_writeEvent) failed.", this);
+        return -(EventEmpty);
+      }
+    } else {
+      event_del(_writeEvent);
+      event_assign(_writeEvent, _eventThread->_workBase, sockFd, events,
+                   WorkThread::writeEventCallBack, this);
+    }
+  }
+
+  resetTimeouts();
+  return Success;
+}
+
+/**
+ * @brief: 握手完成后开始监听socket读写, 并开始计算接收超时.
+ * @return: 成功则为0, 失败则负值.
+ */
+int ConnectNode::addSocketEvent() {
+  if (NULL == _readEvent) {
+    LOG_ERROR("Node(%p) _readEvent is nullptr.", this);
+    return -(EventEmpty);
+  }
+
+  if (_edgeTriggered && _connectEvent) {
+    /* 同一fd上不能混用边沿触发和水平触发的事件, 建连已完成, 移除_connectEvent */
+    event_del(_connectEvent);
+  }
+  clearTimeout(NodeTimeoutConnect);
+  clearTimeout(NodeTimeoutConnectPoll);
+  if (event_add(_readEvent, NULL) != Success) {
+    LOG_ERROR("Node(%p) add _readEvent with sockFd(%d) failed.", this,
+              _socketFd);
+    return -(EventEmpty);
+  }
+
+  refreshRecvTimeout();
+  return Success;
+}
+
+/**
+ * @brief: 待发送数据未能一次写完, 等待socket可写后由writeEventCallBack继续发送.
+ *         边沿触发时_readEvent一直监听着EV_WRITE, 但只有socket写满后才会再有
+ *         可写边沿, 因此仅受单次发送切片限制而未写完时需主动激活.
+ * @param blocked: 本次发送是否因socket发送缓冲区已满而未写完
+ * @return: 成功则为0, 失败则负值.
+ */
+int ConnectNode::waitWritable(bool blocked) {
+  if (_request) {
+    updateTimeout(NodeTimeoutSend,
+                  _request->getRequestParam()->getSendTimeout());
+  }
+
+  if (_edgeTriggered) {
+    if (NULL == _readEvent) {
+      return -(EventEmpty);
+    }
+    if (!blocked) {
+      event_active(_readEvent, EV_WRITE, 0);
+    }
+    return Success;
+  }
+
+  if (NULL == _writeEvent) {
+    return -(EventEmpty);
+  }
+  event_add(_writeEvent, NULL);
+  return Success;
+}
+
+/**
+ * @brief: 边沿触发时可写事件会随每次读事件一并上报,
+ *         仅在处于发送阶段且有待发送数据时才需要交给writeEventCallBack.
+ */
+bool ConnectNode::needWritable() {
+  switch (getConnectNodeStatus()) {
+    case NodeHandshaked:
+    case NodeStarting:
+      return evbuffer_get_length(_cmdEvBuffer) > 0;
+    case NodeWakeWording:
+      return evbuffer_get_length(_wwvEvBuffer) > 0 ||
+             evbuffer_get_length(_cmdEvBuffer) > 0;
+    case NodeStarted:
+      return evbuffer_get_length(_binaryEvBuffer) > 0 ||
+             evbuffer_get_length(_cmdEvBuffer) > 0;
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief: 收到数据后顺延接收超时.
+ */
+void ConnectNode::refreshRecvTimeout() {
+  if (_enableRecvTv && _request) {
+    updateTimeout(NodeTimeoutRecv,
+                  _request->getRequestParam()->getRecvTimeout());
+  }
+}
+
+/**
+ * @brief: _timeoutEntry在时间轮中到期后检查各类超时,
+ *         均未超时则按最近的超时时刻重新加入时间轮.
+ * @return: 已超时的类型, 均未超时则返回NodeTimeoutNumber.
+ */
+NodeTimeoutType ConnectNode::checkTimeout() {
+  NodeTimeoutType ret = NodeTimeoutNumber;
+  uint64_t now = TimerWheel::nowMs();
+  uint64_t next = 0;
+  MUTEX_LOCK(_mtxTimeout);
+  _timeoutFireMs = 0;
+  for (int i = 0; i < NodeTimeoutNumber; i++) {
+    if (_deadlineMs[i] == 0) {
+      continue;
+    }
+    if (_deadlineMs[i] <= now && ret == NodeTimeoutNumber) {
+      _deadlineMs[i] = 0;
+      ret = (NodeTimeoutType)i;
+      continue;
+    }
+    /* 同时到期的其他超时留到下一个tick处理 */
+    if (next == 0 || _deadlineMs[i] < next) {
+      next = _deadlineMs[i];
+    }
+  }
+  if (next > 0 && _timeoutEnabled) {
+    scheduleTimeoutLocked(next);
+  }
+  MUTEX_UNLOCK(_mtxTimeout);
+  return ret;
+}
+
+/**
+ * @brief: 清除之前的超时时刻, 之后的超时加入当前WorkThread的时间轮.
+ */
+void ConnectNode::resetTimeouts() {
+  MUTEX_LOCK(_mtxTimeout);
+  if (_timeoutWheel) {
+    _timeoutWheel->cancel(&_timeoutEntry);
+    _timeoutWheel = NULL;
+  }
+  memset(_deadlineMs, 0, sizeof(_deadlineMs));
+  _timeoutFireMs = 0;
+  _timeoutEnabled = true;
+  MUTEX_UNLOCK(_mtxTimeout);
+}
+
+/**
+ * @brief: 释放事件时移出时间轮, 返回后时间轮不再回调本节点.
+ */
+void ConnectNode::cancelTimeouts() {
+  MUTEX_LOCK(_mtxTimeout);
+  if (_timeoutWheel) {
+    _timeoutWheel->cancel(&_timeoutEntry);
+    _timeoutWheel = NULL;
+  }
+  memset(_deadlineMs, 0, sizeof(_deadlineMs));
+  _timeoutFireMs = 0;
+  _timeoutEnabled = false;
+  MUTEX_UNLOCK(_mtxTimeout);
+}
+
+/**
+ * @brief: 设置或取消某类超时. 只记录超时时刻, 仅当其早于_timeoutEntry
+ *         当前的到期时刻时才在时间轮中移动, 每次收发的顺延都是O(1),
+ *         由到期时再按最新的超时时刻判断.
+ * @param type: 超时类型
+ * @param timeoutMs: 超时时长, 0为取消
+ */
+void ConnectNode::updateTimeout(NodeTimeoutType type, unsigned int timeoutMs) {
+  uint64_t deadline = timeoutMs > 0 ? TimerWheel::nowMs() + timeoutMs : 0;
+  MUTEX_LOCK(_mtxTimeout);
+  _deadlineMs[type] = deadline;
+  if (deadline > 0 && _timeoutEnabled &&
+      (_timeoutFireMs == 0 || deadline < _timeoutFireMs)) {
+    scheduleTimeoutLocked(deadline);
+  }
+  MUTEX_UNLOCK(_mtxTimeout);
+}
+
+void ConnectNode::scheduleTimeoutLocked(uint64_t deadlineMs) {
+  TimerWheel *wheel = _eventThread ? _eventThread->getTimerWheel() : NULL;
+  if (_timeoutWheel && _timeoutWheel != wheel) {
+    /* 节点换了WorkThread, 从原线程的时间轮中移出 */
+    _timeoutWheel->cancel(&_timeoutEntry);
+  }
+  _timeoutWheel = wheel;
+  if (wheel) {
+    wheel->schedule(&_timeoutEntry, deadlineMs);
+    _timeoutFireMs = deadlineMs;
+  }
+}
+
+/**
+ * @brief: 将socket绑定到本节点的connect/read/write事件, 并设置目标地址.
+ * @return: 成功则为0, 失败则负值.
+ */
+int ConnectNode::assignSocketEvents(evutil_socket_t sockFd, const char *ip,
+                                    int aiFamily) {
+  short events = EV_READ | EV_WRITE | EV_TIMEOUT | EV_FINALIZE;
+  // LOG_DEBUG("Node(%p) set events(%d) for connectEventCallback.", this,
+  // events);
+  if (NULL == _connectEvent) {
+    _connectEvent = event_new(_eventThread->_workBase, sockFd, events,
+                              WorkThread::connectEventCallback, this);
+    if (NULL == _connectEvent) {
+      LOG_ERROR("Node(%p) new event(_connectEvent) failed.", this);
       return -(EventEmpty);
     }
   } else {
-    event_del(_writeEvent);
-    event_assign(_writeEvent, _eventThread->_workBase, sockFd, events,
-                 WorkThread::writeEventCallBack, this);
+    event_del(_connectEvent);
+    event_assign(_connectEvent, _eventThread->_workBase, sockFd, events,
+                 WorkThread::connectEventCallback, this);
+  }
+
+  int ret = assignSocketIoEvents(sockFd);
+  if (ret < 0) {
+    return ret;
   }
 
   _aiFamily = aiFamily;
@@ -3278,13 +3704,262 @@ int ConnectNode::connectProcess(const char *ip, int aiFamily) {
   }
 
   _socketFd = sockFd;
+  return Success;
+}
 
-  return socketConnect();
+
+/**
+ * @brief: Happy Eyeballs(RFC 8305), 对多个候选地址错峰并行建连,
+ *         保留最先建连成功的socket, 其余的关闭.
+ * @return: 正在建连则为1, 失败则负值.
+ */
+int ConnectNode::connectRaceProcess(
+    std::vector<struct ConnectCandidate> &candidates) {
+  EXIT_CANCEL_CHECK(_exitStatus, this);
+  cancelConnectRace();
+  if (candidates.empty() || _eventThread == NULL) {
+    return -(SocketConnectFailed);
+  }
+
+  _eventThread->sortConnectCandidates(candidates);
+  _connectCandidates = candidates;
+  _nextConnectCandidate = 0;
+  _connectRaceBeginMs = utility::TextUtils::GetTimestampMs();
+  markTimelineConnectBegin();
+
+  if (NULL == getTriggerEvent()) {
+    _connectCandidates.clear();
+    return -(EventEmpty);
+  }
+
+  LOG_INFO("Node(%p) begin connect race with %d candidates.", this,
+           _connectCandidates.size());
+
+  int ret = startNextConnectAttempt();
+  if (ret < 0) {
+    cancelConnectRace();
+  }
+  return ret;
+}
+
+/**
+ * @brief: 对下一个候选地址发起connect(), 并设置下一次错峰建连的定时器.
+ * @return: 仍有建连尝试进行中则为1, 全部失败则负值.
+ */
+int ConnectNode::startNextConnectAttempt() {
+  EXIT_CANCEL_CHECK(_exitStatus, this);
+  while (_nextConnectCandidate < _connectCandidates.size()) {
+    struct ConnectCandidate &candidate =
+        _connectCandidates[_nextConnectCandidate++];
+    const char *ip = candidate.ip.c_str();
+
+    struct sockaddr_storage addr;
+    socklen_t addrLen = 0;
+    memset(&addr, 0, sizeof(addr));
+    if (candidate.aiFamily == AF_INET6) {
+      struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)&addr;
+      sin6->sin6_family = AF_INET6;
+      sin6->sin6_port = htons(_url._port);
+      if (inet_pton(AF_INET6, ip, &sin6->sin6_addr) <= 0) {
+        LOG_ERROR("Node(%p) IpV6 %s inet_pton failed.", this, ip);
+        continue;
+      }
+      addrLen = sizeof(struct sockaddr_in6);
+    } else {
+      struct sockaddr_in *sin = (struct sockaddr_in *)&addr;
+      sin->sin_family = AF_INET;
+      sin->sin_port = htons(_url._port);
+      if (inet_pton(AF_INET, ip, &sin->sin_addr) <= 0) {
+        LOG_ERROR("Node(%p) IpV4 %s inet_pton failed.", this, ip);
+        continue;
+      }
+      addrLen = sizeof(struct sockaddr_in);
+    }
+
+    evutil_socket_t sockFd = socket(candidate.aiFamily, SOCK_STREAM, 0);
+    if (sockFd < 0) {
+      LOG_ERROR("Node(%p) socket failed. aiFamily:%d, error mesg:%s.", this,
+                candidate.aiFamily,
+                evutil_socket_error_to_string(evutil_socket_geterror(sockFd)));
+      continue;
+    }
+
+    struct linger so_linger;
+    so_linger.l_onoff = 1;
+    so_linger.l_linger = 0;
+    if (setsockopt(sockFd, SOL_SOCKET, SO_LINGER, (char *)&so_linger,
+                   sizeof(struct linger)) < 0 ||
+        evutil_make_socket_nonblocking(sockFd) < 0) {
+      LOG_ERROR("Node(%p) set socket option of Fd:%d failed.", this, sockFd);
+      evutil_closesocket(sockFd);
+      continue;
+    }
+    applySocketOptions(sockFd);
+
+    uint64_t startMs = utility::TextUtils::GetTimestampMs();
+    if (connect(sockFd, (const sockaddr *)&addr, addrLen) == -1) {
+      int connectErrCode = utility::getLastErrorCode();
+      if (!NLS_ERR_CONNECT_RETRIABLE(connectErrCode)) {
+        LOG_WARN("Node(%p) connect %s failed immediately, errno:%d.", this, ip,
+                 connectErrCode);
+        _eventThread->updateAddrConnectStat(candidate.ip, false, 0);
+        evutil_closesocket(sockFd);
+        continue;
+      }
+    }
+
+    struct ConnectAttempt *attempt = new ConnectAttempt();
+    attempt->node = this;
+    attempt->ip = candidate.ip;
+    attempt->aiFamily = candidate.aiFamily;
+    attempt->socketFd = sockFd;
+    attempt->startTimestampMs = startMs;
+    /* 非阻塞connect()完成后socket可写, 立即完成的connect()也会马上触发 */
+    attempt->event = event_new(_eventThread->_workBase, sockFd, EV_WRITE,
+                               WorkThread::connectRaceEventCallback, attempt);
+    if (NULL == attempt->event) {
+      LOG_ERROR("Node(%p) new event of connect attempt failed.", this);
+      evutil_closesocket(sockFd);
+      delete attempt;
+      continue;
+    }
+    event_add(attempt->event, NULL);
+    _connectAttempts.push_back(attempt);
+
+    LOG_INFO("Node(%p) connect attempt(%d/%d) ip:%s port:%d Fd:%d.", this,
+             _nextConnectCandidate, _connectCandidates.size(), ip, _url._port,
+             sockFd);
+    break;
+  }
+
+  if (_connectAttempts.empty()) {
+    LOG_ERROR("Node(%p) all connect attempts failed.", this);
+    return -(SocketConnectFailed);
+  }
+
+  if (_nextConnectCandidate < _connectCandidates.size()) {
+    triggerAction(NodeTriggerConnectRace, ConnectAttemptDelayMs);
+  } else {
+    /* 已无候选地址, 定时器用于整体建连超时 */
+    time_t timeout_ms = _request->getRequestParam()->getTimeout();
+    time_t elapsed_ms = (time_t)(utility::TextUtils::GetTimestampMs() -
+                                 _connectRaceBeginMs);
+    time_t remain_ms = timeout_ms > elapsed_ms ? timeout_ms - elapsed_ms : 1;
+    triggerAction(NodeTriggerConnectRace, (unsigned int)remain_ms);
+  }
+  return 1;
+}
+
+/**
+ * @brief: 某个建连尝试成功, 关闭其余尝试并将获胜的socket交给本节点.
+ * @return: 成功则为0, 失败则负值.
+ */
+int ConnectNode::winConnectRace(struct ConnectAttempt *attempt) {
+  std::vector<struct ConnectAttempt *>::iterator iter =
+      std::find(_connectAttempts.begin(), _connectAttempts.end(), attempt);
+  if (iter == _connectAttempts.end()) {
+    LOG_ERROR("Node(%p) cannot find connect attempt(%p).", this, attempt);
+    return -(SocketConnectFailed);
+  }
+  _connectAttempts.erase(iter);
+
+  std::string ip = attempt->ip;
+  int aiFamily = attempt->aiFamily;
+  evutil_socket_t sockFd = attempt->socketFd;
+  uint64_t rttMs =
+      utility::TextUtils::GetTimestampMs() - attempt->startTimestampMs;
+  _eventThread->updateAddrConnectStat(ip, true, rttMs);
+  LOG_INFO("Node(%p) win connect race with ip:%s Fd:%d, rtt:%llums.", this,
+           ip.c_str(), sockFd, rttMs);
+
+  if (attempt->event) {
+    event_free(attempt->event);
+    attempt->event = NULL;
+  }
+  delete attempt;
+
+  /* 关闭其余的建连尝试 */
+  cancelConnectRace();
+
+  int ret = assignSocketEvents(sockFd, ip.c_str(), aiFamily);
+  if (ret < 0 && _socketFd != sockFd) {
+    evutil_closesocket(sockFd);
+  }
+  return ret;
+}
+
+/**
+ * @brief: 某个建连尝试失败, 关闭它并立即开始下一个候选地址的建连.
+ * @return: 仍有建连尝试进行中则为1, 全部失败则负值.
+ */
+int ConnectNode::failConnectAttempt(struct ConnectAttempt *attempt) {
+  std::vector<struct ConnectAttempt *>::iterator iter =
+      std::find(_connectAttempts.begin(), _connectAttempts.end(), attempt);
+  if (iter != _connectAttempts.end()) {
+    _connectAttempts.erase(iter);
+  }
+
+  LOG_WARN("Node(%p) connect attempt with ip:%s Fd:%d failed.", this,
+           attempt->ip.c_str(), attempt->socketFd);
+  _eventThread->updateAddrConnectStat(attempt->ip, false, 0);
+  utility::NlsMetrics::addCounter(utility::MetricConnectFailed);
+  if (attempt->event) {
+    event_free(attempt->event);
+    attempt->event = NULL;
+  }
+  if (attempt->socketFd != INVALID_SOCKET) {
+    evutil_closesocket(attempt->socketFd);
+    attempt->socketFd = INVALID_SOCKET;
+  }
+  delete attempt;
+
+  if (_nextConnectCandidate < _connectCandidates.size()) {
+    return startNextConnectAttempt();
+  }
+  return _connectAttempts.empty() ? -(SocketConnectFailed) : 1;
+}
+
+/**
+ * @brief: 整体建连是否已超时
+ * @return:
+ */
+bool ConnectNode::connectRaceTimeout() {
+  uint64_t timeout_ms = _request->getRequestParam()->getTimeout();
+  return utility::TextUtils::GetTimestampMs() - _connectRaceBeginMs >=
+         timeout_ms;
+}
+
+/**
+ * @brief: 关闭所有未完成的建连尝试, 释放定时器.
+ * @return:
+ */
+void ConnectNode::cancelConnectRace() {
+  std::vector<struct ConnectAttempt *>::iterator iter;
+  for (iter = _connectAttempts.begin(); iter != _connectAttempts.end();
+       ++iter) {
+    struct ConnectAttempt *attempt = *iter;
+    if (attempt->event) {
+      event_del(attempt->event);
+      event_free(attempt->event);
+      attempt->event = NULL;
+    }
+    if (attempt->socketFd != INVALID_SOCKET) {
+      evutil_closesocket(attempt->socketFd);
+      attempt->socketFd = INVALID_SOCKET;
+    }
+    delete attempt;
+  }
+  _connectAttempts.clear();
+
+  cancelAction(NodeTriggerConnectRace);
+  _connectCandidates.clear();
+  _nextConnectCandidate = 0;
 }
 
 #ifdef ENABLE_PRECONNECTED_POOL
 int ConnectNode::syncConnectProcess(const char *ip, int aiFamily) {
   EXIT_CANCEL_CHECK(_exitStatus, this);
+  markTimelineConnectBegin();
   evutil_socket_t sockFd = socket(aiFamily, SOCK_STREAM, 0);
   if (sockFd < 0) {
     LOG_ERROR("Node(%p) socket failed. aiFamily:%d, sockFd:%d. error mesg:%s.",
@@ -3303,6 +3978,7 @@ int ConnectNode::syncConnectProcess(const char *ip, int aiFamily) {
     LOG_ERROR("Node(%p) set SO_LINGER failed.", this);
     return -(SetSocketoptFailed);
   }
+  applySocketOptions(sockFd);
 
   LOG_INFO("Node(%p) new socket ip:%s port:%d Fd:%d.", this, ip, _url._port,
            sockFd);
@@ -3337,54 +4013,14 @@ int ConnectNode::syncConnectProcess(const char *ip, int aiFamily) {
 #endif
 
 int ConnectNode::prestartProcess() {
-  short events = EV_READ | EV_WRITE | EV_TIMEOUT | EV_FINALIZE;
-  if (_enableRecvTv) {
-    events = EV_READ | EV_TIMEOUT | EV_PERSIST | EV_FINALIZE;
-  } else {
-    events = EV_READ | EV_PERSIST | EV_FINALIZE;
-  }
-  LOG_DEBUG("Node(%p) set events(%d) for readEventCallback with sockFd(%d)",
-            this, events, _socketFd);
-  if (NULL == _readEvent) {
-    LOG_DEBUG("Node(%p) event_new _readEvent with sockFd(%d)", this, _socketFd);
-    _readEvent = event_new(_eventThread->_workBase, _socketFd, events,
-                           WorkThread::readEventCallBack, this);
-    if (NULL == _readEvent) {
-      LOG_ERROR("Node(%p) new event(_readEvent) failed.", this);
-    }
-  } else {
-    LOG_DEBUG("Node(%p) event_del _readEvent first with sockFd(%d)", this,
-              _socketFd);
-    event_del(_readEvent);
-    event_assign(_readEvent, _eventThread->_workBase, _socketFd, events,
-                 WorkThread::readEventCallBack, this);
-  }
-  if (NULL == _readEvent) {
-    LOG_ERROR("Node(%p) _readEvent is nullptr.", this);
-  } else {
-    LOG_DEBUG("Node(%p) event_add _readEvent with sockFd(%d)", this, _socketFd);
-    if (_enableRecvTv) {
-      utility::TextUtils::GetTimevalFromMs(
-          &_recvTv, _request->getRequestParam()->getRecvTimeout());
-      event_add(_readEvent, &_recvTv);
-    } else {
-      event_add(_readEvent, NULL);
-    }
+  LOG_DEBUG("Node(%p) assign socket events with sockFd(%d)", this, _socketFd);
+  if (_eventThread) {
+    _webSocket.setMaskKey(_eventThread->nextMaskKey());
   }
-
-  events = EV_WRITE | EV_TIMEOUT | EV_FINALIZE;
-  // LOG_DEBUG("Node(%p) set events(%d) for writeEventCallback with sockFd(%d)",
-  //           this, events, _socketFd);
-  if (NULL == _writeEvent) {
-    _writeEvent = event_new(_eventThread->_workBase, _socketFd, events,
-                            WorkThread::writeEventCallBack, this);
-    if (NULL == _writeEvent) {
-      LOG_ERROR("Node(%p) new event(_writeEvent) failed.", this);
-    }
+  if (assignSocketIoEvents(_socketFd) < 0) {
+    LOG_ERROR("Node(%p) assign socket events failed.", this);
   } else {
-    event_del(_writeEvent);
-    event_assign(_writeEvent, _eventThread->_workBase, _socketFd, events,
-                 WorkThread::writeEventCallBack, this);
+    addSocketEvent();
   }
   return Success;
 }
@@ -3401,6 +4037,7 @@ int ConnectNode::prestartEventDelProcess() {
     event_free(_writeEvent);
     _writeEvent = NULL;
   }
+  cancelTimeouts();
   return Success;
 }
 
@@ -3448,8 +4085,8 @@ int ConnectNode::socketConnect() {
         return -(EventEmpty);
       }
       time_t timeout_ms = _request->getRequestParam()->getTimeout();
-      utility::TextUtils::GetTimevalFromMs(&_connectTv, timeout_ms);
-      event_add(_connectEvent, &_connectTv);
+      event_add(_connectEvent, NULL);
+      updateTimeout(NodeTimeoutConnect, timeout_ms);
 
       LOG_DEBUG("Node(%p) will connect later, errno:%d. timeout:%ldms.", this,
                 connectErrCode, timeout_ms);
@@ -3476,6 +4113,7 @@ int ConnectNode::socketConnect() {
   } else {
     LOG_DEBUG("Node(%p) connected directly. retCode:%d.", this, retCode);
     _workStatus = NodeConnected;
+    markTimelineConnected();
     node_manager->updateNodeStatus(this, NodeStatusConnected);
     _isConnected = true;
   }
@@ -3532,6 +4170,7 @@ int ConnectNode::syncSocketConnect() {
   } else {
     LOG_DEBUG("Node(%p) connected directly. retCode:%d.", this, retCode);
     _workStatus = NodeConnected;
+    markTimelineConnected();
     node_manager->updateNodeStatus(this, NodeStatusConnected);
     _isConnected = true;
   }
@@ -3555,6 +4194,10 @@ int ConnectNode::sslProcess() {
     return ret;
   }
 
+  if (_timeline.ssl_begin_us < _timeline.connect_end_us) {
+    _timeline.ssl_begin_us = utility::TextUtils::GetMonotonicUs();
+  }
+
   if (_url._isSsl) {
     ret = _sslHandle->sslHandshake(_socketFd, _url._host);
     if (ret == SSL_ERROR_WANT_READ || ret == SSL_ERROR_WANT_WRITE) {
@@ -3566,13 +4209,8 @@ int ConnectNode::sslProcess() {
 #ifdef ENABLE_HIGH_EFFICIENCY
       // connect回调和定时connect回调交替调用, 降低事件量的同时保证稳定
       if (!_connectTimerFlag) {
-        if (NULL == _connectTimerEvent) {
-          LOG_ERROR("Node(%p) event is nullptr.", this);
-          return -(EventEmpty);
-        }
-
-        // LOG_DEBUG("Node(%p) add evtimer _connectTimerEvent.", this);
-        evtimer_add(_connectTimerEvent, &_connectTimerTv);
+        // LOG_DEBUG("Node(%p) add connect poll timeout.", this);
+        updateTimeout(NodeTimeoutConnectPoll, ConnectTimerIntervalMs);
         _connectTimerFlag = true;
       } else {
         if (NULL == _connectEvent) {
@@ -3581,10 +4219,10 @@ int ConnectNode::sslProcess() {
         }
 
         // LOG_DEBUG("Node(%p) add events _connectEvent.", this);
-        utility::TextUtils::GetTimevalFromMs(
-            &_connectTv, _request->getRequestParam()->getTimeout());
         // set _connectEvent to pending status.
-        event_add(_connectEvent, &_connectTv);
+        event_add(_connectEvent, NULL);
+        updateTimeout(NodeTimeoutConnect,
+                      _request->getRequestParam()->getTimeout());
         _connectTimerFlag = false;
       }
 #else
@@ -3592,10 +4230,10 @@ int ConnectNode::sslProcess() {
         LOG_ERROR("Node(%p) event is nullptr.", this);
         return -(EventEmpty);
       }
-      utility::TextUtils::GetTimevalFromMs(
-          &_connectTv, _request->getRequestParam()->getTimeout());
       // LOG_DEBUG("Node(%p) add events _connectEvent.", this);
-      event_add(_connectEvent, &_connectTv);
+      event_add(_connectEvent, NULL);
+      updateTimeout(NodeTimeoutConnect,
+                    _request->getRequestParam()->getTimeout());
 #endif
 
       return 1;
@@ -3607,6 +4245,7 @@ int ConnectNode::sslProcess() {
     } else {
       _workStatus = NodeHandshaking;
       node_manager->updateNodeStatus(this, NodeStatusHandshaking);
+      _timeline.ssl_end_us = utility::TextUtils::GetMonotonicUs();
       LOG_DEBUG(
           "Node(%p) _sslHandle(%p) sslHandshake done, ret:%d, set "
           "node:NodeHandshaking.",
@@ -3616,6 +4255,7 @@ int ConnectNode::sslProcess() {
   } else {
     _workStatus = NodeHandshaking;
     node_manager->updateNodeStatus(this, NodeStatusHandshaking);
+    _timeline.ssl_end_us = _timeline.ssl_begin_us;
     LOG_INFO("Node(%p) it's not ssl process, set node:NodeHandshaking.", this);
   }
 
@@ -3639,6 +4279,10 @@ int ConnectNode::syncSslProcess() {
     return ret;
   }
 
+  if (_timeline.ssl_begin_us < _timeline.connect_end_us) {
+    _timeline.ssl_begin_us = utility::TextUtils::GetMonotonicUs();
+  }
+
   if (_url._isSsl) {
     int try_count = 50;
     ret = _sslHandle->sslHandshake(_socketFd, _url._host);
@@ -3659,6 +4303,7 @@ int ConnectNode::syncSslProcess() {
     } else {
       _workStatus = NodeHandshaking;
       node_manager->updateNodeStatus(this, NodeStatusHandshaking);
+      _timeline.ssl_end_us = utility::TextUtils::GetMonotonicUs();
       LOG_DEBUG(
           "Node(%p) _sslHandle(%p) sslHandshake done, ret:%d, set "
           "node:NodeHandshaking.",
@@ -3668,6 +4313,7 @@ int ConnectNode::syncSslProcess() {
   } else {
     _workStatus = NodeHandshaking;
     node_manager->updateNodeStatus(this, NodeStatusHandshaking);
+    _timeline.ssl_end_us = _timeline.ssl_begin_us;
     LOG_INFO("Node(%p) it's not ssl process, set node:NodeHandshaking.", this);
   }
 
@@ -3793,7 +4439,6 @@ void ConnectNode::updateParameters() {
   }
 
   time_t timeout_ms = _request->getRequestParam()->getTimeout();
-  utility::TextUtils::GetTimevalFromMs(&_connectTv, timeout_ms);
   LOG_INFO("Node(%p) set connect timeout: %ldms.", this, timeout_ms);
 
   _enableRecvTv = _request->getRequestParam()->getEnableRecvTimeout();
@@ -3803,11 +4448,9 @@ void ConnectNode::updateParameters() {
     LOG_INFO("Node(%p) disable recv timeout.", this);
   }
   timeout_ms = _request->getRequestParam()->getRecvTimeout();
-  utility::TextUtils::GetTimevalFromMs(&_recvTv, timeout_ms);
   LOG_INFO("Node(%p) set recv timeout: %ldms.", this, timeout_ms);
 
   timeout_ms = _request->getRequestParam()->getSendTimeout();
-  utility::TextUtils::GetTimevalFromMs(&_sendTv, timeout_ms);
   LOG_INFO("Node(%p) set send timeout: %ldms.", this, timeout_ms);
 
   _enableOnMessage = _request->getRequestParam()->getEnableOnMessage();
@@ -3847,24 +4490,12 @@ void ConnectNode::delAllEvents() {
     LOG_DEBUG("Node(%p) waiting exit NodeInvoking success.", this);
   }
 
-  /* 当Node处于异步dns线程状态, 通知线程退出并等待其退出再进行释放 */
-  if (_url._enableSysGetAddr && _dnsThreadRunning) {
-    _dnsThreadExit = true;
-    try_count = 5000;
-    LOG_WARN("Node(%p) waiting exit dnsThread ...", this);
-    while (_dnsThreadRunning && try_count-- > 0) {
-#ifdef _MSC_VER
-      Sleep(1);
-#else
-      usleep(1000);
-#endif
-    }
-    if (try_count <= 0) {
-      LOG_WARN("Node(%p) waiting exit dnsThread failed.", this);
-    } else {
-      LOG_WARN("Node(%p) waiting exit dnsThread success.", this);
-    }
+  /* 当Node处于异步dns解析状态, 先取消解析请求再进行释放 */
+#ifdef __LINUX__
+  if (_url._enableSysGetAddr) {
+    cancelSysDnsResolve();
   }
+#endif
 
   waitEventCallback();
 
@@ -3889,20 +4520,14 @@ void ConnectNode::delAllEvents() {
     event_free(_writeEvent);
     _writeEvent = NULL;
   }
+  cancelTimeouts();
   if (_connectEvent) {
     event_del(_connectEvent);
     event_free(_connectEvent);
     _connectEvent = NULL;
   }
 #ifdef ENABLE_HIGH_EFFICIENCY
-  if (_connectTimerEvent != NULL) {
-    if (_connectTimerFlag) {
-      evtimer_del(_connectTimerEvent);
-      _connectTimerFlag = false;
-    }
-    event_free(_connectTimerEvent);
-    _connectTimerEvent = NULL;
-  }
+  _connectTimerFlag = false;
 #endif
 
   if (del_all_events_lock_ret) {
@@ -3962,24 +4587,69 @@ void ConnectNode::waitInvokeFinish() {
 #if defined(_MSC_VER)
     MUTEX_LOCK(_mtxInvokeSyncCallNode);
 #else
-    struct timespec outtime;
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    uint64_t time_ms =
-        now.tv_sec * 1000 + now.tv_usec / 1000 + _syncCallTimeoutMs;
-    utility::TextUtils::GetTimespecFromMs(&outtime, time_ms);
-    MUTEX_LOCK(_mtxInvokeSyncCallNode);
+    struct timespec outtime;
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    uint64_t time_ms =
+        now.tv_sec * 1000 + now.tv_usec / 1000 + _syncCallTimeoutMs;
+    utility::TextUtils::GetTimespecFromMs(&outtime, time_ms);
+    MUTEX_LOCK(_mtxInvokeSyncCallNode);
+    if (ETIMEDOUT == pthread_cond_timedwait(&_cvInvokeSyncCallNode,
+                                            &_mtxInvokeSyncCallNode,
+                                            &outtime)) {
+      _nodeErrCode = InvokeTimeout;
+      LOG_WARN("Node(%p) waiting invoke timeout.", this);
+    }
+    MUTEX_UNLOCK(_mtxInvokeSyncCallNode);
+#endif
+
+    LOG_DEBUG("Node(%p) waiting invoke done.", this);
+  }
+}
+
+/**
+ * @brief: 长链接同步调用模式下, 等待上一轮交互由NodeCompleted进入NodeClosed.
+ * @param timeoutMs: 最长等待时间
+ * @return: 等待结束时的节点状态
+ */
+ConnectStatus ConnectNode::waitLongConnectionClosed(unsigned int timeoutMs) {
+  ConnectStatus status = getConnectNodeStatus();
+  if (status != NodeCompleted) {
+    return status;
+  }
+
+  LOG_DEBUG("Node(%p) waiting NodeClosed, timeout %dms...", this, timeoutMs);
+#if defined(_MSC_VER)
+  uint64_t deadline = utility::TextUtils::GetTimestampMs() + timeoutMs;
+  while ((status = getConnectNodeStatus()) == NodeCompleted) {
+    uint64_t now = utility::TextUtils::GetTimestampMs();
+    if (now >= deadline ||
+        WAIT_TIMEOUT == WaitForSingleObject(_mtxInvokeSyncCallNode,
+                                            (DWORD)(deadline - now))) {
+      break;
+    }
+  }
+#else
+  struct timespec outtime;
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  uint64_t time_ms = now.tv_sec * 1000 + now.tv_usec / 1000 + timeoutMs;
+  utility::TextUtils::GetTimespecFromMs(&outtime, time_ms);
+  MUTEX_LOCK(_mtxInvokeSyncCallNode);
+  while ((status = getConnectNodeStatus()) == NodeCompleted) {
     if (ETIMEDOUT == pthread_cond_timedwait(&_cvInvokeSyncCallNode,
                                             &_mtxInvokeSyncCallNode,
                                             &outtime)) {
-      _nodeErrCode = InvokeTimeout;
-      LOG_WARN("Node(%p) waiting invoke timeout.", this);
+      status = getConnectNodeStatus();
+      break;
     }
-    MUTEX_UNLOCK(_mtxInvokeSyncCallNode);
+  }
+  MUTEX_UNLOCK(_mtxInvokeSyncCallNode);
 #endif
 
-    LOG_DEBUG("Node(%p) waiting invoke done.", this);
-  }
+  LOG_DEBUG("Node(%p) waiting NodeClosed done, status:%s.", this,
+            getConnectNodeStatusString().c_str());
+  return status;
 }
 
 /**
@@ -4081,133 +4751,137 @@ const char *ConnectNode::genSynthesisStartedMsg() {
 }
 
 #ifdef ENABLE_REQUEST_RECORDING
-void ConnectNode::updateNodeProcess(std::string api, int status, bool enter,
-                                    size_t size) {
-#ifdef ENABLE_NLS_DEBUG_2
-  uint64_t timewait_start, timewait_0, timewait_a, timewait_end;
-  timewait_start = utility::TextUtils::GetTimestampMs();
-#endif
-  if (api == "start") {
-    if (enter) {
-      _nodeProcess.last_op_timestamp_ms = utility::TextUtils::GetTimestampMs();
-      _nodeProcess.start_timestamp_ms = _nodeProcess.last_op_timestamp_ms;
-      _nodeProcess.last_status = NodeInvoking;
-      _nodeProcess.api_start_run = true;
-      _nodeProcess.last_api_timestamp_ms = utility::TextUtils::GetTimestampMs();
-    } else {
-      _nodeProcess.api_start_run = false;
-    }
-  } else if (api == "stop") {
-    if (enter) {
-      _nodeProcess.last_op_timestamp_ms = utility::TextUtils::GetTimestampMs();
-      _nodeProcess.stop_timestamp_ms = _nodeProcess.last_op_timestamp_ms;
-      _nodeProcess.last_status = NodeStop;
-      _nodeProcess.api_stop_run = true;
-      _nodeProcess.last_api_timestamp_ms = utility::TextUtils::GetTimestampMs();
-    } else {
-      _nodeProcess.api_stop_run = false;
-    }
-  } else if (api == "cancel") {
-    if (enter) {
-      _nodeProcess.last_op_timestamp_ms = utility::TextUtils::GetTimestampMs();
-      _nodeProcess.cancel_timestamp_ms = _nodeProcess.last_op_timestamp_ms;
-      _nodeProcess.last_status = NodeCancel;
-      _nodeProcess.api_cancel_run = true;
-      _nodeProcess.last_api_timestamp_ms = utility::TextUtils::GetTimestampMs();
-    } else {
-      _nodeProcess.api_cancel_run = false;
-    }
-  } else if (api == "sendAudio") {
-    if (enter) {
-      _nodeProcess.last_op_timestamp_ms = utility::TextUtils::GetTimestampMs();
-      _nodeProcess.last_send_timestamp_ms = _nodeProcess.last_op_timestamp_ms;
-      _nodeProcess.last_status = NodeSendAudio;
-      _nodeProcess.recording_bytes += size;
-      _nodeProcess.send_count++;
-      _nodeProcess.api_send_run = true;
-      _nodeProcess.last_api_timestamp_ms = utility::TextUtils::GetTimestampMs();
-    } else {
-      _nodeProcess.api_send_run = false;
-    }
-  } else if (api == "ctrl") {
-    if (enter) {
-      _nodeProcess.last_op_timestamp_ms = utility::TextUtils::GetTimestampMs();
-      _nodeProcess.last_ctrl_timestamp_ms = _nodeProcess.last_op_timestamp_ms;
-      _nodeProcess.last_status = NodeSendControl;
-      _nodeProcess.api_ctrl_run = true;
-      _nodeProcess.last_api_timestamp_ms = utility::TextUtils::GetTimestampMs();
-    } else {
-      _nodeProcess.api_ctrl_run = false;
-    }
-  } else if (api == "send_text") {
-    if (enter) {
-      _nodeProcess.last_op_timestamp_ms = utility::TextUtils::GetTimestampMs();
-      _nodeProcess.last_status = NodeSendText;
-      _nodeProcess.api_ctrl_run = true;
-      _nodeProcess.last_api_timestamp_ms = utility::TextUtils::GetTimestampMs();
-    } else {
-      _nodeProcess.api_ctrl_run = false;
+NodeProcess::NodeProcess() {
+  last_op_timestamp_ms.store(0);
+  last_status.store(NodeInvalid);
+  last_callback.store(NlsEvent::TaskFailed);
+  connect_type.store(ConnectWithSSL);
+  for (int i = 0; i < RecordOpNumber; i++) {
+    enter_count[i].store(0);
+    exit_count[i].store(0);
+    bytes[i].store(0);
+    last_enter_ms[i].store(0);
+    last_exit_ms[i].store(0);
+  }
+  _head.store(0);
+  for (int i = 0; i < RingSize; i++) {
+    _ring[i].seq.store(0);
+    _ring[i].timestamp_ms.store(0);
+    _ring[i].data.store(0);
+  }
+}
+
+/**
+ * @brief: 记录一次操作, 可在多个线程中同时调用
+ * @return:
+ */
+void NodeProcess::record(NodeRecordOp op, bool enter, int status,
+                         uint64_t size) {
+  uint64_t now = utility::TextUtils::GetTimestampMs();
+  if (enter) {
+    enter_count[op].fetch_add(1, std::memory_order_relaxed);
+    last_enter_ms[op].store(now, std::memory_order_relaxed);
+    if (size > 0) {
+      bytes[op].fetch_add(size, std::memory_order_relaxed);
+    }
+    if (op != RecordCallback) {
+      last_op_timestamp_ms.store(now, std::memory_order_relaxed);
     }
-  } else if (api == "callback") {
-    if (enter) {
-#ifdef ENABLE_NLS_DEBUG_2
-      timewait_0 = utility::TextUtils::GetTimestampMs();
-#endif
-      _nodeProcess.last_callback = (NlsEvent::EventType)status;
-      switch (_nodeProcess.last_callback) {
-        case NlsEvent::RecognitionStarted:
-        case NlsEvent::TranscriptionStarted:
-          _nodeProcess.last_op_timestamp_ms =
-              utility::TextUtils::GetTimestampMs();
-          _nodeProcess.started_timestamp_ms = _nodeProcess.last_op_timestamp_ms;
-          break;
-        case NlsEvent::TranscriptionCompleted:
-        case NlsEvent::RecognitionCompleted:
-        case NlsEvent::SynthesisCompleted:
-          _nodeProcess.last_op_timestamp_ms =
-              utility::TextUtils::GetTimestampMs();
-          _nodeProcess.completed_timestamp_ms =
-              _nodeProcess.last_op_timestamp_ms;
-          break;
-        case NlsEvent::Binary:
-          _nodeProcess.last_op_timestamp_ms =
-              utility::TextUtils::GetTimestampMs();
-          _nodeProcess.play_bytes += size;
-          _nodeProcess.play_count++;
-          _nodeProcess.last_status = NodePlayAudio;
-          if (_isFirstBinaryFrame) {
-            _nodeProcess.first_binary_timestamp_ms =
-                _nodeProcess.last_op_timestamp_ms;
-          }
-          break;
-      }
+  } else {
+    exit_count[op].fetch_add(1, std::memory_order_relaxed);
+    last_exit_ms[op].store(now, std::memory_order_relaxed);
+  }
+
+  uint64_t index = _head.fetch_add(1, std::memory_order_relaxed);
+  Slot *slot = &_ring[index % RingSize];
+  uint64_t data = (size > 0xFFFFFFFFULL ? 0xFFFFFFFFULL : size) |
+                  ((uint64_t)op << 32) | ((uint64_t)(enter ? 1 : 0) << 40) |
+                  ((uint64_t)(uint16_t)status << 48);
+  slot->seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->timestamp_ms.store(now, std::memory_order_relaxed);
+  slot->data.store(data, std::memory_order_relaxed);
+  slot->seq.store(index + 1, std::memory_order_release);
+}
 
-#ifdef ENABLE_NLS_DEBUG_2
-      timewait_a = utility::TextUtils::GetTimestampMs();
-#endif
+int NodeProcess::snapshot(Entry *entries, int maxEntries) {
+  uint64_t head = _head.load(std::memory_order_acquire);
+  uint64_t number = head < (uint64_t)RingSize ? head : (uint64_t)RingSize;
+  if (number > (uint64_t)maxEntries) {
+    number = maxEntries;
+  }
+  int count = 0;
+  for (uint64_t index = head - number; index < head; index++) {
+    Slot *slot = &_ring[index % RingSize];
+    uint64_t seq = slot->seq.load(std::memory_order_acquire);
+    if (seq != index + 1) {
+      continue;
+    }
+    uint64_t timestamp = slot->timestamp_ms.load(std::memory_order_relaxed);
+    uint64_t data = slot->data.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->seq.load(std::memory_order_relaxed) != seq) {
+      continue;
+    }
+    Entry *entry = &entries[count++];
+    entry->timestamp_ms = timestamp;
+    entry->size = (uint32_t)(data & 0xFFFFFFFFULL);
+    entry->op = (NodeRecordOp)((data >> 32) & 0xFF);
+    entry->enter = ((data >> 40) & 0xFF) != 0;
+    entry->status = (int16_t)(data >> 48);
+  }
+  return count;
+}
 
-      _nodeProcess.last_cb_start_timestamp_ms =
-          utility::TextUtils::GetTimestampMs();
-      _nodeProcess.last_cb_end_timestamp_ms = 0;
-      _nodeProcess.last_cb_run = true;
-    } else {
-      _nodeProcess.last_cb_end_timestamp_ms =
-          utility::TextUtils::GetTimestampMs();
-      _nodeProcess.last_cb_run = false;
+const char *NodeProcess::getOpString(NodeRecordOp op) {
+  static const char *names[RecordOpNumber] = {
+      "create",    "start",     "stop",    "cancel",
+      "sendAudio", "ctrl",      "send_text", "callback",
+      "started",   "completed", "binary",  "first_binary",
+      "failed",    "closed"};
+  if (op < 0 || op >= RecordOpNumber) {
+    return "unknown";
+  }
+  return names[op];
+}
+
+void ConnectNode::updateNodeProcess(NodeRecordOp op, int status, bool enter,
+                                    size_t size) {
+  if (op != RecordCallback) {
+    if (enter) {
+      _nodeProcess.last_status = status;
     }
+    _nodeProcess.record(op, enter, 0, size);
+    return;
   }
-#ifdef ENABLE_NLS_DEBUG_2
-  timewait_end = utility::TextUtils::GetTimestampMs();
-  if (timewait_end - timewait_start > 50) {
-    LOG_WARN(
-        "Request(%p) Node(%p) updateNodeProcess calback %d done with "
-        "excessive time "
-        "%llums, including 0:%llu a:%llu b:%llums.",
-        _request, this, _nodeProcess.last_callback,
-        timewait_end - timewait_start, timewait_0 - timewait_start,
-        timewait_a - timewait_start, timewait_end - timewait_a);
+
+  if (!enter) {
+    _nodeProcess.record(RecordCallback, false);
+    return;
   }
-#endif
+
+  _nodeProcess.last_callback = status;
+  switch (status) {
+    case NlsEvent::RecognitionStarted:
+    case NlsEvent::TranscriptionStarted:
+      _nodeProcess.record(RecordStarted, true);
+      break;
+    case NlsEvent::TranscriptionCompleted:
+    case NlsEvent::RecognitionCompleted:
+    case NlsEvent::SynthesisCompleted:
+      _nodeProcess.record(RecordCompleted, true);
+      break;
+    case NlsEvent::Binary:
+      _nodeProcess.last_status = NodePlayAudio;
+      _nodeProcess.record(RecordBinary, true, 0, size);
+      if (_isFirstBinaryFrame) {
+        _nodeProcess.record(RecordFirstBinary, true);
+      }
+      break;
+    default:
+      break;
+  }
+  _nodeProcess.record(RecordCallback, true, status);
 }
 
 const char *ConnectNode::dumpAllInfo() {
@@ -4243,6 +4917,7 @@ const char *ConnectNode::dumpAllInfo() {
     if (!block.isNull() && block.isObject() && !block.empty()) {
       root["block"] = block;
     }
+    root["events"] = updateNodeProcess4Events();
     root["sdkversion"] = NLS_SDK_VERSION_STR;
 
 #ifdef ENABLE_CONTINUED
@@ -4256,10 +4931,10 @@ const char *ConnectNode::dumpAllInfo() {
 
     root["connect_type"] = getConnectTypeStr();
 
-    std::string info = Json::writeString(writerBuilder, root);
+    _nodeProcessInfo = Json::writeString(writerBuilder, root);
     LOG_INFO("Request(%p) Node(%p) current info: %s", _request, this,
-             info.c_str());
-    return info.c_str();
+             _nodeProcessInfo.c_str());
+    return _nodeProcessInfo.c_str();
   } catch (const std::exception &e) {
     LOG_ERROR("Json failed: %s", e.what());
     return "";
@@ -4268,7 +4943,7 @@ const char *ConnectNode::dumpAllInfo() {
 
 std::string ConnectNode::getConnectTypeStr() {
   std::string result = "unknown";
-  ConnectType type = _nodeProcess.connect_type;
+  ConnectType type = (ConnectType)_nodeProcess.connect_type.load();
   switch (type) {
     case ConnectWithSSL:
       result = "connect_with_SSL";
@@ -4364,17 +5039,21 @@ std::string ConnectNode::replenishNodeProcess(const char *error) {
 Json::Value ConnectNode::updateNodeProcess4Data() {
   Json::Value data(Json::objectValue);
   try {
-    if (_nodeProcess.recording_bytes > 0) {
-      data["recording_bytes"] = (Json::UInt64)_nodeProcess.recording_bytes;
+    uint64_t recording_bytes =
+        _nodeProcess.bytes[RecordSendAudio].load(std::memory_order_relaxed);
+    uint64_t play_bytes =
+        _nodeProcess.bytes[RecordBinary].load(std::memory_order_relaxed);
+    if (recording_bytes > 0) {
+      data["recording_bytes"] = (Json::UInt64)recording_bytes;
     }
-    if (_nodeProcess.send_count > 0) {
-      data["send_count"] = (Json::UInt64)_nodeProcess.send_count;
+    if (_nodeProcess.count(RecordSendAudio) > 0) {
+      data["send_count"] = (Json::UInt64)_nodeProcess.count(RecordSendAudio);
     }
-    if (_nodeProcess.play_bytes > 0) {
-      data["play_bytes"] = (Json::UInt64)_nodeProcess.play_bytes;
+    if (play_bytes > 0) {
+      data["play_bytes"] = (Json::UInt64)play_bytes;
     }
-    if (_nodeProcess.play_count > 0) {
-      data["play_count"] = (Json::UInt64)_nodeProcess.play_count;
+    if (_nodeProcess.count(RecordBinary) > 0) {
+      data["play_count"] = (Json::UInt64)_nodeProcess.count(RecordBinary);
     }
   } catch (const std::exception &e) {
     LOG_ERROR("Json failed: %s", e.what());
@@ -4386,18 +5065,19 @@ Json::Value ConnectNode::updateNodeProcess4Data() {
 Json::Value ConnectNode::updateNodeProcess4Last() {
   Json::Value last(Json::objectValue);
   try {
-    last["status"] = getConnectNodeStatusString(_nodeProcess.last_status);
-    if (_nodeProcess.last_send_timestamp_ms > 0) {
+    uint64_t last_op_ms = _nodeProcess.last_op_timestamp_ms.load();
+    last["status"] = getConnectNodeStatusString(
+        (ConnectStatus)_nodeProcess.last_status.load());
+    if (_nodeProcess.lastMs(RecordSendAudio) > 0) {
       last["send"] = utility::TextUtils::GetTimeFromMs(
-          _nodeProcess.last_send_timestamp_ms);
+          _nodeProcess.lastMs(RecordSendAudio));
     }
-    if (_nodeProcess.last_ctrl_timestamp_ms > 0) {
+    if (_nodeProcess.lastMs(RecordControl) > 0) {
       last["control"] = utility::TextUtils::GetTimeFromMs(
-          _nodeProcess.last_ctrl_timestamp_ms);
+          _nodeProcess.lastMs(RecordControl));
     }
-    if (_nodeProcess.last_op_timestamp_ms > 0) {
-      last["action"] =
-          utility::TextUtils::GetTimeFromMs(_nodeProcess.last_op_timestamp_ms);
+    if (last_op_ms > 0) {
+      last["action"] = utility::TextUtils::GetTimeFromMs(last_op_ms);
     }
   } catch (const std::exception &e) {
     LOG_ERROR("Json failed: %s", e.what());
@@ -4409,44 +5089,29 @@ Json::Value ConnectNode::updateNodeProcess4Last() {
 Json::Value ConnectNode::updateNodeProcess4Timestamp() {
   Json::Value timestamp(Json::objectValue);
   try {
+    static const NodeRecordOp ops[] = {RecordStart,  RecordStarted,
+                                       RecordStop,   RecordCancel,
+                                       RecordFailed, RecordCompleted,
+                                       RecordClosed};
+    uint64_t start_ms = _nodeProcess.lastMs(RecordStart);
     timestamp["create"] =
-        utility::TextUtils::GetTimeFromMs(_nodeProcess.create_timestamp_ms);
-    if (_nodeProcess.start_timestamp_ms > 0) {
-      timestamp["start"] =
-          utility::TextUtils::GetTimeFromMs(_nodeProcess.start_timestamp_ms);
-    }
-    if (_nodeProcess.started_timestamp_ms > 0) {
-      timestamp["started"] =
-          utility::TextUtils::GetTimeFromMs(_nodeProcess.started_timestamp_ms);
-    }
-    if (_nodeProcess.stop_timestamp_ms > 0) {
-      timestamp["stop"] =
-          utility::TextUtils::GetTimeFromMs(_nodeProcess.stop_timestamp_ms);
-    }
-    if (_nodeProcess.cancel_timestamp_ms > 0) {
-      timestamp["cancel"] =
-          utility::TextUtils::GetTimeFromMs(_nodeProcess.cancel_timestamp_ms);
-    }
-    if (_nodeProcess.failed_timestamp_ms > 0) {
-      timestamp["failed"] =
-          utility::TextUtils::GetTimeFromMs(_nodeProcess.failed_timestamp_ms);
-    }
-    if (_nodeProcess.completed_timestamp_ms > 0) {
-      timestamp["completed"] = utility::TextUtils::GetTimeFromMs(
-          _nodeProcess.completed_timestamp_ms);
-      timestamp["completed_latency"] =
-          (Json::UInt64)(_nodeProcess.completed_timestamp_ms -
-                         _nodeProcess.start_timestamp_ms);
-    }
-    if (_nodeProcess.closed_timestamp_ms > 0) {
-      timestamp["closed"] =
-          utility::TextUtils::GetTimeFromMs(_nodeProcess.closed_timestamp_ms);
-    }
-    if (_nodeProcess.first_binary_timestamp_ms > 0) {
-      timestamp["first_binary"] = utility::TextUtils::GetTimeFromMs(
-          _nodeProcess.first_binary_timestamp_ms);
-      uint64_t first_binary_ms = _nodeProcess.first_binary_timestamp_ms -
-                                 _nodeProcess.start_timestamp_ms;
+        utility::TextUtils::GetTimeFromMs(_nodeProcess.lastMs(RecordCreate));
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+      uint64_t ms = _nodeProcess.lastMs(ops[i]);
+      if (ms > 0) {
+        timestamp[NodeProcess::getOpString(ops[i])] =
+            utility::TextUtils::GetTimeFromMs(ms);
+      }
+    }
+    uint64_t completed_ms = _nodeProcess.lastMs(RecordCompleted);
+    if (completed_ms > 0) {
+      timestamp["completed_latency"] = (Json::UInt64)(completed_ms - start_ms);
+    }
+    uint64_t first_binary_ms = _nodeProcess.lastMs(RecordFirstBinary);
+    if (first_binary_ms > 0) {
+      timestamp["first_binary"] =
+          utility::TextUtils::GetTimeFromMs(first_binary_ms);
+      first_binary_ms -= start_ms;
       timestamp["first_binary_latency"] = (Json::UInt64)(first_binary_ms);
       if (first_binary_ms > 1000) {
         LOG_WARN("Request(%p) Node(%p) include abnormal first_binary:%llums",
@@ -4471,18 +5136,20 @@ Json::Value ConnectNode::updateNodeProcess4Callback() {
   try {
     NlsEvent event(_request->getRequestParam()->_mode,
                    (NlsServiceProtocol)_url._serviceProtocol);
-    std::string cb_name = event.getMsgTypeString(_nodeProcess.last_callback);
+    std::string cb_name = event.getMsgTypeString(
+        (NlsEvent::EventType)_nodeProcess.last_callback.load());
     if (!cb_name.empty() && cb_name != "Unknown") {
+      bool running = _nodeProcess.isRunning(RecordCallback);
+      uint64_t start_ms = _nodeProcess.lastMs(RecordCallback, true);
+      uint64_t end_ms = _nodeProcess.lastMs(RecordCallback, false);
       callback["name"] = cb_name;
-      if (_nodeProcess.last_cb_start_timestamp_ms > 0) {
-        callback["start"] = utility::TextUtils::GetTimeFromMs(
-            _nodeProcess.last_cb_start_timestamp_ms);
+      if (start_ms > 0) {
+        callback["start"] = utility::TextUtils::GetTimeFromMs(start_ms);
       }
-      if (_nodeProcess.last_cb_end_timestamp_ms > 0) {
-        callback["end"] = utility::TextUtils::GetTimeFromMs(
-            _nodeProcess.last_cb_end_timestamp_ms);
+      if (end_ms > 0 && !running) {
+        callback["end"] = utility::TextUtils::GetTimeFromMs(end_ms);
       }
-      if (_nodeProcess.last_cb_run) {
+      if (running) {
         callback["status"] = "running";
       }
     }
@@ -4496,45 +5163,24 @@ Json::Value ConnectNode::updateNodeProcess4Callback() {
 Json::Value ConnectNode::updateNodeProcess4Block() {
   Json::Value block(Json::objectValue);
   try {
-    bool running_flag = false;
-    std::string timestamp_name = "";
-    std::string duration_name = "";
-    if (_nodeProcess.api_start_run) {
-      block["start"] = "running";
-      timestamp_name = "start_timestamp";
-      duration_name = "start_duration_ms";
-      running_flag = true;
-    }
-    if (_nodeProcess.api_stop_run) {
-      block["stop"] = "running";
-      timestamp_name = "stop_timestamp";
-      duration_name = "stop_duration_ms";
-      running_flag = true;
-    }
-    if (_nodeProcess.api_cancel_run) {
-      block["cancel"] = "running";
-      timestamp_name = "cancel_timestamp";
-      duration_name = "cancel_duration_ms";
-      running_flag = true;
-    }
-    if (_nodeProcess.api_send_run) {
-      block["send"] = "running";
-      timestamp_name = "send_timestamp";
-      duration_name = "send_duration_ms";
-      running_flag = true;
-    }
-    if (_nodeProcess.api_ctrl_run) {
-      block["ctrl"] = "running";
-      timestamp_name = "ctrl_timestamp";
-      duration_name = "ctrl_duration_ms";
-      running_flag = true;
-    }
-    if (running_flag && _nodeProcess.last_api_timestamp_ms > 0) {
-      block[timestamp_name] =
-          utility::TextUtils::GetTimeFromMs(_nodeProcess.last_api_timestamp_ms);
+    static const NodeRecordOp ops[] = {RecordStart, RecordStop, RecordCancel,
+                                       RecordSendAudio, RecordControl,
+                                       RecordSendText};
+    static const char *names[] = {"start", "stop", "cancel",
+                                  "send",  "ctrl", "ctrl"};
+    uint64_t api_ms = 0;
+    std::string name = "";
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+      if (_nodeProcess.isRunning(ops[i])) {
+        block[names[i]] = "running";
+        name = names[i];
+        api_ms = _nodeProcess.lastMs(ops[i]);
+      }
+    }
+    if (api_ms > 0) {
+      block[name + "_timestamp"] = utility::TextUtils::GetTimeFromMs(api_ms);
       uint64_t current = utility::TextUtils::GetTimestampMs();
-      block[duration_name] =
-          Json::UInt64(current - _nodeProcess.last_api_timestamp_ms);
+      block[name + "_duration_ms"] = Json::UInt64(current - api_ms);
     }
   } catch (const std::exception &e) {
     LOG_ERROR("Json failed: %s", e.what());
@@ -4542,9 +5188,68 @@ Json::Value ConnectNode::updateNodeProcess4Block() {
   }
   return block;
 }
+
+/**
+ * @brief: 解码飞行记录环形缓冲中最近的操作
+ * @return:
+ */
+Json::Value ConnectNode::updateNodeProcess4Events() {
+  Json::Value events(Json::arrayValue);
+  try {
+    NodeProcess::Entry entries[NodeProcess::RingSize];
+    int number = _nodeProcess.snapshot(entries, NodeProcess::RingSize);
+    for (int i = 0; i < number; i++) {
+      Json::Value item(Json::objectValue);
+      item["op"] = NodeProcess::getOpString(entries[i].op);
+      item["enter"] = entries[i].enter;
+      item["time"] = utility::TextUtils::GetTimeFromMs(entries[i].timestamp_ms);
+      if (entries[i].size > 0) {
+        item["size"] = entries[i].size;
+      }
+      if (entries[i].op == RecordCallback && entries[i].enter) {
+        item["event"] = entries[i].status;
+      }
+      events.append(item);
+    }
+  } catch (const std::exception &e) {
+    LOG_ERROR("Json failed: %s", e.what());
+    return events;
+  }
+  return events;
+}
 #endif
 
 #ifdef ENABLE_CONTINUED
+void NodeAudioReplay::push(const uint8_t *frame, size_t size,
+                           uint32_t durationMs) {
+  Frame item;
+  item.data.assign((const char *)frame, size);
+  item.begin_ms = total_ms;
+  item.duration_ms = durationMs;
+  frames.push_back(item);
+  total_ms += durationMs;
+
+  /* 超出容量的旧音频不再保证可重放 */
+  while (!frames.empty() && capacity_ms > 0 &&
+         frames.front().begin_ms + capacity_ms < total_ms) {
+    frames.pop_front();
+  }
+}
+
+void NodeAudioReplay::confirm(uint64_t confirmedMs, int sentenceIndex) {
+  if (confirmedMs > confirmed_ms) {
+    confirmed_ms = confirmedMs;
+  }
+  if (sentenceIndex > confirmed_index) {
+    confirmed_index = sentenceIndex;
+  }
+  while (!frames.empty() && frames.front().begin_ms +
+                                    frames.front().duration_ms <=
+                                confirmed_ms) {
+    frames.pop_front();
+  }
+}
+
 Json::Value ConnectNode::updateNodeReconnection() {
   Json::Value reconnection(Json::objectValue);
   try {
@@ -4576,18 +5281,109 @@ void ConnectNode::updateTwIndexOffset(NlsEvent *frameEvent) {
   if (frameEvent) {
     if (frameEvent->getMsgType() == NlsEvent::SentenceBegin) {
       _reconnection.tw_index_offset = frameEvent->getSentenceIndex();
+    } else if (frameEvent->getMsgType() == NlsEvent::SentenceEnd) {
+      /* 服务端已确认此句及之前的音频, 不再需要重放 */
+      MUTEX_LOCK(_mtxAudioReplay);
+      _audioReplay.confirm(frameEvent->getSentenceTime(),
+                           frameEvent->getSentenceIndex());
+      MUTEX_UNLOCK(_mtxAudioReplay);
+    }
+  }
+}
+
+/**
+ * @brief: 计算一帧pcm音频的时长, 用于重放缓冲的确认和裁剪
+ * @return: 音频时长(ms), 未开启重连续传或无法得知音频时长则为0
+ */
+uint32_t ConnectNode::getAudioReplayDurationMs(size_t pcmSize) {
+  INlsRequestParam *param = _request ? _request->getRequestParam() : NULL;
+  if (param == NULL || !param->_enableReconnect ||
+      param->_continuedReplayMs == 0) {
+    return 0;
+  }
+  /* 仅在输入为pcm时可得知音频时长 */
+  if (_encoderType == ENCODER_NONE && param->_format != "pcm") {
+    return 0;
+  }
+  int sample_rate = param->_sampleRate > 0 ? param->_sampleRate : SampleRate16K;
+  uint64_t bytes_per_second = (uint64_t)sample_rate * 2;
+  uint32_t duration_ms =
+      (uint32_t)((pcmSize * 1000 + bytes_per_second / 2) / bytes_per_second);
+  _audioReplay.capacity_ms = param->_continuedReplayMs;
+  return duration_ms > 0 ? duration_ms : 1;
+}
+
+bool ConnectNode::isAudioReplayHolding() {
+  MUTEX_LOCK(_mtxAudioReplay);
+  bool holding = _audioReplay.holding;
+  MUTEX_UNLOCK(_mtxAudioReplay);
+  return holding;
+}
+
+/**
+ * @brief: 连接中断准备重连时暂存后续音频, 放弃重连时清空重放缓冲
+ */
+void ConnectNode::holdAudioReplay(bool hold) {
+  MUTEX_LOCK(_mtxAudioReplay);
+  if (hold) {
+    if (_audioReplay.capacity_ms > 0) {
+      _audioReplay.holding = true;
+      LOG_INFO("Node(%p) hold audio replay with %zu frames from %llums.", this,
+               _audioReplay.frames.size(), _audioReplay.replayBeginMs());
+    }
+  } else {
+    _audioReplay.clear();
+  }
+  MUTEX_UNLOCK(_mtxAudioReplay);
+}
+
+/**
+ * @brief: 重连成功后丢弃旧连接未发完的数据, 将未确认的音频重新封包发送
+ * @return: 成功发送的字节数, 失败则返回负值.
+ */
+int ConnectNode::replayAudio() {
+  MUTEX_LOCK(_mtxAudioReplay);
+  if (!_audioReplay.holding) {
+    MUTEX_UNLOCK(_mtxAudioReplay);
+    return 0;
+  }
+
+  evbuffer_lock(_binaryEvBuffer);
+  /* 旧连接中可能残留半帧数据, 全部由重放缓冲重新生成 */
+  evbuffer_drain(_binaryEvBuffer, evbuffer_get_length(_binaryEvBuffer));
+  size_t replay_bytes = 0;
+  std::deque<NodeAudioReplay::Frame>::iterator it;
+  for (it = _audioReplay.frames.begin(); it != _audioReplay.frames.end();
+       ++it) {
+    int frameSize = _webSocket.binaryFrame(
+        (const uint8_t *)it->data.data(), it->data.size(), _binaryEvBuffer);
+    if (frameSize > 0) {
+      replay_bytes += frameSize;
     }
   }
+  evbuffer_unlock(_binaryEvBuffer);
+
+  LOG_INFO("Node(%p) replay %zu audio frames(%zubytes) from %llums.", this,
+           _audioReplay.frames.size(), replay_bytes,
+           _audioReplay.replayBeginMs());
+  _audioReplay.holding = false;
+  MUTEX_UNLOCK(_mtxAudioReplay);
+
+  int ret = 0;
+  MUTEX_LOCK(_mtxNode);
+  if (!_isStop) {
+    ret = nlsSendFrame(_binaryEvBuffer, true);
+  }
+  MUTEX_UNLOCK(_mtxNode);
+  return ret;
 }
 
 bool ConnectNode::nodeReconnecting() {
   if (_reconnection.state == NodeReconnection::WillReconnect) {
-    struct timeval _reconnectTv;
-    utility::TextUtils::GetTimevalFromMs(
-        &_reconnectTv, NodeReconnection::reconnect_interval_ms);
     LOG_INFO("reconnect node(%p) after %dms.", this,
              NodeReconnection::reconnect_interval_ms);
-    int event_ret = event_add(getReconnectEvent(), &_reconnectTv);
+    int event_ret = triggerAction(NodeTriggerReconnect,
+                                  NodeReconnection::reconnect_interval_ms);
     if (event_ret == Success) {
       LOG_INFO("reconnect node(%p) event_add success.", this);
       _reconnection.state = NodeReconnection::TriggerReconnection;
@@ -4606,25 +5402,6 @@ bool ConnectNode::nodeReconnecting() {
   return false;
 }
 
-/**
- * @brief: 获得用于重启当前node的libevent
- * @return: libevent的event指针
- */
-struct event *ConnectNode::getReconnectEvent() {
-  if (_reconnectEvent != NULL) {
-    event_del(_reconnectEvent);
-    event_free(_reconnectEvent);
-    _reconnectEvent = NULL;
-  }
-  _reconnectEvent = event_new(_eventThread->_workBase, -1, EV_READ | EV_TIMEOUT,
-                              WorkThread::launchEventCallback, this);
-  if (NULL == _reconnectEvent) {
-    LOG_ERROR("Node(%p) new event(_reconnectEvent) failed.", this);
-  } else {
-    LOG_DEBUG("Node(%p) new event(_reconnectEvent).", this);
-  }
-  return _reconnectEvent;
-}
 #endif
 
 void ConnectNode::sendFakeSynthesisStarted() {
@@ -4643,6 +5420,254 @@ void ConnectNode::sendFakeSynthesisStarted() {
 }
 
 #ifdef ENABLE_PRECONNECTED_POOL
+/**
+ * @brief: 调用start时重置请求时间线
+ * @return:
+ */
+void ConnectNode::markTimelineStart() {
+  memset(&_timeline, 0, sizeof(_timeline));
+  _timeline.start_us = utility::TextUtils::GetMonotonicUs();
+  traceStart();
+}
+
+/**
+ * @brief: 开始connect, dns未单独记录完成时间(直连/IP缓存)则以此为准
+ * @return:
+ */
+void ConnectNode::markTimelineConnectBegin() {
+  uint64_t now = utility::TextUtils::GetMonotonicUs();
+  if (_timeline.dns_end_us < _timeline.dns_begin_us) {
+    _timeline.dns_end_us = now;
+  }
+  _timeline.connect_begin_us = now;
+  _timeline.connect_end_us = 0;
+}
+
+/**
+ * @brief: connect成功, 记录建连耗时
+ * @return:
+ */
+void ConnectNode::markTimelineConnected() {
+  uint64_t now = utility::TextUtils::GetMonotonicUs();
+  if (_timeline.connect_begin_us > 0 && _timeline.connect_end_us == 0) {
+    utility::NlsMetrics::recordHistogram(utility::MetricConnectLatency,
+                                         now - _timeline.connect_begin_us);
+  }
+  _timeline.connect_end_us = now;
+}
+
+/**
+ * @brief: gateway response解析成功, 记录SSL及WebSocket握手耗时
+ * @return:
+ */
+void ConnectNode::markTimelineHandshaked() {
+  uint64_t now = utility::TextUtils::GetMonotonicUs();
+  if (_timeline.connect_end_us > 0 &&
+      _timeline.ws_response_us < _timeline.connect_end_us) {
+    utility::NlsMetrics::recordHistogram(utility::MetricHandshakeLatency,
+                                         now - _timeline.connect_end_us);
+  }
+  _timeline.ws_response_us = now;
+}
+
+/**
+ * @brief: 按事件类型记录Started/首个结果/首包音频/Completed的时间点,
+ *         并记录相对start的耗时
+ * @return:
+ */
+void ConnectNode::updateTimelineWithEvent(NlsEvent::EventType eventType) {
+  if (_timeline.start_us == 0) {
+    return;
+  }
+
+  uint64_t now = utility::TextUtils::GetMonotonicUs();
+  utility::NlsMetricsHistogram id = utility::MetricHistogramNumber;
+  switch (eventType) {
+    case NlsEvent::RecognitionStarted:
+    case NlsEvent::TranscriptionStarted:
+    case NlsEvent::SynthesisStarted:
+    case NlsEvent::TaskStarted:
+      if (_timeline.started_us == 0) {
+        _timeline.started_us = now;
+        id = utility::MetricStartedLatency;
+      }
+      break;
+    case NlsEvent::RecognitionResultChanged:
+    case NlsEvent::TranscriptionResultChanged:
+    case NlsEvent::SentenceEnd:
+    case NlsEvent::DialogResultGenerated:
+    case NlsEvent::ResultGenerated:
+      if (_timeline.first_result_us == 0) {
+        _timeline.first_result_us = now;
+        id = utility::MetricFirstResultLatency;
+      }
+      break;
+    case NlsEvent::Binary:
+      if (_timeline.first_binary_us == 0) {
+        _timeline.first_binary_us = now;
+        id = utility::MetricFirstBinaryLatency;
+      }
+      break;
+    case NlsEvent::RecognitionCompleted:
+      if (_timeline.first_result_us == 0) {
+        _timeline.first_result_us = now;
+        id = utility::MetricFirstResultLatency;
+      }
+      _timeline.completed_us = now;
+      break;
+    case NlsEvent::TranscriptionCompleted:
+    case NlsEvent::SynthesisCompleted:
+    case NlsEvent::TaskFinished:
+      _timeline.completed_us = now;
+      break;
+    default:
+      break;
+  }
+
+  if (id != utility::MetricHistogramNumber) {
+    utility::NlsMetrics::recordHistogram(id, now - _timeline.start_us);
+  }
+}
+
+/**
+ * @brief: 设置了NlsTracer时, 生成本次请求的trace_id及根span,
+ *         调用方可通过http header参数traceparent传入父trace上下文
+ * @return:
+ */
+void ConnectNode::traceStart() {
+  _traceContext.reset();
+  if (utility::NlsTracing::getTracer() == NULL || _request == NULL) {
+    return;
+  }
+
+  _traceContext.enabled = true;
+  INlsRequestParam *param = _request->getRequestParam();
+  std::string traceParent;
+  if (param && param->_httpHeader.isMember("traceparent")) {
+    traceParent = param->_httpHeader["traceparent"].asString();
+  }
+  if (traceParent.empty() ||
+      !utility::NlsTracing::parseTraceParent(traceParent,
+                                             _traceContext.trace_id,
+                                             _traceContext.parent_span_id)) {
+    utility::NlsTracing::generateId(_traceContext.trace_id, 16);
+    _traceContext.parent_span_id[0] = '\0';
+  }
+  utility::NlsTracing::generateId(_traceContext.root_span_id, 8);
+}
+
+/**
+ * @brief: 累计sendAudio调用, 每audio_batch_count次调用产生一个sendAudio span
+ * @return:
+ */
+void ConnectNode::traceSendAudio(size_t dataSize, uint64_t beginUs) {
+  if (!_traceContext.enabled) {
+    return;
+  }
+  NlsTracer *tracer = utility::NlsTracing::getTracer();
+  if (tracer == NULL) {
+    return;
+  }
+
+  bool full = false;
+  MUTEX_LOCK(_mtxNode);
+  if (_traceContext.audio_count == 0) {
+    _traceContext.audio_begin_us = beginUs;
+  }
+  _traceContext.audio_end_us = utility::TextUtils::GetMonotonicUs();
+  _traceContext.audio_count++;
+  _traceContext.audio_bytes += dataSize;
+  full = _traceContext.audio_count >= NodeTraceContext::audio_batch_count;
+  MUTEX_UNLOCK(_mtxNode);
+
+  if (full) {
+    traceFlushAudio(tracer, utility::NlsTracing::monotonicToUnixOffsetUs());
+  }
+}
+
+void ConnectNode::traceFlushAudio(NlsTracer *tracer, uint64_t offsetUs) {
+  MUTEX_LOCK(_mtxNode);
+  uint64_t beginUs = _traceContext.audio_begin_us;
+  uint64_t endUs = _traceContext.audio_end_us;
+  uint32_t count = _traceContext.audio_count;
+  uint64_t bytes = _traceContext.audio_bytes;
+  _traceContext.audio_count = 0;
+  _traceContext.audio_bytes = 0;
+  MUTEX_UNLOCK(_mtxNode);
+
+  if (count > 0) {
+    traceEmitSpan(tracer, "sendAudio", _traceContext.root_span_id, NULL,
+                  beginUs, endUs, offsetUs, 0, count, bytes);
+  }
+}
+
+/**
+ * @brief: Close时根据请求时间线产生生命周期各阶段的span, 缺失的阶段不产生
+ * @return:
+ */
+void ConnectNode::traceFinish() {
+  if (!_traceContext.enabled) {
+    return;
+  }
+  NlsTracer *tracer = utility::NlsTracing::getTracer();
+  if (tracer == NULL) {
+    return;
+  }
+
+  const char *root = _traceContext.root_span_id;
+  uint64_t offsetUs = utility::NlsTracing::monotonicToUnixOffsetUs();
+  uint64_t handshakeBeginUs = _timeline.ssl_begin_us > 0
+                                  ? _timeline.ssl_begin_us
+                                  : _timeline.ws_request_us;
+  traceFlushAudio(tracer, offsetUs);
+  traceEmitSpan(tracer, "start", root, NULL, _timeline.start_us,
+                _timeline.started_us, offsetUs);
+  traceEmitSpan(tracer, "connect", root, NULL,
+                _timeline.dns_begin_us > 0 ? _timeline.dns_begin_us
+                                           : _timeline.connect_begin_us,
+                _timeline.connect_end_us, offsetUs);
+  traceEmitSpan(tracer, "handshake", root, NULL, handshakeBeginUs,
+                _timeline.ws_response_us, offsetUs);
+  traceEmitSpan(tracer, "started", root, NULL, _timeline.first_send_us,
+                _timeline.started_us, offsetUs);
+  traceEmitSpan(tracer, "stop", root, NULL, _timeline.stop_us,
+                _timeline.completed_us, offsetUs);
+  traceEmitSpan(tracer, "request", _traceContext.parent_span_id, root,
+                _timeline.start_us, _timeline.closed_us, offsetUs,
+                _traceContext.status_code);
+  _traceContext.enabled = false;
+}
+
+void ConnectNode::traceEmitSpan(NlsTracer *tracer, const char *name,
+                                const char *parentSpanId, const char *spanId,
+                                uint64_t beginUs, uint64_t endUs,
+                                uint64_t offsetUs, int statusCode,
+                                uint32_t audioCount, uint64_t audioBytes) {
+  if (beginUs == 0 || endUs < beginUs) {
+    return;
+  }
+
+  char newSpanId[17] = {0};
+  if (spanId == NULL) {
+    utility::NlsTracing::generateId(newSpanId, 8);
+    spanId = newSpanId;
+  }
+
+  NlsTraceSpan span;
+  span.name = name;
+  span.trace_id = _traceContext.trace_id;
+  span.span_id = spanId;
+  span.parent_span_id = parentSpanId;
+  span.start_unix_us = beginUs + offsetUs;
+  span.end_unix_us = endUs + offsetUs;
+  span.task_id = _request ? _request->getRequestParam()->_taskId : "";
+  span.node_uuid = _nodeUUID;
+  span.status_code = statusCode;
+  span.audio_count = audioCount;
+  span.audio_bytes = audioBytes;
+  tracer->onSpanEnd(span);
+}
+
 int ConnectNode::tryToGetPreconnection() {
   ConnectedStatus result = PreNodeInvalid;
   if (NlsEventNetWork::_eventClient &&
@@ -4660,6 +5685,8 @@ int ConnectNode::tryToGetPreconnection() {
         result = PreNodeConnected;
       }
     }
+    NlsEventNetWork::_eventClient->getPreconnectedPool()->statPopResult(
+        _request->getRequestParam()->_mode, popPreNode);
   }
   return result;
 }
@@ -4697,6 +5724,7 @@ bool ConnectNode::ignoreCallbackWhenReconnecting(NlsEvent::EventType eventType,
                 utility::TextUtils::GetTimestampMs();
             _reconnection.reconnected_count++;
             _reconnection.state = NodeReconnection::WillReconnect;
+            holdAudioReplay(true);
           }
         }
       }
@@ -4719,6 +5747,7 @@ bool ConnectNode::ignoreCallbackWhenReconnecting(NlsEvent::EventType eventType,
             return true;
           } else {
             _reconnection.state = NodeReconnection::NoReconnection;
+            holdAudioReplay(false);
             LOG_INFO("Node(%p) failed %d times, should boot normally.", this,
                      _reconnection.reconnected_count);
           }
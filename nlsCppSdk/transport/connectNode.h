@@ -27,9 +27,13 @@
 #endif
 
 #include <stdint.h>
+#include <string.h>
 
+#include <atomic>
+#include <deque>
 #include <queue>
 #include <string>
+#include <vector>
 
 #include "SSLconnect.h"
 #include "error.h"
@@ -41,6 +45,8 @@
 #include "nlsEncoder.h"
 #include "nlsEventInner.h"
 #include "nlsGlobal.h"
+#include "nlsTrace.h"
+#include "timerWheel.h"
 #include "webSocketFrameHandleBase.h"
 #include "webSocketTcp.h"
 #ifdef ENABLE_PRECONNECTED_POOL
@@ -155,84 +161,102 @@ enum ConnectType {
   ConnectWithPreconnectedNodePool,
 };
 
+/* Node在时间轮中的各类超时 */
+enum NodeTimeoutType {
+  NodeTimeoutRecv = 0,
+  NodeTimeoutSend,
+  NodeTimeoutConnect,     /* 建连及SSL握手中等待_connectEvent */
+  NodeTimeoutConnectPoll, /* ENABLE_HIGH_EFFICIENCY下定时检查建连 */
+  NodeTimeoutNumber,
+};
+
+/* Node交由工作线程执行的动作, 共用一个不关联fd的_triggerEvent */
+enum NodeTriggerAction {
+  NodeTriggerLaunch = 0,
+  NodeTriggerLongConnectionStart, /* 长链接上一轮NodeClosed后延后的start */
+  NodeTriggerStartWithPool,       /* 从预连接池取得节点后发起start */
+  NodeTriggerSingleRoundText,
+  NodeTriggerReconnect,   /* 延时执行, 自动重连 */
+  NodeTriggerConnectRace, /* 延时执行, Happy Eyeballs的错峰及整体超时 */
+  NodeTriggerAudioWritable, /* 音频发送缓冲区降至低水位, 回调AudioWritable */
+  NodeTriggerNumber,
+};
+
 #ifdef ENABLE_REQUEST_RECORDING
-/* Node运行过程记录 */
+/* Node运行过程记录的操作类型 */
+enum NodeRecordOp {
+  RecordCreate = 0,
+  RecordStart,
+  RecordStop,
+  RecordCancel,
+  RecordSendAudio,
+  RecordControl,
+  RecordSendText,
+  RecordCallback,
+  RecordStarted,
+  RecordCompleted,
+  RecordBinary,
+  RecordFirstBinary,
+  RecordFailed,
+  RecordClosed,
+  RecordOpNumber,
+};
+
+/*
+ * Node运行过程的飞行记录.
+ * 最近RingSize次操作(op/时间/大小)写入定长环形缓冲, 各op的次数/字节数/
+ * 最近时间单独累计, 均为relaxed原子写入, 无锁且无内存分配.
+ * 只在dumpAllInfo及Close/TaskFailed时解码为Json.
+ */
 struct NodeProcess {
  public:
-  explicit NodeProcess() {
-    create_timestamp_ms = 0;
-    start_timestamp_ms = 0;
-    started_timestamp_ms = 0;
-    stop_timestamp_ms = 0;
-    cancel_timestamp_ms = 0;
-    first_binary_timestamp_ms = 0;
-    last_send_timestamp_ms = 0;
-    last_ctrl_timestamp_ms = 0;
-    failed_timestamp_ms = 0;
-    completed_timestamp_ms = 0;
-    closed_timestamp_ms = 0;
-
-    last_op_timestamp_ms = 0;
-    last_status = NodeInvalid;
-
-    recording_bytes = 0;
-    send_count = 0;
-    play_bytes = 0;
-    play_count = 0;
-
-    /* about API */
-    api_start_run = false;
-    api_stop_run = false;
-    api_cancel_run = false;
-    api_send_run = false;
-    api_ctrl_run = false;
-    last_api_timestamp_ms = 0;
-
-    /* about CALLBACK */
-    last_callback = NlsEvent::TaskFailed;
-    last_cb_start_timestamp_ms = 0;
-    last_cb_end_timestamp_ms = 0;
-    last_cb_run = false;
-
-    connect_type = ConnectWithSSL;
-  };
+  enum NodeProcessConstValue { RingSize = 64 };
+  explicit NodeProcess();
   ~NodeProcess(){};
 
-  uint64_t create_timestamp_ms;
-  uint64_t start_timestamp_ms;
-  uint64_t started_timestamp_ms;
-  uint64_t stop_timestamp_ms;
-  uint64_t cancel_timestamp_ms;
-  uint64_t first_binary_timestamp_ms;
-  uint64_t last_send_timestamp_ms;
-  uint64_t last_ctrl_timestamp_ms;
-  uint64_t failed_timestamp_ms;
-  uint64_t completed_timestamp_ms;
-  uint64_t closed_timestamp_ms;
-
-  uint64_t last_op_timestamp_ms;
-  ConnectStatus last_status;
-
-  uint64_t recording_bytes;
-  uint64_t send_count;
-  uint64_t play_bytes;
-  uint64_t play_count;
-
-  /* about API */
-  bool api_start_run;
-  bool api_stop_run;
-  bool api_cancel_run;
-  bool api_send_run;
-  bool api_ctrl_run;
-  uint64_t last_api_timestamp_ms;
-
-  /* about CALLBACK */
-  NlsEvent::EventType last_callback;
-  uint64_t last_cb_start_timestamp_ms;
-  uint64_t last_cb_end_timestamp_ms;
-  bool last_cb_run;
-
-  ConnectType connect_type;
+  void record(NodeRecordOp op, bool enter, int status = 0, uint64_t size = 0);
+  /* 环形缓冲中的记录, 按时间先后, 跳过正在被覆盖的槽位 */
+  struct Entry {
+    uint64_t timestamp_ms;
+    uint32_t size;
+    NodeRecordOp op;
+    bool enter;
+    int status;
+  };
+  int snapshot(Entry *entries, int maxEntries);
+  bool isRunning(NodeRecordOp op) {
+    return enter_count[op].load(std::memory_order_relaxed) >
+           exit_count[op].load(std::memory_order_relaxed);
+  }
+  uint64_t count(NodeRecordOp op) {
+    return enter_count[op].load(std::memory_order_relaxed);
+  }
+  uint64_t lastMs(NodeRecordOp op, bool enter = true) {
+    return enter ? last_enter_ms[op].load(std::memory_order_relaxed)
+                 : last_exit_ms[op].load(std::memory_order_relaxed);
+  }
+  static const char *getOpString(NodeRecordOp op);
+
+  std::atomic<uint64_t> last_op_timestamp_ms;
+  std::atomic<int> last_status;   /* ConnectStatus */
+  std::atomic<int> last_callback; /* NlsEvent::EventType */
+  std::atomic<int> connect_type;  /* ConnectType */
+
+  std::atomic<uint64_t> enter_count[RecordOpNumber];
+  std::atomic<uint64_t> exit_count[RecordOpNumber];
+  std::atomic<uint64_t> bytes[RecordOpNumber];
+  std::atomic<uint64_t> last_enter_ms[RecordOpNumber];
+  std::atomic<uint64_t> last_exit_ms[RecordOpNumber];
+
+ private:
+  /* seq为写入序号+1, 写入过程中置0, 读取前后seq一致才有效 */
+  struct Slot {
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> timestamp_ms;
+    std::atomic<uint64_t> data; /* size:32 | op:8 | enter:8 | status:16 */
+  };
+  std::atomic<uint64_t> _head;
+  Slot _ring[RingSize];
 };
 #endif
 
@@ -262,8 +286,104 @@ struct NodeReconnection {
   uint64_t interruption_timestamp_ms;
   uint64_t first_audio_timestamp_ms;
 };
+
+/*
+ * 重连续传的音频重放缓冲, 按发送顺序保存最近capacity_ms内已编码的音频帧.
+ * 收到SentenceEnd后丢弃服务端已确认的音频, 中断期间(holding)音频只写入
+ * 此缓冲, 重连成功后将未确认的音频重新封包发送.
+ * 由ConnectNode::_mtxAudioReplay保护.
+ */
+struct NodeAudioReplay {
+ public:
+  struct Frame {
+    std::string data;    /* 已编码的音频, 不含ws帧头 */
+    uint64_t begin_ms;   /* 此帧在整个音频流中的起始位置 */
+    uint32_t duration_ms;
+  };
+  explicit NodeAudioReplay()
+      : capacity_ms(0),
+        total_ms(0),
+        confirmed_ms(0),
+        confirmed_index(0),
+        holding(false){};
+  ~NodeAudioReplay(){};
+
+  void push(const uint8_t *frame, size_t size, uint32_t durationMs);
+  void confirm(uint64_t confirmedMs, int sentenceIndex);
+  /* 重放的起始位置, 即服务端已确认的音频时长 */
+  uint64_t replayBeginMs() {
+    return frames.empty() ? total_ms : frames.front().begin_ms;
+  }
+  void clear() {
+    frames.clear();
+    holding = false;
+  }
+
+  std::deque<Frame> frames;
+  uint32_t capacity_ms;
+  uint64_t total_ms;     /* 已发送音频的总时长 */
+  uint64_t confirmed_ms; /* 最近一次SentenceEnd确认的音频位置 */
+  int confirmed_index;   /* 最近一次SentenceEnd的句子编号 */
+  bool holding;          /* 连接中断等待重连, 音频暂存不发送 */
+};
 #endif
 
+/* 单次请求的trace上下文, 仅在设置了NlsTracer时生效 */
+struct NodeTraceContext {
+ public:
+  enum { audio_batch_count = 50 /* 每批sendAudio的调用次数, 约1s音频 */ };
+  explicit NodeTraceContext() { reset(); };
+  void reset() {
+    enabled = false;
+    memset(trace_id, 0, sizeof(trace_id));
+    memset(parent_span_id, 0, sizeof(parent_span_id));
+    memset(root_span_id, 0, sizeof(root_span_id));
+    status_code = 0;
+    audio_begin_us = 0;
+    audio_end_us = 0;
+    audio_count = 0;
+    audio_bytes = 0;
+  };
+
+  bool enabled;
+  char trace_id[33];
+  char parent_span_id[17]; /* 调用方通过traceparent传入的父span */
+  char root_span_id[17];
+  int status_code;
+  uint64_t audio_begin_us;
+  uint64_t audio_end_us;
+  uint32_t audio_count;
+  uint64_t audio_bytes;
+};
+
+class ConnectNode;
+
+/* Happy Eyeballs(RFC 8305)的候选地址 */
+struct ConnectCandidate {
+ public:
+  explicit ConnectCandidate(const std::string &addr = "", int family = AF_INET)
+      : ip(addr), aiFamily(family){};
+  std::string ip;
+  int aiFamily;
+};
+
+/* Happy Eyeballs(RFC 8305)中正在进行的一次建连尝试 */
+struct ConnectAttempt {
+ public:
+  explicit ConnectAttempt()
+      : node(NULL),
+        aiFamily(AF_INET),
+        socketFd(INVALID_SOCKET),
+        event(NULL),
+        startTimestampMs(0){};
+  ConnectNode *node;
+  std::string ip;
+  int aiFamily;
+  evutil_socket_t socketFd;
+  struct event *event;
+  uint64_t startTimestampMs;
+};
+
 class ConnectNode {
  public:
   ConnectNode(INlsRequest *request,
@@ -279,12 +399,10 @@ class ConnectNode {
   inline void setRequest(INlsRequest *request) { _request = request; }
   inline WorkThread *getEventThread() { return _eventThread; }
   inline void setEventThread(WorkThread *thread) { _eventThread = thread; }
-  /* 1.2. get event point of launching node */
-  struct event *getLaunchEvent(bool init = false);
-#ifdef ENABLE_PRECONNECTED_POOL
-  struct event *getStartWithPoolEvent(bool init = false);
-#endif
-  struct event *getSingleRoundTextEvent();
+  /* 1.2. actions triggered on the WorkThread of this node */
+  int triggerAction(NodeTriggerAction action, unsigned int delayMs = 0);
+  void cancelAction(NodeTriggerAction action);
+  unsigned int takeTriggeredActions();
   bool _isSendSingleRoundText;
   /* 1.3. something about status of this node */
   /*      design to record work status */
@@ -318,6 +436,8 @@ class ConnectNode {
   }
   inline bool isPreNodeStartStepByStep() { return _isPreNodeStartStepByStep; }
   void initAllStatus(); /*init all status in longConnection mode*/
+  /*      长链接模式下, 上一轮交互未进入NodeClosed时, 延后到Closed再start */
+  bool deferLongConnectionStart();
   /* 1.4. about error */
   inline int getErrorCode() { return _nodeErrCode; };
   inline const char *getErrorMsg() { return _nodeErrMsg.c_str(); };
@@ -341,6 +461,8 @@ class ConnectNode {
   /* 3.1. send audio data */
   int addAudioDataBuffer(const uint8_t *frame, size_t length);
   int addSlicedAudioDataBuffer(const uint8_t *frame, size_t length);
+  /*      音频发送缓冲区剩余可写字节数, 为0时待降至低水位后回调AudioWritable */
+  size_t getAudioCredit();
   /* 3.2. parse&send request */
   int sendControlDirective();
   int gatewayRequest();
@@ -357,16 +479,30 @@ class ConnectNode {
   inline SSLconnect *getSslHandle() { return _sslHandle; }
   inline void setSslHandle(SSLconnect *handle) { _sslHandle = handle; }
   inline struct event *getConnectEvent() { return _connectEvent; }
-  inline struct timeval *getConnectTv() { return &_connectTv; }
   inline urlAddress getUrlAddress() { return _url; }
   inline urlAddress *getUrlAddressPointer() { return &_url; }
-  inline struct timeval *getRecvTvPointer() { return &_recvTv; }
   inline bool getEnableRecvTv() { return _enableRecvTv; }
+  /*    边沿触发时读写共用_readEvent, 各类超时共用时间轮中的_timeoutEntry */
+  inline bool isEdgeTriggered() { return _edgeTriggered; }
+  int addSocketEvent();
+  int waitWritable(bool blocked);
+  bool needWritable();
+  void refreshRecvTimeout();
+  inline void clearTimeout(NodeTimeoutType type) { updateTimeout(type, 0); }
+  NodeTimeoutType checkTimeout();
   int dnsProcess(int aiFamily, char *directIp, bool sysGetAddr);
   int socketConnect();
   int connectProcess(const char *ip, int aiFamily);
   int sslProcess();
   void disconnectProcess();
+  /*    Happy Eyeballs: 多地址错峰并行建连, 保留最先建连成功的socket */
+  int connectRaceProcess(std::vector<struct ConnectCandidate> &candidates);
+  int startNextConnectAttempt();
+  int winConnectRace(struct ConnectAttempt *attempt);
+  int failConnectAttempt(struct ConnectAttempt *attempt);
+  bool connectRaceTimeout();
+  void cancelConnectRace();
+  inline bool isConnectRacing() { return !_connectAttempts.empty(); }
 #ifdef ENABLE_PRECONNECTED_POOL
   int prestartProcess();
   int prestartEventDelProcess();
@@ -389,20 +525,14 @@ class ConnectNode {
 
   /* 8. design to native_getaddrinfo */
 #ifdef __LINUX__
-  char *_nodename;
-  char *_servname;
+  bool _dnsResolving; /*已提交至DnsResolverPool且结果尚未投递*/
 
-  pthread_t _dnsThread; /*异步dns方案启动线程*/
-  bool _dnsThreadExit;
-  bool _dnsThreadRunning;   /*异步dns方案线程已经启动*/
-  struct timespec _outtime; /*异步dns方案超时设置*/
-
-  struct gaicb *_gaicbRequest[1];
   struct event *_dnsEvent;
   int _dnsErrorCode;
   struct evutil_addrinfo *_addrinfo;
 
-  static void *async_dns_resolve_thread_fn(void *arg);
+  void sysDnsResolved(int errorCode, struct evutil_addrinfo *address);
+  void cancelSysDnsResolve();
 #endif
   int _dnsRequestCallbackStatus; /* 1:开始DNS; 2:结束DNS */
 
@@ -411,10 +541,12 @@ class ConnectNode {
   HANDLE _mtxNode;
   HANDLE _mtxCloseNode;
   HANDLE _mtxEventCallbackNode;
+  HANDLE _mtxTimeout; /* 保护各超时时刻, 延时动作及_timeoutEntry */
 #else
   pthread_mutex_t _mtxNode;
   pthread_mutex_t _mtxCloseNode;
   pthread_mutex_t _mtxEventCallbackNode;
+  pthread_mutex_t _mtxTimeout; /* 保护各超时时刻, 延时动作及_timeoutEntry */
   pthread_cond_t _cvEventCallbackNode; /*释放过程中等待事件回调结束*/
 #endif
   bool _inEventCallbackNode;         /*是否处于事件回调中*/
@@ -427,14 +559,17 @@ class ConnectNode {
   }
   inline unsigned int getSyncCallTimeout() { return _syncCallTimeoutMs; }
   void waitInvokeFinish();
+  ConnectStatus waitLongConnectionClosed(unsigned int timeoutMs);
 
   /* 11. about listener */
   void handlerTaskFailedEvent(std::string failedInfo,
                               int code = DefaultErrorCode);
+  void handlerAudioWritableEvent();
 
 #ifdef ENABLE_REQUEST_RECORDING
   /* 12. design for recording process */
-  void updateNodeProcess(std::string api, int status, bool enter, size_t size);
+  void updateNodeProcess(NodeRecordOp op, int status, bool enter,
+                         size_t size);
   const char *dumpAllInfo();
   inline struct NodeProcess *getNodeProcess() { return &_nodeProcess; }
   std::string getConnectTypeStr();
@@ -442,12 +577,20 @@ class ConnectNode {
 
 #ifdef ENABLE_CONTINUED
   /* 13. design for reconnection automatically */
-  struct event *getReconnectEvent();
   struct NodeReconnection _reconnection;
+  /*    about audio replay when reconnecting */
+  bool isAudioReplayHolding();
 #endif
 
   /* 14. others */
   void sendFakeSynthesisStarted();
+  /*    about request timeline and metrics */
+  void markTimelineStart();
+  void markTimelineConnected();
+  void markTimelineHandshaked();
+  inline struct NlsRequestTimeline *getRequestTimeline() { return &_timeline; }
+  /*    about tracing spans */
+  void traceSendAudio(size_t dataSize, uint64_t beginUs);
 #ifdef ENABLE_PRECONNECTED_POOL
   int tryToGetPreconnection();
   int getPoolIndex();
@@ -458,11 +601,13 @@ class ConnectNode {
   enum ConnectNodeConstValue {
     RetryConnectCount = 4,
     ConnectTimerIntervalMs = 30,
+    ConnectAttemptDelayMs = 250, /* RFC 8305推荐的错峰建连间隔 */
     SampleRate8K = 8000,
     SampleRate16K = 16000,
     Buffer8kMaxLimit = 96000,   /* 16000bytes = 1s, 6s */
     Buffer16kMaxLimit = 192000, /* 32000bytes = 1s, 6s */
     NodeFrameSize = 2048,
+    ReadDrainBudget = 262144, /* 单次读事件最多读取的字节数, 保证节点间公平 */
   };
 
   /* 1. about pointer and status of this node  */
@@ -472,13 +617,17 @@ class ConnectNode {
   WorkThread *_eventThread;
   /*      setting request of this node*/
   INlsRequest *_request;
-  /* 1.2. event point of launching node */
-  struct event *_launchEvent;
+  /* 1.2. actions triggered on the WorkThread of this node */
+  struct event *getTriggerEvent();
+  void armTriggerEventLocked(uint64_t now);
+  struct event *_triggerEvent;
+  std::atomic<unsigned int> _triggerPending; /* 待执行动作的掩码 */
+  /* 延时动作的到期时刻, 0为未设置, 由_mtxTimeout保护 */
+  uint64_t _triggerDeadlineMs[NodeTriggerNumber];
+  bool _longConnectionStartPending;
 #ifdef ENABLE_PRECONNECTED_POOL
-  struct event *_startWithPoolEvent;
   int _poolIndex;
 #endif
-  struct event *_singleRoundTextEvent;
   /* 1.3. something about status of this node */
   bool _isStop;
   bool _isFirstBinaryFrame;
@@ -509,14 +658,29 @@ class ConnectNode {
   std::string getCmdTypeString(int type);
   /* 2.2. evBuffer for command */
   size_t _limitSize;
+  /* 发送缓冲区写满后置位, 降至_limitSize/2以下时回调AudioWritable并清除 */
+  bool _audioWritablePending;
+  struct evbuffer *getAudioEvBuffer();
   struct evbuffer *_readEvBuffer;
   struct evbuffer *_binaryEvBuffer;
   struct evbuffer *_cmdEvBuffer;
   struct evbuffer *_wwvEvBuffer;
   /* 2.3. ev for command */
   struct event *_connectEvent;
-  struct event *_readEvent;
-  struct event *_writeEvent;
+  struct event *_readEvent;    /* 边沿触发时同时监听EV_WRITE */
+  struct event *_writeEvent;   /* 仅水平触发时使用 */
+  bool _edgeTriggered;
+  int _pendingReadError; /* 读到数据后遇到的错误, 在紧接着的读事件中处理 */
+  TimerWheelEntry _timeoutEntry; /* 各类超时共用的时间轮定时项 */
+  TimerWheel *_timeoutWheel;     /* _timeoutEntry最近加入的时间轮 */
+  bool _timeoutEnabled;          /* 释放事件后不再加入时间轮 */
+  uint64_t _deadlineMs[NodeTimeoutNumber]; /* 各类超时时刻, 0为未设置 */
+  uint64_t _timeoutFireMs; /* _timeoutEntry的到期时刻, 0为未加入 */
+  int assignSocketIoEvents(evutil_socket_t sockFd);
+  void resetTimeouts();
+  void cancelTimeouts();
+  void updateTimeout(NodeTimeoutType type, unsigned int timeoutMs);
+  void scheduleTimeoutLocked(uint64_t deadlineMs);
 
   /* 3. send command and audio data */
   /* 3.1. send audio data */
@@ -529,11 +693,15 @@ class ConnectNode {
   /* 4. recv response and parse */
   int socketRead(uint8_t *buffer, size_t len);
   int nlsReceive(uint8_t *buffer, int max_size);
+  int nlsReceiveDrain(uint8_t *buffer, int max_size);
   NlsEvent *convertResult(WebSocketFrame *frame, int *result);
   int parseFrame(WebSocketFrame *wsFrame);
+  bool isCurrentDashTaskEvent(NlsEvent *frameEvent);
 
   /* 5. something about network */
   bool checkConnectCount();
+  int assignSocketEvents(evutil_socket_t sockFd, const char *ip, int aiFamily);
+  void applySocketOptions(evutil_socket_t sockFd);
   /*    about socket connection */
   urlAddress _url;
   evutil_socket_t _socketFd;
@@ -547,15 +715,15 @@ class ConnectNode {
   WebSocketHeaderType _wsType;
   struct evdns_getaddrinfo_request *_dnsRequest;
   size_t _retryConnectCount; /*try count of connection*/
-  struct timeval _connectTv;
   bool _enableRecvTv;
-  struct timeval _recvTv;
-  struct timeval _sendTv;
 #ifdef ENABLE_HIGH_EFFICIENCY
-  struct timeval _connectTimerTv;
-  struct event *_connectTimerEvent;
   bool _connectTimerFlag;
 #endif
+  /*    about Happy Eyeballs */
+  std::vector<struct ConnectCandidate> _connectCandidates;
+  size_t _nextConnectCandidate;
+  std::vector<struct ConnectAttempt *> _connectAttempts;
+  uint64_t _connectRaceBeginMs;
 
   /* 6. exit operation */
   const char *genCloseMsg(std::string *buf_str);
@@ -588,8 +756,20 @@ class ConnectNode {
                     NlsEvent::EventType eventType, bool ignore = false);
   void handlerMessage(const char *response, NlsEvent::EventType eventType);
   int handlerFrame(NlsEvent *frameEvent);
+  void updateTimelineWithEvent(NlsEvent::EventType eventType);
+  void markTimelineConnectBegin();
+  void traceStart();
+  void traceFinish();
+  void traceFlushAudio(NlsTracer *tracer, uint64_t offsetUs);
+  void traceEmitSpan(NlsTracer *tracer, const char *name,
+                     const char *parentSpanId, const char *spanId,
+                     uint64_t beginUs, uint64_t endUs, uint64_t offsetUs,
+                     int statusCode = 0, uint32_t audioCount = 0,
+                     uint64_t audioBytes = 0);
   HandleBaseOneParamWithReturnVoid<NlsEvent> *_handler; /*callback listener*/
   bool _enableOnMessage;
+  struct NlsRequestTimeline _timeline;
+  struct NodeTraceContext _traceContext;
 
 #ifdef ENABLE_REQUEST_RECORDING
   /* 12. design for recording process */
@@ -599,8 +779,10 @@ class ConnectNode {
   Json::Value updateNodeProcess4Timestamp();
   Json::Value updateNodeProcess4Callback();
   Json::Value updateNodeProcess4Block();
+  Json::Value updateNodeProcess4Events();
 
   struct NodeProcess _nodeProcess;
+  std::string _nodeProcessInfo;
 #endif
 
 #ifdef ENABLE_CONTINUED
@@ -608,7 +790,16 @@ class ConnectNode {
   Json::Value updateNodeReconnection();
   void updateTwIndexOffset(NlsEvent *frameEvent);
   bool nodeReconnecting();
-  struct event *_reconnectEvent;
+
+  uint32_t getAudioReplayDurationMs(size_t pcmSize);
+  void holdAudioReplay(bool hold);
+  int replayAudio();
+  struct NodeAudioReplay _audioReplay;
+#if defined(_MSC_VER)
+  HANDLE _mtxAudioReplay;
+#else
+  pthread_mutex_t _mtxAudioReplay;
+#endif
 #endif
   bool ignoreCallbackWhenReconnecting(NlsEvent::EventType eventType, int code);
   bool ignoreCallbackWhenNodeClosedWhenLongConnection(
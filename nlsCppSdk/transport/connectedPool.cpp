@@ -26,10 +26,18 @@
 #include <sys/sysinfo.h>
 #include <unistd.h>
 #endif
+#include <math.h>
+
 #include "connectedPool.h"
+#include "dashCosyVoiceSynthesizerRequest.h"
+#include "dashFunAsrTranscriberRequest.h"
+#include "dashParaformerTranscriberRequest.h"
+#include "dialogAssistantRequest.h"
 #include "flowingSynthesizerRequest.h"
+#include "json/json.h"
 #include "nlog.h"
 #include "nlsEventNetWork.h"
+#include "nlsMetrics.h"
 #include "nlsRequestParamInfo.h"
 #include "speechRecognizerRequest.h"
 #include "speechSynthesizerRequest.h"
@@ -39,11 +47,22 @@
 
 namespace AlibabaNls {
 
+/* 自动扩缩容: EWMA平滑系数 */
+static const double kPoolScaleEwmaAlpha = 0.3;
+/* 自动扩缩容: 每秒获取次数低于此值时视为无流量 */
+static const double kPoolScaleMinPopRate = 0.01;
+/* 自动扩缩容: 两次缩容的最小间隔, 避免流量抖动时反复建连断连 */
+static const uint64_t kPoolScaleDownIntervalMs = 10000;
+
 ConnectedPool::ConnectedPool(unsigned int maxNumber, unsigned int timeoutMs,
                              unsigned int requestedTimeoutMs)
     : _maxPreconnectedNumber(maxNumber),
       _preconnectedTimeoutMs(timeoutMs),
       _prerequestedTimeoutMs(requestedTimeoutMs),
+      _autoScale(false),
+      _minScaleNumber(maxNumber),
+      _maxScaleNumber(maxNumber),
+      _targetHitRatio(1.0),
       _poolWorkBase(NULL),
       _connectPoolEvent(NULL),
       _connectPoolTimerFlag(false),
@@ -58,9 +77,29 @@ ConnectedPool::ConnectedPool(unsigned int maxNumber, unsigned int timeoutMs,
            _poolWorkBase, features);
 
   _fssRequests.type = TypeStreamInputTts;
+  _fssRequests.name = "fss";
   _srRequests.type = TypeAsr;
+  _srRequests.name = "sr";
   _stRequests.type = TypeRealTime;
+  _stRequests.name = "st";
   _syRequests.type = TypeTts;
+  _syRequests.name = "sy";
+  _daRequests.type = TypeDialog;
+  _daRequests.name = "da";
+  _dashParaformerRequests.type = TypeDashScopeParaformerRealTime;
+  _dashParaformerRequests.name = "dashParaformer";
+  _dashFunAsrRequests.type = TypeDashScopeFunAsrRealTime;
+  _dashFunAsrRequests.name = "dashFunAsr";
+  _dashCosyVoiceRequests.type = TypeDashSceopCosyVoiceStreamInputTts;
+  _dashCosyVoiceRequests.name = "dashCosyVoice";
+  _poolProcesses.push_back(&_fssRequests);
+  _poolProcesses.push_back(&_srRequests);
+  _poolProcesses.push_back(&_stRequests);
+  _poolProcesses.push_back(&_syRequests);
+  _poolProcesses.push_back(&_daRequests);
+  _poolProcesses.push_back(&_dashParaformerRequests);
+  _poolProcesses.push_back(&_dashFunAsrRequests);
+  _poolProcesses.push_back(&_dashCosyVoiceRequests);
 
   if (NULL == _connectPoolEvent) {
     _connectPoolEvent = evtimer_new(
@@ -113,21 +152,12 @@ ConnectedPool::~ConnectedPool() {
     usleep(1 * 1000);
   }
 
-  if (_fssRequests.work) {
-    deletePreNode(&_fssRequests.prestartedRequests);
-    deletePreNode(&_fssRequests.preconnectedRequests);
-  }
-  if (_srRequests.work) {
-    deletePreNode(&_srRequests.prestartedRequests);
-    deletePreNode(&_srRequests.preconnectedRequests);
-  }
-  if (_stRequests.work) {
-    deletePreNode(&_stRequests.prestartedRequests);
-    deletePreNode(&_stRequests.preconnectedRequests);
-  }
-  if (_syRequests.work) {
-    deletePreNode(&_syRequests.prestartedRequests);
-    deletePreNode(&_syRequests.preconnectedRequests);
+  std::vector<struct ConnectedPoolProcess *>::iterator it;
+  for (it = _poolProcesses.begin(); it != _poolProcesses.end(); ++it) {
+    if ((*it)->work) {
+      deletePreNode(&(*it)->prestartedRequests);
+      deletePreNode(&(*it)->preconnectedRequests);
+    }
   }
 
 #if defined(_MSC_VER)
@@ -139,6 +169,44 @@ ConnectedPool::~ConnectedPool() {
   LOG_DEBUG("ConnectedPool(%p) destructing done", this);
 }
 
+int ConnectedPool::setAutoScale(unsigned int minNumber, unsigned int maxNumber,
+                                float targetHitRatio) {
+  if (maxNumber == 0 || minNumber > maxNumber || targetHitRatio <= 0.0 ||
+      targetHitRatio > 1.0) {
+    LOG_ERROR(
+        "ConnectedPool(%p) setAutoScale with invalid params min:%u max:%u "
+        "target hit ratio:%f.",
+        this, minNumber, maxNumber, targetHitRatio);
+    return -(InvalidInputParam);
+  }
+
+  MUTEX_LOCK(_lock);
+  _autoScale = true;
+  _minScaleNumber = minNumber;
+  _maxScaleNumber = maxNumber;
+  _targetHitRatio = targetHitRatio;
+  LOG_INFO(
+      "ConnectedPool(%p) enable auto scale, min:%u max:%u initial:%u target "
+      "hit ratio:%f.",
+      this, _minScaleNumber, _maxScaleNumber, _maxPreconnectedNumber,
+      _targetHitRatio);
+
+  /* 已分配槽位的交互类型无法安全扩容vector, 上限按已分配槽位数截断 */
+  std::vector<struct ConnectedPoolProcess *>::iterator it;
+  for (it = _poolProcesses.begin(); it != _poolProcesses.end(); ++it) {
+    struct ConnectedPoolProcess *process = *it;
+    unsigned int capacity = getAllocatedCapacity(process);
+    if (_maxScaleNumber > capacity) {
+      LOG_WARN(
+          "ConnectedPool(%p) type(%d) has allocated %u slots, max number %u "
+          "is clamped to %u.",
+          this, process->type, capacity, _maxScaleNumber, capacity);
+    }
+  }  // for
+  MUTEX_UNLOCK(_lock);
+  return Success;
+}
+
 #if defined(_MSC_VER)
 unsigned __stdcall ConnectedPool::loopConnectedPoolEventCallback(LPVOID arg) {
 #else
@@ -208,37 +276,30 @@ void ConnectedPool::connectPoolEventCallback(evutil_socket_t socketFd,
             pool);
 
   int releaseCount = 0;
+  unsigned int warmCount = 0;
 
   if (event == EV_CLOSED) {
   } else {
     // event == EV_TIMEOUT
-    if (pool->_fssRequests.work) {
-      releaseCount +=
-          pool->timeoutPrestartedNode(&pool->_fssRequests.prestartedRequests);
-      releaseCount += pool->timeoutPreconnectedNode(
-          &pool->_fssRequests.preconnectedRequests);
-    }
-    if (pool->_srRequests.work) {
-      releaseCount +=
-          pool->timeoutPrestartedNode(&pool->_srRequests.prestartedRequests);
-      releaseCount += pool->timeoutPreconnectedNode(
-          &pool->_srRequests.preconnectedRequests);
-    }
-    if (pool->_stRequests.work) {
-      releaseCount +=
-          pool->timeoutPrestartedNode(&pool->_stRequests.prestartedRequests);
-      releaseCount += pool->timeoutPreconnectedNode(
-          &pool->_stRequests.preconnectedRequests);
-    }
-    if (pool->_syRequests.work) {
-      releaseCount +=
-          pool->timeoutPrestartedNode(&pool->_syRequests.prestartedRequests);
-      // pool->showEveryNode(&pool->_syRequests.prestartedRequests,
-      //                     "syPrestarted after timeout");
-      releaseCount += pool->timeoutPreconnectedNode(
-          &pool->_syRequests.preconnectedRequests);
-      // pool->showEveryNode(&pool->_syRequests.preconnectedRequests,
-      //                     "syPreconnected after timeout");
+    uint64_t nowMs = utility::TextUtils::GetTimestampMs();
+    std::vector<struct ConnectedPoolProcess *>::iterator it;
+    for (it = pool->_poolProcesses.begin(); it != pool->_poolProcesses.end();
+         ++it) {
+      struct ConnectedPoolProcess *process = *it;
+      if (process->work) {
+        struct ConnectedPoolScaler &scaler = process->scaler;
+        pool->autoScaleThisNodesPool(process, nowMs);
+        releaseCount += pool->timeoutPrestartedNode(
+            &process->prestartedRequests, scaler.activeNumber);
+        releaseCount += pool->timeoutPreconnectedNode(
+            &process->preconnectedRequests, scaler.activeNumber);
+        warmCount += scaler.warmDeficit;
+        utility::NlsMetrics::updatePreconnectedPool(
+            std::distance(pool->_poolProcesses.begin(), it),
+            process->name.c_str(), scaler.activeNumber, scaler.warmDeficit,
+            scaler.popRateEwma, scaler.missRateEwma, scaler.hitRatio,
+            scaler.scaleUpCount, scaler.scaleDownCount, scaler.lastDecision);
+      }
     }
   }
 
@@ -246,7 +307,8 @@ void ConnectedPool::connectPoolEventCallback(evutil_socket_t socketFd,
 
   evtimer_add(pool->_connectPoolEvent, &pool->_connectPoolTimerTv);
 
-  if (releaseCount > 0) {
+  /* 扩容后的空闲槽位也在nodeReleaseEventCallback中补充预连接 */
+  if (releaseCount > 0 || warmCount > 0) {
     event_active(pool->_nodeReleaseEvent, EV_READ, 0);
   }
 
@@ -276,33 +338,17 @@ void ConnectedPool::nodeReleaseEventCallback(evutil_socket_t socketFd,
       pool);
 
   if (event == EV_READ) {
-    if (pool->_fssRequests.work) {
-      pool->deleteOrPreconnectNodeShouldReleased(
-          &pool->_fssRequests.prestartedRequests, "fssPrestarted");
-      pool->deleteOrPreconnectNodeShouldReleased(
-          &pool->_fssRequests.preconnectedRequests, "fssPreconnected");
-    }
-    if (pool->_srRequests.work) {
-      pool->deleteOrPreconnectNodeShouldReleased(
-          &pool->_srRequests.prestartedRequests, "srPrestarted");
-      pool->deleteOrPreconnectNodeShouldReleased(
-          &pool->_srRequests.preconnectedRequests, "srPreconnected");
-    }
-    if (pool->_stRequests.work) {
-      pool->deleteOrPreconnectNodeShouldReleased(
-          &pool->_stRequests.prestartedRequests, "stPrestarted");
-      // pool->showEveryNode(&pool->_stRequests.prestartedRequests,
-      //                     "stPrestarted");
-      pool->deleteOrPreconnectNodeShouldReleased(
-          &pool->_stRequests.preconnectedRequests, "stPreconnected");
-      // pool->showEveryNode(&pool->_stRequests.preconnectedRequests,
-      //                     "stPreconnected");
-    }
-    if (pool->_syRequests.work) {
-      pool->deleteOrPreconnectNodeShouldReleased(
-          &pool->_syRequests.prestartedRequests, "syPrestarted");
-      pool->deleteOrPreconnectNodeShouldReleased(
-          &pool->_syRequests.preconnectedRequests, "syPreconnected");
+    std::vector<struct ConnectedPoolProcess *>::iterator it;
+    for (it = pool->_poolProcesses.begin(); it != pool->_poolProcesses.end();
+         ++it) {
+      struct ConnectedPoolProcess *process = *it;
+      if (process->work) {
+        pool->deleteOrPreconnectNodeShouldReleased(
+            &process->prestartedRequests, process->name + "Prestarted");
+        pool->deleteOrPreconnectNodeShouldReleased(
+            &process->preconnectedRequests, process->name + "Preconnected");
+        pool->warmThisNodesPool(process);
+      }
     }
   }
 
@@ -508,27 +554,10 @@ bool ConnectedPool::pushPreconnectedNode(INlsRequest *request, NlsType type,
   evutil_socket_t curSocketFd = request->getConnectNode()->getSocketFd();
   SSLconnect *curSslHandle = request->getConnectNode()->getSslHandle();
 
-  struct ConnectedPoolProcess *poolProcess = NULL;
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
-  switch (type) {
-    case TypeAsr:
-      poolProcess = &_srRequests;
-      curPool = &_srRequests.preconnectedRequests;
-      break;
-    case TypeRealTime:
-      poolProcess = &_stRequests;
-      curPool = &_stRequests.preconnectedRequests;
-      break;
-    case TypeTts:
-      poolProcess = &_syRequests;
-      curPool = &_syRequests.preconnectedRequests;
-      break;
-    case TypeStreamInputTts:
-      poolProcess = &_fssRequests;
-      curPool = &_fssRequests.preconnectedRequests;
-      break;
-    default:
-      break;
+  if (poolProcess) {
+    curPool = &poolProcess->preconnectedRequests;
   }
 
   if (curPool) {
@@ -583,7 +612,9 @@ bool ConnectedPool::pushPreconnectedNode(INlsRequest *request, NlsType type,
              curPool->begin();
          it != curPool->end(); ++it) {
       if (it->status == PreNodeToBeCreated && !it->shouldRelease &&
-          it->request == NULL) {
+          it->request == NULL &&
+          std::distance(curPool->begin(), it) <
+              (int)poolProcess->scaler.activeNumber) {
         index = std::distance(curPool->begin(), it);
         it->type = request->getRequestParam()->_mode;
         it->status = PreNodeConnected;
@@ -591,7 +622,7 @@ bool ConnectedPool::pushPreconnectedNode(INlsRequest *request, NlsType type,
             request->getConnectNode()->getNodeProcess()->last_op_timestamp_ms;
         uint64_t oldTimestamp = it->workableTimestamp;
         it->startTimestamp = it->workableTimestamp;
-        if (request->getRequestParam()->_mode == TypeTts) {
+        if (nodeWithVersion(request->getRequestParam()->_mode)) {
           it->ttsVersion = request->getRequestParam()->getVersion();
         }
         it->sdkName = request->getRequestParam()->getSdkName();
@@ -699,27 +730,10 @@ bool ConnectedPool::pushPrestartedNode(INlsRequest *request, NlsType type,
   evutil_socket_t curSocketFd = request->getConnectNode()->getSocketFd();
   SSLconnect *curSslHandle = request->getConnectNode()->getSslHandle();
 
-  struct ConnectedPoolProcess *poolProcess = NULL;
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
-  switch (type) {
-    case TypeAsr:
-      poolProcess = &_srRequests;
-      curPool = &_srRequests.prestartedRequests;
-      break;
-    case TypeRealTime:
-      poolProcess = &_stRequests;
-      curPool = &_stRequests.prestartedRequests;
-      break;
-    case TypeTts:
-      poolProcess = &_syRequests;
-      curPool = &_syRequests.prestartedRequests;
-      break;
-    case TypeStreamInputTts:
-      poolProcess = &_fssRequests;
-      curPool = &_fssRequests.prestartedRequests;
-      break;
-    default:
-      break;
+  if (poolProcess) {
+    curPool = &poolProcess->prestartedRequests;
   }
 
   if (curPool) {
@@ -786,14 +800,16 @@ bool ConnectedPool::pushPrestartedNode(INlsRequest *request, NlsType type,
              curPool->begin();
          it != curPool->end(); ++it) {
       if (it->status == PreNodeToBeCreated && !it->shouldRelease &&
-          it->request == NULL) {
+          it->request == NULL &&
+          std::distance(curPool->begin(), it) <
+              (int)poolProcess->scaler.activeNumber) {
         index = std::distance(curPool->begin(), it);
         it->type = request->getRequestParam()->_mode;
         it->status = PreNodeStarted;
         it->workableTimestamp =
             request->getConnectNode()->getNodeProcess()->last_op_timestamp_ms;
         it->startTimestamp = it->workableTimestamp;
-        if (request->getRequestParam()->_mode == TypeTts) {
+        if (nodeWithVersion(request->getRequestParam()->_mode)) {
           it->ttsVersion = request->getRequestParam()->getVersion();
         }
         it->sdkName = request->getRequestParam()->getSdkName();
@@ -893,32 +909,12 @@ bool ConnectedPool::pushPrestartedNodeFromPreconnected(INlsRequest *request,
   evutil_socket_t curSocketFd = request->getConnectNode()->getSocketFd();
   SSLconnect *curSslHandle = request->getConnectNode()->getSslHandle();
 
-  struct ConnectedPoolProcess *poolProcess = NULL;
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
   std::vector<struct ConnectedNodeProcess> *curPool0 = NULL;
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
-  switch (type) {
-    case TypeAsr:
-      poolProcess = &_srRequests;
-      curPool0 = &_srRequests.preconnectedRequests;
-      curPool = &_srRequests.prestartedRequests;
-      break;
-    case TypeRealTime:
-      poolProcess = &_stRequests;
-      curPool0 = &_stRequests.preconnectedRequests;
-      curPool = &_stRequests.prestartedRequests;
-      break;
-    case TypeTts:
-      poolProcess = &_syRequests;
-      curPool0 = &_syRequests.preconnectedRequests;
-      curPool = &_syRequests.prestartedRequests;
-      break;
-    case TypeStreamInputTts:
-      poolProcess = &_fssRequests;
-      curPool0 = &_fssRequests.preconnectedRequests;
-      curPool = &_fssRequests.prestartedRequests;
-      break;
-    default:
-      break;
+  if (poolProcess) {
+    curPool0 = &poolProcess->preconnectedRequests;
+    curPool = &poolProcess->prestartedRequests;
   }
 
   bool result = false;
@@ -937,7 +933,9 @@ bool ConnectedPool::pushPrestartedNodeFromPreconnected(INlsRequest *request,
                    curPool->begin();
                it != curPool->end(); ++it) {
             if (it->status == PreNodeToBeCreated && !it->shouldRelease &&
-                it->request == NULL) {
+                it->request == NULL &&
+                std::distance(curPool->begin(), it) <
+                    (int)poolProcess->scaler.activeNumber) {
               index = std::distance(curPool->begin(), it);
               it->type = node.request->getRequestParam()->_mode;
               it->status = PreNodeStarted;
@@ -945,7 +943,7 @@ bool ConnectedPool::pushPrestartedNodeFromPreconnected(INlsRequest *request,
                                           ->getNodeProcess()
                                           ->last_op_timestamp_ms;
               it->startTimestamp = it->workableTimestamp;
-              if (node.request->getRequestParam()->_mode == TypeTts) {
+              if (nodeWithVersion(node.request->getRequestParam()->_mode)) {
                 it->ttsVersion = node.request->getRequestParam()->getVersion();
               }
               it->sdkName = request->getRequestParam()->getSdkName();
@@ -1046,21 +1044,9 @@ bool ConnectedPool::sslBelongToPool(INlsRequest *request, NlsType type,
   SSLconnect *curSslHandle = request->getConnectNode()->getSslHandle();
   int preSize = getNumberOfPrestartedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.prestartedRequests;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.prestartedRequests;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.prestartedRequests;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.prestartedRequests;
-        break;
-      default:
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->prestartedRequests;
     }
 
     if (curPool) {
@@ -1084,21 +1070,9 @@ bool ConnectedPool::sslBelongToPool(INlsRequest *request, NlsType type,
 
   preSize = getNumberOfPreconnectedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.preconnectedRequests;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.preconnectedRequests;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.preconnectedRequests;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.preconnectedRequests;
-        break;
-      default:
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->preconnectedRequests;
     }
 
     if (curPool) {
@@ -1144,27 +1118,10 @@ void ConnectedPool::curRequestIsAbnormal(INlsRequest *request, NlsType type) {
   SSLconnect *curSslHandle = request->getConnectNode()->getSslHandle();
   int preSize = getNumberOfPrestartedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.prestartedRequests;
-        curList = &_srRequests.prestartedIndexList;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.prestartedRequests;
-        curList = &_stRequests.prestartedIndexList;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.prestartedRequests;
-        curList = &_syRequests.prestartedIndexList;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.prestartedRequests;
-        curList = &_fssRequests.prestartedIndexList;
-        break;
-      default:
-        curPool = NULL;
-        curList = NULL;
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->prestartedRequests;
+      curList = &poolProcess->prestartedIndexList;
     }
 
     if (curPool) {
@@ -1191,27 +1148,10 @@ void ConnectedPool::curRequestIsAbnormal(INlsRequest *request, NlsType type) {
 
   preSize = getNumberOfPreconnectedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.preconnectedRequests;
-        curList = &_srRequests.preconnectedIndexList;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.preconnectedRequests;
-        curList = &_stRequests.preconnectedIndexList;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.preconnectedRequests;
-        curList = &_syRequests.preconnectedIndexList;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.preconnectedRequests;
-        curList = &_fssRequests.preconnectedIndexList;
-        break;
-      default:
-        curPool = NULL;
-        curList = NULL;
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->preconnectedRequests;
+      curList = &poolProcess->preconnectedIndexList;
     }
 
     if (curPool) {
@@ -1275,27 +1215,10 @@ void ConnectedPool::finishPushPreNode(NlsType type, evutil_socket_t curSocketFd,
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
   int preSize = getNumberOfPrestartedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.prestartedRequests;
-        curList = &_srRequests.prestartedIndexList;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.prestartedRequests;
-        curList = &_stRequests.prestartedIndexList;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.prestartedRequests;
-        curList = &_syRequests.prestartedIndexList;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.prestartedRequests;
-        curList = &_fssRequests.prestartedIndexList;
-        break;
-      default:
-        curPool = NULL;
-        curList = NULL;
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->prestartedRequests;
+      curList = &poolProcess->prestartedIndexList;
     }
 
 #ifdef ENABLE_NLS_DEBUG_2
@@ -1353,27 +1276,10 @@ void ConnectedPool::finishPushPreNode(NlsType type, evutil_socket_t curSocketFd,
 
   preSize = getNumberOfPreconnectedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.preconnectedRequests;
-        curList = &_srRequests.preconnectedIndexList;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.preconnectedRequests;
-        curList = &_stRequests.preconnectedIndexList;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.preconnectedRequests;
-        curList = &_syRequests.preconnectedIndexList;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.preconnectedRequests;
-        curList = &_fssRequests.preconnectedIndexList;
-        break;
-      default:
-        curPool = NULL;
-        curList = NULL;
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->preconnectedRequests;
+      curList = &poolProcess->preconnectedIndexList;
     }
 
     if (curPool) {
@@ -1441,21 +1347,9 @@ bool ConnectedPool::requestInPool(INlsRequest *request, NlsType type) {
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
   int preSize = getNumberOfPrestartedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.prestartedRequests;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.prestartedRequests;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.prestartedRequests;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.prestartedRequests;
-        break;
-      default:
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->prestartedRequests;
     }
 
     if (curPool) {
@@ -1486,21 +1380,9 @@ bool ConnectedPool::requestInPool(INlsRequest *request, NlsType type) {
 
   preSize = getNumberOfPreconnectedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.preconnectedRequests;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.preconnectedRequests;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.preconnectedRequests;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.preconnectedRequests;
-        break;
-      default:
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->preconnectedRequests;
     }
 
     if (curPool) {
@@ -1547,21 +1429,9 @@ bool ConnectedPool::deletePreNodeByRequest(INlsRequest *request, NlsType type) {
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
   int preSize = getNumberOfPrestartedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.prestartedRequests;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.prestartedRequests;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.prestartedRequests;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.prestartedRequests;
-        break;
-      default:
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->prestartedRequests;
     }
 
     if (curPool) {
@@ -1606,21 +1476,9 @@ bool ConnectedPool::deletePreNodeByRequest(INlsRequest *request, NlsType type) {
 
   preSize = getNumberOfPreconnectedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.preconnectedRequests;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.preconnectedRequests;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.preconnectedRequests;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.preconnectedRequests;
-        break;
-      default:
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->preconnectedRequests;
     }
 
     if (curPool) {
@@ -1682,21 +1540,9 @@ bool ConnectedPool::deletePreNodeBySSL(SSLconnect *curSslHandle, NlsType type) {
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
   int preSize = getNumberOfPrestartedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.prestartedRequests;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.prestartedRequests;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.prestartedRequests;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.prestartedRequests;
-        break;
-      default:
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->prestartedRequests;
     }
 
     if (curPool) {
@@ -1736,22 +1582,9 @@ bool ConnectedPool::deletePreNodeBySSL(SSLconnect *curSslHandle, NlsType type) {
 
   preSize = getNumberOfPreconnectedNodes(type);
   if (preSize > 0) {
-    switch (type) {
-      case TypeAsr:
-        curPool = &_srRequests.preconnectedRequests;
-        break;
-      case TypeRealTime:
-        curPool = &_stRequests.preconnectedRequests;
-        break;
-      case TypeTts:
-        curPool = &_syRequests.preconnectedRequests;
-        break;
-      case TypeStreamInputTts:
-        curPool = &_fssRequests.preconnectedRequests;
-        break;
-      default:
-        curPool = NULL;
-        break;
+    struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+    if (poolProcess) {
+      curPool = &poolProcess->preconnectedRequests;
     }
 
     if (curPool) {
@@ -1796,40 +1629,13 @@ bool ConnectedPool::deletePreNodeBySSL(SSLconnect *curSslHandle, NlsType type) {
 
 int ConnectedPool::getNumberOfThisTypeNodes(NlsType type, int &prestarted,
                                             int &preconnected) {
-  switch (type) {
-    case TypeAsr:
-      prestarted = _srRequests.prestartedRequests.size();
-      break;
-    case TypeRealTime:
-      prestarted = _stRequests.prestartedRequests.size();
-      break;
-    case TypeTts:
-      prestarted = _syRequests.prestartedRequests.size();
-      break;
-    case TypeStreamInputTts:
-      prestarted = _fssRequests.prestartedRequests.size();
-      break;
-    default:
-      prestarted = 0;
-      break;
-  }
-
-  switch (type) {
-    case TypeAsr:
-      preconnected = _srRequests.preconnectedRequests.size();
-      break;
-    case TypeRealTime:
-      preconnected = _stRequests.preconnectedRequests.size();
-      break;
-    case TypeTts:
-      preconnected = _syRequests.preconnectedRequests.size();
-      break;
-    case TypeStreamInputTts:
-      preconnected = _fssRequests.preconnectedRequests.size();
-      break;
-    default:
-      preconnected = 0;
-      break;
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+  if (poolProcess) {
+    prestarted = poolProcess->prestartedRequests.size();
+    preconnected = poolProcess->preconnectedRequests.size();
+  } else {
+    prestarted = 0;
+    preconnected = 0;
   }
 
   return Success;
@@ -1837,21 +1643,9 @@ int ConnectedPool::getNumberOfThisTypeNodes(NlsType type, int &prestarted,
 
 int ConnectedPool::getNumberOfPreconnectedNodes(NlsType type) {
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
-  switch (type) {
-    case TypeAsr:
-      curPool = &_srRequests.preconnectedRequests;
-      break;
-    case TypeRealTime:
-      curPool = &_stRequests.preconnectedRequests;
-      break;
-    case TypeTts:
-      curPool = &_syRequests.preconnectedRequests;
-      break;
-    case TypeStreamInputTts:
-      curPool = &_fssRequests.preconnectedRequests;
-      break;
-    default:
-      break;
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+  if (poolProcess) {
+    curPool = &poolProcess->preconnectedRequests;
   }
 
   int count = 0;
@@ -1870,21 +1664,9 @@ int ConnectedPool::getNumberOfPreconnectedNodes(NlsType type) {
 
 int ConnectedPool::getNumberOfPrestartedNodes(NlsType type) {
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
-  switch (type) {
-    case TypeAsr:
-      curPool = &_srRequests.prestartedRequests;
-      break;
-    case TypeRealTime:
-      curPool = &_stRequests.prestartedRequests;
-      break;
-    case TypeTts:
-      curPool = &_syRequests.prestartedRequests;
-      break;
-    case TypeStreamInputTts:
-      curPool = &_fssRequests.prestartedRequests;
-      break;
-    default:
-      break;
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+  if (poolProcess) {
+    curPool = &poolProcess->prestartedRequests;
   }
 
   int count = 0;
@@ -1905,30 +1687,18 @@ int ConnectedPool::initThisNodesPool(NlsType type) {
   // LOG_DEBUG("ConnectedPool(%p) initThisNodesPool ...", this);
   std::vector<struct ConnectedNodeProcess> *curPrestartedPool = NULL;
   std::vector<struct ConnectedNodeProcess> *curPreconnectedPool = NULL;
-  switch (type) {
-    case TypeAsr:
-      curPrestartedPool = &_srRequests.prestartedRequests;
-      curPreconnectedPool = &_srRequests.preconnectedRequests;
-      break;
-    case TypeRealTime:
-      curPrestartedPool = &_stRequests.prestartedRequests;
-      curPreconnectedPool = &_stRequests.preconnectedRequests;
-      break;
-    case TypeTts:
-      curPrestartedPool = &_syRequests.prestartedRequests;
-      curPreconnectedPool = &_syRequests.preconnectedRequests;
-      break;
-    case TypeStreamInputTts:
-      curPrestartedPool = &_fssRequests.prestartedRequests;
-      curPreconnectedPool = &_fssRequests.preconnectedRequests;
-      break;
-    default:
-      break;
-  }
-
-  if (curPrestartedPool) {
-    size_t size = curPrestartedPool->size();
-    for (size_t i = size; i < _maxPreconnectedNumber; ++i) {
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+  if (poolProcess) {
+    curPrestartedPool = &poolProcess->prestartedRequests;
+    curPreconnectedPool = &poolProcess->preconnectedRequests;
+  }
+
+  /* 按扩缩容上限一次性分配节点, 扩缩容只调整activeNumber.
+   * 已分配的vector不再扩容, 否则搬移时会析构已存储的request */
+  if (curPrestartedPool && curPrestartedPool->empty()) {
+    unsigned int capacity = getPoolCapacity();
+    curPrestartedPool->reserve(capacity);
+    for (unsigned int i = 0; i < capacity; ++i) {
       struct ConnectedNodeProcess tmp;
       tmp.type = type;
       tmp.status = PreNodeToBeCreated;
@@ -1936,9 +1706,10 @@ int ConnectedPool::initThisNodesPool(NlsType type) {
     }  // for
   }
 
-  if (curPreconnectedPool) {
-    size_t size = curPreconnectedPool->size();
-    for (size_t i = size; i < _maxPreconnectedNumber; ++i) {
+  if (curPreconnectedPool && curPreconnectedPool->empty()) {
+    unsigned int capacity = getPoolCapacity();
+    curPreconnectedPool->reserve(capacity);
+    for (unsigned int i = 0; i < capacity; ++i) {
       struct ConnectedNodeProcess tmp;
       tmp.type = type;
       tmp.status = PreNodeToBeCreated;
@@ -1946,6 +1717,17 @@ int ConnectedPool::initThisNodesPool(NlsType type) {
     }  // for
   }
 
+  if (poolProcess && poolProcess->scaler.activeNumber == 0) {
+    unsigned int initialNumber = _maxPreconnectedNumber;
+    if (_autoScale) {
+      unsigned int maxNumber = getScaleLimit(poolProcess);
+      initialNumber = initialNumber < _minScaleNumber ? _minScaleNumber
+                                                      : initialNumber;
+      initialNumber = initialNumber > maxNumber ? maxNumber : initialNumber;
+    }
+    poolProcess->scaler.activeNumber = initialNumber;
+  }
+
   return Success;
 }
 
@@ -1959,27 +1741,10 @@ bool ConnectedPool::popOnePreconnectedNode(INlsRequest *request, NlsType type) {
 
   std::list<int> *curList = NULL;
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
-  switch (type) {
-    case TypeAsr:
-      curPool = &_srRequests.preconnectedRequests;
-      curList = &_srRequests.prestartedIndexList;
-      break;
-    case TypeRealTime:
-      curPool = &_stRequests.preconnectedRequests;
-      curList = &_stRequests.preconnectedIndexList;
-      break;
-    case TypeTts:
-      curPool = &_syRequests.preconnectedRequests;
-      curList = &_syRequests.preconnectedIndexList;
-      break;
-    case TypeStreamInputTts:
-      curPool = &_fssRequests.preconnectedRequests;
-      curList = &_fssRequests.preconnectedIndexList;
-      break;
-    default:
-      curPool = NULL;
-      curList = NULL;
-      break;
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+  if (poolProcess) {
+    curPool = &poolProcess->preconnectedRequests;
+    curList = &poolProcess->preconnectedIndexList;
   }
 
   if (curPool) {
@@ -1992,26 +1757,10 @@ bool ConnectedPool::popOnePreconnectedNode(INlsRequest *request, NlsType type) {
           INlsRequestParam *paramsInRequest = request->getRequestParam();
           INlsRequestParam *paramsInPool = it->request->getRequestParam();
           if (paramsInRequest && paramsInPool) {
-            switch (type) {
-              case TypeAsr:
-                equalFlag = *paramsInPool == *paramsInRequest &&
-                            it->sdkName == paramsInRequest->getSdkName();
-                break;
-              case TypeRealTime:
-                equalFlag = *paramsInPool == *paramsInRequest &&
-                            it->sdkName == paramsInRequest->getSdkName();
-                break;
-              case TypeTts:
-                equalFlag = *paramsInPool == *paramsInRequest &&
-                            it->sdkName == paramsInRequest->getSdkName() &&
-                            it->ttsVersion == paramsInRequest->getVersion();
-                break;
-              case TypeStreamInputTts:
-                equalFlag = *paramsInPool == *paramsInRequest &&
-                            it->sdkName == paramsInRequest->getSdkName();
-                break;
-              default:
-                break;
+            equalFlag = *paramsInPool == *paramsInRequest &&
+                        it->sdkName == paramsInRequest->getSdkName();
+            if (equalFlag && nodeWithVersion(type)) {
+              equalFlag = it->ttsVersion == paramsInRequest->getVersion();
             }
           } else {
             LOG_ERROR(
@@ -2076,27 +1825,10 @@ bool ConnectedPool::popOnePrestartedNode(INlsRequest *request, NlsType type) {
 
   std::list<int> *curList = NULL;
   std::vector<struct ConnectedNodeProcess> *curPool = NULL;
-  switch (type) {
-    case TypeAsr:
-      curPool = &_srRequests.prestartedRequests;
-      curList = &_srRequests.prestartedIndexList;
-      break;
-    case TypeRealTime:
-      curPool = &_stRequests.prestartedRequests;
-      curList = &_stRequests.prestartedIndexList;
-      break;
-    case TypeTts:
-      curPool = &_syRequests.prestartedRequests;
-      curList = &_syRequests.prestartedIndexList;
-      break;
-    case TypeStreamInputTts:
-      curPool = &_fssRequests.prestartedRequests;
-      curList = &_fssRequests.prestartedIndexList;
-      break;
-    default:
-      curPool = NULL;
-      curList = NULL;
-      break;
+  struct ConnectedPoolProcess *poolProcess = getPoolProcess(type);
+  if (poolProcess) {
+    curPool = &poolProcess->prestartedRequests;
+    curList = &poolProcess->prestartedIndexList;
   }
 
   if (curPool) {
@@ -2109,31 +1841,12 @@ bool ConnectedPool::popOnePrestartedNode(INlsRequest *request, NlsType type) {
           INlsRequestParam *paramsInPool = it->request->getRequestParam();
           INlsRequestParam *paramsInRequest = request->getRequestParam();
           if (paramsInRequest && paramsInPool) {
-            switch (type) {
-              case TypeAsr:
-                equalFlag =
-                    *paramsInPool == *paramsInRequest &&
-                    paramsInPool->getSdkName() == paramsInRequest->getSdkName();
-                break;
-              case TypeRealTime:
-                equalFlag =
-                    *paramsInPool == *paramsInRequest &&
-                    paramsInPool->getSdkName() == paramsInRequest->getSdkName();
-                break;
-              case TypeTts:
-                equalFlag =
-                    *paramsInPool == *paramsInRequest &&
-                    paramsInPool->getSdkName() ==
-                        paramsInRequest->getSdkName() &&
-                    paramsInPool->getVersion() == paramsInRequest->getVersion();
-                break;
-              case TypeStreamInputTts:
-                equalFlag =
-                    *paramsInPool == *paramsInRequest &&
-                    paramsInPool->getSdkName() == paramsInRequest->getSdkName();
-                break;
-              default:
-                break;
+            equalFlag =
+                *paramsInPool == *paramsInRequest &&
+                paramsInPool->getSdkName() == paramsInRequest->getSdkName();
+            if (equalFlag && nodeWithVersion(type)) {
+              equalFlag =
+                  paramsInPool->getVersion() == paramsInRequest->getVersion();
             }
           } else {
             LOG_ERROR(
@@ -2211,7 +1924,7 @@ void ConnectedPool::deletePreNode(
 }
 
 int ConnectedPool::timeoutPrestartedNode(
-    std::vector<struct ConnectedNodeProcess> *pool) {
+    std::vector<struct ConnectedNodeProcess> *pool, unsigned int activeNumber) {
   int releaseCount = 0;
   std::vector<struct ConnectedNodeProcess>::iterator it;
   for (it = pool->begin(); it != pool->end(); ++it) {
@@ -2240,8 +1953,18 @@ int ConnectedPool::timeoutPrestartedNode(
       bool timeout = gapTimestamp >= _prerequestedTimeoutMs;
       bool tokenTimeout = it->tokenExpirationTimestamp > 0 &&
                           curTimestamp >= it->tokenExpirationTimestamp;
-      if (timeout || tokenTimeout) {
+      /* 自动缩容后, 超出activeNumber的空闲节点直接释放且不再补充 */
+      bool retired = std::distance(pool->begin(), it) >= (int)activeNumber &&
+                     it->canPick && it->curRequest == NULL;
+      if (timeout || tokenTimeout || retired) {
         if (it->curRequest == NULL) {
+          if (retired) {
+            LOG_INFO(
+                "Pool(%p:(%p)) request(%p) index(%d) is out of active "
+                "number(%u), release it.",
+                this, pool, it->request, std::distance(pool->begin(), it),
+                activeNumber);
+          }
           LOG_WARN(
               "Pool(%p:(%p)%p-%p) connectPoolEventCallback should release "
               "prestarted "
@@ -2272,7 +1995,7 @@ int ConnectedPool::timeoutPrestartedNode(
           it->canPick = false;
           it->curRequestInvalid = false;
           it->shouldRelease = true;
-          if (!tokenTimeout) {
+          if (!tokenTimeout && !retired) {
             it->shouldPreconnect = true;
           }
           releaseCount++;
@@ -2339,7 +2062,7 @@ int ConnectedPool::timeoutPrestartedNode(
 }
 
 int ConnectedPool::timeoutPreconnectedNode(
-    std::vector<struct ConnectedNodeProcess> *pool) {
+    std::vector<struct ConnectedNodeProcess> *pool, unsigned int activeNumber) {
   int releaseCount = 0;
   std::vector<struct ConnectedNodeProcess>::iterator it;
   for (it = pool->begin(); it != pool->end(); ++it) {
@@ -2360,8 +2083,18 @@ int ConnectedPool::timeoutPreconnectedNode(
       bool timeout = gapTimestamp >= _preconnectedTimeoutMs;
       bool tokenTimeout = it->tokenExpirationTimestamp > 0 &&
                           curTimestamp >= it->tokenExpirationTimestamp;
-      if (timeout || tokenTimeout) {
+      /* 自动缩容后, 超出activeNumber的空闲节点直接释放且不再补充 */
+      bool retired = std::distance(pool->begin(), it) >= (int)activeNumber &&
+                     it->canPick && it->curRequest == NULL;
+      if (timeout || tokenTimeout || retired) {
         if (it->curRequest == NULL) {
+          if (retired) {
+            LOG_INFO(
+                "Pool(%p:(%p)) request(%p) index(%d) is out of active "
+                "number(%u), release it.",
+                this, pool, it->request, std::distance(pool->begin(), it),
+                activeNumber);
+          }
           LOG_WARN(
               "Pool(%p:(%p)%p-%p) connectPoolEventCallback should release "
               "preconnected "
@@ -2389,7 +2122,7 @@ int ConnectedPool::timeoutPreconnectedNode(
           it->startedResponse.clear();
           it->canPick = false;
           it->shouldRelease = true;
-          if (!tokenTimeout) {
+          if (!tokenTimeout && !retired) {
             it->shouldPreconnect = true;
           }
           it->curRequestInvalid = false;
@@ -2534,7 +2267,6 @@ void ConnectedPool::deleteOrPreconnectNodeShouldReleased(
 
 void ConnectedPool::preconnectNodeByRequest(INlsRequest *request) {
   if (request) {
-    INlsRequest *newRequest = NULL;
     INlsRequestParam *requestParam = request->getRequestParam();
     ConnectNode *node = request->getConnectNode();
     NlsType type = requestParam->_mode;
@@ -2544,73 +2276,16 @@ void ConnectedPool::preconnectNodeByRequest(INlsRequest *request) {
         "type:%d.",
         this, request, type);
 
-    switch (type) {
-      case TypeAsr:
-        newRequest = NlsClient::getInstance()->createRecognizerRequest(
-            requestParam->getSdkName().c_str(), node->isLongConnection());
-        break;
-      case TypeRealTime:
-        newRequest = NlsClient::getInstance()->createTranscriberRequest(
-            requestParam->getSdkName().c_str(), node->isLongConnection());
-        break;
-      case TypeTts:
-        newRequest = NlsClient::getInstance()->createSynthesizerRequest(
-            (TtsVersion)requestParam->getVersion(),
-            requestParam->getSdkName().c_str(), node->isLongConnection());
-        break;
-      case TypeStreamInputTts:
-        newRequest = NlsClient::getInstance()->createFlowingSynthesizerRequest(
-            requestParam->getSdkName().c_str(), node->isLongConnection());
-        break;
-      default:
-        break;
-    }  // switch
-
+    INlsRequest *newRequest = createPreconnectRequest(
+        type, requestParam->getVersion(), requestParam->getSdkName().c_str(),
+        node->isLongConnection());
     if (newRequest) {
       LOG_INFO(
           "ConnectedPool(%p) create new request(%p) from old request(%p) for "
           "PreconnectedPool.",
           this, newRequest, request);
       *(newRequest->getRequestParam()) = *(request->getRequestParam());
-      newRequest->getConnectNode()->usePreNodeStartStepByStep(true);
-      int ret = NlsEventNetWork::_eventClient->startInner(newRequest);
-      bool result = false;
-      if (ret == Success) {
-        result = newRequest->getConnectNode()->directLinkIpFromCache();
-      }
-      if (result) {
-        result = pushPreconnectedNode(newRequest, type, true);
-        if (result) {
-          finishPushPreNode(type, newRequest->getConnectNode()->getSocketFd(),
-                            newRequest->getConnectNode()->getSslHandle(),
-                            newRequest->getConnectNode()->getPoolIndex(),
-                            newRequest);
-        } else {
-          deletePreNodeBySSL(newRequest->getConnectNode()->getSslHandle(),
-                             type);
-        }
-      } else {
-        switch (type) {
-          case TypeAsr:
-            NlsClient::getInstance()->releaseRecognizerRequest(
-                (SpeechRecognizerRequest *)newRequest);
-            break;
-          case TypeRealTime:
-            NlsClient::getInstance()->releaseTranscriberRequest(
-                (SpeechTranscriberRequest *)newRequest);
-            break;
-          case TypeTts:
-            NlsClient::getInstance()->releaseSynthesizerRequest(
-                (SpeechSynthesizerRequest *)newRequest);
-            break;
-          case TypeStreamInputTts:
-            NlsClient::getInstance()->releaseFlowingSynthesizerRequest(
-                (FlowingSynthesizerRequest *)newRequest);
-            break;
-          default:
-            break;
-        }  // switch
-      }
+      startPreconnectRequest(newRequest, type);
     }
   } else {
     LOG_ERROR("ConnectedPool(%p) preconnectNodeByRequest request is null.",
@@ -2618,6 +2293,427 @@ void ConnectedPool::preconnectNodeByRequest(INlsRequest *request) {
   }
 }
 
+INlsRequest *ConnectedPool::createPreconnectRequest(NlsType type, int version,
+                                                    const char *sdkName,
+                                                    bool isLongConnection) {
+  INlsRequest *newRequest = NULL;
+  switch (type) {
+    case TypeAsr:
+      newRequest = NlsClient::getInstance()->createRecognizerRequest(
+          sdkName, isLongConnection);
+      break;
+    case TypeRealTime:
+      newRequest = NlsClient::getInstance()->createTranscriberRequest(
+          sdkName, isLongConnection);
+      break;
+    case TypeTts:
+      newRequest = NlsClient::getInstance()->createSynthesizerRequest(
+          (TtsVersion)version, sdkName, isLongConnection);
+      break;
+    case TypeStreamInputTts:
+      newRequest = NlsClient::getInstance()->createFlowingSynthesizerRequest(
+          sdkName, isLongConnection);
+      break;
+    case TypeDialog:
+      newRequest = NlsClient::getInstance()->createDialogAssistantRequest(
+          (DaVersion)version, sdkName, isLongConnection);
+      break;
+    case TypeDashScopeParaformerRealTime:
+      newRequest =
+          NlsClient::getInstance()->createDashParaformerTranscriberRequest(
+              sdkName, isLongConnection);
+      break;
+    case TypeDashScopeFunAsrRealTime:
+      newRequest = NlsClient::getInstance()->createDashFunAsrTranscriberRequest(
+          sdkName, isLongConnection);
+      break;
+    case TypeDashSceopCosyVoiceStreamInputTts:
+      newRequest =
+          NlsClient::getInstance()->createDashCosyVoiceSynthesizerRequest(
+              sdkName, isLongConnection);
+      break;
+    default:
+      break;
+  }  // switch
+  return newRequest;
+}
+
+/**
+ * @brief: 已设置好参数的新request建连并存入PreconnectedPool, 失败则释放
+ */
+void ConnectedPool::startPreconnectRequest(INlsRequest *newRequest,
+                                           NlsType type) {
+  newRequest->getConnectNode()->usePreNodeStartStepByStep(true);
+  int ret = NlsEventNetWork::_eventClient->startInner(newRequest);
+  bool result = false;
+  if (ret == Success) {
+    result = newRequest->getConnectNode()->directLinkIpFromCache();
+  }
+  if (result) {
+    result = pushPreconnectedNode(newRequest, type, true);
+    if (result) {
+      finishPushPreNode(type, newRequest->getConnectNode()->getSocketFd(),
+                        newRequest->getConnectNode()->getSslHandle(),
+                        newRequest->getConnectNode()->getPoolIndex(),
+                        newRequest);
+    } else {
+      deletePreNodeBySSL(newRequest->getConnectNode()->getSslHandle(), type);
+    }
+  } else {
+    releasePreconnectRequest(newRequest, type);
+  }
+}
+
+void ConnectedPool::releasePreconnectRequest(INlsRequest *newRequest,
+                                             NlsType type) {
+  switch (type) {
+    case TypeAsr:
+      NlsClient::getInstance()->releaseRecognizerRequest(
+          (SpeechRecognizerRequest *)newRequest);
+      break;
+    case TypeRealTime:
+      NlsClient::getInstance()->releaseTranscriberRequest(
+          (SpeechTranscriberRequest *)newRequest);
+      break;
+    case TypeTts:
+      NlsClient::getInstance()->releaseSynthesizerRequest(
+          (SpeechSynthesizerRequest *)newRequest);
+      break;
+    case TypeStreamInputTts:
+      NlsClient::getInstance()->releaseFlowingSynthesizerRequest(
+          (FlowingSynthesizerRequest *)newRequest);
+      break;
+    case TypeDialog:
+      NlsClient::getInstance()->releaseDialogAssistantRequest(
+          (DialogAssistantRequest *)newRequest);
+      break;
+    case TypeDashScopeParaformerRealTime:
+      NlsClient::getInstance()->releaseDashParaformerTranscriberRequest(
+          (DashParaformerTranscriberRequest *)newRequest);
+      break;
+    case TypeDashScopeFunAsrRealTime:
+      NlsClient::getInstance()->releaseDashFunAsrTranscriberRequest(
+          (DashFunAsrTranscriberRequest *)newRequest);
+      break;
+    case TypeDashSceopCosyVoiceStreamInputTts:
+      NlsClient::getInstance()->releaseDashCosyVoiceSynthesizerRequest(
+          (DashCosyVoiceSynthesizerRequest *)newRequest);
+      break;
+    default:
+      break;
+  }  // switch
+}
+
+/**
+ * @brief: 查找此类交互中仍有效的预连接request, 作为补充预连接的参数模板,
+ *         需在_lock下调用
+ */
+INlsRequest *ConnectedPool::findTemplateRequest(
+    struct ConnectedPoolProcess *process) {
+  std::vector<struct ConnectedNodeProcess> *pools[2] = {
+      &process->preconnectedRequests, &process->prestartedRequests};
+  for (int i = 0; i < 2; i++) {
+    std::vector<struct ConnectedNodeProcess>::iterator it;
+    for (it = pools[i]->begin(); it != pools[i]->end(); ++it) {
+      if ((it->status == PreNodeConnected || it->status == PreNodeStarted) &&
+          it->request && !it->shouldRelease && !it->isAbnormal) {
+        return it->request;
+      }
+    }  // for
+  }
+  return NULL;
+}
+
+/**
+ * @brief: 自动扩容后, 以池中已有的request为模板, 为新增的空闲槽位补充预连接.
+ *         创建和启动request时不持有_lock, 避免与NlsClient的锁形成反序.
+ *         暂无可用模板时保留warmDeficit, 下个检查周期再补充.
+ */
+void ConnectedPool::warmThisNodesPool(struct ConnectedPoolProcess *process) {
+  struct ConnectedPoolScaler &scaler = process->scaler;
+  NlsType type = process->type;
+  while (true) {
+    MUTEX_LOCK(_lock);
+    if (scaler.warmDeficit == 0) {
+      MUTEX_UNLOCK(_lock);
+      break;
+    }
+    INlsRequest *templateRequest = findTemplateRequest(process);
+    if (templateRequest == NULL) {
+      MUTEX_UNLOCK(_lock);
+      break;
+    }
+    INlsRequestParam *templateParam = templateRequest->getRequestParam();
+    int version = templateParam->getVersion();
+    std::string sdkName = templateParam->getSdkName();
+    bool isLongConnection =
+        templateRequest->getConnectNode()->isLongConnection();
+    MUTEX_UNLOCK(_lock);
+
+    INlsRequest *newRequest = createPreconnectRequest(
+        type, version, sdkName.c_str(), isLongConnection);
+    if (newRequest == NULL) {
+      break;
+    }
+
+    /* 解锁期间模板可能已被释放, 重新查找 */
+    MUTEX_LOCK(_lock);
+    templateRequest = findTemplateRequest(process);
+    if (templateRequest == NULL || scaler.warmDeficit == 0) {
+      MUTEX_UNLOCK(_lock);
+      releasePreconnectRequest(newRequest, type);
+      break;
+    }
+    *(newRequest->getRequestParam()) = *(templateRequest->getRequestParam());
+    scaler.warmDeficit--;
+    LOG_INFO(
+        "ConnectedPool(%p) %s warm new request(%p) from request(%p), %u "
+        "left.",
+        this, process->name.c_str(), newRequest, templateRequest,
+        scaler.warmDeficit);
+    MUTEX_UNLOCK(_lock);
+
+    startPreconnectRequest(newRequest, type);
+  }
+}
+
+void ConnectedPool::statPopResult(NlsType type, bool hit) {
+  utility::NlsMetrics::addCounter(hit ? utility::MetricPoolHit
+                                      : utility::MetricPoolMiss);
+  MUTEX_LOCK(_lock);
+  struct ConnectedPoolProcess *process = getPoolProcess(type);
+  if (process) {
+    process->scaler.popCount++;
+    if (hit) {
+      process->scaler.hitCount++;
+    }
+  }
+  MUTEX_UNLOCK(_lock);
+}
+
+struct ConnectedPoolProcess *ConnectedPool::getPoolProcess(NlsType type) {
+  switch (type) {
+    case TypeAsr:
+      return &_srRequests;
+    case TypeRealTime:
+      return &_stRequests;
+    case TypeTts:
+      return &_syRequests;
+    case TypeStreamInputTts:
+      return &_fssRequests;
+    case TypeDialog:
+      return &_daRequests;
+    case TypeDashScopeParaformerRealTime:
+      return &_dashParaformerRequests;
+    case TypeDashScopeFunAsrRealTime:
+      return &_dashFunAsrRequests;
+    case TypeDashSceopCosyVoiceStreamInputTts:
+      return &_dashCosyVoiceRequests;
+    default:
+      return NULL;
+  }
+}
+
+/**
+ * @brief: 此类交互的预连接是否还需要比较版本号(TtsVersion/DaVersion)
+ */
+bool ConnectedPool::nodeWithVersion(NlsType type) {
+  return type == TypeTts || type == TypeDialog;
+}
+
+unsigned int ConnectedPool::getPoolCapacity() {
+  if (_autoScale && _maxScaleNumber > _maxPreconnectedNumber) {
+    return _maxScaleNumber;
+  }
+  return _maxPreconnectedNumber;
+}
+
+/**
+ * @brief: 此类交互已分配的槽位数, 未分配时为getPoolCapacity()
+ */
+unsigned int ConnectedPool::getAllocatedCapacity(
+    struct ConnectedPoolProcess *process) {
+  if (process->preconnectedRequests.empty()) {
+    return getPoolCapacity();
+  }
+  return process->preconnectedRequests.size();
+}
+
+/**
+ * @brief: 此类交互实际可扩容到的上限, 不超过已分配的槽位数
+ */
+unsigned int ConnectedPool::getScaleLimit(
+    struct ConnectedPoolProcess *process) {
+  unsigned int capacity = getAllocatedCapacity(process);
+  return _maxScaleNumber > capacity ? capacity : _maxScaleNumber;
+}
+
+int ConnectedPool::countIdleNodes(
+    std::vector<struct ConnectedNodeProcess> *pool) {
+  int idle = 0;
+  std::vector<struct ConnectedNodeProcess>::iterator it;
+  for (it = pool->begin(); it != pool->end(); ++it) {
+    if ((it->status == PreNodeStarted || it->status == PreNodeConnected) &&
+        it->canPick && it->curRequest == NULL && !it->shouldRelease) {
+      idle++;
+    }
+  }  // for
+  return idle;
+}
+
+/**
+ * @brief: activeNumber范围内可存入新预连接的槽位数
+ */
+unsigned int ConnectedPool::countFreeSlots(
+    std::vector<struct ConnectedNodeProcess> *pool, unsigned int activeNumber) {
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < pool->size() && i < activeNumber; i++) {
+    struct ConnectedNodeProcess &node = (*pool)[i];
+    if (node.status == PreNodeToBeCreated && !node.shouldRelease &&
+        node.request == NULL) {
+      count++;
+    }
+  }  // for
+  return count;
+}
+
+/**
+ * @brief: 按获取频率和未命中率调整此类交互的activeNumber, 需在_lock下调用
+ *         未命中率超过目标时按未命中数扩容, 命中率达标且空闲节点富余时逐个缩容
+ */
+void ConnectedPool::autoScaleThisNodesPool(struct ConnectedPoolProcess *process,
+                                           uint64_t nowMs) {
+  struct ConnectedPoolScaler &scaler = process->scaler;
+  if (scaler.lastTickMs == 0 || nowMs <= scaler.lastTickMs) {
+    scaler.lastTickMs = nowMs;
+    return;
+  }
+
+  double intervalSec = (nowMs - scaler.lastTickMs) / 1000.0;
+  scaler.lastTickMs = nowMs;
+  double popRate = scaler.popCount / intervalSec;
+  double missRate = (scaler.popCount - scaler.hitCount) / intervalSec;
+  scaler.totalPopCount += scaler.popCount;
+  scaler.totalHitCount += scaler.hitCount;
+  scaler.popCount = 0;
+  scaler.hitCount = 0;
+  scaler.popRateEwma = kPoolScaleEwmaAlpha * popRate +
+                       (1.0 - kPoolScaleEwmaAlpha) * scaler.popRateEwma;
+  scaler.missRateEwma = kPoolScaleEwmaAlpha * missRate +
+                        (1.0 - kPoolScaleEwmaAlpha) * scaler.missRateEwma;
+  if (scaler.popRateEwma >= kPoolScaleMinPopRate) {
+    scaler.hitRatio = 1.0 - scaler.missRateEwma / scaler.popRateEwma;
+  } else {
+    scaler.hitRatio = 1.0;
+  }
+
+  if (!_autoScale) {
+    return;
+  }
+
+  int idle = countIdleNodes(&process->prestartedRequests) +
+             countIdleNodes(&process->preconnectedRequests);
+
+  unsigned int target = scaler.activeNumber;
+  ConnectedPoolScaleDecision decision = PoolScaleKeep;
+  if (scaler.popRateEwma >= kPoolScaleMinPopRate &&
+      scaler.hitRatio < _targetHitRatio) {
+    unsigned int step =
+        (unsigned int)ceil(scaler.missRateEwma * intervalSec);
+    target += step > 0 ? step : 1;
+    decision = PoolScaleUp;
+  } else if (idle > 0 &&
+             nowMs - scaler.lastDecisionMs >= kPoolScaleDownIntervalMs) {
+    /* 空闲节点多于下个周期预计的获取次数, 则缩容 */
+    int expected = (int)ceil(scaler.popRateEwma * intervalSec);
+    if (idle > expected) {
+      target = target > 0 ? target - 1 : 0;
+      decision = PoolScaleDown;
+    }
+  }
+  unsigned int maxNumber = getScaleLimit(process);
+  target = target < _minScaleNumber ? _minScaleNumber : target;
+  target = target > maxNumber ? maxNumber : target;
+
+  if (target > scaler.activeNumber) {
+    /* 新增的槽位由nodeReleaseEventCallback以池中request为模板提前建连 */
+    scaler.warmDeficit += target - scaler.activeNumber;
+    scaler.scaleUpCount++;
+  } else if (target < scaler.activeNumber) {
+    scaler.warmDeficit = 0;
+    scaler.scaleDownCount++;
+  } else {
+    decision = PoolScaleKeep;
+  }
+
+  if (decision != PoolScaleKeep) {
+    LOG_INFO(
+        "ConnectedPool(%p) type(%d) scale %s active number %u -> %u, pop "
+        "rate:%.3f/s, miss rate:%.3f/s, hit ratio:%.3f(target %.3f), idle:%d.",
+        this, process->type, decision == PoolScaleUp ? "up" : "down",
+        scaler.activeNumber, target, scaler.popRateEwma, scaler.missRateEwma,
+        scaler.hitRatio, _targetHitRatio, idle);
+    scaler.activeNumber = target;
+    scaler.lastDecisionMs = nowMs;
+  }
+  scaler.lastDecision = decision;
+
+  /* 未补充的数量不超过当前窗口内的空闲槽位 */
+  unsigned int freeSlots =
+      countFreeSlots(&process->preconnectedRequests, scaler.activeNumber);
+  if (scaler.warmDeficit > freeSlots) {
+    scaler.warmDeficit = freeSlots;
+  }
+}
+
+std::string ConnectedPool::dumpPoolInfo() {
+  Json::Value root(Json::objectValue);
+  Json::Value pools(Json::arrayValue);
+  Json::StreamWriterBuilder writer;
+  writer["indentation"] = "";
+
+  MUTEX_LOCK(_lock);
+  root["auto_scale"] = _autoScale;
+  root["min_number"] = _minScaleNumber;
+  root["max_number"] = _autoScale ? _maxScaleNumber : _maxPreconnectedNumber;
+  root["target_hit_ratio"] = _targetHitRatio;
+
+  std::vector<struct ConnectedPoolProcess *>::iterator it;
+  for (it = _poolProcesses.begin(); it != _poolProcesses.end(); ++it) {
+    struct ConnectedPoolProcess *process = *it;
+    struct ConnectedPoolScaler &scaler = process->scaler;
+    Json::Value item(Json::objectValue);
+    item["type"] = process->type;
+    item["name"] = process->name;
+    item["work"] = process->work;
+    item["active_number"] = scaler.activeNumber;
+    item["capacity"] = (Json::UInt)process->preconnectedRequests.size();
+    item["max_number"] =
+        _autoScale ? getScaleLimit(process) : _maxPreconnectedNumber;
+    item["warm_deficit"] = scaler.warmDeficit;
+    item["prestarted"] = getNumberOfPrestartedNodes(process->type);
+    item["preconnected"] = getNumberOfPreconnectedNodes(process->type);
+    item["idle"] = countIdleNodes(&process->prestartedRequests) +
+                   countIdleNodes(&process->preconnectedRequests);
+    item["pop_rate"] = scaler.popRateEwma;
+    item["miss_rate"] = scaler.missRateEwma;
+    item["hit_ratio"] = scaler.hitRatio;
+    item["total_pop"] = (Json::UInt64)(scaler.totalPopCount + scaler.popCount);
+    item["total_hit"] = (Json::UInt64)(scaler.totalHitCount + scaler.hitCount);
+    item["scale_up_count"] = (Json::UInt64)scaler.scaleUpCount;
+    item["scale_down_count"] = (Json::UInt64)scaler.scaleDownCount;
+    item["last_decision"] =
+        scaler.lastDecision == PoolScaleUp
+            ? "up"
+            : (scaler.lastDecision == PoolScaleDown ? "down" : "keep");
+    pools.append(item);
+  }
+  MUTEX_UNLOCK(_lock);
+
+  root["pools"] = pools;
+  return Json::writeString(writer, root);
+}
+
 void ConnectedPool::showEveryNode(
     std::vector<struct ConnectedNodeProcess> *pool, std::string name) {
   LOG_DEBUG("==>> ConnectedPool(%p:(%p)%p-%p) show every node in pool %s ...",
@@ -18,6 +18,7 @@
 #define NLS_SDK_CONNECTED_POOL_H
 
 #include <list>
+#include <string>
 #include <vector>
 #if defined(_MSC_VER)
 #include <windows.h>
@@ -30,6 +31,9 @@
 #include "event2/util.h"
 #include "flowingSynthesizerParam.h"
 #include "dashCosyVoiceSynthesizerParam.h"
+#include "dashFunAsrTranscriberParam.h"
+#include "dashParaformerTranscriberParam.h"
+#include "dialogAssistantParam.h"
 #include "iNlsRequest.h"
 #include "nlog.h"
 #include "speechRecognizerParam.h"
@@ -127,14 +131,62 @@ struct ConnectedNodeProcess {
   }
 };
 
+enum ConnectedPoolScaleDecision {
+  PoolScaleKeep = 0,
+  PoolScaleUp,
+  PoolScaleDown,
+};
+
+/* 预连接池自动扩缩容的统计数据, 仅在预连接池工作线程和_lock下读写 */
+struct ConnectedPoolScaler {
+ public:
+  explicit ConnectedPoolScaler()
+      : activeNumber(0),
+        popCount(0),
+        hitCount(0),
+        totalPopCount(0),
+        totalHitCount(0),
+        popRateEwma(0.0),
+        missRateEwma(0.0),
+        hitRatio(1.0),
+        warmDeficit(0),
+        lastTickMs(0),
+        lastDecisionMs(0),
+        scaleUpCount(0),
+        scaleDownCount(0),
+        lastDecision(PoolScaleKeep){};
+
+  /* 当前生效的节点数, 下标大于等于此值的节点不再存储和补充 */
+  unsigned int activeNumber;
+  /* 本检查周期内获取节点的次数和命中次数 */
+  uint64_t popCount;
+  uint64_t hitCount;
+  uint64_t totalPopCount;
+  uint64_t totalHitCount;
+  /* 每秒获取次数和未命中次数的EWMA */
+  double popRateEwma;
+  double missRateEwma;
+  double hitRatio;
+  /* 扩容后尚未建连的预连接节点数, 跨周期保留直至补充完成或缩容 */
+  unsigned int warmDeficit;
+  uint64_t lastTickMs;
+  uint64_t lastDecisionMs;
+  uint64_t scaleUpCount;
+  uint64_t scaleDownCount;
+  ConnectedPoolScaleDecision lastDecision;
+};
+
 struct ConnectedPoolProcess {
  public:
-  explicit ConnectedPoolProcess() : type(TypeRealTime), work(false){};
+  explicit ConnectedPoolProcess() : type(TypeRealTime), work(false), name(""){};
   ~ConnectedPoolProcess() { work = false; };
 
   NlsType type;
   /* 此ConnectedPoolProcess开始工作的标记 */
   bool work;
+  /* 用于日志和状态输出的名称 */
+  std::string name;
+  struct ConnectedPoolScaler scaler;
   std::list<int> prestartedIndexList;
   std::list<int> preconnectedIndexList;
   std::vector<struct ConnectedNodeProcess> prestartedRequests;
@@ -153,6 +205,17 @@ class ConnectedPool {
                 unsigned int requestedTimeoutMs);
   ~ConnectedPool();
 
+  /**
+   * @brief 启用自动扩缩容, 按每类交互的获取频率和未命中率调整预连接数量
+   * @param minNumber 每类交互最少保留的预连接数量
+   * @param maxNumber 每类交互最多保留的预连接数量,
+   * 已分配槽位的交互类型不超过已分配的槽位数
+   * @param targetHitRatio 目标命中率, 范围(0, 1]
+   * @return 成功则Success
+   */
+  int setAutoScale(unsigned int minNumber, unsigned int maxNumber,
+                   float targetHitRatio);
+
 #ifdef _MSC_VER
   static unsigned __stdcall loopConnectedPoolEventCallback(LPVOID arg);
 #else
@@ -235,6 +298,17 @@ class ConnectedPool {
    */
   bool deletePreNodeBySSL(SSLconnect *curSslHandle, NlsType type);
 
+  /**
+   * @brief 记录一次获取预连接的结果, 用于自动扩缩容的统计
+   * @param hit 获取到prestarted或preconnected节点则为true
+   */
+  void statPopResult(NlsType type, bool hit);
+
+  /**
+   * @brief 以Json格式输出每类交互的预连接池状态和扩缩容决策
+   */
+  std::string dumpPoolInfo();
+
  private:
   int getNumberOfThisTypeNodes(NlsType type, int &prestarted,
                                int &preconnected);
@@ -244,11 +318,30 @@ class ConnectedPool {
   bool popOnePreconnectedNode(INlsRequest *request, NlsType type);
   bool popOnePrestartedNode(INlsRequest *request, NlsType type);
   void deletePreNode(std::vector<struct ConnectedNodeProcess> *pool);
-  int timeoutPrestartedNode(std::vector<struct ConnectedNodeProcess> *pool);
-  int timeoutPreconnectedNode(std::vector<struct ConnectedNodeProcess> *pool);
+  int timeoutPrestartedNode(std::vector<struct ConnectedNodeProcess> *pool,
+                            unsigned int activeNumber);
+  int timeoutPreconnectedNode(std::vector<struct ConnectedNodeProcess> *pool,
+                              unsigned int activeNumber);
   void deleteOrPreconnectNodeShouldReleased(
       std::vector<struct ConnectedNodeProcess> *pool, std::string name);
   void preconnectNodeByRequest(INlsRequest *request);
+  INlsRequest *createPreconnectRequest(NlsType type, int version,
+                                       const char *sdkName,
+                                       bool isLongConnection);
+  void startPreconnectRequest(INlsRequest *newRequest, NlsType type);
+  void releasePreconnectRequest(INlsRequest *newRequest, NlsType type);
+  void warmThisNodesPool(struct ConnectedPoolProcess *process);
+  INlsRequest *findTemplateRequest(struct ConnectedPoolProcess *process);
+  struct ConnectedPoolProcess *getPoolProcess(NlsType type);
+  bool nodeWithVersion(NlsType type);
+  unsigned int getPoolCapacity();
+  unsigned int getAllocatedCapacity(struct ConnectedPoolProcess *process);
+  unsigned int getScaleLimit(struct ConnectedPoolProcess *process);
+  void autoScaleThisNodesPool(struct ConnectedPoolProcess *process,
+                              uint64_t nowMs);
+  int countIdleNodes(std::vector<struct ConnectedNodeProcess> *pool);
+  unsigned int countFreeSlots(std::vector<struct ConnectedNodeProcess> *pool,
+                              unsigned int activeNumber);
   void showEveryNode(std::vector<struct ConnectedNodeProcess> *pool,
                      std::string name);
   std::string getStatusStr(ConnectedStatus status);
@@ -260,6 +353,12 @@ class ConnectedPool {
   unsigned int _preconnectedTimeoutMs;
   unsigned int _prerequestedTimeoutMs;
 
+  /* 自动扩缩容配置, _autoScale为false时固定使用_maxPreconnectedNumber */
+  bool _autoScale;
+  unsigned int _minScaleNumber;
+  unsigned int _maxScaleNumber;
+  double _targetHitRatio;
+
 #ifdef _MSC_VER
   unsigned _poolWorkThreadId;
   HANDLE _poolWorkThreadHandle;
@@ -277,6 +376,12 @@ class ConnectedPool {
   struct ConnectedPoolProcess _srRequests;
   struct ConnectedPoolProcess _stRequests;
   struct ConnectedPoolProcess _syRequests;
+  struct ConnectedPoolProcess _daRequests;
+  struct ConnectedPoolProcess _dashParaformerRequests;
+  struct ConnectedPoolProcess _dashFunAsrRequests;
+  struct ConnectedPoolProcess _dashCosyVoiceRequests;
+  /* 以上所有类型的ConnectedPoolProcess, 用于遍历 */
+  std::vector<struct ConnectedPoolProcess *> _poolProcesses;
 
 #if defined(_MSC_VER)
   HANDLE _lock;
@@ -0,0 +1,331 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef __LINUX__
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+
+#include "connectNode.h"
+#include "dnsResolverPool.h"
+#include "nlog.h"
+#include "nlsGlobal.h"
+#include "text_utils.h"
+#include "utility.h"
+
+namespace AlibabaNls {
+
+DnsResolverPool::DnsResolverPool(int threadsNumber) : _exit(false) {
+  pthread_mutex_init(&_lock, NULL);
+  pthread_cond_init(&_cond, NULL);
+
+  if (threadsNumber <= 0) {
+    threadsNumber = DnsResolverThreadsNumber;
+  }
+  for (int i = 0; i < threadsNumber; i++) {
+    pthread_t thread_id;
+    int err = pthread_create(&thread_id, NULL, resolveThreadFn, this);
+    if (err) {
+      LOG_ERROR("DnsResolverPool(%p) create NO:%d thread failed, err:%d.",
+                this, i, err);
+      continue;
+    }
+    _threads.push_back(thread_id);
+  }
+  LOG_INFO("DnsResolverPool(%p) create %zu resolve threads.", this,
+           _threads.size());
+}
+
+DnsResolverPool::~DnsResolverPool() {
+  LOG_INFO("DnsResolverPool(%p) destroy begin ...", this);
+  MUTEX_LOCK(_lock);
+  _exit = true;
+  pthread_cond_broadcast(&_cond);
+  MUTEX_UNLOCK(_lock);
+
+  for (size_t i = 0; i < _threads.size(); i++) {
+    pthread_join(_threads[i], NULL);
+  }
+  _threads.clear();
+
+  /* 解析线程已退出, 剩余查询的等待者不再投递结果 */
+  std::map<std::string, DnsQuery *>::iterator it;
+  for (it = _queries.begin(); it != _queries.end(); ++it) {
+    std::list<DnsWaiter>::iterator w;
+    for (w = it->second->waiters.begin(); w != it->second->waiters.end();
+         ++w) {
+      w->node->_dnsResolving = false;
+    }
+    delete it->second;
+  }
+  _queries.clear();
+  _pendingQueries.clear();
+  _nodeQueries.clear();
+
+  pthread_cond_destroy(&_cond);
+  pthread_mutex_destroy(&_lock);
+  LOG_INFO("DnsResolverPool(%p) destroy done.", this);
+}
+
+int DnsResolverPool::resolve(ConnectNode *node, const char *host,
+                             int aiFamily, unsigned int timeoutMs) {
+  if (node == NULL || host == NULL) {
+    return -(InvalidInputParam);
+  }
+
+  char family_str[16] = {0};
+  snprintf(family_str, sizeof(family_str), "%d|", aiFamily);
+  std::string key = std::string(family_str) + host;
+
+  MUTEX_LOCK(_lock);
+  if (_exit || _threads.empty()) {
+    MUTEX_UNLOCK(_lock);
+    LOG_ERROR("Node(%p) DnsResolverPool(%p) is unavailable.", node, this);
+    return -(GetAddrinfoFailed);
+  }
+
+  if (_nodeQueries.find(node) != _nodeQueries.end()) {
+    MUTEX_UNLOCK(_lock);
+    LOG_WARN("Node(%p) is resolving already, skip resolve %s.", node, host);
+    return Success;
+  }
+
+  DnsQuery *query = NULL;
+  std::map<std::string, DnsQuery *>::iterator it = _queries.find(key);
+  if (it != _queries.end()) {
+    query = it->second;
+    LOG_DEBUG("Node(%p) join the query of %s, waiters:%zu.", node, host,
+              query->waiters.size());
+  } else {
+    query = new DnsQuery();
+    query->key = key;
+    query->host = host;
+    query->aiFamily = aiFamily;
+    query->running = false;
+    _queries[key] = query;
+    _pendingQueries.push_back(query);
+    pthread_cond_signal(&_cond);
+  }
+
+  DnsWaiter waiter;
+  waiter.node = node;
+  waiter.deadlineMs = utility::TextUtils::GetTimestampMs() + timeoutMs;
+  query->waiters.push_back(waiter);
+  _nodeQueries[node] = query;
+  node->_dnsResolving = true;
+  /* 唤醒空闲线程以更新最近的超时时间 */
+  pthread_cond_broadcast(&_cond);
+  MUTEX_UNLOCK(_lock);
+  return Success;
+}
+
+bool DnsResolverPool::cancel(ConnectNode *node) {
+  bool found = false;
+  MUTEX_LOCK(_lock);
+  std::map<ConnectNode *, DnsQuery *>::iterator it = _nodeQueries.find(node);
+  if (it != _nodeQueries.end()) {
+    DnsQuery *query = it->second;
+    std::list<DnsWaiter>::iterator w;
+    for (w = query->waiters.begin(); w != query->waiters.end(); ++w) {
+      if (w->node == node) {
+        query->waiters.erase(w);
+        break;
+      }
+    }
+    _nodeQueries.erase(it);
+    /* 正在解析的查询由解析线程在结束后回收 */
+    if (query->waiters.empty() && !query->running) {
+      removeQueryLocked(query);
+    }
+    found = true;
+  }
+  node->_dnsResolving = false;
+  MUTEX_UNLOCK(_lock);
+
+  if (found) {
+    LOG_DEBUG("Node(%p) cancel dns resolving.", node);
+  }
+  return found;
+}
+
+void *DnsResolverPool::resolveThreadFn(void *arg) {
+  prctl(PR_SET_NAME, "nlsDnsResolver");
+  DnsResolverPool *pool = static_cast<DnsResolverPool *>(arg);
+  pool->resolveLoop();
+  return NULL;
+}
+
+void DnsResolverPool::resolveLoop() {
+  MUTEX_LOCK(_lock);
+  while (!_exit) {
+    uint64_t next_deadline_ms =
+        expireWaitersLocked(utility::TextUtils::GetTimestampMs());
+
+    if (_pendingQueries.empty()) {
+      if (next_deadline_ms == 0) {
+        pthread_cond_wait(&_cond, &_lock);
+      } else {
+        struct timespec outtime;
+        utility::TextUtils::GetTimespecFromMs(&outtime, next_deadline_ms);
+        pthread_cond_timedwait(&_cond, &_lock, &outtime);
+      }
+      continue;
+    }
+
+    DnsQuery *query = _pendingQueries.front();
+    _pendingQueries.pop_front();
+    query->running = true;
+    MUTEX_UNLOCK(_lock);
+
+    struct evutil_addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = query->aiFamily;
+    hints.ai_flags = EVUTIL_AI_CANONNAME;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    struct evutil_addrinfo *address = NULL;
+    int err = getaddrinfo(query->host.c_str(), NULL, &hints, &address);
+    if (err) {
+      LOG_WARN("DnsResolverPool(%p) cannot get addrinfo of %s, err:%d(%s).",
+               this, query->host.c_str(), err, gai_strerror(err));
+    }
+
+    MUTEX_LOCK(_lock);
+    deliverLocked(query, err, address);
+    removeQueryLocked(query);
+    MUTEX_UNLOCK(_lock);
+
+    if (address) {
+      freeaddrinfo(address);
+    }
+    MUTEX_LOCK(_lock);
+  }
+  MUTEX_UNLOCK(_lock);
+}
+
+/**
+ * @brief: 将解析结果投递给query的所有等待者, 调用前需持有_lock
+ */
+void DnsResolverPool::deliverLocked(DnsQuery *query, int errorCode,
+                                    const struct evutil_addrinfo *address) {
+  std::list<DnsWaiter>::iterator w;
+  for (w = query->waiters.begin(); w != query->waiters.end(); ++w) {
+    ConnectNode *node = w->node;
+    _nodeQueries.erase(node);
+    node->_dnsResolving = false;
+
+    struct evutil_addrinfo *node_addr = NULL;
+    int err = errorCode;
+    if (err == 0) {
+      node_addr = copyAddrinfo(address);
+      if (node_addr == NULL) {
+        err = EAI_MEMORY;
+      }
+    }
+    node->sysDnsResolved(err, node_addr);
+  }
+  query->waiters.clear();
+}
+
+/**
+ * @brief: 以EAI_AGAIN投递超时的等待者, 调用前需持有_lock
+ * @return: 剩余等待者中最近的超时时间, 没有等待者则为0
+ */
+uint64_t DnsResolverPool::expireWaitersLocked(uint64_t nowMs) {
+  uint64_t next_deadline_ms = 0;
+  std::map<std::string, DnsQuery *>::iterator it = _queries.begin();
+  while (it != _queries.end()) {
+    DnsQuery *query = it->second;
+    ++it;
+
+    std::list<DnsWaiter>::iterator w = query->waiters.begin();
+    while (w != query->waiters.end()) {
+      if (w->deadlineMs <= nowMs) {
+        ConnectNode *node = w->node;
+        LOG_WARN("Node(%p) resolve %s timeout.", node, query->host.c_str());
+        _nodeQueries.erase(node);
+        node->_dnsResolving = false;
+        node->sysDnsResolved(EAI_AGAIN, NULL);
+        w = query->waiters.erase(w);
+        continue;
+      }
+      if (next_deadline_ms == 0 || w->deadlineMs < next_deadline_ms) {
+        next_deadline_ms = w->deadlineMs;
+      }
+      ++w;
+    }
+
+    if (query->waiters.empty() && !query->running) {
+      removeQueryLocked(query);
+    }
+  }
+  return next_deadline_ms;
+}
+
+/**
+ * @brief: 从_queries和_pendingQueries中移除并释放query, 调用前需持有_lock
+ */
+void DnsResolverPool::removeQueryLocked(DnsQuery *query) {
+  std::map<std::string, DnsQuery *>::iterator it = _queries.find(query->key);
+  if (it != _queries.end() && it->second == query) {
+    _queries.erase(it);
+  }
+  std::deque<DnsQuery *>::iterator p;
+  for (p = _pendingQueries.begin(); p != _pendingQueries.end(); ++p) {
+    if (*p == query) {
+      _pendingQueries.erase(p);
+      break;
+    }
+  }
+  delete query;
+}
+
+/**
+ * @brief: 拷贝一份解析结果交给ConnectNode, 由WorkThread::dnsEventCallback
+ *         通过evutil_freeaddrinfo()释放.
+ *         每个节点按系统getaddrinfo()的内存布局单独分配,
+ *         以便evutil_freeaddrinfo()最终调用freeaddrinfo()释放.
+ */
+struct evutil_addrinfo *DnsResolverPool::copyAddrinfo(
+    const struct evutil_addrinfo *address) {
+  struct evutil_addrinfo *head = NULL;
+  struct evutil_addrinfo **tail = &head;
+  const struct evutil_addrinfo *ai;
+  for (ai = address; ai; ai = ai->ai_next) {
+    struct evutil_addrinfo *copy = (struct evutil_addrinfo *)malloc(
+        sizeof(struct evutil_addrinfo) + ai->ai_addrlen);
+    if (copy == NULL) {
+      if (head) {
+        freeaddrinfo(head);
+      }
+      return NULL;
+    }
+    memcpy(copy, ai, sizeof(struct evutil_addrinfo));
+    copy->ai_addr = (struct sockaddr *)(copy + 1);
+    memcpy(copy->ai_addr, ai->ai_addr, ai->ai_addrlen);
+    copy->ai_canonname = ai->ai_canonname ? strdup(ai->ai_canonname) : NULL;
+    copy->ai_next = NULL;
+    *tail = copy;
+    tail = &copy->ai_next;
+  }
+  return head;
+}
+
+}  // namespace AlibabaNls
+
+#endif  // __LINUX__
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NLS_SDK_DNS_RESOLVER_POOL_H
+#define NLS_SDK_DNS_RESOLVER_POOL_H
+
+#ifdef __LINUX__
+#include <pthread.h>
+#include <stdint.h>
+
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "event2/util.h"
+
+namespace AlibabaNls {
+
+class ConnectNode;
+
+/* 系统getaddrinfo解析线程池的线程数 */
+#define DnsResolverThreadsNumber 4
+
+/*
+ * 使用系统getaddrinfo()进行dns解析的固定大小线程池,
+ * 用于替代setUseSysGetAddrInfo(true)时每个ConnectNode独立创建的解析线程.
+ * 同一时刻相同host和aiFamily的解析请求合并为一次查询,
+ * 结果拷贝后通过各ConnectNode所属WorkThread的事件回调投递.
+ */
+class DnsResolverPool {
+ public:
+  explicit DnsResolverPool(int threadsNumber = DnsResolverThreadsNumber);
+  ~DnsResolverPool();
+
+  /**
+   * @brief: 提交node的dns解析请求, 结果通过node->sysDnsResolved()投递
+   * @param node: 发起解析的ConnectNode
+   * @param host: 待解析的域名
+   * @param aiFamily: AF_INET/AF_INET6/AF_UNSPEC
+   * @param timeoutMs: 等待解析结果的超时时间, 超时后以EAI_AGAIN投递
+   * @return: 成功则为0, 否则为失败
+   */
+  int resolve(ConnectNode *node, const char *host, int aiFamily,
+              unsigned int timeoutMs);
+
+  /**
+   * @brief: 取消node尚未投递的dns解析请求, 返回后线程池不再访问node
+   * @return: node存在未完成的解析请求则返回true
+   */
+  bool cancel(ConnectNode *node);
+
+ private:
+  struct DnsWaiter {
+    ConnectNode *node;
+    uint64_t deadlineMs;
+  };
+
+  struct DnsQuery {
+    std::string key;
+    std::string host;
+    int aiFamily;
+    bool running;
+    std::list<DnsWaiter> waiters;
+  };
+
+  static void *resolveThreadFn(void *arg);
+  static struct evutil_addrinfo *copyAddrinfo(
+      const struct evutil_addrinfo *address);
+  void resolveLoop();
+  void deliverLocked(DnsQuery *query, int errorCode,
+                     const struct evutil_addrinfo *address);
+  uint64_t expireWaitersLocked(uint64_t nowMs);
+  void removeQueryLocked(DnsQuery *query);
+
+  std::vector<pthread_t> _threads;
+  std::map<std::string, DnsQuery *> _queries; /* 未完成的查询 */
+  std::deque<DnsQuery *> _pendingQueries;     /* 等待解析线程处理的查询 */
+  std::map<ConnectNode *, DnsQuery *> _nodeQueries;
+  bool _exit;
+
+  pthread_mutex_t _lock;
+  pthread_cond_t _cond;
+};
+
+}  // namespace AlibabaNls
+
+#endif  // __LINUX__
+
+#endif  // NLS_SDK_DNS_RESOLVER_POOL_H
@@ -23,6 +23,7 @@
 #endif
 
 #include "connectNode.h"
+#include "dnsResolverPool.h"
 #include "event2/dns.h"
 #include "event2/thread.h"
 #include "iNlsRequest.h"
@@ -31,11 +32,9 @@
 #include "nlsEventNetWork.h"
 #include "nlsGlobal.h"
 #include "nodeManager.h"
+#include "text_utils.h"
 #include "utility.h"
 #include "workThread.h"
-#ifdef ENABLE_REQUEST_RECORDING
-#include "text_utils.h"
-#endif
 #ifdef ENABLE_PRECONNECTED_POOL
 #include "connectedPool.h"
 #endif
@@ -60,6 +59,9 @@ NlsEventNetWork::NlsEventNetWork()
       _directIp(),
       _enableSysGetAddr(false),
       _syncCallTimeoutMs(0),
+#ifdef __LINUX__
+      _dnsResolverPool(NULL),
+#endif
 #ifdef ENABLE_PRECONNECTED_POOL
       _preconnectedPool(NULL),
       _maxPreconnectedNumber(0),
@@ -126,6 +128,11 @@ void NlsEventNetWork::initEventNetWork(NlsClientImpl *instance, int count,
   }
   _enableSysGetAddr = sysGetAddr;
   _syncCallTimeoutMs = syncCallTimeoutMs;
+#ifdef __LINUX__
+  if (_enableSysGetAddr && _dnsResolverPool == NULL) {
+    _dnsResolverPool = new DnsResolverPool();
+  }
+#endif
 
 #if defined(_MSC_VER)
   SYSTEM_INFO sysInfo;
@@ -152,6 +159,7 @@ void NlsEventNetWork::initEventNetWork(NlsClientImpl *instance, int count,
 
   for (size_t i = 0; i < _workThreadsNumber; i++) {
     LOG_INFO("New NO:%zu work thread %p.", i, &_workThreadArray[i]);
+    _workThreadArray[i].setThreadIndex((int)i);
   }
 
   evdns_set_log_fn(DnsLogCb);
@@ -169,6 +177,13 @@ void NlsEventNetWork::destroyEventNetWork() {
   delete[] _workThreadArray;
   _workThreadArray = NULL;
 
+#ifdef __LINUX__
+  if (_dnsResolverPool) {
+    delete _dnsResolverPool;
+    _dnsResolverPool = NULL;
+  }
+#endif
+
 #if defined(_MSC_VER)
   CloseHandle(WorkThread::_mtxCpu);
 #else
@@ -227,26 +242,45 @@ int NlsEventNetWork::start(INlsRequest *request) {
   }
 
 #ifdef ENABLE_PRECONNECTED_POOL
-  if (_preconnectedPool) {
+  if (_preconnectedPool && !node->isLongConnection()) {
     node->usePreconnection(true);
-    node->useLongConnection(false);
   } else {
+    /*
+     * 长链接模式自行建链并在多轮交互间保持链接, 不经过预连接池.
+     * 预连接池在每轮交互结束时收回链接, 与长链接保持链接的语义冲突.
+     */
     node->usePreconnection(false);
   }
 #endif
 
-  /* 长链接模式下, 若为Completed状态, 则等待其进入Closed后, 再重置状态. */
+  /*
+   * 长链接模式下, 若上一轮交互为Completed状态(还未回调Close),
+   * 则记录本次start, 在进入Closed后由工作线程在同一链接上发起.
+   * 同步调用模式需要在本线程等待结果, 仍在此处等待进入Closed.
+   */
   if (node->isLongConnection()) {
-    int try_count = 500;
-    while (try_count-- > 0 && node->getConnectNodeStatus() == NodeCompleted) {
-#ifdef _MSC_VER
-      Sleep(1);
-#else
-      usleep(1000);
-#endif
+    if (_syncCallTimeoutMs == 0 && node->deferLongConnectionStart()) {
+      LOG_DEBUG(
+          "Node:%p current is NodeCompleted and longConnection mode, start "
+          "after NodeClosed.",
+          node);
+      MUTEX_UNLOCK(_mtxThread);
+      return Success;
     }
 
-    if (node->getConnectNodeStatus() == NodeClosed) {
+    /* 等待期间释放_mtxThread, 不阻塞其他请求的start/stop */
+    MUTEX_UNLOCK(_mtxThread);
+    ConnectStatus status = node->waitLongConnectionClosed(500);
+    MUTEX_LOCK(_mtxThread);
+    if (_eventClient == NULL) {
+      LOG_ERROR(
+          "NlsEventNetWork has destroyed, please invoke startWorkThread() "
+          "first.");
+      MUTEX_UNLOCK(_mtxThread);
+      return -(EventClientEmpty);
+    }
+
+    if (status == NodeClosed) {
       LOG_DEBUG(
           "Node:%p current is NodeClosed and longConnection mode, reset "
           "status.",
@@ -262,8 +296,9 @@ int NlsEventNetWork::start(INlsRequest *request) {
   if (node->getConnectNodeStatus() == NodeCreated &&
       node->getExitStatus() == ExitInvalid) {
     node->setConnectNodeStatus(NodeInvoking);
+    node->markTimelineStart();
 #ifdef ENABLE_REQUEST_RECORDING
-    node->updateNodeProcess("start", NodeInvoking, true, 0);
+    node->updateNodeProcess(RecordStart, NodeInvoking, true, 0);
 #endif
 
     int num = request->getThreadNumber();
@@ -274,7 +309,7 @@ int NlsEventNetWork::start(INlsRequest *request) {
       node->setConnectNodeStatus(NodeCreated);
       MUTEX_UNLOCK(_mtxThread);
 #ifdef ENABLE_REQUEST_RECORDING
-      node->updateNodeProcess("start", NodeCreated, false, 0);
+      node->updateNodeProcess(RecordStart, NodeCreated, false, 0);
 #endif
       return -(SelectThreadFailed);
     } else {
@@ -310,8 +345,7 @@ int NlsEventNetWork::start(INlsRequest *request) {
 #ifdef ENABLE_REQUEST_RECORDING
       node->getNodeProcess()->connect_type = ConnectWithPreconnectedNodePool;
 #endif
-      int event_ret = event_add(node->getStartWithPoolEvent(true), NULL);
-      event_active(node->getStartWithPoolEvent(), EV_READ, 0);
+      node->triggerAction(NodeTriggerStartWithPool);
     } else if (getPrestartedNode == PreNodeStarted) {
       // 获得了prestarted节点, 直接开始工作
       LOG_DEBUG("Request(%p) node(%p) get a prestarted node ...", request,
@@ -319,8 +353,7 @@ int NlsEventNetWork::start(INlsRequest *request) {
 #ifdef ENABLE_REQUEST_RECORDING
       node->getNodeProcess()->connect_type = ConnectWithPrestartedNodePool;
 #endif
-      int event_ret = event_add(node->getStartWithPoolEvent(true), NULL);
-      event_active(node->getStartWithPoolEvent(), EV_READ, 0);
+      node->triggerAction(NodeTriggerStartWithPool);
       LOG_DEBUG(
           "Request(%p) node(%p) get a prestarted node "
           "tryToGetPreconnection latency %llums",
@@ -328,26 +361,20 @@ int NlsEventNetWork::start(INlsRequest *request) {
     } else
 #endif
     {
-      LOG_DEBUG(
-          "Request(%p) node(%p) ready to invoke event_add LaunchEvent ...",
-          request, node);
-      int event_ret = event_add(node->getLaunchEvent(true), NULL);
+      LOG_DEBUG("Request(%p) node(%p) ready to trigger NodeTriggerLaunch ...",
+                request, node);
+      int event_ret = node->triggerAction(NodeTriggerLaunch);
       if (event_ret != Success) {
-        LOG_ERROR("Request(%p) node(%p) invoking event_add failed(%d).",
+        LOG_ERROR("Request(%p) node(%p) triggering launch failed(%d).",
                   request, node, event_ret);
         MUTEX_UNLOCK(_mtxThread);
 #ifdef ENABLE_REQUEST_RECORDING
-        node->updateNodeProcess("start", NodeCreated, false, 0);
+        node->updateNodeProcess(RecordStart, NodeCreated, false, 0);
 #endif
         return -(InvokeStartFailed);
       } else {
-        LOG_DEBUG(
-            "Request(%p) node(%p) invoking event_add success, ready to launch "
-            "request.",
-            request, node);
+        LOG_DEBUG("Request(%p) node(%p) launch triggered.", request, node);
       }
-
-      event_active(node->getLaunchEvent(), EV_READ, 0);
     }
 
     node->initNlsEncoder();
@@ -358,13 +385,13 @@ int NlsEventNetWork::start(INlsRequest *request) {
       if (error_code != Success) {
         MUTEX_UNLOCK(_mtxThread);
 #ifdef ENABLE_REQUEST_RECORDING
-        node->updateNodeProcess("start", NodeCreated, false, 0);
+        node->updateNodeProcess(RecordStart, NodeCreated, false, 0);
 #endif
         return -(error_code);
       }
     }
 #ifdef ENABLE_REQUEST_RECORDING
-    node->updateNodeProcess("start", NodeCreated, false, 0);
+    node->updateNodeProcess(RecordStart, NodeCreated, false, 0);
 #endif
 
   } else if (node->getExitStatus() == ExitInvalid &&
@@ -429,8 +456,9 @@ int NlsEventNetWork::startInner(INlsRequest *request) {
   if (node->getConnectNodeStatus() == NodeCreated &&
       node->getExitStatus() == ExitInvalid) {
     node->setConnectNodeStatus(NodeInvoking);
+    node->markTimelineStart();
 #ifdef ENABLE_REQUEST_RECORDING
-    node->updateNodeProcess("start", NodeInvoking, true, 0);
+    node->updateNodeProcess(RecordStart, NodeInvoking, true, 0);
 #endif
 
     int num = request->getThreadNumber();
@@ -441,7 +469,7 @@ int NlsEventNetWork::startInner(INlsRequest *request) {
       node->setConnectNodeStatus(NodeCreated);
       MUTEX_UNLOCK(_mtxThread);
 #ifdef ENABLE_REQUEST_RECORDING
-      node->updateNodeProcess("start", NodeCreated, false, 0);
+      node->updateNodeProcess(RecordStart, NodeCreated, false, 0);
 #endif
       return -(SelectThreadFailed);
     } else {
@@ -514,7 +542,12 @@ int NlsEventNetWork::sendAudio(INlsRequest *request, const uint8_t *data,
 #endif
   }
 
-  if (node->getConnectNodeStatus() != NodeStarted ||
+  bool replay_holding = false;
+#ifdef ENABLE_CONTINUED
+  /* 重连过程中音频暂存至重放缓冲, 重连成功后重放 */
+  replay_holding = node->isAudioReplayHolding();
+#endif
+  if ((node->getConnectNodeStatus() != NodeStarted && !replay_holding) ||
       node->getExitStatus() != ExitInvalid) {
     LOG_ERROR(
         "Request(%p) node(%p) invoke sendAudio command failed, current status "
@@ -525,17 +558,28 @@ int NlsEventNetWork::sendAudio(INlsRequest *request, const uint8_t *data,
   }
 
 #ifdef ENABLE_REQUEST_RECORDING
-  node->updateNodeProcess("sendAudio", NodeSendAudio, true, dataSize);
+  node->updateNodeProcess(RecordSendAudio, NodeSendAudio, true, dataSize);
 #endif
 
+  /* 发送缓冲区已满时在切片和编码前拒绝, 待AudioWritable回调后再发送 */
+  if (node->getAudioCredit() == 0) {
+    LOG_WARN("Request(%p) node(%p) audio evbuffer is full, would block.",
+             request, node);
+    return -(EvbufferTooMuch);
+  }
+
   int ret = 0;
+  uint64_t beginUs = utility::TextUtils::GetMonotonicUs();
   if (type != ENCODER_NONE) {
     ret = node->addSlicedAudioDataBuffer(data, dataSize);
   } else {
     ret = node->addAudioDataBuffer(data, dataSize);
   }
+  if (ret >= 0) {
+    node->traceSendAudio(dataSize, beginUs);
+  }
 #ifdef ENABLE_REQUEST_RECORDING
-  node->updateNodeProcess("sendAudio", NodeSendAudio, false, 0);
+  node->updateNodeProcess(RecordSendAudio, NodeSendAudio, false, 0);
 #endif
   return ret;
 }
@@ -949,6 +993,29 @@ int NlsEventNetWork::destroyPreconnectedPool() {
 ConnectedPool *NlsEventNetWork::getPreconnectedPool() {
   return _preconnectedPool;
 }
+
+int NlsEventNetWork::setPreconnectedPoolAutoScale(unsigned int minNumber,
+                                                  unsigned int maxNumber,
+                                                  float targetHitRatio) {
+  int ret = -(ConnectedPoolEmpty);
+  MUTEX_LOCK(_mtxThread);
+  if (_preconnectedPool) {
+    ret = _preconnectedPool->setAutoScale(minNumber, maxNumber, targetHitRatio);
+  }
+  MUTEX_UNLOCK(_mtxThread);
+  return ret;
+}
+
+int NlsEventNetWork::dumpPreconnectedPoolInfo(std::string &info) {
+  int ret = -(ConnectedPoolEmpty);
+  MUTEX_LOCK(_mtxThread);
+  if (_preconnectedPool) {
+    info = _preconnectedPool->dumpPoolInfo();
+    ret = Success;
+  }
+  MUTEX_UNLOCK(_mtxThread);
+  return ret;
+}
 #endif  // ENABLE_PRECONNECTED_POOL
 
 }  // namespace AlibabaNls
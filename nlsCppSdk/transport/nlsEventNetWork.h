@@ -22,6 +22,8 @@
 #else
 #include <pthread.h>
 #endif
+#include <string>
+
 #include "event2/util.h"
 #include "nlsEncoder.h"
 
@@ -29,6 +31,9 @@ namespace AlibabaNls {
 
 class INlsRequest;
 class WorkThread;
+#ifdef __LINUX__
+class DnsResolverPool;
+#endif
 #ifdef ENABLE_PRECONNECTED_POOL
 class ConnectedPool;
 #endif
@@ -67,6 +72,14 @@ class NlsEventNetWork {
                            unsigned int requestedTimeoutMs);
   int destroyPreconnectedPool();
   ConnectedPool *getPreconnectedPool();
+  int setPreconnectedPoolAutoScale(unsigned int minNumber,
+                                   unsigned int maxNumber,
+                                   float targetHitRatio);
+  int dumpPreconnectedPoolInfo(std::string &info);
+#endif
+
+#ifdef __LINUX__
+  DnsResolverPool *getDnsResolverPool() { return _dnsResolverPool; }
 #endif
 
  private:
@@ -80,6 +93,9 @@ class NlsEventNetWork {
   bool _enableSysGetAddr;  //启用getaddrinfo_a接口进行dns解析, 默认false
   unsigned int _syncCallTimeoutMs;  //启用同步接口, 默认0为不启用同步接口
   NlsClientImpl *_instance;
+#ifdef __LINUX__
+  DnsResolverPool *_dnsResolverPool;  //启用getaddrinfo时的dns解析线程池
+#endif
 
 #ifdef ENABLE_PRECONNECTED_POOL
   ConnectedPool *_preconnectedPool;  //预连接池工作线程
@@ -22,13 +22,23 @@
 #include <stdio.h>
 #endif
 
+#include <ctype.h>
 #include <stdlib.h>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
+#include "event2/buffer.h"
 #include "nlog.h"
 #include "nlsGlobal.h"
+#include "nlsMetrics.h"
 #include "text_utils.h"
 #include "utility.h"
 #include "webSocketTcp.h"
@@ -41,15 +51,46 @@ namespace AlibabaNls {
 #define HTTP_CONTENT_LENGTH "Content-Length: "
 #define HTTP_CONTENT_LENGTH_END "\r\n"
 #define SEC_WS_VER "13"
+#define SEC_WS_EXTENSIONS "sec-websocket-extensions:"
+#define WS_PERMESSAGE_DEFLATE "permessage-deflate"
 
 //#define OPU_DEBUG
 
 WebSocketTcp::WebSocketTcp()
-    : _httpCode(0), _httpLength(0), _rStatus(WsHeadSize), _nodeHandle(NULL) {
+    : _httpCode(0),
+      _httpLength(0),
+      _rStatus(WsHeadSize),
+      _nodeHandle(NULL),
+      _maskKey((uint32_t)utility::TextUtils::GetMonotonicUs() ^
+               (uint32_t)(uintptr_t)this) {
+#ifdef ENABLE_WS_DEFLATE
+  _deflatePool = NULL;
+  _inflater = NULL;
+  _deflater = NULL;
+  _deflateOffered = false;
+  _deflateNegotiated = false;
+  _clientNoContextTakeover = false;
+  _clientMaxWindowBits = WsDeflatePool::DeflateWindowBits;
+  _deflateTx = false;
+  _inflatingMessage = false;
+#if defined(_MSC_VER)
+  _mtxDeflate = CreateMutex(NULL, FALSE, NULL);
+#else
+  pthread_mutex_init(&_mtxDeflate, NULL);
+#endif
+#endif
   LOG_DEBUG("Create WebSocketTcp:%p.", this);
 }
 
 WebSocketTcp::~WebSocketTcp() {
+#ifdef ENABLE_WS_DEFLATE
+  releaseDeflate();
+#if defined(_MSC_VER)
+  CloseHandle(_mtxDeflate);
+#else
+  pthread_mutex_destroy(&_mtxDeflate);
+#endif
+#endif
   LOG_DEBUG("WsTcp(%p) Destroy WebSocketTcp done.", this);
 }
 
@@ -117,19 +158,21 @@ int WebSocketTcp::requestPackage(urlAddress* url, char* buffer,
   const int ws_key_bytes = strnlen(getSecWsKey(), 128) - 18;
   if (httpHeader.empty()) {
     contentSize = _ssnprintf(
-        buffer, BufferSize, "GET /%s HTTP/1.1\r\n%s%s%s%s%s%s%s%s%s: %s\r\n%s",
-        url->_path, hostBuff, "Upgrade: websocket\r\n",
-        "Connection: Upgrade\r\n", getSecWsKey(), HTTP_CONTENT_LENGTH_END,
+        buffer, BufferSize,
+        "GET /%s HTTP/1.1\r\n%s%s%s%s%s%s%s%s%s%s: %s\r\n%s", url->_path,
+        hostBuff, "Upgrade: websocket\r\n", "Connection: Upgrade\r\n",
+        getSecWsKey(), HTTP_CONTENT_LENGTH_END,
         "Sec-WebSocket-Version: ", SEC_WS_VER, HTTP_CONTENT_LENGTH_END,
-        "X-NLS-Token", url->_token, HTTP_CONTENT_LENGTH_END);
+        getExtensionsHeader(), "X-NLS-Token", url->_token,
+        HTTP_CONTENT_LENGTH_END);
   } else {
     contentSize = _ssnprintf(
         buffer, BufferSize,
-        "GET /%s HTTP/1.1\r\n%s%s%s%s%s%s%s%s%s: %s\r\n%s%s", url->_path,
+        "GET /%s HTTP/1.1\r\n%s%s%s%s%s%s%s%s%s%s: %s\r\n%s%s", url->_path,
         hostBuff, "Upgrade: websocket\r\n", "Connection: Upgrade\r\n",
         getSecWsKey(), HTTP_CONTENT_LENGTH_END,
         "Sec-WebSocket-Version: ", SEC_WS_VER, HTTP_CONTENT_LENGTH_END,
-        "X-NLS-Token", url->_token, httpHeader.c_str(),
+        getExtensionsHeader(), "X-NLS-Token", url->_token, httpHeader.c_str(),
         HTTP_CONTENT_LENGTH_END);
   }
 
@@ -172,12 +215,13 @@ int WebSocketTcp::requestDashScopePackage(urlAddress* url, char* buffer,
   if (httpHeader.empty()) {
     contentSize = _ssnprintf(
         buffer, BufferSize,
-        "GET /%s "
-        "HTTP/1.1\r\n%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s\r\n%s",
+        "GET /%s HTTP/1.1\r\n"
+        "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s\r\n%s",
         url->_path, hostBuff, "Upgrade: websocket", HTTP_CONTENT_LENGTH_END,
         "Connection: Upgrade", HTTP_CONTENT_LENGTH_END, getSecWsKey(),
         HTTP_CONTENT_LENGTH_END, "Sec-WebSocket-Version: ", SEC_WS_VER,
-        HTTP_CONTENT_LENGTH_END, "user-agent: dashscope/",
+        HTTP_CONTENT_LENGTH_END, getExtensionsHeader(),
+        "user-agent: dashscope/",
         utility::TextUtils::GetSdkInfo().c_str(), ";version/",
         utility::TextUtils::GetVersion().c_str(), ";platform/",
         utility::TextUtils::GetOSName().c_str(), ";arch/",
@@ -187,12 +231,13 @@ int WebSocketTcp::requestDashScopePackage(urlAddress* url, char* buffer,
   } else {
     contentSize = _ssnprintf(
         buffer, BufferSize,
-        "GET /%s "
-        "HTTP/1.1\r\n%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s\r\n%s",
+        "GET /%s HTTP/1.1\r\n"
+        "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s\r\n%s",
         url->_path, hostBuff, "Upgrade: websocket", HTTP_CONTENT_LENGTH_END,
         "Connection: Upgrade", HTTP_CONTENT_LENGTH_END, getSecWsKey(),
         HTTP_CONTENT_LENGTH_END, "Sec-WebSocket-Version: ", SEC_WS_VER,
-        HTTP_CONTENT_LENGTH_END, "user-agent: dashscope/",
+        HTTP_CONTENT_LENGTH_END, getExtensionsHeader(),
+        "user-agent: dashscope/",
         utility::TextUtils::GetSdkInfo().c_str(), ";version/",
         utility::TextUtils::GetVersion().c_str(), ";platform/",
         utility::TextUtils::GetOSName().c_str(), ";arch/",
@@ -269,6 +314,18 @@ int WebSocketTcp::getTargetLen(std::string line, const char* begin,
 
 const char* WebSocketTcp::getFailedMsg() { return _errorMsg.c_str(); }
 
+const char* WebSocketTcp::getExtensionsHeader() {
+#ifdef ENABLE_WS_DEFLATE
+  if (_deflateOffered) {
+    /* 不限制服务端窗口, 以免服务端不支持该参数而拒绝压缩;
+     * 声明client_max_window_bits, 允许服务端限制上行压缩窗口 */
+    return "Sec-WebSocket-Extensions: permessage-deflate; "
+           "client_max_window_bits\r\n";
+  }
+#endif
+  return "";
+}
+
 const char* WebSocketTcp::getSecWsKey() {
   char buffer[128] = {0};
   char tmp[64] = {0};
@@ -292,23 +349,29 @@ const char* WebSocketTcp::getSecWsKey() {
 }
 
 int WebSocketTcp::responsePackage(const char* content, size_t length) {
-  LOG_DEBUG("WsTcp(%p) Http response:%s", this, content);
+  /* content直接指向接收缓冲区, 不保证以'\0'结尾 */
+  std::string tmpLine(content, length);
+  LOG_DEBUG("WsTcp(%p) Http response:%s", this, tmpLine.c_str());
 
-  if (!strstr(content, HTTP_HEADER_END_STRING)) {
+  if (tmpLine.find(HTTP_HEADER_END_STRING) == std::string::npos) {
     return length;
   }
 
-  std::string tmpLine = content;
   if (_httpCode == 0) {
     _httpCode = getTargetLen(tmpLine, HTTP_STATUS_CODE, HTTP_STATUS_CODE_END);
     if (_httpCode == 0) {
-      LOG_ERROR("WsTcp(%p) Got bad status connecting to %s", this, content);
+      LOG_ERROR("WsTcp(%p) Got bad status connecting to %s", this,
+                tmpLine.c_str());
       return -(HttpGotBadStatus);
     }
   }
 
   if (_httpCode == 101) {
+#ifdef ENABLE_WS_DEFLATE
+    return parseExtensions(tmpLine);
+#else
     return 0;
+#endif
   } else {
     if (_httpLength == 0) {
       _httpLength =
@@ -319,12 +382,12 @@ int WebSocketTcp::responsePackage(const char* content, size_t length) {
     size_t position = tmpLine.find(HTTP_HEADER_END_STRING);
     if (position != std::string::npos) {
       if (_httpLength == 0) {
-        LOG_ERROR("WsTcp(%p) Failed: %s", this, content);
-        _errorMsg = content;
+        LOG_ERROR("WsTcp(%p) Failed: %s", this, tmpLine.c_str());
+        _errorMsg = tmpLine;
         return -(WsResponsePackageFailed);
       } else {
         if (_httpLength == (length - (position + endLen))) {
-          const char* errMsg = (content + position + endLen);
+          const char* errMsg = tmpLine.c_str() + position + endLen;
           _errorMsg = errMsg;
           LOG_ERROR("WsTcp(%p) Position: %d %s", this,
                     (int)(length - (position + endLen)), errMsg);
@@ -337,6 +400,153 @@ int WebSocketTcp::responsePackage(const char* content, size_t length) {
   return -(WsResponsePackageFailed);
 }
 
+#ifdef ENABLE_WS_DEFLATE
+void WebSocketTcp::offerDeflate(WsDeflatePool* pool) {
+  /* 每次握手都从新的压缩上下文开始 */
+  releaseDeflate();
+  if (pool == NULL) {
+    return;
+  }
+
+  WsZStream* inflater = pool->acquire(false, WsDeflatePool::InflateWindowBits);
+  if (inflater == NULL) {
+    utility::NlsMetrics::addCounter(utility::MetricWsDeflateSkip);
+    return;
+  }
+
+  MUTEX_LOCK(_mtxDeflate);
+  _deflatePool = pool;
+  _inflater = inflater;
+  _deflateOffered = true;
+  MUTEX_UNLOCK(_mtxDeflate);
+}
+
+void WebSocketTcp::releaseDeflate() {
+  MUTEX_LOCK(_mtxDeflate);
+  if (_deflatePool) {
+    _deflatePool->release(_inflater);
+    _deflatePool->release(_deflater);
+  }
+  _deflatePool = NULL;
+  _inflater = NULL;
+  _deflater = NULL;
+  _deflateOffered = false;
+  _deflateNegotiated = false;
+  _clientNoContextTakeover = false;
+  _clientMaxWindowBits = WsDeflatePool::DeflateWindowBits;
+  _deflateTx = false;
+  _inflatingMessage = false;
+  MUTEX_UNLOCK(_mtxDeflate);
+}
+
+/**
+ * @brief: 解析101响应中的Sec-WebSocket-Extensions.
+ *         服务端未接受则归还解压流按原样收发, 接受时携带了未知的扩展或参数
+ *         按RFC 7692须断开连接.
+ * @return: 成功返回0, 失败则返回负值.
+ */
+int WebSocketTcp::parseExtensions(const std::string& response) {
+  if (!_deflateOffered) {
+    return 0;
+  }
+
+  size_t headerEnd = response.find(HTTP_HEADER_END_STRING);
+  std::string headers = response.substr(0, headerEnd);
+  for (size_t i = 0; i < headers.size(); i++) {
+    headers[i] = tolower(headers[i]);
+  }
+
+  bool accepted = false;
+  bool clientNoContextTakeover = false;
+  int clientMaxWindowBits = WsDeflatePool::DeflateWindowBits;
+  std::string invalid;
+  size_t pos = 0;
+  while ((pos = headers.find(SEC_WS_EXTENSIONS, pos)) != std::string::npos) {
+    if (pos > 0 && headers[pos - 1] != '\n') {
+      pos += strlen(SEC_WS_EXTENSIONS);
+      continue;
+    }
+    size_t begin = pos + strlen(SEC_WS_EXTENSIONS);
+    size_t end = headers.find("\r\n", begin);
+    std::string value = headers.substr(
+        begin, end == std::string::npos ? std::string::npos : end - begin);
+    pos = begin;
+
+    /* 扩展之间以','分隔, 扩展名与参数之间以';'分隔 */
+    std::stringstream extensions(value);
+    std::string extension;
+    while (std::getline(extensions, extension, ',')) {
+      std::stringstream params(extension);
+      std::string param;
+      bool first = true;
+      bool deflate = false;
+      while (std::getline(params, param, ';')) {
+        param.erase(0, param.find_first_not_of(" \t"));
+        param.erase(param.find_last_not_of(" \t") + 1);
+        if (first) {
+          first = false;
+          deflate = param == WS_PERMESSAGE_DEFLATE && !accepted;
+          if (deflate) {
+            accepted = true;
+          } else if (!param.empty()) {
+            invalid = param;
+          }
+          continue;
+        }
+        if (!deflate) {
+          continue;
+        }
+
+        std::string name = param.substr(0, param.find('='));
+        std::string arg;
+        if (name.size() < param.size()) {
+          arg = param.substr(name.size() + 1);
+          arg.erase(std::remove(arg.begin(), arg.end(), '"'), arg.end());
+        }
+        int bits = atoi(arg.c_str());
+        if (name == "server_no_context_takeover" ||
+            (name == "server_max_window_bits" && bits >= 8 && bits <= 15)) {
+          /* 按最大窗口解压, 服务端的窗口及上下文设置不影响解压 */
+        } else if (name == "client_no_context_takeover") {
+          clientNoContextTakeover = true;
+        } else if (name == "client_max_window_bits" && bits >= 8 &&
+                   bits <= 15) {
+          clientMaxWindowBits = bits;
+        } else {
+          invalid = param;
+        }
+      }
+    }
+  }
+
+  if (!invalid.empty()) {
+    LOG_ERROR("WsTcp(%p) server responded invalid extension: %s", this,
+              invalid.c_str());
+    _errorMsg = "invalid Sec-WebSocket-Extensions: " + invalid;
+    releaseDeflate();
+    return -(WsResponsePackageFailed);
+  }
+  if (!accepted) {
+    LOG_DEBUG("WsTcp(%p) server declined permessage-deflate.", this);
+    releaseDeflate();
+    return 0;
+  }
+
+  MUTEX_LOCK(_mtxDeflate);
+  _deflateNegotiated = true;
+  _clientNoContextTakeover = clientNoContextTakeover;
+  _clientMaxWindowBits = clientMaxWindowBits;
+  /* zlib的raw deflate不支持8位窗口, 此时只解压下行, 上行不压缩 */
+  _deflateTx = clientMaxWindowBits >= 9;
+  MUTEX_UNLOCK(_mtxDeflate);
+  LOG_INFO(
+      "WsTcp(%p) permessage-deflate negotiated, client_max_window_bits:%d "
+      "client_no_context_takeover:%d.",
+      this, clientMaxWindowBits, clientNoContextTakeover);
+  return 0;
+}
+#endif
+
 int WebSocketTcp::receiveFullWebSocketFrame(uint8_t* frame, size_t frameSize,
                                             WebSocketHeaderType* wsType,
                                             WebSocketFrame* resultDate) {
@@ -421,6 +631,8 @@ int WebSocketTcp::decodeHeaderSizeWebSocketFrame(uint8_t* buffer, size_t length,
   const uint8_t* data = buffer;  // peek, but don't consume
   /* FIN: 0bit 表示是否为最后帧 */
   wsType->fin = (data[0] & 0x80) == 0x80;
+  /* RSV1: 1bit 协商permessage-deflate后表示消息经过压缩 */
+  wsType->rsv1 = (data[0] & 0x40) == 0x40;
   /* Opcode: 4-7bit */
   wsType->opCode = (WebSocketHeaderType::OpCodeType)(data[0] & 0x0f);
   /* Mask: 8bit */
@@ -525,6 +737,23 @@ int WebSocketTcp::decodeFrameBodyWebSocketFrame(uint8_t* buffer, size_t length,
 
     receivedData->data = (buffer + wsType->headerSize);
     receivedData->length = (size_t)wsType->N;
+    receivedData->wireLength = (size_t)wsType->N;
+
+#ifdef ENABLE_WS_DEFLATE
+    /* 压缩标记只在消息首帧, 后续分片沿用 */
+    bool compressed = wsType->opCode == WebSocketHeaderType::CONTINUATION
+                          ? _inflatingMessage
+                          : wsType->rsv1;
+    if (compressed) {
+      int inflated = inflateFrame(receivedData->data, receivedData->length,
+                                  wsType->fin);
+      if (inflated < 0) {
+        return inflated;
+      }
+      receivedData->data = &_inflateBuffer[0];
+      receivedData->length = (size_t)inflated;
+    }
+#endif
   } else if (wsType->opCode == WebSocketHeaderType::PING) {
     return -(InvalidWsFrameBody);
   } else if (wsType->opCode == WebSocketHeaderType::CLOSE) {
@@ -538,6 +767,7 @@ int WebSocketTcp::decodeFrameBodyWebSocketFrame(uint8_t* buffer, size_t length,
     }
     receivedData->data = (buffer + wsType->headerSize + 2);
     receivedData->length = (size_t)wsType->N;
+    receivedData->wireLength = (size_t)wsType->N;
   }
 
   if (wsType->opCode == WebSocketHeaderType::TEXT_FRAME) {
@@ -552,92 +782,204 @@ int WebSocketTcp::decodeFrameBodyWebSocketFrame(uint8_t* buffer, size_t length,
   return Success;
 }
 
-int WebSocketTcp::binaryFrame(const uint8_t* buffer, size_t length,
-                              uint8_t** frame, size_t* frameSize) {
-  return framePackage(WebSocketHeaderType::BINARY_FRAME, buffer, length, frame,
-                      frameSize);
-}
-
-int WebSocketTcp::textFrame(const uint8_t* buffer, size_t length,
-                            uint8_t** frame, size_t* frameSize) {
-  return framePackage(WebSocketHeaderType::TEXT_FRAME, buffer, length, frame,
-                      frameSize);
-}
+#ifdef ENABLE_WS_DEFLATE
+/**
+ * @brief: 解压一帧载荷到_inflateBuffer, 上下文在帧与消息之间保留
+ * @return: 成功返回解压后的字节数, 失败则返回负值.
+ */
+int WebSocketTcp::inflateFrame(const uint8_t* buffer, size_t length,
+                               bool fin) {
+  /* 发送端以Z_SYNC_FLUSH结束消息并去掉了末尾4字节, 解压前补回 */
+  static const uint8_t tail[4] = {0x00, 0x00, 0xff, 0xff};
+  const size_t chunk = 4096;
+  int ret = Success;
+  size_t produced = 0;
+
+  MUTEX_LOCK(_mtxDeflate);
+  if (!_deflateNegotiated || _inflater == NULL) {
+    MUTEX_UNLOCK(_mtxDeflate);
+    LOG_ERROR(
+        "Node(%p) WsTcp(%p) received compressed frame without "
+        "permessage-deflate.",
+        getConnectNode(), this);
+    return -(WsInflateFailed);
+  }
 
-int WebSocketTcp::pingFrame(uint8_t** frame, size_t* frameSize) {
-  return framePackage(WebSocketHeaderType::PING, NULL, 0, frame, frameSize);
-}
+  z_stream* zs = &_inflater->zs;
+  for (int pass = 0; pass < 2 && ret == Success; pass++) {
+    if (pass == 0) {
+      zs->next_in = (Bytef*)buffer;
+      zs->avail_in = (uInt)length;
+    } else if (fin) {
+      zs->next_in = (Bytef*)tail;
+      zs->avail_in = sizeof(tail);
+    } else {
+      break;
+    }
 
-int WebSocketTcp::framePackage(WebSocketHeaderType::OpCodeType codeType,
-                               const uint8_t* buffer, size_t length,
-                               uint8_t** frame, size_t* frameSize) {
-  bool useMask = true;
-  const uint8_t masKingKey[4] = {0x12, 0x34, 0x56, 0x78};
-  const int headlen = 2 + (length >= 126 ? 2 : 0) + (length >= 65536 ? 6 : 0) +
-                      (useMask ? 4 : 0);
-
-  uint8_t* header =
-      (uint8_t*)calloc(headlen, sizeof(uint8_t));  // new uint8_t[headlen];
-  if (header == NULL) {
-    LOG_ERROR("WsTcp(%p) calloc header failed.", this);
-    return -(MallocFailed);
+    do {
+      if (_inflateBuffer.size() - produced < chunk) {
+        if (produced >= MaxInflateSize) {
+          LOG_ERROR("Node(%p) WsTcp(%p) inflated frame exceeds %dbytes.",
+                    getConnectNode(), this, MaxInflateSize);
+          ret = -(WsInflateFailed);
+          break;
+        }
+        _inflateBuffer.resize(_inflateBuffer.size() * 2 + chunk);
+      }
+      zs->next_out = &_inflateBuffer[produced];
+      zs->avail_out = (uInt)(_inflateBuffer.size() - produced);
+      int zret = inflate(zs, Z_SYNC_FLUSH);
+      produced = _inflateBuffer.size() - zs->avail_out;
+      if (zret == Z_STREAM_END) {
+        /* 服务端以BFINAL结束了压缩流, 之后的数据从新流开始 */
+        inflateReset(zs);
+        if (pass == 1) {
+          zs->avail_in = 0;
+        }
+      } else if (zret == Z_BUF_ERROR && zs->avail_out > 0) {
+        break;
+      } else if (zret != Z_OK && zret != Z_BUF_ERROR) {
+        LOG_ERROR("Node(%p) WsTcp(%p) inflate failed:%d %s.",
+                  getConnectNode(), this, zret, zs->msg ? zs->msg : "");
+        ret = -(WsInflateFailed);
+        break;
+      }
+    } while (zs->avail_in > 0 || zs->avail_out == 0);
   }
+  if (ret == Success) {
+    _inflatingMessage = !fin;
+  }
+  MUTEX_UNLOCK(_mtxDeflate);
 
-  header[0] = 0x80 | codeType;
+  if (ret < 0) {
+    return ret;
+  }
+  utility::NlsMetrics::addCounter(utility::MetricWsDeflateRxWire, length);
+  utility::NlsMetrics::addCounter(utility::MetricWsDeflateRxRaw, produced);
+  return (int)produced;
+}
 
-  if (length < 126) {
-    header[1] = (length & 0xff) | (useMask ? 0x80 : 0);
-    if (useMask) {
-      header[2] = masKingKey[0];
-      header[3] = masKingKey[1];
-      header[4] = masKingKey[2];
-      header[5] = masKingKey[3];
+/**
+ * @brief: 压缩一条文本消息到_deflateBuffer, 调用前须持有_mtxDeflate
+ * @return: 压缩后的字节数, 0表示不压缩, 按原样发送.
+ */
+int WebSocketTcp::deflateMessageLocked(const uint8_t* buffer, size_t length) {
+  if (!_deflateTx || _deflatePool == NULL || buffer == NULL || length == 0) {
+    return 0;
+  }
+  if (_deflater == NULL) {
+    int bits = _clientMaxWindowBits < WsDeflatePool::DeflateWindowBits
+                   ? _clientMaxWindowBits
+                   : WsDeflatePool::DeflateWindowBits;
+    _deflater = _deflatePool->acquire(true, bits);
+    if (_deflater == NULL) {
+      _deflateTx = false;
+      return 0;
     }
-  } else if (length < 65536) {
-    header[1] = 126 | (useMask ? 0x80 : 0);
-    header[2] = (length >> 8) & 0xff;
-    header[3] = (length >> 0) & 0xff;
-    if (useMask) {
-      header[4] = masKingKey[0];
-      header[5] = masKingKey[1];
-      header[6] = masKingKey[2];
-      header[7] = masKingKey[3];
+  }
+
+  z_stream* zs = &_deflater->zs;
+  size_t bound = deflateBound(zs, length) + 16;
+  if (_deflateBuffer.size() < bound) {
+    _deflateBuffer.resize(bound);
+  }
+  zs->next_in = (Bytef*)buffer;
+  zs->avail_in = (uInt)length;
+  size_t produced = 0;
+  do {
+    if (_deflateBuffer.size() - produced < 64) {
+      _deflateBuffer.resize(_deflateBuffer.size() * 2);
     }
-  } else {  // TODO: run coverage testing here
-    header[1] = 127 | (useMask ? 0x80 : 0);
-    header[2] = ((uint64_t)length >> 56) & 0xff;
-    header[3] = ((uint64_t)length >> 48) & 0xff;
-    header[4] = ((uint64_t)length >> 40) & 0xff;
-    header[5] = ((uint64_t)length >> 32) & 0xff;
-    header[6] = ((uint64_t)length >> 24) & 0xff;
-    header[7] = ((uint64_t)length >> 16) & 0xff;
-    header[8] = ((uint64_t)length >> 8) & 0xff;
-    header[9] = ((uint64_t)length >> 0) & 0xff;
-    if (useMask) {
-      header[10] = masKingKey[0];
-      header[11] = masKingKey[1];
-      header[12] = masKingKey[2];
-      header[13] = masKingKey[3];
+    zs->next_out = &_deflateBuffer[produced];
+    zs->avail_out = (uInt)(_deflateBuffer.size() - produced);
+    int zret = deflate(zs, Z_SYNC_FLUSH);
+    produced = _deflateBuffer.size() - zs->avail_out;
+    if (zret != Z_OK && zret != Z_BUF_ERROR) {
+      /* 上行上下文已损坏, 之后的消息不再压缩 */
+      LOG_ERROR("Node(%p) WsTcp(%p) deflate failed:%d.", getConnectNode(),
+                this, zret);
+      _deflatePool->release(_deflater);
+      _deflater = NULL;
+      _deflateTx = false;
+      return 0;
     }
+  } while (zs->avail_in > 0 || zs->avail_out == 0);
+
+  if (produced >= 4 && _deflateBuffer[produced - 4] == 0x00 &&
+      _deflateBuffer[produced - 3] == 0x00 &&
+      _deflateBuffer[produced - 2] == 0xff &&
+      _deflateBuffer[produced - 1] == 0xff) {
+    produced -= 4;
+  }
+  if (_clientNoContextTakeover) {
+    deflateReset(zs);
   }
 
-  // N.B. - tmpBuffer will keep growing until it can be transmitted over the
-  // socket: uint8_t * tmpBuffer = new uint8_t[headlen + length];
-  // memset(tmpBuffer, 0, sizeof(uint8_t) * (headlen + length));
-  // memcpy(tmpBuffer, header, headlen);
-  // memcpy(tmpBuffer + headlen, (uint8_t*)buffer, length);
+  utility::NlsMetrics::addCounter(utility::MetricWsDeflateTxRaw, length);
+  utility::NlsMetrics::addCounter(utility::MetricWsDeflateTxWire, produced);
+  return (int)produced;
+}
+#endif
 
-  *frameSize = (headlen + length);
-  *frame = (uint8_t*)calloc(*frameSize, sizeof(uint8_t));
-  if (*frame == NULL) {
-    LOG_ERROR("WsTcp(%p) calloc frame failed.", this);
-    free(header);
-    return -(MallocFailed);
+/**
+ * @brief: 复制载荷的同时按4字节掩码异或, dst与src相同时即原地加掩码.
+ *         按16字节/8字节分块, 块起点都是4的倍数, 掩码相位不变.
+ */
+static void maskCopy(uint8_t* dst, const uint8_t* src, size_t length,
+                     uint32_t maskKey) {
+  uint8_t key[4];
+  memcpy(key, &maskKey, 4);
+  uint64_t key64 = ((uint64_t)maskKey << 32) | maskKey;
+  size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128i key128 = _mm_set1_epi32((int)maskKey);
+  for (; i + 16 <= length; i += 16) {
+    __m128i data = _mm_loadu_si128((const __m128i*)(src + i));
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(data, key128));
   }
-  memcpy(*frame, header, headlen);
-  if (buffer && length > 0) {
-    memcpy(*frame + headlen, (uint8_t*)buffer, length);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint8x16_t key128 = vreinterpretq_u8_u32(vdupq_n_u32(maskKey));
+  for (; i + 16 <= length; i += 16) {
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(src + i), key128));
+  }
+#endif
+  for (; i + 8 <= length; i += 8) {
+    uint64_t data;
+    memcpy(&data, src + i, 8);
+    data ^= key64;
+    memcpy(dst + i, &data, 8);
+  }
+  for (; i < length; i++) {
+    dst[i] = src[i] ^ key[i & 0x3];
+  }
+}
+
+size_t WebSocketTcp::frameHeaderSize(size_t length) {
+  return 2 + (length >= 126 ? 2 : 0) + (length >= 65536 ? 6 : 0) + 4;
+}
+
+size_t WebSocketTcp::framePackage(WebSocketHeaderType::OpCodeType codeType,
+                                  const uint8_t* buffer, size_t length,
+                                  uint8_t* frame, bool compressed) {
+  const size_t headlen = frameHeaderSize(length);
+  const uint32_t maskKey = _maskKey.load(std::memory_order_relaxed);
+
+  frame[0] = 0x80 | (compressed ? 0x40 : 0) | codeType;
+  if (length < 126) {
+    frame[1] = (length & 0xff) | 0x80;
+  } else if (length < 65536) {
+    frame[1] = 126 | 0x80;
+    frame[2] = (length >> 8) & 0xff;
+    frame[3] = (length >> 0) & 0xff;
+  } else {
+    frame[1] = 127 | 0x80;
+    for (int i = 0; i < 8; i++) {
+      frame[2 + i] = ((uint64_t)length >> ((7 - i) * 8)) & 0xff;
+    }
   }
+  /* 掩码按内存序写入, 与maskCopy中的取法一致 */
+  memcpy(frame + headlen - 4, &maskKey, 4);
 
 #ifdef OPU_DEBUG
   std::ofstream ofs;
@@ -649,18 +991,61 @@ int WebSocketTcp::framePackage(WebSocketHeaderType::OpCodeType codeType,
   }
 #endif
 
-  // LOG_DEBUG("framePackage Receive Data: %d ", *frameSize);
+  if (buffer && length > 0) {
+    maskCopy(frame + headlen, buffer, length, maskKey);
+  }
+  return headlen + length;
+}
 
-  if (useMask) {
-    for (size_t i = 0; i != length; ++i) {
-      *(*frame + headlen + length - length + i) ^= masKingKey[i & 0x3];
-    }
+int WebSocketTcp::frameToBuffer(WebSocketHeaderType::OpCodeType type,
+                                const uint8_t* buffer, size_t length,
+                                struct evbuffer* output, bool compressed) {
+  const size_t frameSize = frameHeaderSize(length) + length;
+  struct evbuffer_iovec vec;
+  if (evbuffer_reserve_space(output, frameSize, &vec, 1) != 1 ||
+      vec.iov_len < frameSize) {
+    LOG_ERROR("WsTcp(%p) reserve %zubytes in evbuffer failed.", this,
+              frameSize);
+    return -(MallocFailed);
+  }
+  vec.iov_len = framePackage(type, buffer, length, (uint8_t*)vec.iov_base,
+                             compressed);
+  if (evbuffer_commit_space(output, &vec, 1) != 0) {
+    LOG_ERROR("WsTcp(%p) commit %zubytes into evbuffer failed.", this,
+              frameSize);
+    return -(MallocFailed);
   }
+  return (int)frameSize;
+}
 
-  free(header);
-  header = NULL;
+int WebSocketTcp::binaryFrame(const uint8_t* buffer, size_t length,
+                              struct evbuffer* output) {
+  return frameToBuffer(WebSocketHeaderType::BINARY_FRAME, buffer, length,
+                       output);
+}
 
-  return Success;
+int WebSocketTcp::textFrame(const uint8_t* buffer, size_t length,
+                            struct evbuffer* output) {
+#ifdef ENABLE_WS_DEFLATE
+  /* 只压缩文本指令, 音频本身已编码或压缩收益很低 */
+  MUTEX_LOCK(_mtxDeflate);
+  int compressed = deflateMessageLocked(buffer, length);
+  int ret = Success;
+  if (compressed > 0) {
+    ret = frameToBuffer(WebSocketHeaderType::TEXT_FRAME, &_deflateBuffer[0],
+                        compressed, output, true);
+  }
+  MUTEX_UNLOCK(_mtxDeflate);
+  if (compressed > 0) {
+    return ret;
+  }
+#endif
+  return frameToBuffer(WebSocketHeaderType::TEXT_FRAME, buffer, length,
+                       output);
+}
+
+int WebSocketTcp::pingFrame(struct evbuffer* output) {
+  return frameToBuffer(WebSocketHeaderType::PING, NULL, 0, output);
 }
 
 }  // namespace AlibabaNls
@@ -19,8 +19,14 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <cstring>
 #include <string>
+#include <vector>
+
+#include "wsDeflate.h"
+
+struct evbuffer;
 
 namespace AlibabaNls {
 
@@ -32,6 +38,8 @@ enum WebSocketConstValue {
   TokenSize = 512,
   BufferSize = 2048,  // 1024
   ReadBufferSize = 30720,
+  MaxInflateSize = 16 * 1024 * 1024, /* 单帧解压后的上限 */
+  MaxFrameHeaderSize = 14, /* 2字节头 + 8字节扩展长度 + 4字节掩码 */
 };
 
 union StatusCode {
@@ -48,7 +56,8 @@ enum WebSocketReceiveStatus {
 
 struct WebSocketHeaderType {
   unsigned headerSize;
-  bool fin; /* 0bit */
+  bool fin;  /* 0bit */
+  bool rsv1; /* 1bit, permessage-deflate压缩标记 */
   bool mask;
   enum OpCodeType {
     CONTINUATION = 0x0,
@@ -67,6 +76,7 @@ struct WebSocketFrame {
   WebSocketHeaderType::OpCodeType type;
   uint8_t* data;
   size_t length;
+  size_t wireLength; /* 载荷在接收缓冲区中的字节数, 解压后的帧与length不同 */
   int closeCode;
 };
 
@@ -97,13 +107,33 @@ class WebSocketTcp {
                               std::string httpHeader);
   int responsePackage(const char* content, size_t length);
 
-  int framePackage(WebSocketHeaderType::OpCodeType type, const uint8_t* buffer,
-                   size_t length, uint8_t** frame, size_t* frameSize);
-  int binaryFrame(const uint8_t* buffer, size_t length, uint8_t** frame,
-                  size_t* frameSize);
-  int textFrame(const uint8_t* buffer, size_t length, uint8_t** frame,
-                size_t* frameSize);
-  int pingFrame(uint8_t** frame, size_t* frameSize);
+  /**
+   * @brief: 客户端帧的帧头字节数, 即调用方需要在载荷前预留的空间
+   */
+  static size_t frameHeaderSize(size_t length);
+  /**
+   * @brief: 封装客户端帧, 帧头写入frame起始的frameHeaderSize(length)字节,
+   *         载荷在复制到帧头之后的同时加掩码.
+   *         buffer可以就是frame + frameHeaderSize(length), 此时原地加掩码.
+   * @param frame 至少frameHeaderSize(length) + length字节
+   * @return: 帧的总字节数
+   */
+  size_t framePackage(WebSocketHeaderType::OpCodeType type,
+                      const uint8_t* buffer, size_t length, uint8_t* frame,
+                      bool compressed = false);
+  /**
+   * @brief: 在output末尾预留连续空间并直接封装帧, 不产生中间拷贝
+   * @return: 成功则返回写入的字节数, 失败则返回负值
+   */
+  int binaryFrame(const uint8_t* buffer, size_t length,
+                  struct evbuffer* output);
+  int textFrame(const uint8_t* buffer, size_t length, struct evbuffer* output);
+  int pingFrame(struct evbuffer* output);
+
+  /**
+   * @brief: 设置本连接的掩码, 每次握手前由所属WorkThread生成
+   */
+  void setMaskKey(uint32_t maskKey) { _maskKey.store(maskKey); }
 
   int receiveFullWebSocketFrame(uint8_t* frame, size_t frameSize,
                                 WebSocketHeaderType* ws, WebSocketFrame* rData);
@@ -117,6 +147,19 @@ class WebSocketTcp {
 
   const char* getFailedMsg();
 
+#ifdef ENABLE_WS_DEFLATE
+  /**
+   * @brief: 握手前调用, 从pool取出解压流后在握手请求中携带
+   *         permessage-deflate扩展, pool为NULL或超出内存上限则不携带
+   */
+  void offerDeflate(WsDeflatePool* pool);
+  /**
+   * @brief: 连接关闭时归还zlib流
+   */
+  void releaseDeflate();
+  bool isDeflateNegotiated() { return _deflateNegotiated; }
+#endif
+
   static int parseUrlAddress(struct urlAddress& url, const char* address);
   static bool urlWithAccess(const char* address);
 
@@ -129,6 +172,34 @@ class WebSocketTcp {
   std::string _secWsKey;
 
   void* _nodeHandle;
+  std::atomic<uint32_t> _maskKey; /* 用户线程发送音频时也会读取 */
+
+#ifdef ENABLE_WS_DEFLATE
+  WsDeflatePool* _deflatePool;
+  WsZStream* _inflater;
+  WsZStream* _deflater; /* 首次发送文本消息时再取 */
+  bool _deflateOffered;
+  bool _deflateNegotiated;
+  bool _clientNoContextTakeover;
+  int _clientMaxWindowBits;
+  bool _deflateTx;        /* 上行文本消息是否压缩 */
+  bool _inflatingMessage; /* 消息首帧带RSV1, 其后续分片同样需要解压 */
+  std::vector<uint8_t> _inflateBuffer;
+  std::vector<uint8_t> _deflateBuffer;
+#ifdef _MSC_VER
+  HANDLE _mtxDeflate;
+#else
+  pthread_mutex_t _mtxDeflate;
+#endif
+
+  int parseExtensions(const std::string& response);
+  int inflateFrame(const uint8_t* buffer, size_t length, bool fin);
+  int deflateMessageLocked(const uint8_t* buffer, size_t length);
+#endif
+  const char* getExtensionsHeader();
+  int frameToBuffer(WebSocketHeaderType::OpCodeType type,
+                    const uint8_t* buffer, size_t length,
+                    struct evbuffer* output, bool compressed = false);
 
   int getTargetLen(std::string line, const char* begin, const char* end);
   const char* getSecWsKey();
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef ENABLE_WS_DEFLATE
+
+#include "wsDeflate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nlog.h"
+#include "utility.h"
+
+namespace AlibabaNls {
+
+std::atomic<size_t> WsDeflatePool::_memoryUsed(0);
+std::atomic<size_t> WsDeflatePool::_memoryLimit(DefaultMemoryLimit);
+
+WsDeflatePool::WsDeflatePool() {
+#if defined(_MSC_VER)
+  _mtxPool = CreateMutex(NULL, FALSE, NULL);
+#else
+  pthread_mutex_init(&_mtxPool, NULL);
+#endif
+}
+
+WsDeflatePool::~WsDeflatePool() {
+  MUTEX_LOCK(_mtxPool);
+  for (size_t i = 0; i < _idleStreams.size(); i++) {
+    freeStream(_idleStreams[i]);
+  }
+  _idleStreams.clear();
+  MUTEX_UNLOCK(_mtxPool);
+
+#if defined(_MSC_VER)
+  CloseHandle(_mtxPool);
+#else
+  pthread_mutex_destroy(&_mtxPool);
+#endif
+}
+
+void WsDeflatePool::setMemoryLimit(size_t bytes) {
+  _memoryLimit.store(bytes);
+  LOG_INFO("Set permessage-deflate memory limit %zubytes, used %zubytes.",
+           bytes, _memoryUsed.load());
+}
+
+size_t WsDeflatePool::getMemoryUsed() { return _memoryUsed.load(); }
+
+/**
+ * @brief: zconf.h给出的内存估算, 另加z_stream内部状态
+ */
+size_t WsDeflatePool::estimateBytes(bool deflater, int windowBits) {
+  if (deflater) {
+    return (1 << (windowBits + 2)) + (1 << (DeflateMemLevel + 9)) + 6 * 1024;
+  }
+  return (1 << windowBits) + 7 * 1024;
+}
+
+bool WsDeflatePool::reserveMemory(size_t bytes) {
+  size_t used = _memoryUsed.load();
+  do {
+    if (used + bytes > _memoryLimit.load()) {
+      return false;
+    }
+  } while (!_memoryUsed.compare_exchange_weak(used, used + bytes));
+  return true;
+}
+
+void WsDeflatePool::freeStream(WsZStream *stream) {
+  if (stream->deflater) {
+    deflateEnd(&stream->zs);
+  } else {
+    inflateEnd(&stream->zs);
+  }
+  _memoryUsed.fetch_sub(stream->memoryBytes);
+  delete stream;
+}
+
+WsZStream *WsDeflatePool::acquire(bool deflater, int windowBits) {
+  MUTEX_LOCK(_mtxPool);
+  for (size_t i = 0; i < _idleStreams.size(); i++) {
+    WsZStream *stream = _idleStreams[i];
+    if (stream->deflater == deflater && stream->windowBits == windowBits) {
+      _idleStreams[i] = _idleStreams.back();
+      _idleStreams.pop_back();
+      MUTEX_UNLOCK(_mtxPool);
+      return stream;
+    }
+  }
+  MUTEX_UNLOCK(_mtxPool);
+
+  size_t bytes = estimateBytes(deflater, windowBits);
+  if (!reserveMemory(bytes)) {
+    LOG_WARN(
+        "WsDeflatePool(%p) memory limit %zubytes reached(used %zubytes), "
+        "skip permessage-deflate.",
+        this, _memoryLimit.load(), _memoryUsed.load());
+    return NULL;
+  }
+
+  WsZStream *stream = new WsZStream();
+  memset(&stream->zs, 0, sizeof(z_stream));
+  stream->deflater = deflater;
+  stream->windowBits = windowBits;
+  stream->memoryBytes = bytes;
+  /* 负的windowBits表示raw deflate, 不带zlib头和校验 */
+  int ret = deflater ? deflateInit2(&stream->zs, Z_DEFAULT_COMPRESSION,
+                                    Z_DEFLATED, -windowBits, DeflateMemLevel,
+                                    Z_DEFAULT_STRATEGY)
+                     : inflateInit2(&stream->zs, -windowBits);
+  if (ret != Z_OK) {
+    LOG_ERROR("WsDeflatePool(%p) init %s stream failed:%d.", this,
+              deflater ? "deflate" : "inflate", ret);
+    _memoryUsed.fetch_sub(bytes);
+    delete stream;
+    return NULL;
+  }
+  return stream;
+}
+
+void WsDeflatePool::release(WsZStream *stream) {
+  if (stream == NULL) {
+    return;
+  }
+  int ret = stream->deflater ? deflateReset(&stream->zs)
+                             : inflateReset(&stream->zs);
+  if (ret == Z_OK) {
+    MUTEX_LOCK(_mtxPool);
+    if (_idleStreams.size() < MaxIdleStreams) {
+      _idleStreams.push_back(stream);
+      stream = NULL;
+    }
+    MUTEX_UNLOCK(_mtxPool);
+  }
+  if (stream) {
+    freeStream(stream);
+  }
+}
+
+}  // namespace AlibabaNls
+
+#endif  // ENABLE_WS_DEFLATE
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NLS_SDK_WS_DEFLATE_H
+#define NLS_SDK_WS_DEFLATE_H
+
+#ifdef ENABLE_WS_DEFLATE
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include <stddef.h>
+
+#include <atomic>
+#include <vector>
+
+#include "zlib.h"
+
+namespace AlibabaNls {
+
+/* 池化的zlib流, 归还时reset而不释放, 避免每个连接重新分配窗口 */
+struct WsZStream {
+ public:
+  z_stream zs;
+  bool deflater;
+  int windowBits;
+  size_t memoryBytes; /* 按zlib文档估算的占用, 计入进程级内存上限 */
+};
+
+/*
+ * permessage-deflate(RFC 7692)使用的zlib流池, 每个WorkThread一个.
+ * 开启上下文接管后流随连接存活, 压缩/解压窗口是长期占用的大块内存,
+ * 所有池中的流(含空闲流)共享一个进程级内存上限,
+ * 超出上限时连接不协商压缩, 按原样收发.
+ * 发送控制指令时可能在用户线程取流, 因此以互斥锁保护.
+ */
+class WsDeflatePool {
+ public:
+  enum WsDeflateConstValue {
+    InflateWindowBits = 15, /* 服务端压缩窗口由服务端决定, 按最大值解压 */
+    DeflateWindowBits = 12, /* 上行只有较短的json指令, 4KB窗口足够 */
+    DeflateMemLevel = 5,
+    MaxIdleStreams = 8, /* 每个池保留的空闲流个数 */
+    DefaultMemoryLimit = 32 * 1024 * 1024,
+  };
+
+  WsDeflatePool();
+  ~WsDeflatePool();
+
+  static void setMemoryLimit(size_t bytes);
+  static size_t getMemoryUsed();
+  static size_t estimateBytes(bool deflater, int windowBits);
+
+  /**
+   * @brief: 取出一个可直接使用的流
+   * @return: 超出内存上限或zlib初始化失败则返回NULL
+   */
+  WsZStream *acquire(bool deflater, int windowBits);
+
+  /**
+   * @brief: 归还流, 空闲流超过MaxIdleStreams时直接释放
+   */
+  void release(WsZStream *stream);
+
+ private:
+  static bool reserveMemory(size_t bytes);
+  static void freeStream(WsZStream *stream);
+
+  static std::atomic<size_t> _memoryUsed;
+  static std::atomic<size_t> _memoryLimit;
+
+  std::vector<WsZStream *> _idleStreams;
+
+#ifdef _MSC_VER
+  HANDLE _mtxPool;
+#else
+  pthread_mutex_t _mtxPool;
+#endif
+};
+
+}  // namespace AlibabaNls
+
+#endif  // ENABLE_WS_DEFLATE
+
+#endif  // NLS_SDK_WS_DEFLATE_H
@@ -18,15 +18,27 @@
 #include <stdio.h>
 
 #include <string.h>
+#if !defined(_MSC_VER)
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+#include <atomic>
 #include <ctime>
 #include <iostream>
 
+#if defined(_MSC_VER)
+#include <process.h>
+#endif
+
 #if defined(__ANDRIOD__)
 #include <android/log.h>
 #elif defined(_MSC_VER) || defined(__linux__)
 #include "log4cpp/Appender.hh"
 #include "log4cpp/Category.hh"
 #include "log4cpp/FileAppender.hh"
+#include "log4cpp/LoggingEvent.hh"
+#include "log4cpp/NDC.hh"
+#include "log4cpp/PassThroughLayout.hh"
 #include "log4cpp/PatternLayout.hh"
 #include "log4cpp/Priority.hh"
 #include "log4cpp/RollingFileAppender.hh"
@@ -34,6 +46,7 @@
 
 #include "event.h"
 #include "nlog.h"
+#include "text_utils.h"
 #include "utility.h"
 
 namespace AlibabaNls {
@@ -49,51 +62,142 @@ using std::string;
 #define LOG_FILE_BASE_SIZE 1024 * 1024
 #define LOG_TAG "AliSpeechLib"
 
-#define LOG_FORMAT_STRING(a, l, f, b)                                         \
-  do {                                                                        \
-    char tmpBuffer[LOG_BUFFER_SIZE] = {0};                                    \
-    va_list arg;                                                              \
-    va_start(arg, f);                                                         \
-    vsnprintf(tmpBuffer, LOG_BUFFER_SIZE - 1, f, arg);                        \
-    va_end(arg);                                                              \
-    _ssnprintf(b, LOG_BUFFER_SIZE, "[ID:0x%lx][%s:%d]%s", pthreadSelfId(), a, \
-               l, tmpBuffer);                                                 \
+#define LOG_FORMAT_STRING(a, l, f, b) \
+  do {                                \
+    va_list arg;                      \
+    va_start(arg, f);                 \
+    formatLog(b, a, l, f, arg);       \
+    va_end(arg);                      \
   } while (0)
 
-#define LOG_WASH(in, str)                                        \
-  do {                                                           \
-    std::string delim = "%";                                     \
-    std::vector<std::string> str_vector;                         \
-    std::string tmp_str(in);                                     \
-    int pos1 = 0;                                                \
-    int pos2 = tmp_str.find(delim);                              \
-    int len = delim.length();                                    \
-    while (pos2 != string::npos) {                               \
-      str_vector.push_back(tmp_str.substr(pos1, pos2 - pos1));   \
-      pos1 = pos2 + len;                                         \
-      pos2 = tmp_str.find(delim, pos1);                          \
-    }                                                            \
-    if (pos1 != tmp_str.length()) {                              \
-      str_vector.push_back(tmp_str.substr(pos1));                \
-    }                                                            \
-    std::vector<std::string>::iterator iter;                     \
-    for (iter = str_vector.begin(); iter != str_vector.end();) { \
-      str += *iter;                                              \
-      if (++iter != str_vector.end()) {                          \
-        str += "%%";                                             \
-      }                                                          \
-    }                                                            \
-  } while (0)
+/* 将%转义为%%, 避免log4cpp再次格式化 */
+static void washLogMessage(const char* in, std::string& out) {
+  size_t len = strnlen(in, LOG_BUFFER_PLUS_SIZE);
+  out.reserve(len + 16);
+  for (size_t i = 0; i < len; i++) {
+    out.push_back(in[i]);
+    if (in[i] == '%') {
+      out.push_back('%');
+    }
+  }
+}
 
-#define LOG_PRINT_COMMON(level, message)                                       \
-  do {                                                                         \
-    time_t tt = time(NULL);                                                    \
-    struct tm* ptm = localtime(&tt);                                           \
-    fprintf(stdout, "%4d-%02d-%02d %02d:%02d:%02d %s(%s): %s\n",               \
-            (int)ptm->tm_year + 1900, (int)ptm->tm_mon + 1, (int)ptm->tm_mday, \
-            (int)ptm->tm_hour, (int)ptm->tm_min, (int)ptm->tm_sec, LOG_TAG,    \
-            level, message);                                                   \
-  } while (0)
+/*
+ * 有界无锁环形队列(Vyukov MPMC), 每个槽位存放一条格式化完成的日志.
+ * 多个线程按线程ID分片写入, 写日志线程统一取出.
+ */
+class NlsLogRing {
+ public:
+  explicit NlsLogRing(size_t size)
+      : _enqueuePos(0), _dequeuePos(0), _dropped(0) {
+    size_t capacity = 2;
+    while (capacity < size) {
+      capacity <<= 1;
+    }
+    _mask = capacity - 1;
+    _slots = new Slot[capacity];
+    for (size_t i = 0; i < capacity; i++) {
+      _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  ~NlsLogRing() { delete[] _slots; }
+
+  bool push(int level, const char* message) {
+    Slot* slot = NULL;
+    size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      slot = &_slots[pos & _mask];
+      size_t seq = slot->sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+      if (diff == 0) {
+        if (_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = _enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    size_t len = strnlen(message, LOG_BUFFER_SIZE - 1);
+    memcpy(slot->message, message, len);
+    slot->message[len] = '\0';
+    slot->level = level;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(int* level, char* message) {
+    Slot* slot = NULL;
+    size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      slot = &_slots[pos & _mask];
+      size_t seq = slot->sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+      if (diff == 0) {
+        if (_dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = _dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    *level = slot->level;
+    size_t len = strnlen(slot->message, LOG_BUFFER_SIZE - 1);
+    memcpy(message, slot->message, len);
+    message[len] = '\0';
+    slot->sequence.store(pos + _mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  unsigned long long dropped() {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+  /* 队列中尚未取出的日志条数(近似值) */
+  size_t size() {
+    size_t enqueue = _enqueuePos.load(std::memory_order_relaxed);
+    size_t dequeue = _dequeuePos.load(std::memory_order_relaxed);
+    return enqueue > dequeue ? enqueue - dequeue : 0;
+  }
+
+  size_t capacity() { return _mask + 1; }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    int level;
+    char message[LOG_BUFFER_SIZE];
+  };
+
+  Slot* _slots;
+  size_t _mask;
+  std::atomic<size_t> _enqueuePos;
+  std::atomic<size_t> _dequeuePos;
+  std::atomic<unsigned long long> _dropped;
+};
+
+/* 按终端输出格式生成一行日志, 追加到batch */
+static void appendCommonLine(const char* level, const std::string& message,
+                             std::string& batch) {
+  time_t tt = time(NULL);
+  struct tm* ptm = localtime(&tt);
+  char prefix[128] = {0};
+  snprintf(prefix, sizeof(prefix), "%4d-%02d-%02d %02d:%02d:%02d %s(%s): ",
+           (int)ptm->tm_year + 1900, (int)ptm->tm_mon + 1, (int)ptm->tm_mday,
+           (int)ptm->tm_hour, (int)ptm->tm_min, (int)ptm->tm_sec, LOG_TAG,
+           level);
+  batch.append(prefix);
+  batch.append(message);
+  batch.push_back('\n');
+}
 
 #define LOG_PRINT_CALLBACK(level, message, callback)                         \
   do {                                                                       \
@@ -125,9 +229,40 @@ NlsLog::NlsLog()
       _isStdout(true),
       _isConfig(false),
       _logFileName(""),
-      _logLibeventFileName("") {}
+      _logLibeventFileName(""),
+      _isAsync(false),
+      _asyncWriterRunning(false),
+      _asyncWriterWaiting(false),
+      _reportedDroppedCount(0) {
+  for (int i = 0; i < AsyncRingNumber; i++) {
+    _asyncRings[i] = NULL;
+  }
+#if defined(_MSC_VER)
+  _asyncWriterHandle = NULL;
+  _asyncWriterEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+#else
+  _asyncWriterId = 0;
+  pthread_mutex_init(&_mtxAsyncWriter, NULL);
+  pthread_cond_init(&_cvAsyncWriter, NULL);
+#endif
+}
 
 NlsLog::~NlsLog() {
+  _isAsync = false;
+  stopAsyncWriter();
+  for (int i = 0; i < AsyncRingNumber; i++) {
+    if (_asyncRings[i]) {
+      delete _asyncRings[i];
+      _asyncRings[i] = NULL;
+    }
+  }
+#if defined(_MSC_VER)
+  CloseHandle(_asyncWriterEvent);
+#else
+  pthread_mutex_destroy(&_mtxAsyncWriter);
+  pthread_cond_destroy(&_cvAsyncWriter);
+#endif
+
 #if (!defined(__ANDRIOD__)) && (!defined(__APPLE__))
 #if defined(_MSC_VER) || defined(__linux__)
   if (!_isStdout && _isConfig) {
@@ -172,6 +307,21 @@ static log4cpp::Category& getCategory() {
       log4cpp::Category::getRoot().getInstance("alibabaNlsLog");
   return _category;
 }
+
+/*
+ * 每行日志的格式. 文件appender使用PassThroughLayout,
+ * 由此layout逐行格式化后拼接, 使一批日志只需一次appender写入.
+ */
+static log4cpp::PatternLayout* newLineLayout() {
+  log4cpp::PatternLayout* layout = new log4cpp::PatternLayout();
+  layout->setConversionPattern("%d: %p %c%x: %m%n");
+  return layout;
+}
+
+static log4cpp::PatternLayout& getLineLayout() {
+  static log4cpp::PatternLayout* layout = newLineLayout();
+  return *layout;
+}
 #endif
 #endif
 
@@ -196,9 +346,8 @@ void NlsLog::logConfig(const char* name, int level, size_t fileSize,
   if (!_isConfig) {
 #if (!defined(__ANDRIOD__)) && (!defined(__APPLE__))
     if (name && (fileSize > 0)) {
-      log4cpp::PatternLayout* layout;
-      layout = new log4cpp::PatternLayout();
-      layout->setConversionPattern("%d: %p %c%x: %m%n");
+      /* 每行的格式由getLineLayout()生成, appender原样写入 */
+      log4cpp::PassThroughLayout* layout = new log4cpp::PassThroughLayout();
 
       _logFileName = name;
       _logLibeventFileName = name;
@@ -250,22 +399,8 @@ void NlsLog::logVerbose(const char* function, int line, const char* format,
   }
 
   char message[LOG_BUFFER_PLUS_SIZE] = {0};
-  std::string str_in = "";
   LOG_FORMAT_STRING(function, line, format, message);
-  LOG_WASH(message, str_in);
-
-#if defined(__ANDRIOD__)
-  __android_log_print(ANDROID_LOG_VERBOSE, LOG_TAG, "%s", str_in.c_str());
-#elif defined(_MSC_VER) || defined(__linux__)
-  if (!_isStdout) {
-    getCategory().debug(str_in.c_str());
-  } else {
-    LOG_PRINT_COMMON("VERBOSE", str_in.c_str());
-  }
-#else
-  LOG_PRINT_COMMON("VERBOSE", str_in.c_str());
-#endif
-  LOG_PRINT_CALLBACK(AlibabaNls::LogDebug, str_in.c_str(), _callback);
+  outputLog(OutputVerbose, message);
 }
 
 void NlsLog::logDebug(const char* function, int line, const char* format, ...) {
@@ -275,22 +410,8 @@ void NlsLog::logDebug(const char* function, int line, const char* format, ...) {
 
   if (_logLevel >= 4) {
     char message[LOG_BUFFER_PLUS_SIZE] = {0};
-    std::string str_in = "";
     LOG_FORMAT_STRING(function, line, format, message);
-    LOG_WASH(message, str_in);
-
-#if defined(__ANDRIOD__)
-    __android_log_print(ANDROID_LOG_VERBOSE, LOG_TAG, "%s", str_in.c_str());
-#elif defined(_MSC_VER) || defined(__linux__)
-    if (!_isStdout) {
-      getCategory().debug(str_in.c_str());
-    } else {
-      LOG_PRINT_COMMON("DEBUG", str_in.c_str());
-    }
-#else
-    LOG_PRINT_COMMON("DEBUG", str_in.c_str());
-#endif
-    LOG_PRINT_CALLBACK(AlibabaNls::LogDebug, str_in.c_str(), _callback);
+    outputLog(OutputDebug, message);
   }
 }
 
@@ -301,22 +422,8 @@ void NlsLog::logInfo(const char* function, int line, const char* format, ...) {
 
   if (_logLevel >= 3) {
     char message[LOG_BUFFER_PLUS_SIZE] = {0};
-    std::string str_in = "";
     LOG_FORMAT_STRING(function, line, format, message);
-    LOG_WASH(message, str_in);
-
-#if defined(__ANDRIOD__)
-    __android_log_print(ANDROID_LOG_VERBOSE, LOG_TAG, "%s", str_in.c_str());
-#elif defined(_MSC_VER) || defined(__linux__)
-    if (!_isStdout) {
-      getCategory().info(str_in.c_str());
-    } else {
-      LOG_PRINT_COMMON("INFO", str_in.c_str());
-    }
-#else
-    LOG_PRINT_COMMON("INFO", str_in.c_str());
-#endif
-    LOG_PRINT_CALLBACK(AlibabaNls::LogInfo, str_in.c_str(), _callback);
+    outputLog(OutputInfo, message);
   }
 }
 
@@ -327,22 +434,8 @@ void NlsLog::logWarn(const char* function, int line, const char* format, ...) {
 
   if (_logLevel >= 2) {
     char message[LOG_BUFFER_PLUS_SIZE] = {0};
-    std::string str_in = "";
     LOG_FORMAT_STRING(function, line, format, message);
-    LOG_WASH(message, str_in);
-
-#if defined(__ANDRIOD__)
-    __android_log_print(ANDROID_LOG_VERBOSE, LOG_TAG, "%s", str_in.c_str());
-#elif defined(_MSC_VER) || defined(__linux__)
-    if (!_isStdout) {
-      getCategory().warn(str_in.c_str());
-    } else {
-      LOG_PRINT_COMMON("WARN", str_in.c_str());
-    }
-#else
-    LOG_PRINT_COMMON("WARN", str_in.c_str());
-#endif
-    LOG_PRINT_CALLBACK(AlibabaNls::LogWarning, str_in.c_str(), _callback);
+    outputLog(OutputWarn, message);
   }
 }
 
@@ -353,22 +446,8 @@ void NlsLog::logError(const char* function, int line, const char* format, ...) {
 
   if (_logLevel >= 1) {
     char message[LOG_BUFFER_PLUS_SIZE] = {0};
-    std::string str_in = "";
     LOG_FORMAT_STRING(function, line, format, message);
-    LOG_WASH(message, str_in);
-
-#if defined(__ANDRIOD__)
-    __android_log_print(ANDROID_LOG_VERBOSE, LOG_TAG, "%s", str_in.c_str());
-#elif defined(_MSC_VER) || defined(__linux__)
-    if (!_isStdout) {
-      getCategory().error(str_in.c_str());
-    } else {
-      LOG_PRINT_COMMON("ERROR", str_in.c_str());
-    }
-#else
-    LOG_PRINT_COMMON("ERROR", str_in.c_str());
-#endif
-    LOG_PRINT_CALLBACK(AlibabaNls::LogError, str_in.c_str(), _callback);
+    outputLog(OutputError, message);
   }
 }
 
@@ -380,22 +459,318 @@ void NlsLog::logException(const char* function, int line, const char* format,
   }
 
   char message[LOG_BUFFER_PLUS_SIZE] = {0};
-  std::string str_in = "";
   LOG_FORMAT_STRING(function, line, format, message);
-  LOG_WASH(message, str_in);
+  outputLog(OutputException, message);
+}
+
+void NlsLog::formatLog(char* buffer, const char* function, int line,
+                       const char* format, va_list arg) {
+  int prefix = _ssnprintf(buffer, LOG_BUFFER_SIZE, "[ID:0x%lx][%s:%d]",
+                          pthreadSelfId(), function, line);
+  if (prefix < 0) {
+    prefix = 0;
+  } else if (prefix >= LOG_BUFFER_SIZE) {
+    prefix = LOG_BUFFER_SIZE - 1;
+  }
+  vsnprintf(buffer + prefix, LOG_BUFFER_SIZE - prefix, format, arg);
+}
+
+/**
+ * @brief: 异步模式下写入当前线程对应的环形队列, 否则直接写日志
+ * @return:
+ */
+void NlsLog::outputLog(int level, const char* message) {
+  if (_isAsync) {
+    unsigned long id = pthreadSelfId();
+    size_t index = (size_t)((id >> 8) ^ id) % AsyncRingNumber;
+    NlsLogRing* ring = _asyncRings[index];
+    if (ring) {
+      ring->push(level, message);
+      /* 超过高水位且写日志线程在等待时才唤醒, 避免每条日志都发信号 */
+      if (ring->size() >= ring->capacity() / 2 &&
+          _asyncWriterWaiting.exchange(false)) {
+        wakeAsyncWriter();
+      }
+      return;
+    }
+  }
+  writeLog(level, message);
+}
+
+void NlsLog::writeLog(int level, const char* message) {
+  std::string line;
+  appendLogLine(level, message, line);
+  flushLogBatch(line);
+}
+
+/**
+ * @brief: 格式化一条日志追加到batch, 日志回调仍逐条进行
+ * @return:
+ */
+void NlsLog::appendLogLine(int level, const char* message,
+                           std::string& batch) {
+  std::string str_in = "";
+  washLogMessage(message, str_in);
+
+  const char* level_str = "ERROR";
+  int callback_level = AlibabaNls::LogError;
+  switch (level) {
+    case OutputVerbose:
+      level_str = "VERBOSE";
+      callback_level = AlibabaNls::LogDebug;
+      break;
+    case OutputDebug:
+      level_str = "DEBUG";
+      callback_level = AlibabaNls::LogDebug;
+      break;
+    case OutputInfo:
+      level_str = "INFO";
+      callback_level = AlibabaNls::LogInfo;
+      break;
+    case OutputWarn:
+      level_str = "WARN";
+      callback_level = AlibabaNls::LogWarning;
+      break;
+    case OutputException:
+      level_str = "EXCEPTION";
+      break;
+    default:
+      break;
+  }
 
 #if defined(__ANDRIOD__)
   __android_log_print(ANDROID_LOG_VERBOSE, LOG_TAG, "%s", str_in.c_str());
 #elif defined(_MSC_VER) || defined(__linux__)
   if (!_isStdout) {
-    getCategory().fatal(str_in.c_str());
+    log4cpp::Priority::Value priority = log4cpp::Priority::ERROR;
+    switch (level) {
+      case OutputVerbose:
+      case OutputDebug:
+        priority = log4cpp::Priority::DEBUG;
+        break;
+      case OutputInfo:
+        priority = log4cpp::Priority::INFO;
+        break;
+      case OutputWarn:
+        priority = log4cpp::Priority::WARN;
+        break;
+      case OutputException:
+        priority = log4cpp::Priority::FATAL;
+        break;
+      default:
+        break;
+    }
+    log4cpp::Category& category = getCategory();
+    if (category.isPriorityEnabled(priority)) {
+      batch.append(getLineLayout().format(log4cpp::LoggingEvent(
+          category.getName(), message, log4cpp::NDC::get(), priority)));
+    }
+  } else {
+    appendCommonLine(level_str, str_in, batch);
+  }
+#else
+  appendCommonLine(level_str, str_in, batch);
+#endif
+  LOG_PRINT_CALLBACK(callback_level, str_in.c_str(), _callback);
+}
+
+/**
+ * @brief: 将batch中的日志一次写入日志文件或终端, 并清空batch
+ * @return:
+ */
+void NlsLog::flushLogBatch(std::string& batch) {
+  if (batch.empty()) {
+    return;
+  }
+
+#if defined(__ANDRIOD__)
+#elif defined(_MSC_VER) || defined(__linux__)
+  if (!_isStdout) {
+    /* 已逐行判断过级别, 以FATAL写入保证不被再次过滤 */
+    getCategory().log(log4cpp::Priority::FATAL, batch);
   } else {
-    LOG_PRINT_COMMON("EXCEPTION", str_in.c_str());
+    fwrite(batch.data(), 1, batch.size(), stdout);
+  }
+#else
+  fwrite(batch.data(), 1, batch.size(), stdout);
+#endif
+  batch.clear();
+}
+
+void NlsLog::setAsyncMode(bool enable, size_t ringSize) {
+  MUTEX_LOCK(_mtxLog);
+  if (enable) {
+    if (ringSize == 0) {
+      ringSize = AsyncRingDefaultSize;
+    }
+    /* 环形队列只在首次开启时创建, 直到日志实例销毁才释放 */
+    for (int i = 0; i < AsyncRingNumber; i++) {
+      if (_asyncRings[i] == NULL) {
+        _asyncRings[i] = new NlsLogRing(ringSize);
+      }
+    }
+    if (!_asyncWriterRunning) {
+      _asyncWriterRunning = true;
+#if defined(_MSC_VER)
+      unsigned threadId = 0;
+      _asyncWriterHandle = (HANDLE)_beginthreadex(NULL, 0, asyncWriterLoop,
+                                                  (LPVOID)this, 0, &threadId);
+#else
+      pthread_create(&_asyncWriterId, NULL, asyncWriterLoop, (void*)this);
+#endif
+    }
+    _isAsync = true;
+    MUTEX_UNLOCK(_mtxLog);
+  } else {
+    _isAsync = false;
+    MUTEX_UNLOCK(_mtxLog);
+    stopAsyncWriter();
+  }
+}
+
+unsigned long long NlsLog::getDroppedLogCount() {
+  unsigned long long dropped = 0;
+  for (int i = 0; i < AsyncRingNumber; i++) {
+    if (_asyncRings[i]) {
+      dropped += _asyncRings[i]->dropped();
+    }
+  }
+  return dropped;
+}
+
+/**
+ * @brief: 取出所有环形队列中的日志并写入, 并报告新增的丢弃数
+ * @return: 本次写入的日志条数
+ */
+size_t NlsLog::drainAsyncRings() {
+  size_t count = 0;
+  int level = OutputError;
+  char message[LOG_BUFFER_SIZE];
+  for (int i = 0; i < AsyncRingNumber; i++) {
+    if (_asyncRings[i] == NULL) {
+      continue;
+    }
+    while (_asyncRings[i]->pop(&level, message)) {
+      appendLogLine(level, message, _asyncBatch);
+      count++;
+      if (_asyncBatch.size() >= AsyncBatchFlushSize) {
+        flushLogBatch(_asyncBatch);
+      }
+    }
+  }
+
+  unsigned long long dropped = getDroppedLogCount();
+  if (dropped > _reportedDroppedCount) {
+    char report[128] = {0};
+    _ssnprintf(report, sizeof(report),
+               "[AsyncLog] %llu log messages dropped, %llu in total.",
+               dropped - _reportedDroppedCount, dropped);
+    _reportedDroppedCount = dropped;
+    appendLogLine(OutputWarn, report, _asyncBatch);
+  }
+  flushLogBatch(_asyncBatch);
+  return count;
+}
+
+/**
+ * @brief: 是否有环形队列达到高水位
+ * @return:
+ */
+bool NlsLog::asyncRingsAboveWatermark() {
+  for (int i = 0; i < AsyncRingNumber; i++) {
+    NlsLogRing* ring = _asyncRings[i];
+    if (ring && ring->size() >= ring->capacity() / 2) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief: 唤醒等待中的写日志线程
+ * @return:
+ */
+void NlsLog::wakeAsyncWriter() {
+#if defined(_MSC_VER)
+  SetEvent(_asyncWriterEvent);
+#else
+  pthread_mutex_lock(&_mtxAsyncWriter);
+  pthread_cond_signal(&_cvAsyncWriter);
+  pthread_mutex_unlock(&_mtxAsyncWriter);
+#endif
+}
+
+/**
+ * @brief: 写日志线程空闲等待, 直到有队列达到高水位或超过AsyncWriterFlushMs
+ * @return:
+ */
+void NlsLog::waitAsyncWriter() {
+#if defined(_MSC_VER)
+  _asyncWriterWaiting = true;
+  if (_asyncWriterRunning && !asyncRingsAboveWatermark()) {
+    WaitForSingleObject(_asyncWriterEvent, AsyncWriterFlushMs);
+  }
+  _asyncWriterWaiting = false;
+#else
+  struct timespec outtime;
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  uint64_t time_ms =
+      now.tv_sec * 1000 + now.tv_usec / 1000 + AsyncWriterFlushMs;
+  TextUtils::GetTimespecFromMs(&outtime, time_ms);
+  pthread_mutex_lock(&_mtxAsyncWriter);
+  _asyncWriterWaiting = true;
+  if (_asyncWriterRunning && !asyncRingsAboveWatermark()) {
+    pthread_cond_timedwait(&_cvAsyncWriter, &_mtxAsyncWriter, &outtime);
+  }
+  _asyncWriterWaiting = false;
+  pthread_mutex_unlock(&_mtxAsyncWriter);
+#endif
+}
+
+void NlsLog::stopAsyncWriter() {
+  MUTEX_LOCK(_mtxLog);
+  bool running = _asyncWriterRunning;
+  _asyncWriterRunning = false;
+  MUTEX_UNLOCK(_mtxLog);
+  if (!running) {
+    return;
+  }
+  wakeAsyncWriter();
+
+#if defined(_MSC_VER)
+  if (_asyncWriterHandle) {
+    WaitForSingleObject(_asyncWriterHandle, INFINITE);
+    CloseHandle(_asyncWriterHandle);
+    _asyncWriterHandle = NULL;
   }
 #else
-  LOG_PRINT_COMMON("EXCEPTION", str_in.c_str());
+  if (_asyncWriterId != 0) {
+    pthread_join(_asyncWriterId, NULL);
+    _asyncWriterId = 0;
+  }
+#endif
+}
+
+#if defined(_MSC_VER)
+unsigned __stdcall NlsLog::asyncWriterLoop(LPVOID arg) {
+#else
+void* NlsLog::asyncWriterLoop(void* arg) {
+#endif
+  NlsLog* log = static_cast<NlsLog*>(arg);
+  while (log->_asyncWriterRunning) {
+    if (log->drainAsyncRings() == 0) {
+      log->waitAsyncWriter();
+    }
+  }
+  /* 退出前写完剩余日志 */
+  log->drainAsyncRings();
+
+#if defined(_MSC_VER)
+  return 0;
+#else
+  return NULL;
 #endif
-  LOG_PRINT_CALLBACK(AlibabaNls::LogError, str_in.c_str(), _callback);
 }
 
 void NlsLog::dumpEvents(void* evbase) {
@@ -25,12 +25,17 @@
 #if defined(__ANDROID__)
 #include <vector>
 #endif
+#include <stdarg.h>
+
+#include <atomic>
 #include <string>
 #include "nlsClient.h"
 
 namespace AlibabaNls {
 namespace utility {
 
+class NlsLogRing;
+
 class NlsLog {
  public:
   static NlsLog* _logInstance;
@@ -47,11 +52,58 @@ class NlsLog {
   void logException(const char* function, int line, const char* format, ...);
   void dumpEvents(void* evbase);
 
+  /*
+   * 异步日志模式: 日志格式化后写入按线程分片的无锁环形队列,
+   * 由单独的写日志线程批量取出写入文件/终端/回调.
+   * 任一队列达到半满时唤醒写日志线程, 否则最多等待AsyncWriterFlushMs.
+   * 队列满时丢弃日志并计数, 不阻塞调用线程.
+   */
+  void setAsyncMode(bool enable, size_t ringSize);
+  unsigned long long getDroppedLogCount();
+
+  /* 在求值日志参数之前判断运行时日志级别 */
+  inline bool isLevelEnabled(int level) {
+    return _isConfig && _logLevel >= level;
+  }
+
  private:
   NlsLog();
   ~NlsLog();
 
+  enum NlsLogConstValue {
+    AsyncRingNumber = 8,
+    AsyncRingDefaultSize = 128,
+    /* 未达到高水位时, 写日志线程最长的等待时间 */
+    AsyncWriterFlushMs = 50,
+    /* 一批日志累计到此大小即写入一次 */
+    AsyncBatchFlushSize = 64 * 1024,
+  };
+  enum NlsLogOutputLevel {
+    OutputException = 0,
+    OutputError,
+    OutputWarn,
+    OutputInfo,
+    OutputDebug,
+    OutputVerbose,
+  };
+
   unsigned long pthreadSelfId();
+  void formatLog(char* buffer, const char* function, int line,
+                 const char* format, va_list arg);
+  void outputLog(int level, const char* message);
+  void writeLog(int level, const char* message);
+  void appendLogLine(int level, const char* message, std::string& batch);
+  void flushLogBatch(std::string& batch);
+  size_t drainAsyncRings();
+  bool asyncRingsAboveWatermark();
+  void wakeAsyncWriter();
+  void waitAsyncWriter();
+  void stopAsyncWriter();
+#if defined(_MSC_VER)
+  static unsigned __stdcall asyncWriterLoop(LPVOID arg);
+#else
+  static void* asyncWriterLoop(void* arg);
+#endif
 
 #if defined(_MSC_VER)
   static HANDLE _mtxLog;
@@ -67,57 +119,151 @@ class NlsLog {
 
   std::string _logFileName;
   std::string _logLibeventFileName;
+
+  NlsLogRing* _asyncRings[AsyncRingNumber];
+  std::atomic<bool> _isAsync;
+  std::atomic<bool> _asyncWriterRunning;
+  /* 写日志线程正在等待, 日志线程据此决定是否唤醒 */
+  std::atomic<bool> _asyncWriterWaiting;
+  unsigned long long _reportedDroppedCount;
+  /* 写日志线程中待写入的一批日志 */
+  std::string _asyncBatch;
+#if defined(_MSC_VER)
+  HANDLE _asyncWriterHandle;
+  HANDLE _asyncWriterEvent;
+#else
+  pthread_t _asyncWriterId;
+  pthread_mutex_t _mtxAsyncWriter;
+  pthread_cond_t _cvAsyncWriter;
+#endif
 };
 
 }  // namespace utility
 
+/*
+ * 编译期日志级别过滤: 高于NLS_LOG_COMPILE_LEVEL的LOG_XXX在编译期移除,
+ * 1:Error 2:Warning 3:Info 4:Debug 5:Verbose, 默认全部保留.
+ * 保留的LOG_XXX先判断运行时日志级别, 未开启时不会对参数求值.
+ * 移除的LOG_XXX仍在if (0)中引用参数, 不求值也不产生unused告警.
+ */
+#ifndef NLS_LOG_COMPILE_LEVEL
+#define NLS_LOG_COMPILE_LEVEL 5
+#endif
+
+/* VERBOSE与EXCEPTION不受运行时日志级别限制 */
+#if NLS_LOG_COMPILE_LEVEL >= 5
 #define LOG_VERBOSE(...)                                                \
   do {                                                                  \
-    if (utility::NlsLog::_logInstance) {                                \
+    if (utility::NlsLog::_logInstance &&                                \
+        utility::NlsLog::_logInstance->isLevelEnabled(LogError)) {      \
       utility::NlsLog::_logInstance->logVerbose(__FUNCTION__, __LINE__, \
                                                 __VA_ARGS__);           \
     }                                                                   \
   } while (0);
+#else
+#define LOG_VERBOSE(...)                                                \
+  do {                                                                  \
+    if (0) {                                                            \
+      utility::NlsLog::_logInstance->logVerbose(__FUNCTION__, __LINE__, \
+                                                __VA_ARGS__);           \
+    }                                                                   \
+  } while (0);
+#endif
 
+#if NLS_LOG_COMPILE_LEVEL >= 4
 #define LOG_DEBUG(...)                                                \
   do {                                                                \
-    if (utility::NlsLog::_logInstance) {                              \
+    if (utility::NlsLog::_logInstance &&                              \
+        utility::NlsLog::_logInstance->isLevelEnabled(LogDebug)) {    \
       utility::NlsLog::_logInstance->logDebug(__FUNCTION__, __LINE__, \
                                               __VA_ARGS__);           \
     }                                                                 \
   } while (0);
+#else
+#define LOG_DEBUG(...)                                                \
+  do {                                                                \
+    if (0) {                                                          \
+      utility::NlsLog::_logInstance->logDebug(__FUNCTION__, __LINE__, \
+                                              __VA_ARGS__);           \
+    }                                                                 \
+  } while (0);
+#endif
 
+#if NLS_LOG_COMPILE_LEVEL >= 3
 #define LOG_INFO(...)                                                \
   do {                                                               \
-    if (utility::NlsLog::_logInstance) {                             \
+    if (utility::NlsLog::_logInstance &&                             \
+        utility::NlsLog::_logInstance->isLevelEnabled(LogInfo)) {    \
       utility::NlsLog::_logInstance->logInfo(__FUNCTION__, __LINE__, \
                                              __VA_ARGS__);           \
     }                                                                \
   } while (0);
+#else
+#define LOG_INFO(...)                                                \
+  do {                                                               \
+    if (0) {                                                         \
+      utility::NlsLog::_logInstance->logInfo(__FUNCTION__, __LINE__, \
+                                             __VA_ARGS__);           \
+    }                                                                \
+  } while (0);
+#endif
 
+#if NLS_LOG_COMPILE_LEVEL >= 2
 #define LOG_WARN(...)                                                \
   do {                                                               \
-    if (utility::NlsLog::_logInstance) {                             \
+    if (utility::NlsLog::_logInstance &&                             \
+        utility::NlsLog::_logInstance->isLevelEnabled(LogWarning)) { \
       utility::NlsLog::_logInstance->logWarn(__FUNCTION__, __LINE__, \
                                              __VA_ARGS__);           \
     }                                                                \
   } while (0);
+#else
+#define LOG_WARN(...)                                                \
+  do {                                                               \
+    if (0) {                                                         \
+      utility::NlsLog::_logInstance->logWarn(__FUNCTION__, __LINE__, \
+                                             __VA_ARGS__);           \
+    }                                                                \
+  } while (0);
+#endif
 
+#if NLS_LOG_COMPILE_LEVEL >= 1
 #define LOG_ERROR(...)                                                \
   do {                                                                \
-    if (utility::NlsLog::_logInstance) {                              \
+    if (utility::NlsLog::_logInstance &&                              \
+        utility::NlsLog::_logInstance->isLevelEnabled(LogError)) {    \
       utility::NlsLog::_logInstance->logError(__FUNCTION__, __LINE__, \
                                               __VA_ARGS__);           \
     }                                                                 \
   } while (0);
+#else
+#define LOG_ERROR(...)                                                \
+  do {                                                                \
+    if (0) {                                                          \
+      utility::NlsLog::_logInstance->logError(__FUNCTION__, __LINE__, \
+                                              __VA_ARGS__);           \
+    }                                                                 \
+  } while (0);
+#endif
 
+#if NLS_LOG_COMPILE_LEVEL >= 1
 #define LOG_EXCEPTION(...)                                                \
   do {                                                                    \
-    if (utility::NlsLog::_logInstance) {                                  \
+    if (utility::NlsLog::_logInstance &&                                  \
+        utility::NlsLog::_logInstance->isLevelEnabled(LogError)) {        \
       utility::NlsLog::_logInstance->logException(__FUNCTION__, __LINE__, \
                                                   __VA_ARGS__);           \
     }                                                                     \
   } while (0);
+#else
+#define LOG_EXCEPTION(...)                                                \
+  do {                                                                    \
+    if (0) {                                                              \
+      utility::NlsLog::_logInstance->logException(__FUNCTION__, __LINE__, \
+                                                  __VA_ARGS__);           \
+    }                                                                     \
+  } while (0);
+#endif
 
 #define LOG_DUMP_EVENTS(p) do { \
   if (utility::NlsLog::_logInstance) { \
@@ -0,0 +1,557 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nlsMetrics.h"
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include <stdio.h>
+
+#include "json/json.h"
+#include "nlog.h"
+
+namespace AlibabaNls {
+namespace utility {
+
+/* 单独占用缓存行的计数分片 */
+struct NlsMetricsCounterShard {
+  std::atomic<uint64_t> value[MetricCounterNumber];
+  char padding[64];
+};
+
+struct NlsMetricsHistogramData {
+  std::atomic<uint64_t> sum;
+  std::atomic<uint64_t> max;
+  std::atomic<uint64_t> buckets[NlsMetrics::HistogramBucketNumber];
+};
+
+/* 单个WorkThread事件循环的最新状态 */
+struct NlsMetricsEventLoop {
+  std::atomic<bool> active;
+  std::atomic<uint64_t> lag_us;
+  std::atomic<uint64_t> max_lag_us;
+  std::atomic<uint64_t> callbacks;
+  std::atomic<uint64_t> slowest_us;
+  std::atomic<const char *> slowest_callback;
+  std::atomic<void *> slowest_node;
+  std::atomic<int> slowest_event;
+};
+
+/* 单类交互预连接池的扩缩容状态, name仅在首次更新时写入 */
+struct NlsMetricsPool {
+  std::atomic<bool> active;
+  char name[NlsMetrics::PoolNameMaxLength];
+  std::atomic<uint32_t> active_number;
+  std::atomic<uint32_t> warm_deficit;
+  std::atomic<double> pop_rate;
+  std::atomic<double> miss_rate;
+  std::atomic<double> hit_ratio;
+  std::atomic<uint64_t> scale_up;
+  std::atomic<uint64_t> scale_down;
+  std::atomic<int> last_decision;
+};
+
+struct NlsMetricsDesc {
+  const char *key;  /* Json快照中的名称 */
+  const char *name; /* OpenMetrics中的名称 */
+  const char *help;
+  bool latency; /* true: 微秒耗时, 导出时换算为秒; false: 字节 */
+};
+
+/* 静态存储期的原子变量零初始化, 无需构造 */
+static NlsMetricsCounterShard
+    g_counterShards[NlsMetrics::CounterShardNumber];
+static NlsMetricsHistogramData g_histograms[MetricHistogramNumber];
+static NlsMetricsEventLoop g_eventLoops[NlsMetrics::EventLoopMaxNumber];
+static NlsMetricsPool g_pools[NlsMetrics::PoolMaxNumber];
+
+static const NlsMetricsDesc g_counterDesc[MetricCounterNumber] = {
+    {"pool_hit", "nls_pool_hit", "Requests served by a preconnected node.",
+     false},
+    {"pool_miss", "nls_pool_miss",
+     "Requests that missed the preconnected pool.", false},
+    {"bytes_in", "nls_bytes_in", "Bytes received from the server.", false},
+    {"bytes_out", "nls_bytes_out", "Bytes sent to the server.", false},
+    {"connect_failed", "nls_connect_failed", "Failed TCP connect attempts.",
+     false},
+    {"handshake_failed", "nls_handshake_failed",
+     "Failed SSL/WebSocket handshakes.", false},
+    {"event_loop_stall", "nls_event_loop_stall",
+     "Heartbeats delayed beyond the watchdog threshold.", false},
+    {"read_wakeups", "nls_read_wakeups",
+     "WebSocket read events handled by the work threads.", false},
+    {"read_buffer_allocs", "nls_read_buffer_allocs",
+     "Heap allocations of receive buffers on the read path.", false},
+    {"timer_arms", "nls_timer_arms",
+     "Node timeouts inserted into or moved within the timer wheels.", false},
+    {"ws_deflate_rx_wire_bytes", "nls_ws_deflate_rx_wire_bytes",
+     "Compressed payload bytes of permessage-deflate messages received.",
+     false},
+    {"ws_deflate_rx_bytes", "nls_ws_deflate_rx_bytes",
+     "Payload bytes of received permessage-deflate messages after inflate.",
+     false},
+    {"ws_deflate_tx_bytes", "nls_ws_deflate_tx_bytes",
+     "Text payload bytes passed to deflate before sending.", false},
+    {"ws_deflate_tx_wire_bytes", "nls_ws_deflate_tx_wire_bytes",
+     "Compressed text payload bytes sent.", false},
+    {"ws_deflate_skipped", "nls_ws_deflate_skipped",
+     "Handshakes that did not offer permessage-deflate due to the memory "
+     "limit.",
+     false},
+};
+
+static const NlsMetricsDesc g_histogramDesc[MetricHistogramNumber] = {
+    {"connect_latency", "nls_connect_latency_seconds",
+     "TCP connect latency.", true},
+    {"handshake_latency", "nls_handshake_latency_seconds",
+     "SSL and WebSocket handshake latency.", true},
+    {"started_latency", "nls_started_latency_seconds",
+     "Latency from start to the started event.", true},
+    {"first_result_latency", "nls_first_result_latency_seconds",
+     "Latency from start to the first result event.", true},
+    {"first_binary_latency", "nls_first_binary_latency_seconds",
+     "Latency from start to the first binary frame.", true},
+    {"callback_duration", "nls_callback_duration_seconds",
+     "Duration of user callbacks.", true},
+    {"evbuffer_depth", "nls_evbuffer_depth_bytes",
+     "Pending bytes in evbuffer on each send.", false},
+    {"event_loop_lag", "nls_event_loop_lag_seconds",
+     "Scheduling lag of the WorkThread heartbeat timer.", true},
+};
+
+/* OpenMetrics导出的分桶上界, 耗时为微秒 */
+static const uint64_t g_latencyBounds[] = {
+    1000,   2500,   5000,    10000,   25000,   50000,   100000,
+    250000, 500000, 1000000, 2500000, 5000000, 10000000};
+static const uint64_t g_depthBounds[] = {1024,   4096,    16384,  65536,
+                                         262144, 1048576, 4194304};
+
+static size_t counterShardIndex() {
+#if defined(_MSC_VER)
+  unsigned long id = GetCurrentThreadId();
+#elif defined(__APPLE__)
+  unsigned long id = (unsigned long)pthread_self()->__sig;
+#else
+  unsigned long id = (unsigned long)pthread_self();
+#endif
+  return (size_t)((id >> 8) ^ id) % NlsMetrics::CounterShardNumber;
+}
+
+int NlsMetrics::histogramBucketIndex(uint64_t value) {
+  if (value < HistogramLinearNumber) {
+    return (int)value;
+  }
+  int msb = 0;
+  uint64_t v = value;
+  while (v >>= 1) {
+    msb++;
+  }
+  if (msb >= HistogramMaxBits) {
+    return HistogramBucketNumber - 1;
+  }
+  int shift = msb - HistogramSubBucketBits;
+  int sub = (int)((value >> shift) & (HistogramSubBucketNumber - 1));
+  return HistogramLinearNumber +
+         (msb - HistogramSubBucketBits - 1) * HistogramSubBucketNumber + sub;
+}
+
+uint64_t NlsMetrics::histogramBucketLowerBound(int index) {
+  if (index < HistogramLinearNumber) {
+    return (uint64_t)index;
+  }
+  int octave = (index - HistogramLinearNumber) / HistogramSubBucketNumber;
+  int sub = (index - HistogramLinearNumber) % HistogramSubBucketNumber;
+  int shift = octave + 1;
+  return ((uint64_t)(HistogramSubBucketNumber + sub)) << shift;
+}
+
+void NlsMetrics::addCounter(NlsMetricsCounter id, uint64_t value) {
+  if (id < 0 || id >= MetricCounterNumber) {
+    return;
+  }
+  g_counterShards[counterShardIndex()].value[id].fetch_add(
+      value, std::memory_order_relaxed);
+}
+
+void NlsMetrics::recordHistogram(NlsMetricsHistogram id, uint64_t value) {
+  if (id < 0 || id >= MetricHistogramNumber) {
+    return;
+  }
+  NlsMetricsHistogramData *h = &g_histograms[id];
+  h->buckets[histogramBucketIndex(value)].fetch_add(1,
+                                                    std::memory_order_relaxed);
+  h->sum.fetch_add(value, std::memory_order_relaxed);
+  uint64_t curMax = h->max.load(std::memory_order_relaxed);
+  while (value > curMax &&
+         !h->max.compare_exchange_weak(curMax, value,
+                                       std::memory_order_relaxed)) {
+  }
+}
+
+void NlsMetrics::updateEventLoop(int threadIndex, uint64_t lagUs,
+                                 uint64_t callbacks, uint64_t slowestUs,
+                                 const char *slowestCallback,
+                                 void *slowestNode, int slowestEvent) {
+  if (threadIndex < 0 || threadIndex >= EventLoopMaxNumber) {
+    return;
+  }
+  NlsMetricsEventLoop *loop = &g_eventLoops[threadIndex];
+  loop->lag_us.store(lagUs, std::memory_order_relaxed);
+  if (lagUs > loop->max_lag_us.load(std::memory_order_relaxed)) {
+    loop->max_lag_us.store(lagUs, std::memory_order_relaxed);
+  }
+  loop->callbacks.fetch_add(callbacks, std::memory_order_relaxed);
+  loop->slowest_us.store(slowestUs, std::memory_order_relaxed);
+  loop->slowest_callback.store(slowestCallback, std::memory_order_relaxed);
+  loop->slowest_node.store(slowestNode, std::memory_order_relaxed);
+  loop->slowest_event.store(slowestEvent, std::memory_order_relaxed);
+  loop->active.store(true, std::memory_order_release);
+}
+
+void NlsMetrics::updatePreconnectedPool(
+    int poolIndex, const char *name, unsigned int activeNumber,
+    unsigned int warmDeficit, double popRate, double missRate,
+    double hitRatio, uint64_t scaleUpCount, uint64_t scaleDownCount,
+    int lastDecision) {
+  if (poolIndex < 0 || poolIndex >= PoolMaxNumber) {
+    return;
+  }
+  NlsMetricsPool *pool = &g_pools[poolIndex];
+  if (!pool->active.load(std::memory_order_relaxed)) {
+    snprintf(pool->name, sizeof(pool->name), "%s", name ? name : "");
+  }
+  pool->active_number.store(activeNumber, std::memory_order_relaxed);
+  pool->warm_deficit.store(warmDeficit, std::memory_order_relaxed);
+  pool->pop_rate.store(popRate, std::memory_order_relaxed);
+  pool->miss_rate.store(missRate, std::memory_order_relaxed);
+  pool->hit_ratio.store(hitRatio, std::memory_order_relaxed);
+  pool->scale_up.store(scaleUpCount, std::memory_order_relaxed);
+  pool->scale_down.store(scaleDownCount, std::memory_order_relaxed);
+  pool->last_decision.store(lastDecision, std::memory_order_relaxed);
+  pool->active.store(true, std::memory_order_release);
+}
+
+uint64_t NlsMetrics::counterValue(NlsMetricsCounter id) {
+  uint64_t total = 0;
+  for (int i = 0; i < CounterShardNumber; i++) {
+    total += g_counterShards[i].value[id].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t NlsMetrics::histogramPercentile(const uint64_t *buckets,
+                                         uint64_t count, double percentile) {
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t target = (uint64_t)(percentile * count);
+  if (target >= count) {
+    target = count - 1;
+  }
+  uint64_t seen = 0;
+  for (int i = 0; i < HistogramBucketNumber; i++) {
+    seen += buckets[i];
+    if (seen > target) {
+      /* 取分桶的中点作为估计值 */
+      uint64_t lower = histogramBucketLowerBound(i);
+      uint64_t upper = (i + 1 < HistogramBucketNumber)
+                           ? histogramBucketLowerBound(i + 1)
+                           : lower + 1;
+      return lower + (upper - lower) / 2;
+    }
+  }
+  return histogramBucketLowerBound(HistogramBucketNumber - 1);
+}
+
+/* 读取一份分布的副本, 各字段之间不保证严格一致, 以分桶累加值作为count */
+static uint64_t loadHistogram(NlsMetricsHistogram id, uint64_t *buckets,
+                              uint64_t *sum, uint64_t *max) {
+  NlsMetricsHistogramData *h = &g_histograms[id];
+  uint64_t count = 0;
+  for (int i = 0; i < NlsMetrics::HistogramBucketNumber; i++) {
+    buckets[i] = h->buckets[i].load(std::memory_order_relaxed);
+    count += buckets[i];
+  }
+  *sum = h->sum.load(std::memory_order_relaxed);
+  *max = h->max.load(std::memory_order_relaxed);
+  return count;
+}
+
+std::string NlsMetrics::dumpSnapshot() {
+  Json::Value root(Json::objectValue);
+  Json::Value counters(Json::objectValue);
+  Json::Value histograms(Json::objectValue);
+  Json::StreamWriterBuilder writer;
+  writer["indentation"] = "";
+
+  for (int i = 0; i < MetricCounterNumber; i++) {
+    counters[g_counterDesc[i].key] =
+        (Json::UInt64)counterValue((NlsMetricsCounter)i);
+  }
+  if (NlsLog::_logInstance) {
+    counters["log_dropped"] =
+        (Json::UInt64)NlsLog::_logInstance->getDroppedLogCount();
+  }
+
+  uint64_t buckets[HistogramBucketNumber];
+  for (int i = 0; i < MetricHistogramNumber; i++) {
+    uint64_t sum = 0, max = 0;
+    uint64_t count =
+        loadHistogram((NlsMetricsHistogram)i, buckets, &sum, &max);
+    Json::Value item(Json::objectValue);
+    item["unit"] = g_histogramDesc[i].latency ? "us" : "bytes";
+    item["count"] = (Json::UInt64)count;
+    item["sum"] = (Json::UInt64)sum;
+    item["max"] = (Json::UInt64)max;
+    item["p50"] = (Json::UInt64)histogramPercentile(buckets, count, 0.5);
+    item["p90"] = (Json::UInt64)histogramPercentile(buckets, count, 0.9);
+    item["p99"] = (Json::UInt64)histogramPercentile(buckets, count, 0.99);
+    item["p999"] = (Json::UInt64)histogramPercentile(buckets, count, 0.999);
+    histograms[g_histogramDesc[i].key] = item;
+  }
+
+  Json::Value loops(Json::arrayValue);
+  for (int i = 0; i < EventLoopMaxNumber; i++) {
+    NlsMetricsEventLoop *loop = &g_eventLoops[i];
+    if (!loop->active.load(std::memory_order_acquire)) {
+      continue;
+    }
+    char node[32] = {0};
+    snprintf(node, sizeof(node), "%p",
+             loop->slowest_node.load(std::memory_order_relaxed));
+    const char *callback =
+        loop->slowest_callback.load(std::memory_order_relaxed);
+    Json::Value item(Json::objectValue);
+    item["thread"] = i;
+    item["lag_us"] = (Json::UInt64)loop->lag_us.load(std::memory_order_relaxed);
+    item["max_lag_us"] =
+        (Json::UInt64)loop->max_lag_us.load(std::memory_order_relaxed);
+    item["callbacks"] =
+        (Json::UInt64)loop->callbacks.load(std::memory_order_relaxed);
+    item["slowest_callback"] = callback ? callback : "";
+    item["slowest_callback_us"] =
+        (Json::UInt64)loop->slowest_us.load(std::memory_order_relaxed);
+    item["slowest_node"] = node;
+    item["slowest_event"] =
+        loop->slowest_event.load(std::memory_order_relaxed);
+    loops.append(item);
+  }
+
+  Json::Value pools(Json::arrayValue);
+  for (int i = 0; i < PoolMaxNumber; i++) {
+    NlsMetricsPool *pool = &g_pools[i];
+    if (!pool->active.load(std::memory_order_acquire)) {
+      continue;
+    }
+    Json::Value item(Json::objectValue);
+    item["pool"] = pool->name;
+    item["active_number"] =
+        pool->active_number.load(std::memory_order_relaxed);
+    item["warm_deficit"] = pool->warm_deficit.load(std::memory_order_relaxed);
+    item["pop_rate"] = pool->pop_rate.load(std::memory_order_relaxed);
+    item["miss_rate"] = pool->miss_rate.load(std::memory_order_relaxed);
+    item["hit_ratio"] = pool->hit_ratio.load(std::memory_order_relaxed);
+    item["scale_up_count"] =
+        (Json::UInt64)pool->scale_up.load(std::memory_order_relaxed);
+    item["scale_down_count"] =
+        (Json::UInt64)pool->scale_down.load(std::memory_order_relaxed);
+    item["last_decision"] =
+        pool->last_decision.load(std::memory_order_relaxed);
+    pools.append(item);
+  }
+
+  root["counters"] = counters;
+  root["histograms"] = histograms;
+  root["event_loops"] = loops;
+  root["preconnected_pools"] = pools;
+  return Json::writeString(writer, root);
+}
+
+std::string NlsMetrics::dumpOpenMetrics() {
+  std::string out;
+  char line[256];
+
+  for (int i = 0; i < MetricCounterNumber; i++) {
+    const NlsMetricsDesc *desc = &g_counterDesc[i];
+    snprintf(line, sizeof(line),
+             "# TYPE %s counter\n# HELP %s %s\n%s_total %llu\n", desc->name,
+             desc->name, desc->help, desc->name,
+             (unsigned long long)counterValue((NlsMetricsCounter)i));
+    out.append(line);
+  }
+  if (NlsLog::_logInstance) {
+    snprintf(line, sizeof(line),
+             "# TYPE nls_log_dropped counter\n"
+             "# HELP nls_log_dropped Log lines dropped in async mode.\n"
+             "nls_log_dropped_total %llu\n",
+             NlsLog::_logInstance->getDroppedLogCount());
+    out.append(line);
+  }
+
+  uint64_t buckets[HistogramBucketNumber];
+  for (int i = 0; i < MetricHistogramNumber; i++) {
+    const NlsMetricsDesc *desc = &g_histogramDesc[i];
+    uint64_t sum = 0, max = 0;
+    uint64_t count =
+        loadHistogram((NlsMetricsHistogram)i, buckets, &sum, &max);
+    const uint64_t *bounds = desc->latency ? g_latencyBounds : g_depthBounds;
+    size_t boundNumber =
+        desc->latency ? sizeof(g_latencyBounds) / sizeof(g_latencyBounds[0])
+                      : sizeof(g_depthBounds) / sizeof(g_depthBounds[0]);
+    double scale = desc->latency ? 1e-6 : 1.0;
+
+    snprintf(line, sizeof(line), "# TYPE %s histogram\n# HELP %s %s\n",
+             desc->name, desc->name, desc->help);
+    out.append(line);
+    if (desc->latency) {
+      snprintf(line, sizeof(line), "# UNIT %s seconds\n", desc->name);
+      out.append(line);
+    }
+
+    /* 导出分桶与HDR子桶不完全对齐, 以子桶下界判断归属 */
+    uint64_t cumulative = 0;
+    int index = 0;
+    for (size_t b = 0; b < boundNumber; b++) {
+      while (index < HistogramBucketNumber &&
+             histogramBucketLowerBound(index) <= bounds[b]) {
+        cumulative += buckets[index];
+        index++;
+      }
+      snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %llu\n", desc->name,
+               bounds[b] * scale, (unsigned long long)cumulative);
+      out.append(line);
+    }
+    snprintf(line, sizeof(line),
+             "%s_bucket{le=\"+Inf\"} %llu\n%s_count %llu\n%s_sum %g\n",
+             desc->name, (unsigned long long)count, desc->name,
+             (unsigned long long)count, desc->name, sum * scale);
+    out.append(line);
+  }
+
+  const char *loopGauges[][2] = {
+      {"nls_event_loop_current_lag_seconds",
+       "Latest heartbeat lag of each WorkThread."},
+      {"nls_event_loop_slowest_callback_seconds",
+       "Slowest callback in the latest heartbeat period."},
+  };
+  for (int g = 0; g < 2; g++) {
+    snprintf(line, sizeof(line), "# TYPE %s gauge\n# HELP %s %s\n",
+             loopGauges[g][0], loopGauges[g][0], loopGauges[g][1]);
+    out.append(line);
+    for (int i = 0; i < EventLoopMaxNumber; i++) {
+      NlsMetricsEventLoop *loop = &g_eventLoops[i];
+      if (!loop->active.load(std::memory_order_acquire)) {
+        continue;
+      }
+      uint64_t value = g == 0
+                           ? loop->lag_us.load(std::memory_order_relaxed)
+                           : loop->slowest_us.load(std::memory_order_relaxed);
+      snprintf(line, sizeof(line), "%s{thread=\"%d\"} %g\n",
+               loopGauges[g][0], i, value * 1e-6);
+      out.append(line);
+    }
+  }
+  out.append(
+      "# TYPE nls_event_loop_callbacks counter\n"
+      "# HELP nls_event_loop_callbacks Callbacks run by each WorkThread.\n");
+  for (int i = 0; i < EventLoopMaxNumber; i++) {
+    NlsMetricsEventLoop *loop = &g_eventLoops[i];
+    if (!loop->active.load(std::memory_order_acquire)) {
+      continue;
+    }
+    snprintf(line, sizeof(line),
+             "nls_event_loop_callbacks_total{thread=\"%d\"} %llu\n", i,
+             (unsigned long long)loop->callbacks.load(
+                 std::memory_order_relaxed));
+    out.append(line);
+  }
+
+  /* 0: 保持, 1: 扩容, 2: 缩容 */
+  const char *poolGauges[][2] = {
+      {"nls_pool_active_nodes", "Active preconnected node number of a pool."},
+      {"nls_pool_warm_deficit", "Scaled-up slots still waiting to connect."},
+      {"nls_pool_pop_rate", "EWMA of node pops per second."},
+      {"nls_pool_miss_rate", "EWMA of pool misses per second."},
+      {"nls_pool_hit_ratio", "EWMA based pool hit ratio."},
+      {"nls_pool_last_decision",
+       "Latest scale decision, 0:keep, 1:up, 2:down."},
+  };
+  for (int g = 0; g < 6; g++) {
+    snprintf(line, sizeof(line), "# TYPE %s gauge\n# HELP %s %s\n",
+             poolGauges[g][0], poolGauges[g][0], poolGauges[g][1]);
+    out.append(line);
+    for (int i = 0; i < PoolMaxNumber; i++) {
+      NlsMetricsPool *pool = &g_pools[i];
+      if (!pool->active.load(std::memory_order_acquire)) {
+        continue;
+      }
+      double value = 0;
+      switch (g) {
+        case 0:
+          value = pool->active_number.load(std::memory_order_relaxed);
+          break;
+        case 1:
+          value = pool->warm_deficit.load(std::memory_order_relaxed);
+          break;
+        case 2:
+          value = pool->pop_rate.load(std::memory_order_relaxed);
+          break;
+        case 3:
+          value = pool->miss_rate.load(std::memory_order_relaxed);
+          break;
+        case 4:
+          value = pool->hit_ratio.load(std::memory_order_relaxed);
+          break;
+        default:
+          value = pool->last_decision.load(std::memory_order_relaxed);
+          break;
+      }
+      snprintf(line, sizeof(line), "%s{pool=\"%s\"} %g\n", poolGauges[g][0],
+               pool->name, value);
+      out.append(line);
+    }
+  }
+  const char *poolCounters[][2] = {
+      {"nls_pool_scale_up", "Scale up decisions of a pool."},
+      {"nls_pool_scale_down", "Scale down decisions of a pool."},
+  };
+  for (int c = 0; c < 2; c++) {
+    snprintf(line, sizeof(line), "# TYPE %s counter\n# HELP %s %s\n",
+             poolCounters[c][0], poolCounters[c][0], poolCounters[c][1]);
+    out.append(line);
+    for (int i = 0; i < PoolMaxNumber; i++) {
+      NlsMetricsPool *pool = &g_pools[i];
+      if (!pool->active.load(std::memory_order_acquire)) {
+        continue;
+      }
+      uint64_t value = c == 0
+                           ? pool->scale_up.load(std::memory_order_relaxed)
+                           : pool->scale_down.load(std::memory_order_relaxed);
+      snprintf(line, sizeof(line), "%s_total{pool=\"%s\"} %llu\n",
+               poolCounters[c][0], pool->name, (unsigned long long)value);
+      out.append(line);
+    }
+  }
+
+  out.append("# EOF\n");
+  return out;
+}
+
+}  // namespace utility
+}  // namespace AlibabaNls
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NLS_SDK_METRICS_H
+#define NLS_SDK_METRICS_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+namespace AlibabaNls {
+namespace utility {
+
+/* 计数类指标 */
+enum NlsMetricsCounter {
+  MetricPoolHit = 0,     /* 从预连接池获取到可用链接 */
+  MetricPoolMiss,        /* 预连接池未命中 */
+  MetricBytesIn,         /* 收到的字节数 */
+  MetricBytesOut,        /* 发出的字节数 */
+  MetricConnectFailed,   /* 建连失败次数 */
+  MetricHandshakeFailed, /* 握手失败次数 */
+  MetricEventLoopStall,  /* 事件循环调度延迟超过阈值的次数 */
+  MetricReadWakeups,     /* 处理WebSocket读事件的次数 */
+  MetricReadBufferAlloc, /* 读路径上堆分配接收缓冲区的次数 */
+  MetricTimerArm,        /* 节点超时加入或移动到时间轮的次数 */
+  MetricWsDeflateRxWire, /* 收到的压缩消息载荷字节数 */
+  MetricWsDeflateRxRaw,  /* 压缩消息解压后的字节数 */
+  MetricWsDeflateTxRaw,  /* 压缩发送的文本消息原始字节数 */
+  MetricWsDeflateTxWire, /* 文本消息压缩后的字节数 */
+  MetricWsDeflateSkip,   /* 因内存上限未协商压缩的握手次数 */
+  MetricCounterNumber,
+};
+
+/* 分布类指标, 耗时单位为微秒, 缓存深度单位为字节 */
+enum NlsMetricsHistogram {
+  MetricConnectLatency = 0,  /* TCP建连耗时 */
+  MetricHandshakeLatency,    /* SSL及WebSocket握手耗时 */
+  MetricStartedLatency,      /* 调用start到收到Started事件 */
+  MetricFirstResultLatency,  /* 调用start到收到首个识别结果 */
+  MetricFirstBinaryLatency,  /* 调用start到收到首包音频 */
+  MetricCallbackDuration,    /* 用户回调耗时 */
+  MetricEvbufferDepth,       /* 发送时evbuffer中待发送数据量 */
+  MetricEventLoopLag,        /* WorkThread心跳定时器的调度延迟 */
+  MetricHistogramNumber,
+};
+
+/*
+ * 进程级指标登记, 所有写入均为无锁的relaxed原子操作,
+ * 计数按线程分片以避免多个WorkThread争抢同一缓存行.
+ * 分布采用HDR风格的对数-线性分桶, 每个2的幂区间16个子桶, 相对误差不超过6.25%.
+ */
+class NlsMetrics {
+ public:
+  static void addCounter(NlsMetricsCounter id, uint64_t value = 1);
+  static void recordHistogram(NlsMetricsHistogram id, uint64_t value);
+  /* WorkThread每次心跳时更新本线程上一周期的事件循环负载 */
+  static void updateEventLoop(int threadIndex, uint64_t lagUs,
+                              uint64_t callbacks, uint64_t slowestUs,
+                              const char *slowestCallback, void *slowestNode,
+                              int slowestEvent);
+  /* 预连接池工作线程每次检查后更新此类交互的扩缩容状态 */
+  static void updatePreconnectedPool(int poolIndex, const char *name,
+                                     unsigned int activeNumber,
+                                     unsigned int warmDeficit, double popRate,
+                                     double missRate, double hitRatio,
+                                     uint64_t scaleUpCount,
+                                     uint64_t scaleDownCount,
+                                     int lastDecision);
+
+  /* Json格式快照, 包括计数值及各分布的count/sum/max/p50/p90/p99/p999 */
+  static std::string dumpSnapshot();
+  /* OpenMetrics(Prometheus)文本格式, 耗时换算为秒 */
+  static std::string dumpOpenMetrics();
+
+  enum NlsMetricsConstValue {
+    CounterShardNumber = 8,
+    EventLoopMaxNumber = 128, /* 超过此序号的WorkThread不单独统计 */
+    PoolMaxNumber = 16,       /* 预连接池中交互类型的最大数量 */
+    PoolNameMaxLength = 32,
+    HistogramSubBucketBits = 4,
+    HistogramSubBucketNumber = 1 << HistogramSubBucketBits,
+    HistogramLinearNumber = HistogramSubBucketNumber * 2,
+    HistogramMaxBits = 40, /* 超过2^40的数值计入最后一个分桶 */
+    HistogramBucketNumber =
+        HistogramLinearNumber +
+        (HistogramMaxBits - HistogramSubBucketBits - 1) *
+            HistogramSubBucketNumber,
+  };
+
+  static int histogramBucketIndex(uint64_t value);
+  static uint64_t histogramBucketLowerBound(int index);
+
+ private:
+  static uint64_t counterValue(NlsMetricsCounter id);
+  static uint64_t histogramPercentile(const uint64_t *buckets, uint64_t count,
+                                      double percentile);
+};
+
+}  // namespace utility
+}  // namespace AlibabaNls
+
+#endif  // NLS_SDK_METRICS_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nlsTracing.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "text_utils.h"
+
+namespace AlibabaNls {
+namespace utility {
+
+std::atomic<NlsTracer *> NlsTracing::_tracer(NULL);
+
+static std::atomic<uint64_t> g_idState(0);
+
+/* splitmix64, 各线程共享一个原子状态, 无需加锁 */
+static uint64_t nextRandom() {
+  uint64_t state = g_idState.load(std::memory_order_relaxed);
+  if (state == 0) {
+    uint64_t seed = TextUtils::GetMonotonicUs() ^
+                    (TextUtils::GetTimestampMs() << 20) ^
+                    (uint64_t)(uintptr_t)&g_idState;
+    g_idState.compare_exchange_strong(state, seed | 1);
+  }
+  uint64_t z =
+      g_idState.fetch_add(0x9E3779B97F4A7C15ULL, std::memory_order_relaxed);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static bool isLowerHex(const char *str, size_t length) {
+  bool allZero = true;
+  for (size_t i = 0; i < length; i++) {
+    char c = str[i];
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+      return false;
+    }
+    if (c != '0') {
+      allZero = false;
+    }
+  }
+  return !allZero;
+}
+
+void NlsTracing::setTracer(NlsTracer *tracer) {
+  _tracer.store(tracer, std::memory_order_release);
+}
+
+void NlsTracing::generateId(char *hex, int bytes) {
+  for (int i = 0; i < bytes; i += 8) {
+    snprintf(hex + i * 2, 17, "%016llx", (unsigned long long)nextRandom());
+  }
+  hex[bytes * 2] = '\0';
+}
+
+bool NlsTracing::parseTraceParent(const std::string &traceParent,
+                                  char *traceId, char *parentSpanId) {
+  /* version(2)-trace_id(32)-parent_id(16)-flags(2) */
+  const char *str = traceParent.c_str();
+  if (traceParent.size() < 55 || str[2] != '-' || str[35] != '-' ||
+      str[52] != '-' || strncmp(str, "ff", 2) == 0) {
+    return false;
+  }
+  if (!isLowerHex(str + 3, 32) || !isLowerHex(str + 36, 16)) {
+    return false;
+  }
+  memcpy(traceId, str + 3, 32);
+  traceId[32] = '\0';
+  memcpy(parentSpanId, str + 36, 16);
+  parentSpanId[16] = '\0';
+  return true;
+}
+
+uint64_t NlsTracing::monotonicToUnixOffsetUs() {
+  uint64_t monotonicUs = TextUtils::GetMonotonicUs();
+  uint64_t unixUs = TextUtils::GetTimestampMs() * 1000;
+  return unixUs > monotonicUs ? unixUs - monotonicUs : 0;
+}
+
+}  // namespace utility
+}  // namespace AlibabaNls
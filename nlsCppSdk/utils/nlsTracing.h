@@ -0,0 +1,59 @@
+/*
+ * Copyright 2025 Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NLS_SDK_TRACING_H
+#define NLS_SDK_TRACING_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+#include "nlsTrace.h"
+
+namespace AlibabaNls {
+namespace utility {
+
+/*
+ * 进程级tracer登记. 未设置tracer时getTracer()返回NULL,
+ * 调用方据此跳过span的构造, 关闭时只有一次原子读的开销.
+ */
+class NlsTracing {
+ public:
+  static void setTracer(NlsTracer *tracer);
+  static NlsTracer *getTracer() {
+    return _tracer.load(std::memory_order_acquire);
+  }
+
+  /* 生成W3C Trace Context格式的随机ID, 16字节trace_id或8字节span_id */
+  static void generateId(char *hex, int bytes);
+  /*
+   * 解析"00-<trace_id>-<parent_id>-<flags>"格式的traceparent,
+   * 成功时写入traceId(33字节)和parentSpanId(17字节)
+   */
+  static bool parseTraceParent(const std::string &traceParent, char *traceId,
+                               char *parentSpanId);
+  /* 单调时钟微秒与Unix微秒的差值 */
+  static uint64_t monotonicToUnixOffsetUs();
+
+ private:
+  static std::atomic<NlsTracer *> _tracer;
+};
+
+}  // namespace utility
+}  // namespace AlibabaNls
+
+#endif  // NLS_SDK_TRACING_H
@@ -37,6 +37,8 @@ class TextUtils {
   static std::string GetTime();
   static std::string GetTimestamp();
   static uint64_t GetTimestampMs();
+  /* 单调时钟, 微秒, 仅用于计算耗时 */
+  static uint64_t GetMonotonicUs();
   static std::string GetTimeFromMs(uint64_t ms);
   static struct timeval *GetTimevalFromMs(struct timeval *tv, time_t ms);
   static struct timespec *GetTimespecFromMs(struct timespec *ts, time_t ms);
@@ -199,6 +199,7 @@ cp $git_root_path/nlsCppSdk/framework/item/iNlsRequest.h $sdk_install_folder/inc
 cp $git_root_path/nlsCppSdk/framework/common/nlsClient.h $sdk_install_folder/include/
 cp $git_root_path/nlsCppSdk/framework/common/nlsGlobal.h $sdk_install_folder/include/
 cp $git_root_path/nlsCppSdk/framework/common/nlsEvent.h $sdk_install_folder/include/
+cp $git_root_path/nlsCppSdk/framework/common/nlsTrace.h $sdk_install_folder/include/
 cp $git_root_path/nlsCppSdk/token/include/nlsToken.h $sdk_install_folder/include/
 
 
@@ -178,6 +178,7 @@ cp $git_root_path/nlsCppSdk/framework/feature/st/dashParaformerTranscriberReques
 cp $git_root_path/nlsCppSdk/framework/item/iNlsRequest.h $sdk_install_folder/include/
 cp $git_root_path/nlsCppSdk/framework/common/nlsClient.h $sdk_install_folder/include/
 cp $git_root_path/nlsCppSdk/framework/common/nlsGlobal.h $sdk_install_folder/include/
+cp $git_root_path/nlsCppSdk/framework/common/nlsTrace.h $sdk_install_folder/include/
 cp $git_root_path/nlsCppSdk/framework/common/nlsEvent.h $sdk_install_folder/include/
 cp $git_root_path/nlsCppSdk/token/include/nlsToken.h $sdk_install_folder/include/
 cp $git_root_path/nlsCppSdk/token/include/dashToken.h $sdk_install_folder/include/
@@ -236,4 +237,6 @@ mkdir -p $build_folder/demo/tests
 cp -f $git_root_path/demo/Linux/run_functional_test.sh $build_folder/demo/tests/
 chmod a+x $build_folder/demo/tests/run_functional_test.sh
 cp -f $git_root_path/demo/Linux/run_pressure_test.sh $build_folder/demo/tests/
-chmod a+x $build_folder/demo/tests/run_pressure_test.sh
\ No newline at end of file
+chmod a+x $build_folder/demo/tests/run_pressure_test.sh
+cp -f $git_root_path/demo/Linux/run_scale_test.sh $build_folder/demo/tests/
+chmod a+x $build_folder/demo/tests/run_scale_test.sh
\ No newline at end of file
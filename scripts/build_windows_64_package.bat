@@ -134,6 +134,7 @@ copy /y %project_folder%\nlsCppSdk\framework\feature\sy\speechSynthesizerRequest
 copy /y %project_folder%\nlsCppSdk\framework\common\nlsClient.h %install_include_folder%\
 copy /y %project_folder%\nlsCppSdk\framework\common\nlsEvent.h %install_include_folder%\
 copy /y %project_folder%\nlsCppSdk\framework\common\nlsGlobal.h %install_include_folder%\
+copy /y %project_folder%\nlsCppSdk\framework\common\nlsTrace.h %install_include_folder%\
 copy /y %project_folder%\nlsCppSdk\framework\item\iNlsRequest.h %install_include_folder%\
 copy /y %project_folder%\nlsCppSdk\token\include\nlsToken.h %install_include_folder%\
 copy /y %project_folder%\nlsCppSdk\token\include\FileTrans.h %install_include_folder%\